@@ -0,0 +1,388 @@
+#include "buffer/buffer_pool_manager_instance.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include "glog/logging.h"
+#include "page/bitmap_page.h"
+
+BufferPoolManagerInstance::BufferPoolManagerInstance(size_t pool_size, DiskManager *disk_manager,
+                                                     ReplacerType replacer_type, size_t replacer_k)
+    : BufferPoolManagerInstance(pool_size, 1, 0, disk_manager, replacer_type, replacer_k) {}
+
+BufferPoolManagerInstance::BufferPoolManagerInstance(size_t pool_size, uint32_t num_instances,
+                                                     uint32_t instance_index, DiskManager *disk_manager,
+                                                     ReplacerType replacer_type, size_t replacer_k)
+    : pool_size_(pool_size),
+      num_instances_(num_instances),
+      instance_index_(instance_index),
+      disk_manager_(disk_manager) {
+  ASSERT(num_instances_ > 0, "A buffer pool needs at least one instance.");
+  ASSERT(instance_index_ < num_instances_, "Instance index out of range.");
+  pages_ = new Page[pool_size_];
+  switch (replacer_type) {
+    case ReplacerType::kLRUK:
+      replacer_ = new LRUKReplacer(pool_size_, replacer_k);
+      break;
+    case ReplacerType::kClock:
+      replacer_ = new CLOCKReplacer(pool_size_);
+      break;
+    case ReplacerType::kLRU:
+    default:
+      replacer_ = new LRUReplacer(pool_size_);
+      break;
+  }
+  for (size_t i = 0; i < pool_size_; i++) {
+    free_list_.emplace_back(i);//新建page列表，全在free_list_中
+  }
+}
+
+BufferPoolManagerInstance::~BufferPoolManagerInstance() {
+  StopBackgroundFlusher();
+  for (auto &prefetch : prefetching_) {
+    prefetch.second->Wait();
+  }
+  // write back every cached page with all writes in flight at once, callers are not required to mark pages dirty
+  std::vector<IOHandle> writes;
+  for (auto page : page_table_) {
+    writes.push_back(disk_manager_->WritePageAsync(page.first, pages_[page.second].GetData()));
+  }
+  for (auto &write : writes) {
+    write->Wait();
+  }
+  delete[] pages_;
+  delete replacer_;
+}
+
+// 1.     Search the page table for the requested page (P).
+// 1.1    If P exists, pin it and return it immediately.
+// 1.2    If P does not exist, find a replacement page (R) from either the free list or the replacer.
+//        Note that pages are always found from the free list first.
+// 2.     If R is dirty, write it back to the disk.
+// 3.     Delete R from the page table and insert P.
+// 4.     Update P's metadata, read in the page content from disk, and then return a pointer to P.
+Page *BufferPoolManagerInstance::FetchPage(page_id_t page_id) {
+  //梁嘉琦加的
+  if(page_id > MAX_VALID_PAGE_ID || page_id <= INVALID_PAGE_ID) return nullptr;
+  std::scoped_lock<std::recursive_mutex> lock(latch_);
+
+  //If P exists, pin it and return it immediately.
+  auto iter = page_table_.find(page_id);
+  if (iter != page_table_.end()) {
+    frame_id_t tmp = iter->second;
+    if (WaitForPrefetch(page_id)) {
+      // the read-ahead itself was not an access, the replacer sees this fetch as the first one
+      replacer_->Remove(tmp);
+    }
+    replacer_->Pin(tmp);
+    pages_[tmp].pin_count_++;
+    return &pages_[tmp];
+  }
+  //p dos not exist, pick a frame from the free list or the replacer
+  frame_id_t tmp = TryToFindFreePage();
+  if (tmp == INVALID_FRAME_ID) return nullptr;
+  page_table_[page_id] = tmp;
+  replacer_->Pin(tmp);//let the replacer see the access
+  pages_[tmp].page_id_ = page_id;
+  pages_[tmp].pin_count_ = 1;
+  SetDirty(tmp, false);
+  //readpage from disk
+  WaitForBackgroundFlush(page_id);
+  disk_manager_->ReadPage(page_id, pages_[tmp].data_);
+  return &pages_[tmp];
+}
+
+// 0.   Pick a victim page P from either the free list or the replacer. Always pick from the free list first.
+// 1.   If all the pages in the buffer pool are pinned, return nullptr.
+// 2.   Pick a victim page P from either the free list or the replacer. Always pick from the free list first.
+// 3.   Update P's metadata, zero out memory and add P to the page table.
+// 4.   Set the page ID output parameter. Return a pointer to P.
+Page *BufferPoolManagerInstance::NewPage(page_id_t &page_id) {
+  std::scoped_lock<std::recursive_mutex> lock(latch_);
+  page_id = INVALID_PAGE_ID;
+  frame_id_t tmp = TryToFindFreePage();
+  if (tmp == INVALID_FRAME_ID) return nullptr;//如果replacer里也没有
+  page_id_t new_page_id = AllocatePage();
+  // a shard can only hold its own pages, parallel pools allocate through NewPageWithId instead
+  if (new_page_id == INVALID_PAGE_ID || static_cast<uint32_t>(new_page_id) % num_instances_ != instance_index_) {
+    if (new_page_id != INVALID_PAGE_ID) {
+      DeallocatePage(new_page_id);
+    }
+    free_list_.push_back(tmp);
+    return nullptr;
+  }
+  page_id = new_page_id;
+  //Update P's metadata
+  pages_[tmp].ResetMemory();
+  pages_[tmp].page_id_ = page_id;
+  pages_[tmp].pin_count_ = 1;
+  SetDirty(tmp, false);
+  page_table_[page_id] = tmp;
+  replacer_->Pin(tmp);
+  return &pages_[tmp];
+}
+
+Page *BufferPoolManagerInstance::NewPageWithId(page_id_t page_id) {
+  ASSERT(static_cast<uint32_t>(page_id) % num_instances_ == instance_index_, "Page does not belong to this instance.");
+  std::scoped_lock<std::recursive_mutex> lock(latch_);
+  frame_id_t tmp = TryToFindFreePage();
+  if (tmp == INVALID_FRAME_ID) return nullptr;
+  pages_[tmp].ResetMemory();
+  pages_[tmp].page_id_ = page_id;
+  pages_[tmp].pin_count_ = 1;
+  SetDirty(tmp, false);
+  page_table_[page_id] = tmp;
+  replacer_->Pin(tmp);
+  return &pages_[tmp];
+}
+
+// 0.   Make sure you call DeallocatePage!
+// 1.   Search the page table for the requested page (P).
+// 1.   If P does not exist, return true.
+// 2.   If P exists, but has a non-zero pin-count, return false. Someone is using the page.
+// 3.   Otherwise, P can be deleted. Remove P from the page table, reset its metadata and return it to the free list.
+bool BufferPoolManagerInstance::DeletePage(page_id_t page_id) {
+  std::scoped_lock<std::recursive_mutex> lock(latch_);
+  //Search the page table for the requested page
+  auto iter = page_table_.find(page_id);
+  if (iter == page_table_.end()) {
+    DeallocatePage(page_id);
+    return true;
+  }
+  frame_id_t tmp = iter->second;
+  //If P exists, but has a non-zero pin-count, return false. Someone is using the page.
+  if(pages_[tmp].pin_count_>0)
+    return false;
+  WaitForPrefetch(page_id);
+  //delete
+  page_table_.erase(iter);
+  replacer_->Remove(tmp);//the frame goes back to the free list, it must not be victimized any more
+  pages_[tmp].ResetMemory();
+  pages_[tmp].page_id_=INVALID_PAGE_ID;
+  SetDirty(tmp, false);
+  free_list_.push_back(tmp);
+  DeallocatePage(page_id);//call DeallocatePage
+  return true;
+}
+
+void BufferPoolManagerInstance::Prefetch(page_id_t page_id) {
+  if (page_id > MAX_VALID_PAGE_ID || page_id <= INVALID_PAGE_ID) return;
+  std::scoped_lock<std::recursive_mutex> lock(latch_);
+  if (page_table_.count(page_id) > 0 || flushing_pages_.count(page_id) > 0) {
+    return;
+  }
+  // a prefetch never waits, it only takes a free frame or a clean victim whose page is not being read
+  frame_id_t tmp;
+  if (!free_list_.empty()) {
+    tmp = free_list_.front();
+    free_list_.pop_front();
+  } else {
+    std::vector<frame_id_t> candidates;
+    replacer_->GetVictimCandidates(&candidates, 1);
+    if (candidates.empty()) {
+      return;
+    }
+    tmp = candidates[0];
+    page_id_t victim_page_id = pages_[tmp].GetPageId();
+    if (pages_[tmp].IsDirty() || prefetching_.count(victim_page_id) > 0) {
+      return;
+    }
+    replacer_->Remove(tmp);
+    page_table_.erase(victim_page_id);
+  }
+  page_table_[page_id] = tmp;
+  pages_[tmp].page_id_ = page_id;
+  pages_[tmp].pin_count_ = 0;
+  SetDirty(tmp, false);
+  WaitForBackgroundFlush(page_id);
+  prefetching_[page_id] = disk_manager_->ReadPageAsync(page_id, pages_[tmp].data_);
+  // unpinned right away, a page read ahead but never fetched is evicted like any other
+  replacer_->Unpin(tmp);
+}
+
+bool BufferPoolManagerInstance::UnpinPage(page_id_t page_id, bool is_dirty) {
+  std::scoped_lock<std::recursive_mutex> lock(latch_);
+  auto iter = page_table_.find(page_id);
+  if (iter == page_table_.end())
+    return false;
+  frame_id_t tmp = iter->second;
+  if (is_dirty) {
+    SetDirty(tmp, true);
+    if (flusher_running_ && num_dirty_ > dirty_high_watermark_ * pool_size_) {
+      flusher_cv_.notify_one();
+    }
+  }
+  if(pages_[tmp].pin_count_==0)
+    return true;
+  //only a page nobody is using can be replaced
+  if (--pages_[tmp].pin_count_ == 0) {
+    replacer_->Unpin(tmp);
+  }
+  return true;
+}
+
+bool BufferPoolManagerInstance::FlushPage(page_id_t page_id) {
+  std::scoped_lock<std::recursive_mutex> lock(latch_);
+  auto iter = page_table_.find(page_id);
+  if (iter == page_table_.end()) {
+    return false;
+  }
+  WaitForBackgroundFlush(page_id);
+  WaitForPrefetch(page_id);
+  disk_manager_->WritePage(page_id, pages_[iter->second].data_);
+  SetDirty(iter->second, false);
+  return true;
+}
+
+frame_id_t BufferPoolManagerInstance::TryToFindFreePage() {
+  frame_id_t tmp;
+  if (!free_list_.empty()) {//freelist first
+    tmp = free_list_.front();//pick from the head of the free list
+    free_list_.pop_front();//delete the frame id from free list
+    return tmp;
+  }
+  if (!replacer_->Victim(&tmp)) {
+    return INVALID_FRAME_ID;
+  }
+  // a prefetched page may be evicted before anyone fetched it, its read must not land in the reused frame
+  WaitForPrefetch(pages_[tmp].GetPageId());
+  if (pages_[tmp].IsDirty()) {//write back to the disk
+    WaitForBackgroundFlush(pages_[tmp].GetPageId());
+    disk_manager_->WritePage(pages_[tmp].GetPageId(), pages_[tmp].GetData());
+    SetDirty(tmp, false);
+  }
+  page_table_.erase(pages_[tmp].page_id_);//由于替换了page_id，要删除相应old值
+  return tmp;
+}
+
+void BufferPoolManagerInstance::SetDirty(frame_id_t frame_id, bool is_dirty) {
+  if (pages_[frame_id].is_dirty_ != is_dirty) {
+    pages_[frame_id].is_dirty_ = is_dirty;
+    is_dirty ? num_dirty_++ : num_dirty_--;
+  }
+}
+
+void BufferPoolManagerInstance::WaitForBackgroundFlush(page_id_t page_id) {
+  if (flushing_pages_.count(page_id) > 0) {
+    // the flusher holds the io latch for as long as its batch is being written
+    std::scoped_lock<std::mutex> io_lock(flush_io_latch_);
+  }
+}
+
+bool BufferPoolManagerInstance::WaitForPrefetch(page_id_t page_id) {
+  auto iter = prefetching_.find(page_id);
+  if (iter == prefetching_.end()) {
+    return false;
+  }
+  iter->second->Wait();
+  prefetching_.erase(iter);
+  return true;
+}
+
+void BufferPoolManagerInstance::StartBackgroundFlusher(double high_watermark, double low_watermark) {
+  ASSERT(low_watermark <= high_watermark, "Low watermark must not exceed high watermark.");
+  std::scoped_lock<std::recursive_mutex> lock(latch_);
+  dirty_high_watermark_ = high_watermark;
+  dirty_low_watermark_ = low_watermark;
+  if (!flusher_running_) {
+    stop_flusher_ = false;
+    flusher_running_ = true;
+    flusher_ = std::thread(&BufferPoolManagerInstance::BackgroundFlush, this);
+  }
+  flusher_cv_.notify_one();
+}
+
+void BufferPoolManagerInstance::StopBackgroundFlusher() {
+  {
+    std::scoped_lock<std::recursive_mutex> lock(latch_);
+    if (!flusher_running_) {
+      return;
+    }
+    stop_flusher_ = true;
+    flusher_cv_.notify_one();
+  }
+  flusher_.join();
+  std::scoped_lock<std::recursive_mutex> lock(latch_);
+  flusher_running_ = false;
+}
+
+void BufferPoolManagerInstance::BackgroundFlush() {
+  const size_t batch_size = DEFAULT_FLUSH_BATCH_SIZE;
+  std::unique_ptr<char[]> buffer(new char[batch_size * PAGE_SIZE]);
+  std::vector<std::pair<page_id_t, char *>> batch;
+  std::vector<frame_id_t> candidates;
+  std::vector<IOHandle> writes;
+  batch.reserve(batch_size);
+
+  std::unique_lock<std::recursive_mutex> lock(latch_);
+  auto above = [this](double watermark) { return num_dirty_ > watermark * pool_size_; };
+  while (!stop_flusher_) {
+    flusher_cv_.wait_for(lock, std::chrono::milliseconds(FLUSHER_INTERVAL_MS),
+                         [&] { return stop_flusher_ || above(dirty_high_watermark_); });
+    if (stop_flusher_ || !above(dirty_high_watermark_)) {
+      continue;
+    }
+    while (!stop_flusher_ && above(dirty_low_watermark_)) {
+      // 1. copy dirty frames the replacer is about to evict, they are unpinned so nobody is changing them
+      candidates.clear();
+      replacer_->GetVictimCandidates(&candidates, 4 * batch_size);
+      batch.clear();
+      for (auto frame_id : candidates) {
+        Page &page = pages_[frame_id];
+        if (!page.is_dirty_ || page.pin_count_ > 0 || batch.size() == batch_size) {
+          continue;
+        }
+        char *image = buffer.get() + batch.size() * PAGE_SIZE;
+        memcpy(image, page.data_, PAGE_SIZE);
+        batch.emplace_back(page.page_id_, image);
+        flushing_pages_.insert(page.page_id_);
+        SetDirty(frame_id, false);
+      }
+      if (batch.empty()) {
+        break;
+      }
+      // 2. write the batch in page id order without holding the buffer pool latch, all writes are in flight at once
+      std::sort(batch.begin(), batch.end());
+      std::unique_lock<std::mutex> io_lock(flush_io_latch_);
+      lock.unlock();
+      writes.clear();
+      for (auto &entry : batch) {
+        writes.push_back(disk_manager_->WritePageAsync(entry.first, entry.second));
+      }
+      for (auto &write : writes) {
+        write->Wait();
+      }
+      io_lock.unlock();
+      lock.lock();
+      for (auto &entry : batch) {
+        flushing_pages_.erase(entry.first);
+      }
+    }
+  }
+}
+
+page_id_t BufferPoolManagerInstance::AllocatePage() {
+  int next_page_id = disk_manager_->AllocatePage();
+  return next_page_id;
+}
+
+void BufferPoolManagerInstance::DeallocatePage(page_id_t page_id) {
+  disk_manager_->DeAllocatePage(page_id);
+}
+
+bool BufferPoolManagerInstance::IsPageFree(page_id_t page_id) {
+  return disk_manager_->IsPageFree(page_id);
+}
+
+// Only used for debug
+bool BufferPoolManagerInstance::CheckAllUnpinned() {
+  std::scoped_lock<std::recursive_mutex> lock(latch_);
+  bool res = true;
+  for (size_t i = 0; i < pool_size_; i++) {
+    if (pages_[i].pin_count_ != 0) {
+      res = false;
+      LOG(ERROR) << "page " << pages_[i].page_id_ << " pin count:" << pages_[i].pin_count_ << endl;
+    }
+  }
+  return res;
+}
@@ -0,0 +1,65 @@
+#include "buffer/clock_replacer.h"
+
+CLOCKReplacer::CLOCKReplacer(size_t num_pages)
+    : capacity(num_pages), clock_status(new std::atomic<uint8_t>[num_pages]) {
+  for (size_t i = 0; i < capacity; i++) {
+    clock_status[i].store(kNotInReplacer, std::memory_order_relaxed);
+  }
+}
+
+CLOCKReplacer::~CLOCKReplacer() = default;
+
+/*
+ * 时钟指针扫过的页帧若有引用位则清除，否则将其替换；
+ * 最多扫描两圈以上仍找不到说明所有页帧都被并发地固定了
+ */
+bool CLOCKReplacer::Victim(frame_id_t *frame_id) {
+  if (capacity == 0) {
+    return false;
+  }
+  for (size_t step = 0; step < 2 * capacity + 1; step++) {
+    if (size.load(std::memory_order_acquire) <= 0) {
+      return false;
+    }
+    size_t victim = clock_hand.fetch_add(1, std::memory_order_relaxed) % capacity;
+    uint8_t state = clock_status[victim].load(std::memory_order_acquire);
+    if (state == kReferenced) {
+      clock_status[victim].compare_exchange_strong(state, kUnreferenced, std::memory_order_acq_rel);
+    } else if (state == kUnreferenced &&
+               clock_status[victim].compare_exchange_strong(state, kNotInReplacer, std::memory_order_acq_rel)) {
+      size.fetch_sub(1, std::memory_order_acq_rel);
+      *frame_id = static_cast<frame_id_t>(victim);
+      return true;
+    }
+  }
+  return false;
+}
+
+void CLOCKReplacer::Pin(frame_id_t frame_id) {
+  if (clock_status[frame_id].exchange(kNotInReplacer, std::memory_order_acq_rel) != kNotInReplacer) {
+    size.fetch_sub(1, std::memory_order_acq_rel);
+  }
+}
+
+void CLOCKReplacer::Unpin(frame_id_t frame_id) {
+  if (clock_status[frame_id].exchange(kReferenced, std::memory_order_acq_rel) == kNotInReplacer) {
+    size.fetch_add(1, std::memory_order_acq_rel);
+  }
+}
+
+size_t CLOCKReplacer::Size() {
+  // the count may be briefly negative, see size
+  int64_t count = size.load(std::memory_order_acquire);
+  return count > 0 ? static_cast<size_t>(count) : 0;
+}
+
+void CLOCKReplacer::GetVictimCandidates(std::vector<frame_id_t> *frame_ids, size_t max_count) {
+  // frames the hand reaches first are victimized first, reference bits aside
+  size_t hand = clock_hand.load(std::memory_order_relaxed);
+  for (size_t step = 0; step < capacity && frame_ids->size() < max_count; step++) {
+    size_t frame_id = (hand + step) % capacity;
+    if (clock_status[frame_id].load(std::memory_order_acquire) != kNotInReplacer) {
+      frame_ids->push_back(static_cast<frame_id_t>(frame_id));
+    }
+  }
+}
@@ -0,0 +1,85 @@
+#include "buffer/lru_k_replacer.h"
+
+#include "common/macros.h"
+
+LRUKReplacer::LRUKReplacer(size_t num_pages, size_t k)
+    : max_size_(num_pages), k_(k), history_(num_pages * k), access_count_(num_pages, 0), evictable_(num_pages, false) {
+  ASSERT(k_ > 0, "k of a LRU-K replacer must be positive.");
+}
+
+LRUKReplacer::~LRUKReplacer() = default;
+
+/*
+ * 先淘汰访问次数不足k次的页帧（按第一次访问的先后），
+ * 再淘汰倒数第k次访问最早的页帧
+ */
+bool LRUKReplacer::Victim(frame_id_t *frame_id) {
+  auto &victims = history_list_.empty() ? cache_list_ : history_list_;
+  if (victims.empty()) {
+    return false;
+  }
+  *frame_id = victims.begin()->second;
+  victims.erase(victims.begin());
+  evictable_[*frame_id] = false;
+  access_count_[*frame_id] = 0;
+  return true;
+}
+
+/*
+ * 每次固定都是一次访问，固定后的页帧不能被替换
+ */
+void LRUKReplacer::Pin(frame_id_t frame_id) {
+  if (evictable_[frame_id]) {
+    EraseEvictable(frame_id);
+  }
+  RecordAccess(frame_id);
+}
+
+/*
+ * 引用计数变为0时调用，页帧按照访问历史加入替换队列
+ */
+void LRUKReplacer::Unpin(frame_id_t frame_id) {
+  if (evictable_[frame_id] || Size() >= max_size_) {
+    return;
+  }
+  // a frame handed to the replacer without ever being pinned counts as accessed now
+  if (access_count_[frame_id] == 0) {
+    RecordAccess(frame_id);
+  }
+  evictable_[frame_id] = true;
+  auto &victims = access_count_[frame_id] < k_ ? history_list_ : cache_list_;
+  victims.emplace(OldestAccess(frame_id), frame_id);
+}
+
+void LRUKReplacer::Remove(frame_id_t frame_id) {
+  if (evictable_[frame_id]) {
+    EraseEvictable(frame_id);
+  }
+  access_count_[frame_id] = 0;
+}
+
+size_t LRUKReplacer::Size() { return history_list_.size() + cache_list_.size(); }
+
+void LRUKReplacer::GetVictimCandidates(std::vector<frame_id_t> *frame_ids, size_t max_count) {
+  for (auto *victims : {&history_list_, &cache_list_}) {
+    for (auto iter = victims->begin(); iter != victims->end() && frame_ids->size() < max_count; ++iter) {
+      frame_ids->push_back(iter->second);
+    }
+  }
+}
+
+void LRUKReplacer::RecordAccess(frame_id_t frame_id) {
+  history_[frame_id * k_ + access_count_[frame_id] % k_] = current_timestamp_++;
+  access_count_[frame_id]++;
+}
+
+uint64_t LRUKReplacer::OldestAccess(frame_id_t frame_id) const {
+  size_t count = access_count_[frame_id];
+  return history_[frame_id * k_ + (count < k_ ? 0 : count % k_)];
+}
+
+void LRUKReplacer::EraseEvictable(frame_id_t frame_id) {
+  auto &victims = access_count_[frame_id] < k_ ? history_list_ : cache_list_;
+  victims.erase({OldestAccess(frame_id), frame_id});
+  evictable_[frame_id] = false;
+}
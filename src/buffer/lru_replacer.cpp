@@ -52,4 +52,9 @@ void LRUReplacer::Unpin(frame_id_t frame_id) {
 
 }
 
-size_t LRUReplacer::Size() { return victims_.size(); }
\ No newline at end of file
+size_t LRUReplacer::Size() { return victims_.size(); }
+void LRUReplacer::GetVictimCandidates(std::vector<frame_id_t> *frame_ids, size_t max_count) {
+  for (auto iter = victims_.rbegin(); iter != victims_.rend() && frame_ids->size() < max_count; ++iter) {
+    frame_ids->push_back(*iter);
+  }
+}
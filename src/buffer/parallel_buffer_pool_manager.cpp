@@ -0,0 +1,105 @@
+#include "buffer/parallel_buffer_pool_manager.h"
+
+ParallelBufferPoolManager::ParallelBufferPoolManager(size_t num_instances, size_t pool_size,
+                                                     DiskManager *disk_manager, ReplacerType replacer_type,
+                                                     size_t replacer_k)
+    : num_instances_(num_instances), pool_size_(pool_size), disk_manager_(disk_manager) {
+  ASSERT(num_instances_ > 0, "A buffer pool needs at least one instance.");
+  instances_.reserve(num_instances_);
+  for (size_t i = 0; i < num_instances_; i++) {
+    instances_.emplace_back(
+        new BufferPoolManagerInstance(pool_size_, num_instances_, i, disk_manager_, replacer_type, replacer_k));
+  }
+}
+
+ParallelBufferPoolManager::~ParallelBufferPoolManager() {
+  for (auto instance : instances_) {
+    delete instance;
+  }
+}
+
+BufferPoolManagerInstance *ParallelBufferPoolManager::GetBufferPoolManager(page_id_t page_id) {
+  return instances_[static_cast<uint32_t>(page_id) % num_instances_];
+}
+
+Page *ParallelBufferPoolManager::FetchPage(page_id_t page_id) {
+  if (page_id > MAX_VALID_PAGE_ID || page_id <= INVALID_PAGE_ID) return nullptr;
+  return GetBufferPoolManager(page_id)->FetchPage(page_id);
+}
+
+bool ParallelBufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty) {
+  if (page_id <= INVALID_PAGE_ID) return false;
+  return GetBufferPoolManager(page_id)->UnpinPage(page_id, is_dirty);
+}
+
+bool ParallelBufferPoolManager::FlushPage(page_id_t page_id) {
+  if (page_id <= INVALID_PAGE_ID) return false;
+  return GetBufferPoolManager(page_id)->FlushPage(page_id);
+}
+
+Page *ParallelBufferPoolManager::NewPage(page_id_t &page_id) {
+  // the disk manager decides the page id, which in turn decides the shard. If every frame of that shard is pinned
+  // the id is held back and another one is allocated, which may belong to a shard with a free frame.
+  page_id = INVALID_PAGE_ID;
+  std::vector<page_id_t> held_back;
+  std::vector<bool> shard_full(num_instances_, false);
+  size_t full_shards = 0;
+  Page *page = nullptr;
+  for (size_t attempt = 0; page == nullptr && full_shards < num_instances_ && attempt < 4 * num_instances_;
+       attempt++) {
+    page_id_t new_page_id = disk_manager_->AllocatePage();
+    if (new_page_id == INVALID_PAGE_ID) {
+      break;
+    }
+    size_t shard = static_cast<uint32_t>(new_page_id) % num_instances_;
+    if (!shard_full[shard]) {
+      page = instances_[shard]->NewPageWithId(new_page_id);
+    }
+    if (page == nullptr) {
+      if (!shard_full[shard]) {
+        shard_full[shard] = true;
+        full_shards++;
+      }
+      held_back.push_back(new_page_id);
+    } else {
+      page_id = new_page_id;
+    }
+  }
+  // give the held back ids back so they are reused by later allocations
+  for (auto held_back_page_id : held_back) {
+    disk_manager_->DeAllocatePage(held_back_page_id);
+  }
+  return page;
+}
+
+bool ParallelBufferPoolManager::DeletePage(page_id_t page_id) {
+  if (page_id <= INVALID_PAGE_ID) return true;
+  return GetBufferPoolManager(page_id)->DeletePage(page_id);
+}
+
+void ParallelBufferPoolManager::Prefetch(page_id_t page_id) {
+  if (page_id > MAX_VALID_PAGE_ID || page_id <= INVALID_PAGE_ID) return;
+  GetBufferPoolManager(page_id)->Prefetch(page_id);
+}
+
+bool ParallelBufferPoolManager::IsPageFree(page_id_t page_id) { return disk_manager_->IsPageFree(page_id); }
+
+bool ParallelBufferPoolManager::CheckAllUnpinned() {
+  bool res = true;
+  for (auto instance : instances_) {
+    res = instance->CheckAllUnpinned() && res;
+  }
+  return res;
+}
+
+void ParallelBufferPoolManager::StartBackgroundFlusher(double high_watermark, double low_watermark) {
+  for (auto instance : instances_) {
+    instance->StartBackgroundFlusher(high_watermark, low_watermark);
+  }
+}
+
+void ParallelBufferPoolManager::StopBackgroundFlusher() {
+  for (auto instance : instances_) {
+    instance->StopBackgroundFlusher();
+  }
+}
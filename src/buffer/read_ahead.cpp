@@ -0,0 +1,34 @@
+#include "buffer/read_ahead.h"
+
+#include <algorithm>
+
+ReadAhead::ReadAhead(BufferPoolManager *buffer_pool_manager, size_t window)
+    : buffer_pool_manager_(buffer_pool_manager), window_(window) {}
+
+void ReadAhead::OnPageAccess(page_id_t page_id, page_id_t next_page_id) {
+  if (buffer_pool_manager_ == nullptr || page_id == last_page_id_) {
+    return;
+  }
+  bool sequential = last_page_id_ != INVALID_PAGE_ID && page_id == last_page_id_ + 1;
+  last_page_id_ = page_id;
+  if (next_page_id == INVALID_PAGE_ID) {
+    return;
+  }
+  if (!sequential || next_page_id != page_id + 1) {
+    // random layout, only the next page of the chain is known to be needed
+    prefetched_until_ = INVALID_PAGE_ID;
+    buffer_pool_manager_->Prefetch(next_page_id);
+    return;
+  }
+  // refill the window once the scan has consumed half of it
+  if (prefetched_until_ != INVALID_PAGE_ID && prefetched_until_ > page_id &&
+      static_cast<size_t>(prefetched_until_ - page_id) > window_ / 2) {
+    return;
+  }
+  page_id_t from = std::max(next_page_id, prefetched_until_ + 1);
+  page_id_t until = std::min<page_id_t>(page_id + window_, MAX_VALID_PAGE_ID);
+  for (page_id_t id = from; id <= until; id++) {
+    buffer_pool_manager_->Prefetch(id);
+  }
+  prefetched_until_ = until;
+}
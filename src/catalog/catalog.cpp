@@ -119,8 +119,6 @@ dberr_t CatalogManager::CreateTable(const string &table_name, TableSchema *schem
     //init
     page_id_t meta_page_id=0;
     Page* meta_page=nullptr;
-    page_id_t table_page_id=0;
-    Page* table_page=nullptr;
     table_id_t table_id=0;
     TableMetadata* table_meta_=nullptr;
     TableHeap* table_heap_=nullptr;
@@ -133,13 +131,13 @@ dberr_t CatalogManager::CreateTable(const string &table_name, TableSchema *schem
     schema_=schema_->DeepCopySchema(schema);
     //get new table meta page
     meta_page=buffer_pool_manager_->NewPage(meta_page_id);
-    //get new table page
-    table_page=buffer_pool_manager_->NewPage(table_page_id);
+    //table init, the heap allocates its first page and its free space map
+    table_heap_=table_heap_->Create(buffer_pool_manager_,schema_, nullptr,nullptr,nullptr);
     //table meta init
-    table_meta_=table_meta_->Create(table_id,table_name,table_page_id,schema_);
+    table_meta_=table_meta_->Create(table_id,table_name,table_heap_->GetFirstPageId(),
+                                    table_heap_->GetFreeSpaceMapPageId(),schema_);
     table_meta_->SerializeTo(meta_page->GetData());
-    //table init
-    table_heap_=table_heap_->Create(buffer_pool_manager_,schema_, nullptr,nullptr,nullptr);
+    buffer_pool_manager_->UnpinPage(meta_page_id, true);
     //table info
     table_info->Init(table_meta_,table_heap_);
 
@@ -194,7 +192,7 @@ dberr_t CatalogManager::GetTables(vector<TableInfo *> &tables) const {
  */
 dberr_t CatalogManager::CreateIndex(const std::string &table_name, const string &index_name,
                                     const std::vector<std::string> &index_keys, Transaction *txn,
-                                    IndexInfo *&index_info, const string &index_type) {
+                                    IndexInfo *&index_info, const string &index_type, bool is_unique) {
   try{
     //Does the table exist?
     auto iter_find_table = table_names_.find(table_name);
@@ -241,10 +239,21 @@ dberr_t CatalogManager::CreateIndex(const std::string &table_name, const string
     //get new index meta page
     meta_page=buffer_pool_manager_->NewPage(meta_page_id);
     //create index meta
-    index_meta_=index_meta_->Create(index_id,index_name,table_id,key_map);
+    index_meta_=index_meta_->Create(index_id,index_name,table_id,key_map,is_unique);
     index_meta_->SerializeTo(meta_page->GetData());
     //Init index info
     index_info->Init(index_meta_,table_info_,buffer_pool_manager_);
+    //build the index from the rows already in the table, sorted and loaded bottom-up
+    if (index_info->GetIndex()->BuildFromTable(table_info_->GetTableHeap(), schema_, key_map, txn) != DB_SUCCESS) {
+      //a unique index over rows with duplicate keys, or a key value too long for the key, the index is left empty
+      index_info->GetIndex()->Destroy();
+      delete index_info;
+      index_info = nullptr;
+      buffer_pool_manager_->UnpinPage(meta_page_id, false);
+      buffer_pool_manager_->DeletePage(meta_page_id);
+      return DB_FAILED;
+    }
+    buffer_pool_manager_->UnpinPage(meta_page_id, true);
     //table meta
     index_names_[table_name][index_name]=index_id;
     indexes_[index_id]=index_info;
@@ -376,12 +385,21 @@ dberr_t CatalogManager::LoadTable(const table_id_t table_id, const page_id_t pag
     meta_page=buffer_pool_manager_->FetchPage(meta_page_id);
     //LOad table meta
     table_meta_->DeserializeFrom(meta_page->GetData(),table_meta_);
+    buffer_pool_manager_->UnpinPage(meta_page_id, false);
     //table init
     ASSERT(table_id==table_meta_->GetTableId(),"Load wrong table");
     table_name_=table_meta_->GetTableName();
     table_page_id=table_meta_->GetFirstPageId();
     schema_=table_meta_->GetSchema();
-    table_heap_=table_heap_->Create(buffer_pool_manager_,table_page_id,schema_,nullptr,nullptr);
+    table_heap_=table_heap_->Create(buffer_pool_manager_,table_page_id,table_meta_->GetFreeSpaceMapPageId(),schema_,
+                                    nullptr,nullptr);
+    //旧格式的表没有free space map，堆重建了一个；按新格式写回，下次不再重建
+    if(table_meta_->GetFreeSpaceMapPageId()!=table_heap_->GetFreeSpaceMapPageId()){
+      table_meta_->SetFreeSpaceMapPageId(table_heap_->GetFreeSpaceMapPageId());
+      meta_page=buffer_pool_manager_->FetchPage(meta_page_id);
+      table_meta_->SerializeTo(meta_page->GetData());
+      buffer_pool_manager_->UnpinPage(meta_page_id, true);
+    }
     //table info
     table_info->Init(table_meta_,table_heap_);
     //table meta
@@ -432,6 +450,23 @@ dberr_t CatalogManager::LoadIndex(const index_id_t index_id, const page_id_t pag
     table_name=table_info_->GetTableName();
     //Init index info
     index_info->Init(index_meta_,table_info_,buffer_pool_manager_);
+    //旧格式的索引按旧的键编码建成：清空后从表重建，再按新格式写回
+    if(index_meta_->HasOlderLayout()){
+      Index* index=index_info->GetIndex();
+      if(index!=nullptr){
+        index->Destroy();
+      }
+      if(index==nullptr||index->BuildFromTable(table_info_->GetTableHeap(),table_info_->GetSchema(),
+                                               index_meta_->GetKeyMapping(),nullptr)!=DB_SUCCESS){
+        LOG(ERROR) << "Failed to rebuild index " << index_name << " of table " << table_name
+                   << " written with an older key encoding, the index is not loaded.";
+        delete index_info;
+        buffer_pool_manager_->UnpinPage(meta_page_id, false);
+        return DB_FAILED;
+      }
+      index_meta_->SerializeTo(meta_page->GetData());
+    }
+    buffer_pool_manager_->UnpinPage(meta_page_id, index_meta_->HasOlderLayout());
     //table meta
     index_names_[table_name][index_name]=index_id;
     indexes_[index_id]=index_info;
@@ -1,16 +1,16 @@
 #include "catalog/indexes.h"
 
 IndexMetadata::IndexMetadata(const index_id_t index_id, const std::string &index_name, const table_id_t table_id,
-                             const std::vector<uint32_t> &key_map)
-    : index_id_(index_id), index_name_(index_name), table_id_(table_id), key_map_(key_map) {}
+                             const std::vector<uint32_t> &key_map, bool is_unique)
+    : index_id_(index_id), index_name_(index_name), table_id_(table_id), key_map_(key_map), is_unique_(is_unique) {}
 
 IndexMetadata *IndexMetadata::Create(const index_id_t index_id, const string &index_name, const table_id_t table_id,
-                                     const vector<uint32_t> &key_map) {
-  return new IndexMetadata(index_id, index_name, table_id, key_map);
+                                     const vector<uint32_t> &key_map, bool is_unique) {
+  return new IndexMetadata(index_id, index_name, table_id, key_map, is_unique);
 }
 
 uint32_t IndexMetadata::SerializeTo(char *buf) const {
-  /*content: MAGIC_NUM | index_id_ | index_name_ | table_id_ | key_map_ */
+  /*content: MAGIC_NUM | index_id_ | index_name_ | table_id_ | key_map_ | is_unique_ */
   uint32_t offset=0;
   //magic num
   MACH_WRITE_TO(uint32_t,buf,INDEX_METADATA_MAGIC_NUM);
@@ -36,12 +36,15 @@ uint32_t IndexMetadata::SerializeTo(char *buf) const {
     MACH_WRITE_TO(uint32_t,buf+offset,key_map_[i]);
     offset+=sizeof(uint32_t);
   }
+  //is_unique_
+  MACH_WRITE_TO(uint32_t,buf+offset,is_unique_ ? 1 : 0);
+  offset+=sizeof(uint32_t);
 
   return offset;
 }
 
 uint32_t IndexMetadata::GetSerializedSize() const {
-  return index_name_.size()+4*key_map_.size()+4*5;
+  return index_name_.size()+4*key_map_.size()+4*6;
 }
 
 
@@ -53,7 +56,8 @@ uint32_t IndexMetadata::DeserializeFrom(char *buf, IndexMetadata *&index_meta) {
   // magic num
   uint32_t magic_num = MACH_READ_UINT32(buf);
   buf += 4;
-  ASSERT(magic_num == INDEX_METADATA_MAGIC_NUM, "Failed to deserialize index info.");
+  ASSERT(magic_num == INDEX_METADATA_MAGIC_NUM || magic_num == PRE_NORMALIZED_INDEX_METADATA_MAGIC_NUM,
+         "Failed to deserialize index info.");
   // index id
   index_id_t index_id = MACH_READ_FROM(index_id_t, buf);
   buf += 4;
@@ -75,7 +79,14 @@ uint32_t IndexMetadata::DeserializeFrom(char *buf, IndexMetadata *&index_meta) {
     buf += 4;
     key_map.push_back(key_index);
   }
+  // unique or not, indexes of the older layout were all unique
+  bool is_unique = true;
+  if (magic_num == INDEX_METADATA_MAGIC_NUM) {
+    is_unique = MACH_READ_UINT32(buf) != 0;
+    buf += 4;
+  }
   // allocate space for index meta data
-  index_meta = new IndexMetadata(index_id, index_name, table_id, key_map);
+  index_meta = new IndexMetadata(index_id, index_name, table_id, key_map, is_unique);
+  index_meta->older_layout_ = magic_num != INDEX_METADATA_MAGIC_NUM;
   return buf - p;
 }
@@ -1,7 +1,7 @@
 #include "catalog/table.h"
 
 uint32_t TableMetadata::SerializeTo(char *buf) const {
-  /*content: MAGIC_NUM | table_id_ | table_name_.length() | table_name_ | root_table_id_ |schema*/
+  /*content: MAGIC_NUM | table_id_ | table_name_.length() | table_name_ | root_table_id_ | fsm_page_id_ | tuple_format | schema*/
   char* buffer = buf;
   //magic num
   MACH_WRITE_TO(uint32_t, buffer, TABLE_METADATA_MAGIC_NUM);
@@ -17,6 +17,18 @@ uint32_t TableMetadata::SerializeTo(char *buf) const {
   //root table
   MACH_WRITE_TO(int32_t, buffer,root_page_id_);
   buffer+=sizeof(int32_t);
+  //free space map
+  MACH_WRITE_TO(int32_t, buffer,fsm_page_id_);
+  buffer+=sizeof(int32_t);
+  //tuple format
+  uint32_t format = FORMAT_VARIABLE;
+  if(schema_->IsColumnar()){
+    format = FORMAT_COLUMNAR;
+  }else if(schema_->IsFixedWidth()){
+    format = FORMAT_FIXED_WIDTH;
+  }
+  MACH_WRITE_TO(uint32_t, buffer,format);
+  buffer+=sizeof(uint32_t);
 
   buffer+=schema_->SerializeTo(buffer);
 
@@ -25,7 +37,8 @@ uint32_t TableMetadata::SerializeTo(char *buf) const {
 
 uint32_t TableMetadata::GetSerializedSize() const {
   return sizeof(table_id_)+sizeof(TABLE_METADATA_MAGIC_NUM)
-         +MACH_STR_SERIALIZED_SIZE(table_name_)+sizeof(root_page_id_);
+         +MACH_STR_SERIALIZED_SIZE(table_name_)+sizeof(root_page_id_)+sizeof(fsm_page_id_)
+         +sizeof(uint32_t)+schema_->GetSerializedSize();
 }
 
 
@@ -37,7 +50,8 @@ uint32_t TableMetadata::DeserializeFrom(char *buf, TableMetadata *&table_meta) {
   // magic num
   uint32_t magic_num = MACH_READ_UINT32(buf);
   buf += 4;
-  ASSERT(magic_num == TABLE_METADATA_MAGIC_NUM, "Failed to deserialize table info.");
+  ASSERT(magic_num == TABLE_METADATA_MAGIC_NUM || magic_num == PRE_FSM_TABLE_METADATA_MAGIC_NUM,
+         "Failed to deserialize table info.");
   // table id
   table_id_t table_id = MACH_READ_FROM(table_id_t, buf);
   buf += 4;
@@ -49,11 +63,24 @@ uint32_t TableMetadata::DeserializeFrom(char *buf, TableMetadata *&table_meta) {
   // table heap root page id
   page_id_t root_page_id = MACH_READ_FROM(page_id_t, buf);
   buf += 4;
+  // a record of the older layout has neither, the heap then rebuilds its free space map from its pages
+  page_id_t fsm_page_id = INVALID_PAGE_ID;
+  uint32_t format = FORMAT_VARIABLE;
+  if (magic_num == TABLE_METADATA_MAGIC_NUM) {
+    // free space map first page id
+    fsm_page_id = MACH_READ_FROM(page_id_t, buf);
+    buf += 4;
+    // tuple format
+    format = MACH_READ_UINT32(buf);
+    buf += 4;
+  }
   // table schema
   TableSchema *schema = nullptr;
   buf += TableSchema::DeserializeFrom(buf, schema);
+  schema->SetFixedWidth(format != FORMAT_VARIABLE);
+  schema->SetColumnar(format == FORMAT_COLUMNAR);
   // allocate space for table metadata
-  table_meta = new TableMetadata(table_id, table_name, root_page_id, schema);
+  table_meta = new TableMetadata(table_id, table_name, root_page_id, fsm_page_id, schema);
   return buf - p;
 }
 
@@ -63,9 +90,14 @@ uint32_t TableMetadata::DeserializeFrom(char *buf, TableMetadata *&table_meta) {
  * @param heap Memory heap passed by TableInfo
  */
 TableMetadata *TableMetadata::Create(table_id_t table_id, std::string table_name, page_id_t root_page_id,
-                                     TableSchema *schema) {
-  return new TableMetadata(table_id, table_name, root_page_id, schema);
+                                     page_id_t fsm_page_id, TableSchema *schema) {
+  return new TableMetadata(table_id, table_name, root_page_id, fsm_page_id, schema);
 }
 
-TableMetadata::TableMetadata(table_id_t table_id, std::string table_name, page_id_t root_page_id, TableSchema *schema)
-    : table_id_(table_id), table_name_(table_name), root_page_id_(root_page_id), schema_(schema) {}
+TableMetadata::TableMetadata(table_id_t table_id, std::string table_name, page_id_t root_page_id,
+                             page_id_t fsm_page_id, TableSchema *schema)
+    : table_id_(table_id),
+      table_name_(table_name),
+      root_page_id_(root_page_id),
+      fsm_page_id_(fsm_page_id),
+      schema_(schema) {}
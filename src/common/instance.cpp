@@ -3,7 +3,12 @@
 //
 #include "common/instance.h"
 
-DBStorageEngine::DBStorageEngine(std::string db_name, bool init, uint32_t buffer_pool_size)
+#include "buffer/buffer_pool_manager_instance.h"
+#include "buffer/parallel_buffer_pool_manager.h"
+
+DBStorageEngine::DBStorageEngine(std::string db_name, bool init, uint32_t buffer_pool_size,
+                                 uint32_t buffer_pool_instances, ReplacerType replacer_type, size_t replacer_k,
+                                 bool background_flusher)
     : db_file_name_(std::move(db_name)), init_(init) {
   // Init database file if needed
   db_file_name_ = "./databases/"+db_file_name_;
@@ -12,7 +17,15 @@ DBStorageEngine::DBStorageEngine(std::string db_name, bool init, uint32_t buffer
   }
   // Initialize components
   disk_mgr_ = new DiskManager(db_file_name_);
-  bpm_ = new BufferPoolManager(buffer_pool_size, disk_mgr_);
+  if (buffer_pool_instances > 1) {
+    bpm_ = new ParallelBufferPoolManager(buffer_pool_instances, buffer_pool_size / buffer_pool_instances, disk_mgr_,
+                                         replacer_type, replacer_k);
+  } else {
+    bpm_ = new BufferPoolManagerInstance(buffer_pool_size, disk_mgr_, replacer_type, replacer_k);
+  }
+  if (background_flusher) {
+    bpm_->StartBackgroundFlusher();
+  }
 
   // Allocate static page for db storage engine
   if (init) {
@@ -38,7 +38,7 @@ bool DeleteExecutor::Next([[maybe_unused]] Row *row, RowId *rid) {
         fields.push_back(*field);
       }
       Row temp(fields);//对应的索引
-      (*itr)->GetIndex()->RemoveEntry(temp, child_rowid,nullptr);//这里的rid并不会被使用
+      (*itr)->GetIndex()->RemoveEntry(temp, child_rowid,nullptr);//非唯一索引只删除这个rid对应的项
     }
     return true;
   }
@@ -407,7 +407,7 @@ dberr_t ExecuteEngine::ExecuteCreateTable(pSyntaxNode ast, ExecuteContext *conte
     if(type=="char"){
       string len(detail_node->next_->child_->val_);
       for(auto it:len)if(!isdigit(it))return DB_FAILED;
-      if(stoi(len)<0)return DB_FAILED;
+      if(stoi(len)<0||stoi(len)>=static_cast<int>(VARCHAR_MAX_LEN))return DB_FAILED;
       column=new Column(column_name,kTypeChar,stoi(len),index,true,unique);
     }
     if(unique){
@@ -418,6 +418,30 @@ dberr_t ExecuteEngine::ExecuteCreateTable(pSyntaxNode ast, ExecuteContext *conte
     node=node->next_;
   }
   Schema *schema=new Schema(columns);
+  //create table ... using columnar 用PAX页按列存储
+  bool columnar=false;
+  for(auto format_node=ast->child_;format_node!=nullptr;format_node=format_node->next_){
+    if(format_node->type_==kNodeTableFormat){
+      string format(format_node->child_->val_);
+      if(format!="columnar"&&format!="pax"&&format!="row"){
+        cout<<"unknown table format "<<format<<endl;
+        delete schema;
+        return DB_FAILED;
+      }
+      columnar=format!="row";
+    }
+  }
+  if(columnar){
+    if(!PaxPage::CanStore(schema)){
+      cout<<"rows of table "<<table_name<<" are too wide for the columnar format"<<endl;
+      delete schema;
+      return DB_FAILED;
+    }
+    schema->SetColumnar(true);
+  }else{
+    //只有定长列且行不太宽的表用定长格式存储
+    schema->SetFixedWidth(schema->CanBeFixedWidth());
+  }
   TableInfo *table_info;
   auto res=clm->CreateTable(table_name,schema,context->GetTransaction(),table_info);
   if(res!=DB_SUCCESS)return res;
@@ -427,7 +451,7 @@ dberr_t ExecuteEngine::ExecuteCreateTable(pSyntaxNode ast, ExecuteContext *conte
     index_name += it + "_";
     index_name += "ON_" + table_name;
     IndexInfo *index_info;
-    clm->CreateIndex(table_name, index_name, unique_keys, context->GetTransaction(), index_info, "btree");
+    clm->CreateIndex(table_name, index_name, {it}, context->GetTransaction(), index_info, "btree");
   }
   if(primary_keys.size()>0) {
     string index_name = "AUTO_CREATED_INDEX_OF_";
@@ -507,6 +531,8 @@ dberr_t ExecuteEngine::ExecuteCreateIndex(pSyntaxNode ast, ExecuteContext *conte
 #endif
   if(current_db_.empty())return DB_FAILED;
   auto clm=context->GetCatalog();
+  //CREATE UNIQUE INDEX建唯一索引，CREATE INDEX允许重复键
+  bool is_unique=(ast->val_!=nullptr&&string(ast->val_)=="unique");
   auto node=ast->child_;
   string index_name(node->val_);
   node=node->next_;
@@ -520,7 +546,7 @@ dberr_t ExecuteEngine::ExecuteCreateIndex(pSyntaxNode ast, ExecuteContext *conte
     node=node->next_;
   }
   IndexInfo *index_info;
-  return clm->CreateIndex(table_name,index_name,index_keys,context->GetTransaction(),index_info,"btree");
+  return clm->CreateIndex(table_name,index_name,index_keys,context->GetTransaction(),index_info,"btree",is_unique);
 }
 
 /**
@@ -574,21 +600,17 @@ dberr_t ExecuteEngine::ExecuteExecfile(pSyntaxNode ast, ExecuteContext *context)
   fstream file;
   file.open(file_name);
   if(!file.is_open())return DB_FAILED;
-  const int buf_size=1024;
-  char cmd[buf_size];
+  std::string cmd;
   double time=0;
   int affected=0;
   std::stringstream ss;
   ResultWriter writer(ss);
-  while(!file.eof()){
-    memset(cmd,0,buf_size);
-    int cnt=0;
-    char ch;
-    while(!file.eof()&&(ch=file.get())!=';')cmd[cnt++]=ch;
-    if(ch!=';')break;
-    if(!file.eof())file.get();
-    cmd[cnt]=ch;
-    YY_BUFFER_STATE bp = yy_scan_string(cmd);
+  //read one statement at a time, the string grows with it
+  while(std::getline(file,cmd,';')){
+    if(file.eof())break;//no ';' before the end of the file
+    file.get();//remove enter
+    cmd.push_back(';');
+    YY_BUFFER_STATE bp = yy_scan_string(cmd.c_str());
     MinisqlParserInit();
     // parse
     yyparse();
@@ -4,6 +4,10 @@
 
 #include "executor/executors/insert_executor.h"
 
+#include <unordered_set>
+
+#include "index/generic_key.h"
+
 InsertExecutor::InsertExecutor(ExecuteContext *exec_ctx, const InsertPlanNode *plan,
                                std::unique_ptr<AbstractExecutor> &&child_executor)
     : AbstractExecutor(exec_ctx), plan_(plan), child_executor_(std::move(child_executor)) {
@@ -19,40 +23,83 @@ void InsertExecutor::Init() {
 }
 
 bool InsertExecutor::Next([[maybe_unused]] Row *row, RowId *rid) {
-  Row childRow;RowId childRowId;
-  if(child_executor_->Next(&childRow,&childRowId)){
-    for(auto itr = indices.begin();itr!=indices.end();itr++){//遍历所有index，看是否有unique冲突
-      vector<Field> fields;
-      auto keySchema = (*itr)->GetIndexKeySchema();
-      for(int i=0;i<keySchema->GetColumnCount();i++){//生成此row上面的key
-        uint32_t idx = keySchema->GetColumn(i)->GetTableInd();//获得在表中的第几列
-        Field* field = childRow.GetField(idx);
-        fields.push_back(*field);
-      }
-      Row temp(fields);
+  if(next_inserted_==inserted_.size()){
+    inserted_.clear();
+    next_inserted_=0;
+    if(!child_exhausted_){
+      InsertBatch();
+    }
+    if(inserted_.empty()){
+      return false;
+    }
+  }
+  *rid = inserted_[next_inserted_++];//返回索引
+  return true;
+}
+
+void InsertExecutor::InsertBatch() {
+  //从子节点取一批行，逐行检查unique冲突，批内的重复key也算冲突
+  std::vector<Row> rows;
+  std::vector<std::unordered_set<std::string>> batchKeys(indices.size());
+  while(rows.size()<BULK_INSERT_BATCH_SIZE){
+    Row childRow;RowId childRowId;
+    if(!child_executor_->Next(&childRow,&childRowId)){
+      child_exhausted_=true;
+      break;
+    }
+    bool conflict=false,too_long=false;
+    for(size_t i=0;i<indices.size()&&!conflict&&!too_long;i++){//遍历所有index，看是否有unique冲突
+      Row temp;
+      std::string key=GetKey(childRow,indices[i],&temp);
+      too_long=!KeyManager::KeyFits(temp,indices[i]->GetIndexKeySchema());//比列长的char放不进索引键
+      if(too_long||!indices[i]->GetIndexMetadata().IsUnique())continue;//非唯一索引允许重复key
       vector<RowId>scanResult;
-      if((*itr)->GetIndex()->ScanKey(temp,scanResult, nullptr)==DB_SUCCESS ){
-        printf("unique conflict in insert\n");
-        return false;//有冲突直接返回
-      }
-    }
-    tableHeap->InsertTuple(childRow, nullptr);//插入到表中
-    *rid = childRow.GetRowId();//返回索引
-    //更新索引
+      conflict=indices[i]->GetIndex()->ScanKey(temp,scanResult, nullptr)==DB_SUCCESS||batchKeys[i].count(key)>0;
+    }
+    if(too_long){
+      printf("value too long for an index key in insert\n");
+      child_exhausted_=true;
+      break;
+    }
+    if(conflict){
+      printf("unique conflict in insert\n");
+      child_exhausted_=true;//有冲突，之前的行照常插入，之后的不再插入
+      break;
+    }
+    for(size_t i=0;i<indices.size();i++){
+      if(!indices[i]->GetIndexMetadata().IsUnique())continue;
+      Row temp;
+      batchKeys[i].insert(GetKey(childRow,indices[i],&temp));
+    }
+    rows.emplace_back(std::move(childRow));
+  }
+  //单行直接插入，多行走批量追加
+  if(rows.size()==1){
+    if(tableHeap->InsertTuple(rows[0], nullptr)){
+      inserted_.push_back(rows[0].GetRowId());
+    }
+  }else if(!rows.empty()){
+    tableHeap->BulkInsert(rows, nullptr, &inserted_);
+  }
+  //更新索引
+  for(size_t r=0;r<inserted_.size();r++){
     for(auto itr = indices.begin();itr!=indices.end();itr++){
-      auto keySchema = (*itr)->GetIndexKeySchema();
-      vector<Field>fields;
-      for(int i=0;i<keySchema->GetColumnCount();i++){//获取索引
-        uint32_t idx = keySchema->GetColumn(i)->GetTableInd();
-        Field* field = childRow.GetField(idx);
-        fields.push_back(*field);
-      }
-      Row temp(fields);
-      (*itr)->GetIndex()->InsertEntry(temp,childRow.GetRowId(),nullptr);
-    }
-    return true;
-  }else{
-    return false;
+      Row temp;
+      GetKey(rows[r],*itr,&temp);
+      (*itr)->GetIndex()->InsertEntry(temp,inserted_[r],nullptr);
+    }
   }
+}
 
+std::string InsertExecutor::GetKey(Row &row, IndexInfo *index, Row *key) {
+  auto keySchema = index->GetIndexKeySchema();
+  vector<Field> fields;
+  for(uint32_t i=0;i<keySchema->GetColumnCount();i++){//生成此row上面的key
+    uint32_t idx = keySchema->GetColumn(i)->GetTableInd();//获得在表中的第几列
+    fields.push_back(*row.GetField(idx));
+  }
+  *key = Row(fields);
+  std::string buf(key->GetSerializedSize(keySchema), '\0');
+  key->SerializeTo(buf.data(), keySchema);
+  return buf;
 }
\ No newline at end of file
@@ -3,6 +3,10 @@
 //
 #include "executor/executors/seq_scan_executor.h"
 
+#include <algorithm>
+#include <stdexcept>
+#include <unordered_map>
+
 /**
 * TODO: Student Implement
 */
@@ -12,28 +16,195 @@ SeqScanExecutor::SeqScanExecutor(ExecuteContext *exec_ctx, const SeqScanPlanNode
   TableInfo* tableInfo = TableInfo::Create();
   exec_ctx->GetCatalog()->GetTable(plan->table_name_,tableInfo);
   tableHeap = tableInfo->GetTableHeap();//给私有变量赋值指针
-  cur = (tableHeap->Begin(nullptr));
+  schema_ = tableInfo->GetSchema();
+  read_ahead_ = ReadAhead(exec_ctx->GetBufferPoolManager());
+  next_page_id_ = tableHeap->GetFirstPageId();
 }
 
-void SeqScanExecutor::Init() {
+SeqScanExecutor::~SeqScanExecutor() { StopWorkers(); }
 
+void SeqScanExecutor::Init() {
+  StopWorkers();
+  next_page_id_ = tableHeap->GetFirstPageId();
+  rows_.clear();
+  next_row_ = 0;
+  parallel_ = false;
+  page_ids_.clear();
+  next_page_index_ = 0;
+  use_page_ids_ = plan_->GetPredicate() != nullptr;
+  if (use_page_ids_ || plan_->IsParallel()) {
+    tableHeap->GetPageIds(&page_ids_);
+  }
+  if (!plan_->IsParallel()) {
+    return;
+  }
+  size_t morsel_count = (page_ids_.size() + PARALLEL_SCAN_MORSEL_PAGES - 1) / PARALLEL_SCAN_MORSEL_PAGES;
+  if (morsel_count < 2) {
+    // 表太小，串行扫描即可
+    return;
+  }
+  parallel_ = true;
+  morsels_.clear();
+  morsels_.resize(morsel_count);
+  next_morsel_ = output_morsel_ = 0;
+  stop_ = false;
+  size_t worker_count = std::min<size_t>(PARALLEL_SCAN_THREADS, morsel_count);
+  for (size_t i = 0; i < worker_count; i++) {
+    workers_.emplace_back(&SeqScanExecutor::ScanMorsels, this);
+  }
 }
 
 bool SeqScanExecutor::Next(Row *row, RowId *rid) {
-  while(cur!=tableHeap->End()){
-    if(!plan_->GetPredicate()){//谓词可能是空的，如select *,直接返回
-      *row = (*cur);
-      *rid = (cur)->GetRowId();
-      (cur)++;
-      return true;
+  while (next_row_ == rows_.size()) {
+    rows_.clear();
+    next_row_ = 0;
+    if (parallel_) {
+      // take the rows of the next morsel once its worker is done with it
+      std::unique_lock<std::mutex> lock(latch_);
+      if (output_morsel_ == morsels_.size()) {
+        return false;
+      }
+      cv_.wait(lock, [this] { return morsels_[output_morsel_].done; });
+      if (morsels_[output_morsel_].failed) {
+        throw std::runtime_error("Failed to read a page of table " + plan_->table_name_ + ".");
+      }
+      rows_.swap(morsels_[output_morsel_].rows);
+      output_morsel_++;
+      cv_.notify_all();
+      continue;
+    }
+    // 当前页的行已经取完，整页读入下一页并过滤
+    if (use_page_ids_) {
+      if (next_page_index_ == page_ids_.size()) {
+        return false;
+      }
+      page_id_t page_id = page_ids_[next_page_index_++];
+      if (PageMayMatch(page_id, plan_->GetPredicate().get()) && !FilterPage(page_id, batch_, &rows_, &read_ahead_)) {
+        throw std::runtime_error("Failed to read a page of table " + plan_->table_name_ + ".");
+      }
+      continue;
+    }
+    if (next_page_id_ == INVALID_PAGE_ID) {
+      return false;
+    }
+    if (!FilterPage(next_page_id_, batch_, &rows_, &read_ahead_, &next_page_id_)) {
+      throw std::runtime_error("Failed to read a page of table " + plan_->table_name_ + ".");
+    }
+  }
+  *row = rows_[next_row_];
+  *rid = row->GetRowId();
+  next_row_++;
+  return true;
+}
+
+bool SeqScanExecutor::FilterPage(page_id_t page_id, RowBatch &batch, std::vector<Row> *rows, ReadAhead *read_ahead,
+                                 page_id_t *next_page_id) {
+  if (!tableHeap->ScanPage(page_id, batch, nullptr, read_ahead)) {
+    return false;
+  }
+  rows->reserve(rows->size() + batch.Size());
+  const std::vector<bool> *needed_columns = plan_->GetColumnMask().empty() ? nullptr : &plan_->GetColumnMask();
+  RowView tuple;
+  for (size_t i = 0; i < batch.Size(); i++) {
+    //谓词可能是空的，如select *,直接返回
+    if (plan_->GetPredicate()) {
+      // the predicate is evaluated on the tuple in place, only matching rows are deserialized
+      batch.GetView(i, schema_, &tuple);
+      if (!Field(kTypeInt, 1).CompareEquals(plan_->GetPredicate()->Evaluate(tuple))) {
+        continue;
+      }
+    }
+    rows->emplace_back();
+    batch.GetRow(i, &rows->back(), schema_, needed_columns);
+  }
+  if (next_page_id != nullptr) {
+    *next_page_id = batch.GetNextPageId();
+  }
+  // the page is not held between two calls, the caller may modify the table
+  batch.Release();
+  return true;
+}
+
+bool SeqScanExecutor::PageMayMatch(page_id_t page_id, AbstractExpression *predicate) {
+  if (predicate == nullptr) {
+    return true;
+  }
+  if (predicate->GetType() == ExpressionType::LogicExpression) {
+    auto logic = static_cast<LogicExpression *>(predicate);
+    bool left = PageMayMatch(page_id, logic->GetChildAt(0).get());
+    if (logic->logic_type_ == LogicType::And) {
+      return left && PageMayMatch(page_id, logic->GetChildAt(1).get());
     }
-    if(Field(kTypeInt, 1).CompareEquals(plan_->GetPredicate()->Evaluate(&(*cur)))){
-      *row = (*cur);
-      *rid = (cur)->GetRowId();
-      (cur)++;
+    return left || PageMayMatch(page_id, logic->GetChildAt(1).get());
+  }
+  if (predicate->GetType() != ExpressionType::ComparisonExpression) {
+    return true;
+  }
+  // only a column compared with a constant can be checked against the zone
+  auto comparison = static_cast<ComparisonExpression *>(predicate);
+  AbstractExpression *column = comparison->GetChildAt(0).get();
+  AbstractExpression *constant = comparison->GetChildAt(1).get();
+  std::string comp_type = comparison->GetComparisonType();
+  if (column->GetType() == ExpressionType::ConstantExpression &&
+      constant->GetType() == ExpressionType::ColumnExpression) {
+    // 常量在左边，交换两边
+    std::swap(column, constant);
+    if (comp_type == "is" || comp_type == "not") {
       return true;
     }
-    (cur)++;
+    static const std::unordered_map<std::string, std::string> mirrored{
+        {"=", "="}, {"<>", "<>"}, {"<", ">"}, {"<=", ">="}, {">", "<"}, {">=", "<="}};
+    comp_type = mirrored.at(comp_type);
+  }
+  if (column->GetType() != ExpressionType::ColumnExpression ||
+      constant->GetType() != ExpressionType::ConstantExpression) {
+    return true;
+  }
+  auto value = static_cast<ConstantValueExpression *>(constant);
+  return tableHeap->PageMayMatch(page_id, column->GetColIdx(), comp_type, value->val_);
+}
+
+void SeqScanExecutor::ScanMorsels() {
+  RowBatch batch;
+  ReadAhead read_ahead(exec_ctx_->GetBufferPoolManager());
+  std::vector<Row> rows;
+  while (true) {
+    size_t morsel;
+    {
+      // do not run too far ahead of the consumer, the rows of finished morsels are kept in memory
+      std::unique_lock<std::mutex> lock(latch_);
+      cv_.wait(lock, [this] {
+        return stop_ || next_morsel_ == morsels_.size() || next_morsel_ < output_morsel_ + PARALLEL_SCAN_PENDING_MORSELS;
+      });
+      if (stop_ || next_morsel_ == morsels_.size()) {
+        return;
+      }
+      morsel = next_morsel_++;
+    }
+    size_t end = std::min<size_t>((morsel + 1) * PARALLEL_SCAN_MORSEL_PAGES, page_ids_.size());
+    bool failed = false;
+    for (size_t i = morsel * PARALLEL_SCAN_MORSEL_PAGES; !failed && i < end; i++) {
+      if (PageMayMatch(page_ids_[i], plan_->GetPredicate().get())) {
+        failed = !FilterPage(page_ids_[i], batch, &rows, &read_ahead);
+      }
+    }
+    std::scoped_lock<std::mutex> lock(latch_);
+    morsels_[morsel].rows.swap(rows);
+    morsels_[morsel].failed = failed;
+    morsels_[morsel].done = true;
+    cv_.notify_all();
+    rows.clear();
+  }
+}
+
+void SeqScanExecutor::StopWorkers() {
+  {
+    std::scoped_lock<std::mutex> lock(latch_);
+    stop_ = true;
+    cv_.notify_all();
+  }
+  for (auto &worker : workers_) {
+    worker.join();
   }
-  return false;
+  workers_.clear();
 }
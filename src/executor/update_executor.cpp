@@ -4,6 +4,8 @@
 
 #include "executor/executors/update_executor.h"
 
+#include "index/generic_key.h"
+
 UpdateExecutor::UpdateExecutor(ExecuteContext *exec_ctx, const UpdatePlanNode *plan,
                                std::unique_ptr<AbstractExecutor> &&child_executor)
     : AbstractExecutor(exec_ctx), plan_(plan), child_executor_(std::move(child_executor)) {}
@@ -15,35 +17,77 @@ void UpdateExecutor::Init() {
   tableInfo = TableInfo::Create();
   exec_ctx_->GetCatalog()->GetTable(plan_->table_name_,tableInfo);
   tableHeap = tableInfo->GetTableHeap();
+  indices.clear();
   exec_ctx_->GetCatalog()->GetTableIndexes(tableInfo->GetTableName(),indices);
+  //只有键列被更新的索引才需要维护
+  key_updated_.clear();
+  for(auto index : indices){
+    bool key_updated = false;
+    for(auto column : index->GetIndexKeySchema()->GetColumns()){
+      key_updated = key_updated || plan_->GetUpdateAttr().count(column->GetTableInd()) > 0;
+    }
+    key_updated_.push_back(key_updated);
+  }
+  updated_rows_.clear();
   child_executor_->Init();
 }
 
 bool UpdateExecutor::Next([[maybe_unused]] Row *row, RowId *rid) {
   Row childRow;
   RowId childRowId;
-  if(child_executor_->Next(&childRow,&childRowId)){
+  while(child_executor_->Next(&childRow,&childRowId)){
+    //被搬到后面页的行可能再被扫描到一次，每行只更新一次
+    if(!updated_rows_.insert(childRowId.Get()).second){
+      continue;
+    }
     Row updatedRow = GenerateUpdatedTuple(childRow);
-    tableHeap->UpdateTuple(updatedRow,childRowId, nullptr);
-    //更新索引，删除原来的索引，添加新的索引
-    for(auto itr = indices.begin();itr!=indices.end();itr++){
-      auto keySchema = (*itr)->GetIndexKeySchema();
+    //比列长的char放不进索引键，不更新这一行和之后的行
+    for(size_t i = 0;i<indices.size();i++){
+      if(!key_updated_[i]){
+        continue;
+      }
+      auto keySchema = indices[i]->GetIndexKeySchema();
+      vector<Field>newFields;
+      for(uint32_t j=0;j<keySchema->GetColumnCount();j++){
+        newFields.push_back(*updatedRow.GetField(keySchema->GetColumn(j)->GetTableInd()));
+      }
+      if(!KeyManager::KeyFits(Row(newFields),keySchema)){
+        printf("value too long for an index key in update\n");
+        return false;
+      }
+    }
+    if(!tableHeap->UpdateTuple(updatedRow,childRowId, nullptr)){
+      return true;
+    }
+    //行的rid不变，只有键变了的索引要删除原来的项、添加新的项
+    for(size_t i = 0;i<indices.size();i++){
+      if(!key_updated_[i]){
+        continue;
+      }
+      auto keySchema = indices[i]->GetIndexKeySchema();
       vector<Field>oldFields,newFields;
-      for(int i=0;i<keySchema->GetColumnCount();i++){
-        uint32_t idx = keySchema->GetColumn(i)->GetTableInd();
-        Field * field = childRow.GetField(idx);
-        oldFields.push_back(*field);
-        field = updatedRow.GetField(idx);
-        newFields.push_back(*field);
+      bool key_changed = false;
+      for(uint32_t j=0;j<keySchema->GetColumnCount();j++){
+        uint32_t idx = keySchema->GetColumn(j)->GetTableInd();
+        Field *oldField = childRow.GetField(idx), *newField = updatedRow.GetField(idx);
+        oldFields.push_back(*oldField);
+        newFields.push_back(*newField);
+        if(oldField->IsNull() || newField->IsNull()){
+          key_changed = key_changed || oldField->IsNull() != newField->IsNull();
+        }else{
+          key_changed = key_changed || oldField->CompareEquals(*newField) != CmpBool::kTrue;
+        }
+      }
+      if(!key_changed){
+        continue;
       }
       Row oldTemp(oldFields),newTemp(newFields);
-      (*itr)->GetIndex()->RemoveEntry(oldTemp,childRowId, nullptr);
-      (*itr)->GetIndex()->InsertEntry(newTemp,updatedRow.GetRowId(), nullptr);
+      indices[i]->GetIndex()->RemoveEntry(oldTemp,childRowId, nullptr);
+      indices[i]->GetIndex()->InsertEntry(newTemp,childRowId, nullptr);
     }
     return true;
-  }else{
-    return false;
   }
+  return false;
 }
 
 Row UpdateExecutor::GenerateUpdatedTuple(const Row &src_row) {
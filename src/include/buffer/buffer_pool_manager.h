@@ -1,58 +1,80 @@
 #ifndef MINISQL_BUFFER_POOL_MANAGER_H
 #define MINISQL_BUFFER_POOL_MANAGER_H
 
-#include <list>
-#include <mutex>
-#include <unordered_map>
-
-#include "buffer/lru_replacer.h"
-#include "page/disk_file_meta_page.h"
+#include "common/config.h"
 #include "page/page.h"
 #include "storage/disk_manager.h"
 
 using namespace std;
 
+/**
+ * BufferPoolManager is the interface shared by a single buffer pool instance (BufferPoolManagerInstance) and a pool
+ * sharded over several instances (ParallelBufferPoolManager). Upper layers only ever talk to this interface.
+ */
 class BufferPoolManager {
  public:
-  explicit BufferPoolManager(size_t pool_size, DiskManager *disk_manager);
+  BufferPoolManager() = default;
 
-  ~BufferPoolManager();
+  virtual ~BufferPoolManager() = default;
 
-  Page *FetchPage(page_id_t page_id);
+  /**
+   * Fetch the requested page from the buffer pool, the page is pinned until UnpinPage is called.
+   * @return nullptr if page_id is invalid or no frame can be found for it
+   */
+  virtual Page *FetchPage(page_id_t page_id) = 0;
 
-  bool UnpinPage(page_id_t page_id, bool is_dirty);
+  /**
+   * Unpin the target page from the buffer pool.
+   * @param is_dirty true if the page should be marked as dirty, false otherwise
+   * @return false if the page is not in the page table
+   */
+  virtual bool UnpinPage(page_id_t page_id, bool is_dirty) = 0;
 
-  bool FlushPage(page_id_t page_id);
+  /**
+   * Flush the target page to disk.
+   * @return false if the page could not be found in the page table
+   */
+  virtual bool FlushPage(page_id_t page_id) = 0;
 
-  Page *NewPage(page_id_t &page_id);
+  /**
+   * Create a new page in the buffer pool, the new page is pinned.
+   * @param[out] page_id id of the created page
+   * @return nullptr if no new page could be created
+   */
+  virtual Page *NewPage(page_id_t &page_id) = 0;
 
-  bool DeletePage(page_id_t page_id);
+  /**
+   * Delete a page from the buffer pool and deallocate it on disk.
+   * @return false if the page exists but is still pinned, true otherwise
+   */
+  virtual bool DeletePage(page_id_t page_id) = 0;
+
+  /**
+   * Hint that page_id will be fetched soon. If the page is not cached it is read into a free or victim frame in the
+   * background, without being pinned, so that the later FetchPage finds it in memory. Never waits: a dirty victim is
+   * not written back, the hint is dropped instead, and neither is the read waited for.
+   */
+  virtual void Prefetch(page_id_t page_id) = 0;
+
+  virtual bool IsPageFree(page_id_t page_id) = 0;
 
-  bool IsPageFree(page_id_t page_id);
+  // Only used for debug
+  virtual bool CheckAllUnpinned() = 0;
 
-  bool CheckAllUnpinned();
+  /** @return the total number of frames managed by this buffer pool */
+  virtual size_t GetPoolSize() = 0;
 
- private:
   /**
-   * Allocate new page (operations like create index/table) For now just keep an increasing counter
+   * Start a background thread that writes dirty, unpinned pages back to disk once the fraction of dirty frames rises
+   * above high_watermark, until it falls below low_watermark, so that evictions rarely have to write a victim back.
    */
-  page_id_t AllocatePage();
+  virtual void StartBackgroundFlusher(double high_watermark = DEFAULT_DIRTY_HIGH_WATERMARK,
+                                      double low_watermark = DEFAULT_DIRTY_LOW_WATERMARK) = 0;
 
   /**
-   * Deallocate page (operations like drop index/table) Need bitmap in header page for tracking pages
+   * Stop the background flusher thread, if it is running.
    */
-  void DeallocatePage(page_id_t page_id);
-
-  frame_id_t TryToFindFreePage();
-
- private:
-  size_t pool_size_;                                 // number of pages in buffer pool
-  Page *pages_;                                      // array of pages
-  DiskManager *disk_manager_;                        // pointer to the disk manager.
-  unordered_map<page_id_t, frame_id_t> page_table_;  // to keep track of pages
-  Replacer *replacer_;                               // to find an unpinned page for replacement
-  list<frame_id_t> free_list_;                       // to find a free page for replacement
-  recursive_mutex latch_;                            // to protect shared data structure
+  virtual void StopBackgroundFlusher() = 0;
 };
 
 #endif  // MINISQL_BUFFER_POOL_MANAGER_H
@@ -0,0 +1,144 @@
+#ifndef MINISQL_BUFFER_POOL_MANAGER_INSTANCE_H
+#define MINISQL_BUFFER_POOL_MANAGER_INSTANCE_H
+
+#include <condition_variable>
+#include <list>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "buffer/buffer_pool_manager.h"
+#include "buffer/clock_replacer.h"
+#include "buffer/lru_k_replacer.h"
+#include "buffer/lru_replacer.h"
+#include "page/disk_file_meta_page.h"
+#include "page/page.h"
+#include "storage/disk_manager.h"
+
+using namespace std;
+
+/**
+ * BufferPoolManagerInstance is a single buffer pool with its own frames, page table, replacer and free list, all
+ * protected by one latch. It can be used stand-alone or as one shard of a ParallelBufferPoolManager.
+ */
+class BufferPoolManagerInstance : public BufferPoolManager {
+ public:
+  /**
+   * Create a stand-alone buffer pool.
+   * @param replacer_type replacement policy of the pool
+   * @param replacer_k k of the LRU-K policy, ignored by the other policies
+   */
+  explicit BufferPoolManagerInstance(size_t pool_size, DiskManager *disk_manager,
+                                     ReplacerType replacer_type = ReplacerType::kLRU,
+                                     size_t replacer_k = DEFAULT_LRUK_REPLACER_K);
+
+  /**
+   * Create one shard of a parallel buffer pool. The shard only caches pages with
+   * page_id % num_instances == instance_index.
+   */
+  BufferPoolManagerInstance(size_t pool_size, uint32_t num_instances, uint32_t instance_index,
+                            DiskManager *disk_manager, ReplacerType replacer_type = ReplacerType::kLRU,
+                            size_t replacer_k = DEFAULT_LRUK_REPLACER_K);
+
+  ~BufferPoolManagerInstance() override;
+
+  Page *FetchPage(page_id_t page_id) override;
+
+  bool UnpinPage(page_id_t page_id, bool is_dirty) override;
+
+  bool FlushPage(page_id_t page_id) override;
+
+  Page *NewPage(page_id_t &page_id) override;
+
+  /**
+   * Put a page whose id has already been allocated on disk into this buffer pool. Used by ParallelBufferPoolManager,
+   * which has to know the page id before it can pick the owning shard.
+   * @return nullptr if every frame is pinned, the caller is then responsible for deallocating the page id
+   */
+  Page *NewPageWithId(page_id_t page_id);
+
+  bool DeletePage(page_id_t page_id) override;
+
+  void Prefetch(page_id_t page_id) override;
+
+  bool IsPageFree(page_id_t page_id) override;
+
+  bool CheckAllUnpinned() override;
+
+  size_t GetPoolSize() override { return pool_size_; }
+
+  void StartBackgroundFlusher(double high_watermark = DEFAULT_DIRTY_HIGH_WATERMARK,
+                              double low_watermark = DEFAULT_DIRTY_LOW_WATERMARK) override;
+
+  void StopBackgroundFlusher() override;
+
+ private:
+  /**
+   * Allocate new page (operations like create index/table) For now just keep an increasing counter
+   */
+  page_id_t AllocatePage();
+
+  /**
+   * Deallocate page (operations like drop index/table) Need bitmap in header page for tracking pages
+   */
+  void DeallocatePage(page_id_t page_id);
+
+  /**
+   * Find a frame to hold a new page, first from the free list then from the replacer. A dirty victim is written
+   * back and removed from the page table. Must be called with latch_ held.
+   * @return INVALID_FRAME_ID if every frame is pinned
+   */
+  frame_id_t TryToFindFreePage();
+
+  /**
+   * Set or clear the dirty flag of a frame and keep num_dirty_ up to date. Must be called with latch_ held.
+   */
+  void SetDirty(frame_id_t frame_id, bool is_dirty);
+
+  /**
+   * Wait until a write of page_id issued by the background flusher has reached the disk, so that the page is neither
+   * read back stale nor overwritten by the older image afterwards. Must be called with latch_ held.
+   */
+  void WaitForBackgroundFlush(page_id_t page_id);
+
+  /**
+   * Wait until a read of page_id issued by Prefetch has completed, so that the frame holds the page before it is
+   * handed out, written back or reused. Must be called with latch_ held.
+   * @return true if page_id was being prefetched
+   */
+  bool WaitForPrefetch(page_id_t page_id);
+
+  /**
+   * Body of the background flusher thread. Cleans dirty frames near the eviction end of the replacer in batches
+   * sorted by page id whenever the dirty ratio is above the high watermark.
+   */
+  void BackgroundFlush();
+
+ private:
+  size_t pool_size_;                                 // number of pages in buffer pool
+  const uint32_t num_instances_ = 1;                 // number of shards in the parallel buffer pool
+  const uint32_t instance_index_ = 0;                // index of this shard in the parallel buffer pool
+  Page *pages_;                                      // array of pages
+  DiskManager *disk_manager_;                        // pointer to the disk manager.
+  unordered_map<page_id_t, frame_id_t> page_table_;  // to keep track of pages
+  Replacer *replacer_;                               // to find an unpinned page for replacement
+  list<frame_id_t> free_list_;                       // to find a free page for replacement
+  recursive_mutex latch_;                            // to protect shared data structure
+  size_t num_dirty_{0};                              // number of dirty frames
+
+  // background flusher, see StartBackgroundFlusher
+  std::thread flusher_;
+  bool flusher_running_{false};
+  bool stop_flusher_{false};
+  std::condition_variable_any flusher_cv_;  // wakes the flusher up early, waited on with latch_
+  double dirty_high_watermark_{DEFAULT_DIRTY_HIGH_WATERMARK};
+  double dirty_low_watermark_{DEFAULT_DIRTY_LOW_WATERMARK};
+  unordered_set<page_id_t> flushing_pages_;  // pages of the batch the flusher is writing, protected by latch_
+  std::mutex flush_io_latch_;                // held by the flusher while its batch is written, taken after latch_
+
+  // reads issued by Prefetch whose pages have not been fetched yet, protected by latch_
+  unordered_map<page_id_t, IOHandle> prefetching_;
+};
+
+#endif  // MINISQL_BUFFER_POOL_MANAGER_INSTANCE_H
@@ -1,13 +1,8 @@
 #ifndef MINISQL_CLOCK_REPLACER_H
 #define MINISQL_CLOCK_REPLACER_H
 
-#include <algorithm>
-#include <list>
-#include <map>
-#include <mutex>
-#include <queue>
-#include <unordered_set>
-#include <vector>
+#include <atomic>
+#include <memory>
 
 #include "buffer/replacer.h"
 #include "common/config.h"
@@ -16,6 +11,9 @@ using namespace std;
 
 /**
  * CLOCKReplacer implements the clock replacement.
+ *
+ * The state of every frame lives in a flat array of atomics indexed by frame id, so Pin and Unpin are a single
+ * atomic exchange and Victim sweeps the clock hand with compare-and-swap, none of them takes a lock.
  */
 class CLOCKReplacer : public Replacer {
  public:
@@ -38,10 +36,21 @@ class CLOCKReplacer : public Replacer {
 
   size_t Size() override;
 
+  void GetVictimCandidates(std::vector<frame_id_t> *frame_ids, size_t max_count) override;
+
  private:
+  enum FrameState : uint8_t {
+    kNotInReplacer = 0,  // pinned or free, never victimized
+    kUnreferenced = 1,   // can be victimized when the hand passes
+    kReferenced = 2,     // gets a second chance, the hand clears the reference bit first
+  };
+
   size_t capacity;
-  list<frame_id_t> clock_list;               // replacer中可以被替换的数据页
-  map<frame_id_t, frame_id_t> clock_status;  // 数据页的存储状态
+  std::unique_ptr<std::atomic<uint8_t>[]> clock_status;  // 数据页的存储状态
+  std::atomic<size_t> clock_hand{0};                      // 时钟指针, the next frame to look at is hand % capacity
+  // replacer中可以被替换的数据页数量. A frame's state and the count are changed by two separate atomics, so a Victim
+  // can count a frame out before the Unpin that put it in has counted it in, and the count may be briefly negative.
+  std::atomic<int64_t> size{0};
 };
 
-#endif  // MINISQL_CLOCK_REPLACER_H
\ No newline at end of file
+#endif  // MINISQL_CLOCK_REPLACER_H
@@ -0,0 +1,69 @@
+#ifndef MINISQL_LRU_K_REPLACER_H
+#define MINISQL_LRU_K_REPLACER_H
+
+#include <set>
+#include <utility>
+#include <vector>
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+
+using namespace std;
+
+/**
+ * LRUKReplacer implements the LRU-K replacement policy.
+ *
+ * Every Pin is an access. The backward k-distance of a frame is the distance to its k-th most recent access, the
+ * frame with the largest one is evicted first. Frames seen less than k times have an infinite distance and go before
+ * all others, oldest first access first, so pages touched once by a sequential scan never push out pages that are
+ * used repeatedly such as B+ tree inner pages and catalog pages.
+ */
+class LRUKReplacer : public Replacer {
+ public:
+  /**
+   * Create a new LRUKReplacer.
+   * @param num_pages the maximum number of pages the LRUKReplacer will be required to store
+   * @param k number of accesses remembered per frame
+   */
+  explicit LRUKReplacer(size_t num_pages, size_t k = DEFAULT_LRUK_REPLACER_K);
+
+  /**
+   * Destroys the LRUKReplacer.
+   */
+  ~LRUKReplacer() override;
+
+  bool Victim(frame_id_t *frame_id) override;
+
+  void Pin(frame_id_t frame_id) override;
+
+  void Unpin(frame_id_t frame_id) override;
+
+  void Remove(frame_id_t frame_id) override;
+
+  size_t Size() override;
+
+  void GetVictimCandidates(std::vector<frame_id_t> *frame_ids, size_t max_count) override;
+
+ private:
+  /** Remember an access to frame_id at the current timestamp. */
+  void RecordAccess(frame_id_t frame_id);
+
+  /** @return the oldest access still remembered for frame_id, i.e. its k-th most recent access once it has k */
+  uint64_t OldestAccess(frame_id_t frame_id) const;
+
+  /** Take an evictable frame out of the eviction order. */
+  void EraseEvictable(frame_id_t frame_id);
+
+ private:
+  size_t max_size_;
+  size_t k_;
+  uint64_t current_timestamp_{0};
+  std::vector<uint64_t> history_;       // ring buffer of the last k accesses of each frame, k_ slots per frame
+  std::vector<size_t> access_count_;    // number of accesses of each frame, 0 if the frame is not tracked
+  std::vector<bool> evictable_;         // whether the frame is unpinned and can be victimized
+  // evictable frames ordered by their oldest remembered access
+  std::set<std::pair<uint64_t, frame_id_t>> history_list_;  // frames with less than k accesses
+  std::set<std::pair<uint64_t, frame_id_t>> cache_list_;    // frames with k accesses
+};
+
+#endif  // MINISQL_LRU_K_REPLACER_H
@@ -37,6 +37,8 @@ class LRUReplacer : public Replacer {
 
   size_t Size() override;
 
+  void GetVictimCandidates(std::vector<frame_id_t> *frame_ids, size_t max_count) override;
+
 private:
 //add your own private member variables here
  std::list<frame_id_t> victims_;
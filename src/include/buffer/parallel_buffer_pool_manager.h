@@ -0,0 +1,68 @@
+#ifndef MINISQL_PARALLEL_BUFFER_POOL_MANAGER_H
+#define MINISQL_PARALLEL_BUFFER_POOL_MANAGER_H
+
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_manager_instance.h"
+#include "storage/disk_manager.h"
+
+/**
+ * ParallelBufferPoolManager shards pages over several BufferPoolManagerInstance by page_id % num_instances, so
+ * threads working on different pages rarely contend on the same buffer pool latch.
+ */
+class ParallelBufferPoolManager : public BufferPoolManager {
+ public:
+  /**
+   * @param num_instances number of shards
+   * @param pool_size number of frames of each shard
+   * @param replacer_type replacement policy of every shard
+   */
+  ParallelBufferPoolManager(size_t num_instances, size_t pool_size, DiskManager *disk_manager,
+                            ReplacerType replacer_type = ReplacerType::kLRU,
+                            size_t replacer_k = DEFAULT_LRUK_REPLACER_K);
+
+  ~ParallelBufferPoolManager() override;
+
+  Page *FetchPage(page_id_t page_id) override;
+
+  bool UnpinPage(page_id_t page_id, bool is_dirty) override;
+
+  bool FlushPage(page_id_t page_id) override;
+
+  /**
+   * Allocate a page on disk and put it into the shard owning its id. If that shard has no free frame other ids are
+   * tried, so the call only fails when no shard can take the page.
+   */
+  Page *NewPage(page_id_t &page_id) override;
+
+  bool DeletePage(page_id_t page_id) override;
+
+  void Prefetch(page_id_t page_id) override;
+
+  bool IsPageFree(page_id_t page_id) override;
+
+  bool CheckAllUnpinned() override;
+
+  size_t GetPoolSize() override { return num_instances_ * pool_size_; }
+
+  /**
+   * Start one background flusher per shard, the watermarks apply to each shard separately.
+   */
+  void StartBackgroundFlusher(double high_watermark = DEFAULT_DIRTY_HIGH_WATERMARK,
+                              double low_watermark = DEFAULT_DIRTY_LOW_WATERMARK) override;
+
+  void StopBackgroundFlusher() override;
+
+ private:
+  /** @return the shard responsible for page_id */
+  BufferPoolManagerInstance *GetBufferPoolManager(page_id_t page_id);
+
+ private:
+  size_t num_instances_;                               // number of shards
+  size_t pool_size_;                                   // number of frames of each shard
+  DiskManager *disk_manager_;                          // shared by all shards
+  std::vector<BufferPoolManagerInstance *> instances_;  // shards, indexed by page_id % num_instances_
+};
+
+#endif  // MINISQL_PARALLEL_BUFFER_POOL_MANAGER_H
@@ -0,0 +1,31 @@
+#ifndef MINISQL_READ_AHEAD_H
+#define MINISQL_READ_AHEAD_H
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/config.h"
+
+/**
+ * ReadAhead follows the pages visited by one scan over a page chain and prefetches the pages it is about to visit.
+ *
+ * The next page of the chain is always prefetched as soon as it is known. Once the scan has moved to the physically
+ * next page, i.e. the chain was allocated sequentially, the following window pages are read ahead as well, so that
+ * several reads are in flight instead of one per page.
+ */
+class ReadAhead {
+ public:
+  explicit ReadAhead(BufferPoolManager *buffer_pool_manager = nullptr, size_t window = READ_AHEAD_WINDOW);
+
+  /**
+   * Report that the scan has moved to page_id.
+   * @param next_page_id the page the chain continues with, INVALID_PAGE_ID at its end
+   */
+  void OnPageAccess(page_id_t page_id, page_id_t next_page_id);
+
+ private:
+  BufferPoolManager *buffer_pool_manager_;
+  size_t window_;
+  page_id_t last_page_id_{INVALID_PAGE_ID};      // page the scan was on before
+  page_id_t prefetched_until_{INVALID_PAGE_ID};  // last page of the current sequential read-ahead window
+};
+
+#endif  // MINISQL_READ_AHEAD_H
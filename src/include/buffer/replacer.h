@@ -2,9 +2,15 @@
 #define MINISQL_REPLACER_H
 
 #include <cstdio>
+#include <vector>
 
 #include "common/config.h"
 
+/**
+ * Replacement policies the buffer pool can be constructed with.
+ */
+enum class ReplacerType { kLRU, kLRUK, kClock };
+
 /**
  * Replacer is an abstract class that tracks page usage.
  */
@@ -33,6 +39,19 @@ class Replacer {
    */
   virtual void Unpin(frame_id_t frame_id) = 0;
 
+  /**
+   * Forget everything known about a frame, e.g. when its page is deleted and the frame goes back to the free list.
+   * For policies that keep no access history this is the same as pinning the frame.
+   * @param frame_id the id of the frame to remove
+   */
+  virtual void Remove(frame_id_t frame_id) { Pin(frame_id); }
+
+  /**
+   * List the frames that would be victimized next, in eviction order, without removing them.
+   * @param[out] frame_ids receives at most max_count frame ids
+   */
+  virtual void GetVictimCandidates(std::vector<frame_id_t> *frame_ids, size_t max_count) = 0;
+
   /** @return the number of elements in the replacer that can be victimized */
   virtual size_t Size() = 0;
 };
@@ -15,7 +15,7 @@ class IndexMetadata {
 
  public:
   static IndexMetadata *Create(const index_id_t index_id, const std::string &index_name, const table_id_t table_id,
-                               const std::vector<uint32_t> &key_map);
+                               const std::vector<uint32_t> &key_map, bool is_unique = true);
 
   uint32_t SerializeTo(char *buf) const;
 
@@ -33,18 +33,29 @@ class IndexMetadata {
 
   inline index_id_t GetIndexId() const { return index_id_; }
 
+  /** @return false if several rows may have the same key */
+  inline bool IsUnique() const { return is_unique_; }
+
+  /** @return true if the record was read in the older layout, whose tree holds keys in the older encoding */
+  inline bool HasOlderLayout() const { return older_layout_; }
+
  private:
   IndexMetadata() = delete;
 
   explicit IndexMetadata(const index_id_t index_id, const std::string &index_name, const table_id_t table_id,
-                         const std::vector<uint32_t> &key_map);
+                         const std::vector<uint32_t> &key_map, bool is_unique);
 
  private:
-  static constexpr uint32_t INDEX_METADATA_MAGIC_NUM = 344528;
+  // changed with the record layout
+  static constexpr uint32_t INDEX_METADATA_MAGIC_NUM = 344529;
+  // the layout before is_unique_ was recorded and the keys were normalized, read as a unique index to be rebuilt
+  static constexpr uint32_t PRE_NORMALIZED_INDEX_METADATA_MAGIC_NUM = 344528;
   index_id_t index_id_;
   std::string index_name_;
   table_id_t table_id_;
   std::vector<uint32_t> key_map_; /** The mapping of index key to tuple key */
+  bool is_unique_;
+  bool older_layout_{false};  // not serialized, see HasOlderLayout
 };
 
 /**
@@ -94,10 +105,8 @@ class IndexInfo {
 //  }
 
   Index *CreateIndex(BufferPoolManager *buffer_pool_manager, const string &index_type){
-    size_t max_size = 0;
-    for (auto col : key_schema_->GetColumns()) {
-      max_size += col->GetLength();
-    }
+    // keys are stored normalized, see KeyManager
+    size_t max_size = KeyManager::GetKeyLength(key_schema_);
 
     if (index_type == "bptree") {
       if (max_size <= 8)
@@ -117,7 +126,8 @@ class IndexInfo {
     } else {
       return nullptr;
     }
-    return new BPlusTreeIndex(meta_data_->index_id_, key_schema_, max_size, buffer_pool_manager);
+    return new BPlusTreeIndex(meta_data_->index_id_, key_schema_, max_size, buffer_pool_manager,
+                              meta_data_->is_unique_);
   }
 
 
@@ -23,7 +23,7 @@ class TableMetadata {
    * will create new table schema and owned by mem heap
    */
   static TableMetadata *Create(table_id_t table_id, std::string table_name, page_id_t root_page_id,
-                               TableSchema *schema);
+                               page_id_t fsm_page_id, TableSchema *schema);
 
   inline table_id_t GetTableId() const { return table_id_; }
 
@@ -31,18 +31,32 @@ class TableMetadata {
 
   inline uint32_t GetFirstPageId() const { return root_page_id_; }
 
+  inline page_id_t GetFreeSpaceMapPageId() const { return fsm_page_id_; }
+
+  inline void SetFreeSpaceMapPageId(page_id_t fsm_page_id) { fsm_page_id_ = fsm_page_id; }
+
   inline Schema *GetSchema() const { return schema_; }
 
  private:
   TableMetadata() = delete;
 
-  TableMetadata(table_id_t table_id, std::string table_name, page_id_t root_page_id, TableSchema *schema);
+  TableMetadata(table_id_t table_id, std::string table_name, page_id_t root_page_id, page_id_t fsm_page_id,
+                TableSchema *schema);
 
  private:
-  static constexpr uint32_t TABLE_METADATA_MAGIC_NUM = 344528;
+  // changed with the record layout
+  static constexpr uint32_t TABLE_METADATA_MAGIC_NUM = 344529;
+  // the layout before fsm_page_id_ and the tuple format were recorded, still read as a variable-format table without a
+  // free space map
+  static constexpr uint32_t PRE_FSM_TABLE_METADATA_MAGIC_NUM = 344528;
+  // how the tuples of the table are stored, tables recorded before the format was use FORMAT_VARIABLE
+  static constexpr uint32_t FORMAT_VARIABLE = 0;     // Row::SerializeTo in slotted pages
+  static constexpr uint32_t FORMAT_FIXED_WIDTH = 1;  // fixed-width tuples in slotted pages
+  static constexpr uint32_t FORMAT_COLUMNAR = 2;     // PAX pages
   table_id_t table_id_;
   std::string table_name_;
   page_id_t root_page_id_;
+  page_id_t fsm_page_id_;  // first page of the free space map of the table heap
   Schema *schema_;
 };
 
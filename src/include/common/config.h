@@ -15,9 +15,30 @@ static constexpr int INDEX_ROOTS_PAGE_ID = 1;   // logical page id of the index
 
 static constexpr int PAGE_SIZE = 4096;                  // size of a data page in byte
 static constexpr int DEFAULT_BUFFER_POOL_SIZE = 20480;  // default size of buffer pool
+static constexpr int DEFAULT_BUFFER_POOL_INSTANCES = 1;  // default number of buffer pool shards
+static constexpr int DEFAULT_LRUK_REPLACER_K = 2;       // default k of the LRU-K replacer
+static constexpr double DEFAULT_DIRTY_HIGH_WATERMARK = 0.5;   // dirty ratio at which the background flusher starts
+static constexpr double DEFAULT_DIRTY_LOW_WATERMARK = 0.25;   // dirty ratio at which the background flusher stops
+static constexpr int DEFAULT_FLUSH_BATCH_SIZE = 32;           // pages written back by the flusher at a time
+static constexpr int FLUSHER_INTERVAL_MS = 100;               // how often the flusher checks the dirty ratio
+static constexpr int ASYNC_IO_QUEUE_DEPTH = 64;               // max asynchronous page requests in flight
+static constexpr int ASYNC_IO_THREADS = 4;                    // threads of the fallback asynchronous I/O engine
+static constexpr int READ_AHEAD_WINDOW = 8;                   // pages read ahead of a sequential scan
+static constexpr int BULK_INSERT_BATCH_SIZE = 1024;           // rows the insert executor appends at a time
+static constexpr int BULK_INSERT_PAGE_BATCH = 8;              // pages a bulk insert allocates at a time
+static constexpr int PARALLEL_SCAN_THREADS = 4;               // workers of a parallel sequential scan
+static constexpr int PARALLEL_SCAN_MORSEL_PAGES = 16;         // pages a parallel scan worker takes at a time
+static constexpr int PARALLEL_SCAN_PENDING_MORSELS = 16;      // morsels scanned ahead of the consumer at most
+static constexpr uint32_t FIXED_WIDTH_MAX_ROW_SIZE = 256;     // widest row a new table stores in the fixed-width format
+static constexpr uint32_t TOAST_TUPLE_THRESHOLD = PAGE_SIZE / 4;  // larger tuples have long values moved out of line
+static constexpr uint32_t TOAST_VALUE_MIN_SIZE = 256;         // shortest char value that is moved out of line
+static constexpr int OPTIMISTIC_READ_RETRIES = 8;             // failed version checks before a reader takes latches
+static constexpr size_t INDEX_SORT_BUFFER_SIZE = 8 << 20;     // bytes of keys an index build sorts in memory at a time
+static constexpr size_t INDEX_SORT_MERGE_FAN_IN = 64;         // runs an index build merges at once, each pins a page
+static constexpr double INDEX_BUILD_FILL_FACTOR = 0.9;        // how full an index build packs the tree pages
 
 static constexpr uint32_t FIELD_NULL_LEN = UINT32_MAX;
-static constexpr uint32_t VARCHAR_MAX_LEN = PAGE_SIZE / 2;  // max length of varchar
+static constexpr uint32_t VARCHAR_MAX_LEN = PAGE_SIZE * 64;  // max length of varchar, long values are stored out of line
 
 // static std::string DB_META_FILE = "minisql.meta.db";
 
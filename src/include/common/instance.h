@@ -5,6 +5,7 @@
 #include <string>
 
 #include "buffer/buffer_pool_manager.h"
+#include "buffer/replacer.h"
 #include "catalog/catalog.h"
 #include "common/config.h"
 #include "common/dberr.h"
@@ -14,7 +15,18 @@
 
 class DBStorageEngine {
  public:
-  explicit DBStorageEngine(std::string db_name, bool init = true, uint32_t buffer_pool_size = DEFAULT_BUFFER_POOL_SIZE);
+  /**
+   * @param buffer_pool_size total number of frames in the buffer pool
+   * @param buffer_pool_instances number of shards the frames are split over, each with its own latch
+   * @param replacer_type replacement policy of the buffer pool
+   * @param replacer_k k of the LRU-K replacer, unused by the other policies
+   * @param background_flusher whether to start the background flusher, dirty pages are otherwise only written back
+   * when they are evicted or flushed
+   */
+  explicit DBStorageEngine(std::string db_name, bool init = true, uint32_t buffer_pool_size = DEFAULT_BUFFER_POOL_SIZE,
+                           uint32_t buffer_pool_instances = DEFAULT_BUFFER_POOL_INSTANCES,
+                           ReplacerType replacer_type = ReplacerType::kLRUK, size_t replacer_k = DEFAULT_LRUK_REPLACER_K,
+                           bool background_flusher = true);
 
   ~DBStorageEngine();
 
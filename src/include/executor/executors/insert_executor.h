@@ -5,6 +5,9 @@
 #ifndef MINISQL_INSERT_EXECUTOR_H
 #define MINISQL_INSERT_EXECUTOR_H
 
+#include <string>
+#include <vector>
+
 #include "executor/execute_context.h"
 #include "executor/executors/abstract_executor.h"
 #include "executor/plans/insert_plan.h"
@@ -44,10 +47,22 @@ class InsertExecutor : public AbstractExecutor {
  private:
   /** The insert plan node to be executed*/
   const InsertPlanNode *plan_;
+  /**
+   * Pull up to BULK_INSERT_BATCH_SIZE rows from the child, append them to the table in one go and add their index
+   * entries. Stops at the first row violating a unique index.
+   */
+  void InsertBatch();
+
+  /** @return the key of row in index, serialized so that equal keys compare equal */
+  std::string GetKey(Row &row, IndexInfo *index, Row *key);
+
   std::unique_ptr<AbstractExecutor> child_executor_;
   TableInfo* tableInfo;
   TableHeap * tableHeap;
   std::vector<IndexInfo *>indices;
+  std::vector<RowId> inserted_;    // rids of the current batch not returned yet
+  size_t next_inserted_{0};
+  bool child_exhausted_{false};    // the child has no more rows or a row violated a unique index
 };
 
 #endif  // MINISQL_INSERT_EXECUTOR_H
@@ -5,14 +5,30 @@
 #ifndef MINISQL_SEQ_SCAN_EXECUTOR_H
 #define MINISQL_SEQ_SCAN_EXECUTOR_H
 
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 #include <vector>
 
 #include "executor/execute_context.h"
 #include "executor/executors/abstract_executor.h"
 #include "executor/plans/seq_scan_plan.h"
+#include "planner/expressions/column_value_expression.h"
+#include "planner/expressions/comparison_expression.h"
+#include "planner/expressions/constant_value_expression.h"
+#include "planner/expressions/logic_expression.h"
+#include "storage/row_batch.h"
 
 /**
  * The SeqScanExecutor executor executes a sequential table scan.
+ *
+ * If the plan allows it and the table is large enough, the scan runs in parallel: the page ids of the table are split
+ * into morsels of PARALLEL_SCAN_MORSEL_PAGES pages, a pool of workers takes morsels one at a time and filters them,
+ * and Next returns the results morsel by morsel in page order, so the output is the same as for a serial scan.
+ *
+ * A scan with a predicate takes the page ids from the table's page directory instead of following the chain, and does
+ * not read the pages whose zone (see ZoneMap) shows that none of their tuples can satisfy a comparison of a column
+ * with a constant in the predicate.
  */
 class SeqScanExecutor : public AbstractExecutor {
  public:
@@ -23,6 +39,8 @@ class SeqScanExecutor : public AbstractExecutor {
    */
   SeqScanExecutor(ExecuteContext *exec_ctx, const SeqScanPlanNode *plan);
 
+  ~SeqScanExecutor() override;
+
   /** Initialize the sequential scan */
   void Init() override;
 
@@ -38,10 +56,55 @@ class SeqScanExecutor : public AbstractExecutor {
   const Schema *GetOutputSchema() const override { return plan_->OutputSchema(); }
 
  private:
+  /**
+   * Read one heap page and append its rows that satisfy the predicate to rows. The page is released before returning.
+   * @param[out] next_page_id the page following it in the chain, INVALID_PAGE_ID at the end of the table
+   * @return false if the page could not be read
+   */
+  bool FilterPage(page_id_t page_id, RowBatch &batch, std::vector<Row> *rows, ReadAhead *read_ahead,
+                  page_id_t *next_page_id = nullptr);
+
+  /**
+   * @return false if the zone map of the table shows that no tuple of the page satisfies predicate
+   */
+  bool PageMayMatch(page_id_t page_id, AbstractExpression *predicate);
+
+  /** Body of a parallel scan worker. */
+  void ScanMorsels();
+
+  /** Stop the workers of a parallel scan and wait for them. */
+  void StopWorkers();
+
+  /** Rows of one morsel of a parallel scan, filled by the worker that took it. */
+  struct Morsel {
+    std::vector<Row> rows;
+    bool done{false};
+    bool failed{false};  // a page of the morsel could not be read
+  };
+
   /** The sequential scan plan node to be executed */
   const SeqScanPlanNode *plan_;
-  TableIterator cur;
   TableHeap * tableHeap;
+  Schema *schema_;
+  // the table is read a page at a time, the matching rows of the page are buffered here
+  page_id_t next_page_id_{INVALID_PAGE_ID};
+  RowBatch batch_;
+  std::vector<Row> rows_;
+  size_t next_row_{0};
+  ReadAhead read_ahead_;
+  // a serial scan with a predicate walks page_ids_ instead of the chain, skipping pages by their zone
+  bool use_page_ids_{false};
+  size_t next_page_index_{0};
+  // parallel scan, morsels_, next_morsel_, output_morsel_ and stop_ are protected by latch_
+  bool parallel_{false};
+  std::vector<page_id_t> page_ids_;
+  std::vector<Morsel> morsels_;
+  size_t next_morsel_{0};    // next morsel to be taken by a worker
+  size_t output_morsel_{0};  // next morsel whose rows are returned by Next
+  bool stop_{false};
+  std::mutex latch_;
+  std::condition_variable cv_;
+  std::vector<std::thread> workers_;
 };
 
 #endif  // MINISQL_SEQ_SCAN_EXECUTOR_H
@@ -5,6 +5,9 @@
 #ifndef MINISQL_UPDATE_EXECUTOR_H
 #define MINISQL_UPDATE_EXECUTOR_H
 
+#include <unordered_set>
+#include <vector>
+
 #include "executor/execute_context.h"
 #include "executor/executors/abstract_executor.h"
 #include "executor/plans/update_plan.h"
@@ -60,6 +63,10 @@ class UpdateExecutor : public AbstractExecutor {
   TableInfo* tableInfo;
   TableHeap * tableHeap;
   std::vector<IndexInfo *>indices;
+  // key_updated_[i] is false if the update sets no key column of indices[i], the index is then left alone
+  std::vector<bool> key_updated_;
+  // rids of the rows already updated, a row moved to a page the scan has not read yet comes back under the same rid
+  std::unordered_set<int64_t> updated_rows_;
 };
 
 #endif  // MINISQL_UPDATE_EXECUTOR_H
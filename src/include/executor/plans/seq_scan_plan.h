@@ -15,11 +15,17 @@ class SeqScanPlanNode : public AbstractPlanNode {
    * Construct a new SeqScanPlanNode instance.
    * @param output The output schema of this sequential scan plan node
    * @param table_name The identifier of table to be scanned
+   * @param parallel Whether the table may be scanned by several threads, only for scans whose consumer does not
+   * modify the table
+   * @param column_mask Columns of the table the consumer reads, the others are not deserialized, empty for all
    */
-  SeqScanPlanNode(const Schema *output, std::string table_name, AbstractExpressionRef filter_predicate = nullptr)
+  SeqScanPlanNode(const Schema *output, std::string table_name, AbstractExpressionRef filter_predicate = nullptr,
+                  bool parallel = false, std::vector<bool> column_mask = {})
       : AbstractPlanNode(output, {}),
         table_name_(std::move(table_name)),
-        filter_predicate_(std::move(filter_predicate)) {}
+        filter_predicate_(std::move(filter_predicate)),
+        parallel_(parallel),
+        column_mask_(std::move(column_mask)) {}
 
   /** @return The type of the plan node */
   PlanType GetType() const override { return PlanType::SeqScan; }
@@ -29,11 +35,21 @@ class SeqScanPlanNode : public AbstractPlanNode {
 
   AbstractExpressionRef GetPredicate() const { return filter_predicate_; }
 
+  bool IsParallel() const { return parallel_; }
+
+  const std::vector<bool> &GetColumnMask() const { return column_mask_; }
+
   /** The table name */
   std::string table_name_;
 
   /** The predicate to filter in SeqScan.*/
   AbstractExpressionRef filter_predicate_;
+
+  /** Whether the scan may run on several threads. */
+  bool parallel_;
+
+  /** The columns read by the consumer, indexed by table column, empty if all are read. */
+  std::vector<bool> column_mask_;
 };
 
 #endif  // MINISQL_SEQ_SCAN_PLAN_H
@@ -1,14 +1,20 @@
 #ifndef MINISQL_B_PLUS_TREE_H
 #define MINISQL_B_PLUS_TREE_H
 
+#include <atomic>
+#include <fstream>
+#include <mutex>
 #include <queue>
 #include <string>
 #include <vector>
 
+#include "common/rwlatch.h"
 #include "index/index_iterator.h"
+#include "index/key_sorter.h"
 #include "page/b_plus_tree_internal_page.h"
 #include "page/b_plus_tree_leaf_page.h"
 #include "page/b_plus_tree_page.h"
+#include "page/posting_list_page.h"
 #include "transaction/transaction.h"
 
 /**
@@ -16,10 +22,22 @@
  *
  * Implementation of simple b+ tree data structure where internal pages direct
  * the search and leaf pages contain actual data.
- * (1) We only support unique key
+ * (1) A unique tree rejects a key it already holds. A non-unique tree keeps every row of a key: a key with a single row
+ * keeps its RowId in the leaf, a key with more keeps a reference to a sorted posting list (see PostingListPage), so
+ * adding or removing a row of a key that has others never splits or merges a page.
  * (2) support insert & remove
  * (3) The structure should shrink and grow dynamically
  * (4) Implement index iterator for range scan
+ *
+ * The tree is safe for concurrent readers and writers. Readers take no latch: they read each page optimistically
+ * and validate its version (see Page::ReadVersion), coupling a page to its parent by validating the parent again
+ * once the child is pinned, and start over if a writer got in. Readers that keep failing crab down with read latches
+ * instead, holding a page latched until its child is latched. A writer first tries an optimistic pass that read
+ * latches the inner pages and write latches only the leaf, which is enough when the leaf neither splits nor
+ * underflows. Otherwise it starts over with write latch crabbing, and releases every latched ancestor as soon as it
+ * reaches a page that is safe for the operation, so that only the pages that may change stay latched. root_latch_
+ * guards root_page_id_ against other writers and latching readers and is held like the latch of a parent of the root,
+ * optimistic readers check that the root they started from is still the root.
  */
 class BPlusTree {
   using InternalPage = BPlusTreeInternalPage;
@@ -27,18 +45,31 @@ class BPlusTree {
 
  public:
   explicit BPlusTree(index_id_t index_id, BufferPoolManager *buffer_pool_manager, const KeyManager &comparator,
-                     int leaf_max_size = UNDEFINED_SIZE, int internal_max_size = UNDEFINED_SIZE);
+                     int leaf_max_size = UNDEFINED_SIZE, int internal_max_size = UNDEFINED_SIZE, bool unique = true);
 
   // Returns true if this B+ tree has no keys and values.
   bool IsEmpty() const;
 
-  // Insert a key-value pair into this B+ tree.
+  bool IsUnique() const { return unique_; }
+
+  // Insert a key-value pair into this B+ tree, false if the key (the pair if the tree is not unique) is already there.
   bool Insert(GenericKey *key, const RowId &value, Transaction *transaction = nullptr);
 
-  // Remove a key and its value from this B+ tree.
+  // Remove a key and all its values from this B+ tree.
   void Remove(const GenericKey *key, Transaction *transaction = nullptr);
 
-  // return the value associated with a given key
+  // Remove a key-value pair from this B+ tree, the key stays if it has other values.
+  void Remove(const GenericKey *key, const RowId &value, Transaction *transaction = nullptr);
+
+  /**
+   * Build the tree bottom-up from the sorted pairs of sorter, whose Finish was called. The tree must be empty. Pages
+   * are filled to fill_factor of their capacity, never below their min size, and each level is written in one pass.
+   * @return false if the tree is unique and two pairs have the same key, or a page could not be allocated, the tree
+   * is then left empty
+   */
+  bool BulkLoad(KeySorter *sorter, double fill_factor = INDEX_BUILD_FILL_FACTOR);
+
+  // return the values associated with a given key
   bool GetValue(const GenericKey *key, std::vector<RowId> &result, Transaction *transaction = nullptr);
 
   IndexIterator Begin();
@@ -47,15 +78,19 @@ class BPlusTree {
 
   IndexIterator End();
 
-  // expose for test purpose
+  // expose for test purpose, the returned leaf is pinned and read latched
   Page *FindLeafPage(const GenericKey *key, page_id_t page_id = INVALID_PAGE_ID, bool leftMost = false);
 
   // used to check whether all pages are unpinned
   bool Check();
 
-  // destroy the b plus tree
+  // destroy the b plus tree: free the pages of the subtree of current_page_id, of the whole tree by default, which is
+  // then left empty. No other operation may run beside it.
   void Destroy(page_id_t current_page_id = INVALID_PAGE_ID);
 
+  // delete the pages emptied by merges, a page still pinned (by an iterator on it) is kept and tried again later
+  void DeletePages(const std::vector<page_id_t> &page_ids);
+
   void PrintTree(std::ofstream &out) {
     if (IsEmpty()) {
       return;
@@ -68,6 +103,113 @@ class BPlusTree {
   }
 
  private:
+  enum class Operation { INSERT, REMOVE };
+
+  /**
+   * Pages a writer holds write latched in its pessimistic pass.
+   */
+  struct WriteSet {
+    bool root_latched{false};         // root_latch_ is held, the root may change
+    std::vector<Page *> pages;        // pinned and latched, from the highest unsafe ancestor down to the leaf
+    std::vector<page_id_t> deleted;   // pages emptied by a merge, deleted once the latches are released
+  };
+
+  /**
+   * Descend for the optimistic pass: inner pages are read latched, the leaf is write latched.
+   * @param is_root set to true if the leaf is the root
+   */
+  Page *FindLeafPageOptimistic(const GenericKey *key, bool *is_root);
+
+  /**
+   * Descend with write latch crabbing, the latched pages are added to write_set.
+   * @return the leaf, or nullptr if the tree is empty, root_latch_ is then held
+   */
+  Page *FindLeafPagePessimistic(const GenericKey *key, Operation op, WriteSet *write_set);
+
+  /**
+   * Find the leaf for key optimistically and call read on it. read may see the leaf torn by a writer, what it reads is
+   * only kept once the leaf version validates afterwards, otherwise the descent starts over. After
+   * OPTIMISTIC_READ_RETRIES attempts the leaf is found with read latches, see FindLeafPage.
+   * @param leaf_version if not null, set to the version of the leaf read
+   * @return the leaf pinned but not latched, or nullptr if the tree is empty
+   */
+  template <typename F>
+  Page *ReadLeafPage(const GenericKey *key, bool leftMost, F &&read, uint64_t *leaf_version = nullptr);
+
+  /** @return true if op on node can not split or merge it, so its ancestors will not change */
+  static bool IsSafe(BPlusTreePage *node, Operation op, bool is_root);
+
+  void ReleaseWriteSet(WriteSet *write_set, bool is_dirty);
+
+  /**
+   * A level of a tree being bulk loaded. Its nodes are filled in turn, and a full node is added to the level above
+   * only once the node after it is started, so that the last two nodes of the level can be evened out when the input
+   * ends. Only these two nodes are pinned.
+   */
+  struct BulkLevel {
+    BPlusTreePage *full{nullptr};  // the last full node, not yet added to the level above
+    BPlusTreePage *node{nullptr};  // the node being filled
+  };
+
+  /** State of a bulk load, levels[0] being the leaves. */
+  struct BulkBuild {
+    double fill_factor;
+    std::vector<BulkLevel> levels;
+    std::vector<page_id_t> created;   // pages of the tree, deleted if the load fails
+    std::vector<page_id_t> postings;  // first pages of the posting lists, freed if the load fails
+  };
+
+  /** @return entries a node of the level is filled with, fill_factor of its capacity but its min size at least */
+  int BulkTargetSize(const BulkBuild &build, size_t level) const;
+
+  /**
+   * @return the node of the level to add an entry to. A full node is replaced by a new one, leaves are linked to the
+   * one before them. nullptr if a page could not be allocated.
+   */
+  BPlusTreePage *BulkNode(BulkBuild *build, size_t level);
+
+  bool BulkAppendLeaf(BulkBuild *build, GenericKey *key, const RowId &value);
+
+  /** Add child, a node of the level, to the level above. child is unpinned. */
+  bool BulkAddToParent(BulkBuild *build, size_t level, BPlusTreePage *child);
+
+  /**
+   * Move pairs from left to right, the last node of a level, so that both hold their min size, or all of right into
+   * left if they fit in one node. right is then deleted.
+   * @return true if right was merged into left
+   */
+  template <typename N>
+  bool BulkEvenOut(BulkBuild *build, N *left, N *right);
+
+  /** Set the parent of the children of node from begin to end, which were moved into node. */
+  void BulkAdopt(LeafPage *, int, int) {}
+
+  void BulkAdopt(InternalPage *node, int begin, int end);
+
+  /**
+   * Even out and add the last nodes of every level to the level above, up to the root.
+   * @return the root, INVALID_PAGE_ID if a page could not be allocated
+   */
+  page_id_t BulkFinish(BulkBuild *build);
+
+  /** Unpin and delete the pages of a failed bulk load. */
+  void BulkAbort(BulkBuild *build);
+
+  /**
+   * Add value to the values of key, which the leaf write latched by the caller holds.
+   * @return false if key already has value
+   */
+  bool InsertIntoPostingList(LeafPage *leaf, const GenericKey *key, const RowId &value);
+
+  /**
+   * Remove value from the values of key, which the leaf write latched by the caller holds in a posting list.
+   * @return false if key does not have value
+   */
+  bool RemoveFromPostingList(LeafPage *leaf, const GenericKey *key, const RowId &reference, const RowId &value);
+
+  /** Remove key, or only value from key if value is not null. */
+  void RemoveEntry(const GenericKey *key, const RowId *value);
+
   void StartNewTree(GenericKey *key, const RowId &value);
 
   bool InsertIntoLeaf(GenericKey *key, const RowId &value, Transaction *transaction = nullptr);
@@ -80,17 +222,16 @@ class BPlusTree {
   InternalPage *Split(InternalPage *node, Transaction *transaction);
 
   template <typename N>
-  bool CoalesceOrRedistribute(N *&node, Transaction *transaction = nullptr);
+  bool CoalesceOrRedistribute(N *&node, WriteSet *write_set);
 
   bool Coalesce(InternalPage *&neighbor_node, InternalPage *&node, InternalPage *&parent, int index,
-                Transaction *transaction = nullptr);
+                WriteSet *write_set);
 
-  bool Coalesce(LeafPage *&neighbor_node, LeafPage *&node, InternalPage *&parent, int index,
-                Transaction *transaction = nullptr);
+  bool Coalesce(LeafPage *&neighbor_node, LeafPage *&node, InternalPage *&parent, int index, WriteSet *write_set);
 
-  void Redistribute(LeafPage *neighbor_node, LeafPage *node, int index);
+  void Redistribute(LeafPage *neighbor_node, LeafPage *node, InternalPage *parent, int index);
 
-  void Redistribute(InternalPage *neighbor_node, InternalPage *node, int index);
+  void Redistribute(InternalPage *neighbor_node, InternalPage *node, InternalPage *parent, int index);
 
   bool AdjustRoot(BPlusTreePage *node);
 
@@ -103,11 +244,15 @@ class BPlusTree {
 
   // member variable
   index_id_t index_id_;
-  page_id_t root_page_id_{INVALID_PAGE_ID};
+  ReaderWriterLatch root_latch_;
+  std::atomic<page_id_t> root_page_id_{INVALID_PAGE_ID};
   BufferPoolManager *buffer_pool_manager_;
   KeyManager processor_;
   int leaf_max_size_;
   int internal_max_size_;
+  bool unique_;
+  std::mutex deleted_latch_;              // guards deleted_pages_
+  std::vector<page_id_t> deleted_pages_;  // emptied pages that were still pinned when they were to be deleted
 };
 
 #endif  // MINISQL_B_PLUS_TREE_H
@@ -9,10 +9,17 @@ class BPlusTreeIndex : public Index {
  public:
   //重载函数
   BPlusTreeIndex(index_id_t index_id, IndexSchema *key_schema, BufferPoolManager *buffer_pool_manager);
-  BPlusTreeIndex(index_id_t index_id, IndexSchema *key_schema, size_t key_size, BufferPoolManager *buffer_pool_manager);
+  /** @param unique false for an index where several rows may have the same key */
+  BPlusTreeIndex(index_id_t index_id, IndexSchema *key_schema, size_t key_size, BufferPoolManager *buffer_pool_manager,
+                 bool unique = true);
 
   dberr_t InsertEntry(const Row &key, RowId row_id, Transaction *txn) override;
 
+  /** The keys are sorted, spilling to temporary pages if needed, and the tree is built bottom-up from them. */
+  dberr_t BuildFromTable(TableHeap *table_heap, Schema *schema, const std::vector<uint32_t> &key_map,
+                         Transaction *txn) override;
+
+  /** A unique index removes the key, a non-unique index only the entry of row_id. */
   dberr_t RemoveEntry(const Row &key, RowId row_id, Transaction *txn) override;
 
   dberr_t ScanKey(const Row &key, std::vector<RowId> &result, Transaction *txn, string compare_operator = "=") override;
@@ -30,6 +37,7 @@ class BPlusTreeIndex : public Index {
   KeyManager processor_;
   // container
   BPlusTree container_;
+  BufferPoolManager *buffer_pool_manager_;
 };
 
 #endif  // MINISQL_B_PLUS_TREE_INDEX_H
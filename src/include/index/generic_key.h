@@ -1,75 +1,279 @@
 #ifndef MINISQL_GENERIC_KEY_H
 #define MINISQL_GENERIC_KEY_H
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
 #include <cstring>
+#include <string>
+#include <vector>
 
 #include "record/field.h"
 #include "record/row.h"
+#include "record/row_view.h"
 
 class GenericKey {
   friend class KeyManager;
   char data[0];//这个地址就是数据的地址,常用于构成动态缓冲区buffer
 };
 
+/**
+ * KeyManager builds and compares index keys.
+ *
+ * A key is stored in a normalized form whose byte order is the order of the key, so that two keys are compared with a
+ * single memcmp. Each key column takes a fixed number of bytes, in key column order:
+ *  -----------------------------------------------
+ *  | Null (1) | Value (column width) | Null (1) | ...
+ *  -----------------------------------------------
+ * The null byte is 0 for a null, which sorts before every value and leaves the value bytes zero, and 1 otherwise.
+ * An int is stored big-endian with its sign bit flipped. A float is stored big-endian after flipping its sign bit if
+ * it is positive and all its bits if it is negative. A char value is stored as is and padded with zero bytes to the
+ * column length. A value longer than its column does not fit in a key, see SerializeFromKey.
+ */
 class KeyManager {
  public: /**/
   [[nodiscard]] inline GenericKey *InitKey() const {
     return (GenericKey *)malloc(key_size_);  // remember delete
   }
 
-  inline void SerializeFromKey(GenericKey *key_buf, const Row &key, Schema *schema) const {
-    // initialize to 0
-    [[maybe_unused]] uint32_t size = key.GetSerializedSize(schema);
+  /**
+   * Build the key of a row of the key schema. A value the key can not hold exactly, a char value longer than its column
+   * or a number of the other type such as 3.5 for an int column, is replaced by the nearest key below it, or above it
+   * if there is none below.
+   * @return 0 if the key holds the values exactly, otherwise the sign of the first such value compared with its key
+   */
+  inline int SerializeFromKey(GenericKey *key_buf, const Row &key, Schema *schema) const {
     ASSERT(key.GetFieldCount() == schema->GetColumnCount(), "field nums not match.");
-    ASSERT(size <= (uint32_t)key_size_, "Index key size exceed max key size.");
+    ASSERT(key_length_ <= (uint32_t)key_size_, "Index key size exceed max key size.");
     memset(key_buf->data, 0, key_size_);
-    key.SerializeTo(key_buf->data, schema);
+    char *cur = key_buf->data;
+    int cmp = 0;
+    for (uint32_t i = 0; i < key.GetFieldCount(); i++) {
+      const Column *column = schema->GetColumn(i);
+      int field_cmp = EncodeField(cur, *key.GetField(i), column);
+      cmp = cmp != 0 ? cmp : field_cmp;
+      cur += 1 + column->GetLength();
+    }
+    return cmp;
   }
 
-  inline void DeserializeToKey(const GenericKey *key_buf, Row &key, Schema *schema) const {
-    [[maybe_unused]] uint32_t ofs = key.DeserializeFrom(const_cast<char *>(key_buf->data), schema);
-    ASSERT(ofs <= (uint32_t)key_size_, "Index key size exceed max key size.");
+  /** @return true if a key of key_schema holds the values of key exactly, see SerializeFromKey */
+  static bool KeyFits(const Row &key, const Schema *key_schema) {
+    std::string buf;
+    for (uint32_t i = 0; i < key.GetFieldCount(); i++) {
+      const Column *column = key_schema->GetColumn(i);
+      buf.assign(1 + column->GetLength(), '\0');
+      if (EncodeField(buf.data(), *key.GetField(i), column) != 0) {
+        return false;
+      }
+    }
+    return true;
   }
 
-  // compare
-  [[nodiscard]] inline int CompareKeys(const GenericKey *lhs, const GenericKey *rhs) const {
-    //    ASSERT(malloc_usable_size((void *)&lhs) == malloc_usable_size((void *)&rhs), "key size not match.");
-    uint32_t column_count = key_schema_->GetColumnCount();
-    Row lhs_key(INVALID_ROWID);
-    Row rhs_key(INVALID_ROWID);
-    DeserializeToKey(lhs, lhs_key, key_schema_);
-    DeserializeToKey(rhs, rhs_key, key_schema_);
-
-    for (uint32_t i = 0; i < column_count; i++) {
-      Field *lhs_value = lhs_key.GetField(i);
-      Field *rhs_value = rhs_key.GetField(i);
-
-      if (lhs_value->CompareLessThan(*rhs_value) == CmpBool::kTrue) {
+  /**
+   * Build the key of a tuple read in place, without deserializing it.
+   * @param key_map position in the tuple of each key column
+   * @return false if a key value is longer than its column, or stored out of line which makes it longer than any column
+   */
+  inline bool SerializeFromView(GenericKey *key_buf, const RowView &row, const std::vector<uint32_t> &key_map) const {
+    ASSERT(key_map.size() == key_schema_->GetColumnCount(), "field nums not match.");
+    ASSERT(key_length_ <= (uint32_t)key_size_, "Index key size exceed max key size.");
+    memset(key_buf->data, 0, key_size_);
+    char *cur = key_buf->data;
+    for (uint32_t i = 0; i < key_map.size(); i++) {
+      const Column *column = key_schema_->GetColumn(i);
+      if (!row.IsNull(key_map[i])) {
+        *cur = 1;
+        switch (column->GetType()) {
+          case kTypeInt:
+            EncodeInt(cur + 1, row.GetInt(key_map[i]));
+            break;
+          case kTypeFloat:
+            EncodeFloat(cur + 1, row.GetFloat(key_map[i]));
+            break;
+          default: {
+            if (row.IsExternal(key_map[i])) {
+              return false;
+            }
+            uint32_t len;
+            const char *chars = row.GetChars(key_map[i], &len);
+            if (len > column->GetLength()) {
+              return false;
+            }
+            EncodeChars(cur + 1, chars, len);
+          }
+        }
+      }
+      cur += 1 + column->GetLength();
+    }
+    return true;
+  }
 
-        return -1;
+  /**
+   * Decode a key into a row of the key schema. The padding of a char value is dropped.
+   */
+  inline void DeserializeToKey(const GenericKey *key_buf, Row &key, Schema *schema) const {
+    ASSERT(key.GetFieldCount() == 0, "Non empty field in key.");
+    const char *cur = key_buf->data;
+    for (uint32_t i = 0; i < schema->GetColumnCount(); i++) {
+      const Column *column = schema->GetColumn(i);
+      if (*cur == 0) {
+        key.GetFields().push_back(new Field(column->GetType()));
+      } else if (column->GetType() == kTypeInt) {
+        key.GetFields().push_back(new Field(kTypeInt, DecodeInt(cur + 1)));
+      } else if (column->GetType() == kTypeFloat) {
+        key.GetFields().push_back(new Field(kTypeFloat, DecodeFloat(cur + 1)));
+      } else {
+        uint32_t len = column->GetLength();
+        while (len > 0 && cur[len] == 0) {
+          len--;
+        }
+        key.GetFields().push_back(new Field(kTypeChar, const_cast<char *>(cur + 1), len, true));
       }
+      cur += 1 + column->GetLength();
+    }
+  }
 
-      if (lhs_value->CompareGreaterThan(*rhs_value) == CmpBool::kTrue) {
+  // compare
+  [[nodiscard]] inline int CompareKeys(const GenericKey *lhs, const GenericKey *rhs) const {
+    int cmp = memcmp(lhs->data, rhs->data, key_length_);
+    return cmp < 0 ? -1 : (cmp > 0 ? 1 : 0);
+  }
 
-        return 1;
+  /** @return true if a column of the key is null, such a key matches no comparison */
+  [[nodiscard]] inline bool HasNull(const GenericKey *key) const {
+    const char *cur = key->data;
+    for (auto column : key_schema_->GetColumns()) {
+      if (*cur == 0) {
+        return true;
       }
+      cur += 1 + column->GetLength();
     }
-    // equals
-    return 0;
+    return false;
   }
 
   inline int GetKeySize() const { return key_size_; }
 
+  /** @return bytes of a normalized key of key_schema, see KeyManager */
+  static uint32_t GetKeyLength(const Schema *key_schema) {
+    uint32_t length = 0;
+    for (auto column : key_schema->GetColumns()) {
+      length += 1 + column->GetLength();
+    }
+    return length;
+  }
+
   KeyManager(const KeyManager &other) {
     this->key_schema_ = other.key_schema_;
     this->key_size_ = other.key_size_;
+    this->key_length_ = other.key_length_;
   }
 
   // constructor
-  KeyManager(Schema *key_schema, size_t key_size) : key_size_(key_size), key_schema_(key_schema) {}
+  KeyManager(Schema *key_schema, size_t key_size)
+      : key_size_(key_size), key_length_(GetKeyLength(key_schema)), key_schema_(key_schema) {}
 
  private:
+  static int32_t ReadInt(const Field &field) {
+    char buf[sizeof(int32_t)];
+    field.SerializeTo(buf);
+    return MACH_READ_FROM(int32_t, buf);
+  }
+
+  static float ReadFloat(const Field &field) {
+    char buf[sizeof(float)];
+    field.SerializeTo(buf);
+    return MACH_READ_FROM(float, buf);
+  }
+
+  static void EncodeUint32(char *buf, uint32_t bits) {
+    for (int i = 3; i >= 0; i--, bits >>= 8) {
+      buf[i] = static_cast<char>(bits & 0xFF);
+    }
+  }
+
+  static uint32_t DecodeUint32(const char *buf) {
+    uint32_t bits = 0;
+    for (int i = 0; i < 4; i++) {
+      bits = bits << 8 | static_cast<uint8_t>(buf[i]);
+    }
+    return bits;
+  }
+
+  static void EncodeInt(char *buf, int32_t value) { EncodeUint32(buf, static_cast<uint32_t>(value) ^ 0x80000000U); }
+
+  static int32_t DecodeInt(const char *buf) { return static_cast<int32_t>(DecodeUint32(buf) ^ 0x80000000U); }
+
+  static void EncodeFloat(char *buf, float value) {
+    // -0.0 equals 0.0
+    if (value == 0) {
+      value = 0;
+    }
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(float));
+    EncodeUint32(buf, (bits & 0x80000000U) ? ~bits : bits ^ 0x80000000U);
+  }
+
+  static float DecodeFloat(const char *buf) {
+    uint32_t bits = DecodeUint32(buf);
+    bits = (bits & 0x80000000U) ? bits ^ 0x80000000U : ~bits;
+    float value;
+    memcpy(&value, &bits, sizeof(float));
+    return value;
+  }
+
+  static void EncodeChars(char *buf, const char *chars, uint32_t len) { memcpy(buf, chars, len); }
+
+  /**
+   * Write the null byte and the value of one key column at buf, which is zeroed.
+   * @return 0 if the value is held exactly, otherwise the sign of the value compared with what is written
+   */
+  static int EncodeField(char *buf, const Field &field, const Column *column) {
+    if (field.IsNull()) {
+      return 0;
+    }
+    *buf = 1;
+    switch (column->GetType()) {
+      case kTypeInt: {
+        if (field.GetTypeId() != kTypeFloat) {
+          EncodeInt(buf + 1, ReadInt(field));
+          return 0;
+        }
+        // the largest int not above the float
+        double value = ReadFloat(field);
+        double below = std::floor(value);
+        if (below > INT32_MAX) {
+          EncodeInt(buf + 1, INT32_MAX);
+          return 1;
+        }
+        if (!(below >= INT32_MIN)) {
+          EncodeInt(buf + 1, INT32_MIN);
+          return -1;
+        }
+        EncodeInt(buf + 1, static_cast<int32_t>(below));
+        return value > below ? 1 : 0;
+      }
+      case kTypeFloat: {
+        if (field.GetTypeId() != kTypeInt) {
+          EncodeFloat(buf + 1, ReadFloat(field));
+          return 0;
+        }
+        // an int beyond 2^24 may have no float of the same value
+        int32_t value = ReadInt(field);
+        float rounded = static_cast<float>(value);
+        EncodeFloat(buf + 1, rounded);
+        double diff = static_cast<double>(value) - static_cast<double>(rounded);
+        return diff > 0 ? 1 : (diff < 0 ? -1 : 0);
+      }
+      default:
+        // a longer value sorts after its prefix
+        EncodeChars(buf + 1, field.GetData(), std::min(field.GetLength(), column->GetLength()));
+        return field.GetLength() > column->GetLength() ? 1 : 0;
+    }
+  }
+
   int key_size_;
+  uint32_t key_length_;  // bytes of the normalized key, the rest of the key_size_ bytes are zero
   Schema *key_schema_;
 };
 
@@ -5,8 +5,11 @@
 
 #include "common/dberr.h"
 #include "record/row.h"
+#include "record/row_view.h"
 #include "transaction/transaction.h"
 
+class TableHeap;
+
 class Index {
  public:
   explicit Index(index_id_t index_id, IndexSchema *key_schema) : index_id_(index_id), key_schema_(key_schema) {}
@@ -15,6 +18,15 @@ class Index {
 
   virtual dberr_t InsertEntry(const Row &key, RowId row_id, Transaction *txn) = 0;
 
+  /**
+   * Fill an empty index with the keys of every tuple of table_heap.
+   * @param key_map position in the tuple of each key column
+   * @return DB_FAILED if two tuples have the same key or a key value does not fit in the key, the index is then left
+   * empty
+   */
+  virtual dberr_t BuildFromTable(TableHeap *table_heap, Schema *schema, const std::vector<uint32_t> &key_map,
+                                 Transaction *txn) = 0;
+
   virtual dberr_t RemoveEntry(const Row &key, RowId row_id, Transaction *txn) = 0;
 
   virtual dberr_t ScanKey(const Row &key, std::vector<RowId> &result, Transaction *txn,
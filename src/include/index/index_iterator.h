@@ -1,8 +1,27 @@
 #ifndef MINISQL_INDEX_ITERATOR_H
 #define MINISQL_INDEX_ITERATOR_H
 
+#include <vector>
+
+#include "buffer/read_ahead.h"
 #include "page/b_plus_tree_leaf_page.h"
+#include "page/posting_list_page.h"
+
+class BPlusTree;
 
+/**
+ * The iterator keeps its leaf pinned but never latches it: it reads the leaf optimistically and validates the version
+ * of the page afterwards (see Page::ReadVersion), retrying if a writer got in, and falls back to the read latch only
+ * after OPTIMISTIC_READ_RETRIES failed attempts. It copies the pair it points at, and a step moves to the first key
+ * greater than the copied one, found again if writers shifted the leaf in between. Keys are compared with memcmp, see
+ * KeyManager. Pairs only leave a leaf to the left when the leaf is merged into its left sibling, which marks it (see
+ * BPlusTreeLeafPage::MoveAllTo), or when its first pairs are lent to that sibling. So when its leaf is marked, or has
+ * changed and holds no key up to the copied one, the iterator finds the leaf of the copied key again from the root. A
+ * scan running beside writers thus returns strictly increasing keys and every key that stays in the tree during the
+ * scan. The next leaf is pinned before the current one is unlatched, so it can not be freed and reused under the
+ * iterator. A key whose values are in a posting list is read with the leaf read latched, its values are copied and
+ * returned one by one. An iterator owns its pin: it can be moved but not copied.
+ */
 class IndexIterator {
   using LeafPage = BPlusTreeLeafPage;
 
@@ -10,7 +29,19 @@ class IndexIterator {
   // you may define your own constructor based on your member variables
   explicit IndexIterator();
 
-  explicit IndexIterator(page_id_t page_id, BufferPoolManager *bpm, int index = 0);
+  /**
+   * @param page_id the leaf to start from, pinned by the caller
+   * @param version version of the leaf when all the keys to return were in it or the leaves after it
+   * @param key the first key to return if present, nullptr to start from the first key of the leaf
+   */
+  explicit IndexIterator(BPlusTree *tree, BufferPoolManager *bpm, page_id_t page_id, uint64_t version,
+                         const GenericKey *key = nullptr);
+
+  IndexIterator(IndexIterator &&other) noexcept;
+
+  IndexIterator(const IndexIterator &other) = delete;
+
+  IndexIterator &operator=(const IndexIterator &other) = delete;
 
   ~IndexIterator();
 
@@ -27,10 +58,38 @@ class IndexIterator {
   bool operator!=(const IndexIterator &itr) const;
 
  private:
+  /**
+   * Find the pair to point at: the first one after current_key, or the first one before the first pair is found. Move
+   * on to the following leaves while the current one has no such pair, then copy the pair.
+   */
+  void Settle();
+
+  /** @return index of the pair to point at in the current leaf, which may be its size */
+  int FindPosition();
+
+  /** @return index of the first key in the current leaf greater than current_key, or not less than it if inclusive */
+  int Seek();
+
+  /**
+   * Leave the current leaf, unlatching it first if latched, and find the leaf of current_key from the root. The new
+   * leaf is returned read latched, current_page_id is INVALID_PAGE_ID if the tree is empty.
+   */
+  void Restart(bool latched);
+
+  BPlusTree *tree{nullptr};
   page_id_t current_page_id{INVALID_PAGE_ID};
+  Page *frame{nullptr};  // the pinned page of the current leaf
   LeafPage *page{nullptr};
+  uint64_t leaf_version{0};  // version of the leaf when all the keys after current_key were in it or after it
   int item_index{0};
+  std::vector<char> current_key;  // copy of the key at item_index, empty before the first pair is found
+  bool inclusive{false};          // current_key is the start key of the scan, not yet returned
+  RowId current_value;
+  std::vector<RowId> postings;  // values of current_key when it has a posting list, current_value is one of them
+  size_t posting_index{0};
+  std::vector<char> next_key;  // key read from the page, kept only once the page version validates
   BufferPoolManager *buffer_pool_manager{nullptr};
+  ReadAhead read_ahead;  // prefetches the leaf chain ahead of the iterator
   // add your own private member variables here
 };
 
@@ -0,0 +1,123 @@
+#ifndef MINISQL_KEY_SORTER_H
+#define MINISQL_KEY_SORTER_H
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/config.h"
+#include "common/macros.h"
+#include "common/rowid.h"
+#include "index/generic_key.h"
+
+/**
+ * KeySorter sorts the (key, RowId) pairs of an index build by key, then by RowId, so that the tree can be built
+ * bottom-up from them (see BPlusTree::BulkLoad). Keys are in the normalized form of KeyManager and compared with
+ * memcmp.
+ *
+ * Pairs are collected in a buffer of buffer_size bytes. When the buffer is full it is sorted and written out as a run
+ * to a chain of temporary pages, Finish then merges the runs, reading one page of each run at a time. If every pair
+ * fits in the buffer nothing is written. At most INDEX_SORT_MERGE_FAN_IN runs are merged at once, more runs are first
+ * merged into longer runs. The run pages are deleted as soon as they are read.
+ *
+ * Run page format (size in byte):
+ *  ----------------------------------------------------------------
+ * | NextPageId (4) | Count (4) | Key (key_size) | RowId (8) | ... |
+ *  ----------------------------------------------------------------
+ */
+class KeySorter {
+ public:
+  KeySorter(BufferPoolManager *buffer_pool_manager, int key_size, size_t buffer_size = INDEX_SORT_BUFFER_SIZE);
+
+  ~KeySorter();
+
+  DISALLOW_COPY(KeySorter);
+
+  /**
+   * Add a pair, must be called before Finish.
+   * @return false if a run could not be written out
+   */
+  bool Add(const GenericKey *key, RowId rid);
+
+  /**
+   * Stop adding pairs and start returning them in order.
+   * @return false if a run could not be written out or read back
+   */
+  bool Finish();
+
+  /**
+   * Get the next pair in order. key points into the sorter and is valid until the next call.
+   * @return false once every pair was returned, or if a run page could not be read
+   */
+  bool Next(GenericKey **key, RowId *rid);
+
+  /** @return number of pairs added */
+  uint64_t Size() const { return size_; }
+
+ private:
+  static constexpr uint32_t OFFSET_NEXT_PAGE_ID = 0;
+  static constexpr uint32_t OFFSET_COUNT = 4;
+  static constexpr uint32_t RUN_PAGE_HEADER_SIZE = 8;
+
+  /** Position in a run being merged, the page it reads is pinned. */
+  struct RunCursor {
+    Page *page{nullptr};
+    uint32_t index{0};
+    uint32_t count{0};
+  };
+
+  const char *EntryAt(const char *base, uint32_t index) const { return base + index * entry_size_; }
+
+  const char *CursorEntry(const RunCursor &cursor) const {
+    return EntryAt(cursor.page->GetData() + RUN_PAGE_HEADER_SIZE, cursor.index);
+  }
+
+  /** @return true if entry lhs sorts before entry rhs */
+  bool Less(const char *lhs, const char *rhs) const;
+
+  /** Sort the buffered pairs and write them out as a new run. */
+  bool SpillBuffer();
+
+  /** Start writing a new run. */
+  void BeginRun();
+
+  bool AppendToRun(const char *entry);
+
+  /** Finish the run being written and add it to runs_. */
+  void EndRun();
+
+  /** Open a cursor on each run and start merging them, the runs are removed from runs_. */
+  bool StartMerge(size_t run_count);
+
+  /**
+   * Get the next entry of the merge. entry points into a run page and is valid until the next call.
+   * @return false once the runs are exhausted, or if a run page could not be read
+   */
+  bool NextMerged(const char **entry);
+
+  /** Delete a chain of run pages starting at page_id. */
+  void DeleteRun(page_id_t page_id);
+
+  BufferPoolManager *buffer_pool_manager_;
+  const uint32_t key_size_;
+  const uint32_t entry_size_;
+  const uint32_t entries_per_page_;
+  const size_t buffer_capacity_;  // entries the buffer holds
+  std::vector<char> buffer_;
+  std::vector<uint32_t> order_;  // sorted positions in buffer_
+  uint64_t size_{0};
+  bool finished_{false};
+  bool failed_{false};
+  std::deque<page_id_t> runs_;  // first page of each run not being merged
+  // run being written
+  page_id_t write_first_page_id_{INVALID_PAGE_ID};
+  Page *write_page_{nullptr};
+  // merge state, only used when there are runs
+  std::vector<RunCursor> cursors_;
+  std::vector<uint32_t> heap_;  // indexes into cursors_, a min-heap on their entries
+  int current_{-1};             // cursor whose entry was returned last, it is advanced on the next call
+  size_t next_sorted_{0};       // without runs, the position in order_ of the next pair
+};
+
+#endif  // MINISQL_KEY_SORTER_H
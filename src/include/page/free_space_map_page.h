@@ -0,0 +1,63 @@
+#ifndef MINISQL_FREE_SPACE_MAP_PAGE_H
+#define MINISQL_FREE_SPACE_MAP_PAGE_H
+
+#include <cstdint>
+
+#include "common/config.h"
+
+/**
+ * Free space map page of a table heap. It records, for every page of the heap, how much free space the page has as a
+ * one byte category, category c meaning at least c * CATEGORY_BYTES free bytes. The pages of one heap are listed in
+ * chain order over a linked list of map pages.
+ *
+ * Format (size in byte):
+ *  ----------------------------------------------------------------------------------------------------
+ * | NextPageId (4) | EntryCount (4) | PageId_1 (4) | ... | PageId_n (4) | Category_1 (1) | ... | Category_n (1) |
+ *  ----------------------------------------------------------------------------------------------------
+ */
+class FreeSpaceMapPage {
+ public:
+  void Init() {
+    next_page_id_ = INVALID_PAGE_ID;
+    count_ = 0;
+  }
+
+  page_id_t GetNextPageId() const { return next_page_id_; }
+
+  void SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
+
+  uint32_t GetCount() const { return count_; }
+
+  page_id_t GetPageId(uint32_t index) const { return page_ids_[index]; }
+
+  uint8_t GetCategory(uint32_t index) const { return Categories()[index]; }
+
+  void SetCategory(uint32_t index, uint8_t category) { Categories()[index] = category; }
+
+  /**
+   * Add an entry for a heap page at the end of the map page.
+   * @return the index of the new entry, or -1 if the map page is full
+   */
+  int Append(page_id_t page_id, uint8_t category);
+
+  /** @return the largest category a page with free_space bytes free belongs to */
+  static uint8_t ToCategory(uint32_t free_space);
+
+  /** @return the smallest category whose pages are guaranteed to have free_space bytes free */
+  static uint8_t RequiredCategory(uint32_t free_space);
+
+  static constexpr uint32_t CATEGORY_BYTES = PAGE_SIZE / 256;
+  static constexpr uint32_t MAX_ENTRY_COUNT = (PAGE_SIZE - 8) / (sizeof(page_id_t) + sizeof(uint8_t));
+
+ private:
+  uint8_t *Categories() { return reinterpret_cast<uint8_t *>(page_ids_ + MAX_ENTRY_COUNT); }
+
+  const uint8_t *Categories() const { return reinterpret_cast<const uint8_t *>(page_ids_ + MAX_ENTRY_COUNT); }
+
+ private:
+  page_id_t next_page_id_;
+  uint32_t count_;
+  page_id_t page_ids_[0];
+};
+
+#endif  // MINISQL_FREE_SPACE_MAP_PAGE_H
@@ -0,0 +1,59 @@
+#ifndef MINISQL_OVERFLOW_PAGE_H
+#define MINISQL_OVERFLOW_PAGE_H
+
+#include <cstdint>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/config.h"
+#include "record/row.h"
+
+/**
+ * Overflow page, holding a piece of a char value stored out of line (see Row::ExternalValue). The pieces of one value
+ * are chained from its first page, which the tuple points to. An overflow page is written once, when the value is
+ * stored, and is never modified afterwards, so it is read without latching; the value is freed only after no tuple
+ * points to it any more.
+ *
+ * Format (size in byte):
+ *  ---------------------------------------------------
+ * | NextPageId (4) | DataSize (4) | Data (DataSize) |
+ *  ---------------------------------------------------
+ */
+class OverflowPage {
+ public:
+  page_id_t GetNextPageId() const { return next_page_id_; }
+
+  uint32_t GetDataSize() const { return data_size_; }
+
+  const char *GetData() const { return data_; }
+
+  /**
+   * Store a value in a new chain of overflow pages.
+   * @return the first page of the chain, INVALID_PAGE_ID if the pages could not be allocated
+   */
+  static page_id_t WriteValue(BufferPoolManager *buffer_pool_manager, const char *data, uint32_t size);
+
+  /**
+   * Copy size bytes of the value starting at first_page_id into out.
+   * @return false if a page of the chain could not be fetched
+   */
+  static bool ReadValue(BufferPoolManager *buffer_pool_manager, page_id_t first_page_id, char *out, uint32_t size);
+
+  /** Delete the pages of the value starting at first_page_id. */
+  static void FreeValue(BufferPoolManager *buffer_pool_manager, page_id_t first_page_id);
+
+  /**
+   * Replace the placeholder fields that Row::DeserializeFrom leaves for out-of-line values by the values, and forget
+   * the values' pages.
+   * @return false if a value could not be read, its field is then left null
+   */
+  static bool ReadExternalValues(BufferPoolManager *buffer_pool_manager, Row *row);
+
+  static constexpr uint32_t MAX_DATA_SIZE = PAGE_SIZE - 2 * sizeof(uint32_t);
+
+ private:
+  page_id_t next_page_id_;
+  uint32_t data_size_;
+  char data_[0];
+};
+
+#endif  // MINISQL_OVERFLOW_PAGE_H
@@ -1,6 +1,7 @@
 #ifndef MINISQL_PAGE_H
 #define MINISQL_PAGE_H
 
+#include <atomic>
 #include <cstring>
 #include <iostream>
 #include <shared_mutex>
@@ -15,7 +16,7 @@
  */
 class Page {
   // There is bookkeeping information inside the page that should only be relevant to the buffer pool manager.
-  friend class BufferPoolManager;
+  friend class BufferPoolManagerInstance;
 
  public:
   DISALLOW_COPY(Page)
@@ -38,11 +39,18 @@ class Page {
   /** @return true if the page in memory has been modified from the page on disk, false otherwise */
   inline bool IsDirty() { return is_dirty_; }
 
-  /** Acquire the page write latch. */
-  inline void WLatch() { rwlatch_.WLock(); }
+  /** Acquire the page write latch. The version becomes odd while the page is write latched. */
+  inline void WLatch() {
+    rwlatch_.WLock();
+    version_.store(version_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+  }
 
   /** Release the page write latch. */
-  inline void WUnlatch() { rwlatch_.WUnlock(); }
+  inline void WUnlatch() {
+    version_.store(version_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    rwlatch_.WUnlock();
+  }
 
   /** Acquire the page read latch. */
   inline void RLatch() { rwlatch_.RLock(); }
@@ -50,6 +58,22 @@ class Page {
   /** Release the page read latch. */
   inline void RUnlatch() { rwlatch_.RUnlock(); }
 
+  /**
+   * Start an optimistic read, which reads the page without latching it and so without writing to it. The data read
+   * may be torn by a writer and can only be trusted once ValidateVersion succeeds.
+   * @return false if the page is write latched right now
+   */
+  inline bool ReadVersion(uint64_t *version) {
+    *version = version_.load(std::memory_order_acquire);
+    return (*version & 1) == 0;
+  }
+
+  /** @return true if the page has not been write latched since ReadVersion returned version */
+  inline bool ValidateVersion(uint64_t version) {
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return version_.load(std::memory_order_relaxed) == version;
+  }
+
   /** @return the page LSN. */
   inline lsn_t GetLSN() { return *reinterpret_cast<lsn_t *>(GetData() + OFFSET_LSN); }
 
@@ -78,6 +102,8 @@ class Page {
   bool is_dirty_ = false;
   /** Page latch. */
   ReaderWriterLatch rwlatch_;
+  /** Bumped by every write latch and unlatch, see ReadVersion. */
+  std::atomic<uint64_t> version_{0};
 };
 
 #endif  // MINISQL_PAGE_H
@@ -0,0 +1,138 @@
+#ifndef MINISQL_PAX_PAGE_H
+#define MINISQL_PAX_PAGE_H
+/**
+ * PAX (Partition Attributes Across) page format, used by tables created in the columnar format:
+ *  ----------------------------------------------------------------------------------
+ *  | HEADER | USED BITMAP | DELETED BITMAP | MINIPAGE_1 | ... | MINIPAGE_N |
+ *  ----------------------------------------------------------------------------------
+ *
+ *  Header format (size in bytes):
+ *  ----------------------------------------------------------------------------------------------
+ *  | PageId (4)| LSN (4)| PrevPageId (4)| NextPageId (4)| Capacity (4)| TupleCount (4)|
+ *  ----------------------------------------------------------------------------------------------
+ *  --------------------------------------------------------------------------------
+ *  | TupleSpace (4)| ColumnCount (4)| Minipage_1 offset (4)| ... | Minipage_N offset (4)|
+ *  --------------------------------------------------------------------------------
+ *
+ *  Minipage format:
+ *  ------------------------------------------------------
+ *  | NULL BITMAP | Value_1 | Value_2 | ... | Value_Capacity |
+ *  ------------------------------------------------------
+ *
+ * The page holds up to Capacity tuples, tuple i owns bit i of every bitmap and entry i of every minipage. A minipage
+ * is an array of the column's fixed-width slots (see Schema::CanBeFixedWidth), so a scan that needs a few columns
+ * only touches their minipages. The first four header fields sit where TablePage keeps them, so the page chain is
+ * walked through the TablePage accessors whatever the page format.
+ **/
+
+#include <vector>
+
+#include "page/table_page.h"
+
+class PaxPage : public TablePage {
+ public:
+  /**
+   * @return true if tuples of schema can be stored in PAX pages, i.e. every column has a fixed width and a page holds
+   * a useful number of tuples
+   */
+  static bool CanStore(const Schema *schema);
+
+  /**
+   * @return bytes a tuple of schema takes in a PAX page, the unit of GetFreeSpaceRemaining
+   */
+  static uint32_t GetTupleSpace(const Schema *schema);
+
+  void Init(page_id_t page_id, page_id_t prev_id, const Schema *schema, LogManager *log_mgr, Transaction *txn);
+
+  bool InsertTuple(Row &row, Schema *schema, Transaction *txn, LockManager *lock_manager, LogManager *log_manager);
+
+  bool MarkDelete(const RowId &rid, Transaction *txn, LockManager *lock_manager, LogManager *log_manager);
+
+  /**
+   * Overwrite the tuple in place, a PAX slot always has room for the new values.
+   */
+  bool UpdateTuple(const Row &new_row, Row *old_row, Schema *schema, Transaction *txn, LockManager *lock_manager,
+                   LogManager *log_manager);
+
+  void ApplyDelete(const RowId &rid, Transaction *txn, LogManager *log_manager);
+
+  void RollbackDelete(const RowId &rid, Transaction *txn, LogManager *log_manager);
+
+  /**
+   * @param needed_columns if not null, only the minipages of these columns are read, the other columns are left as
+   * null fields, see Row::DeserializeFrom
+   */
+  bool GetTuple(Row *row, Schema *schema, Transaction *txn, LockManager *lock_manager,
+                const std::vector<bool> *needed_columns = nullptr);
+
+  bool GetFirstTupleRid(RowId *first_rid);
+
+  bool GetNextTupleRid(const RowId &cur_rid, RowId *next_rid);
+
+  /**
+   * Append the rid of every live tuple of this page to spans, in slot order. The tuples are not contiguous, offset
+   * holds the slot and size is 0.
+   */
+  void GetTupleSpans(std::vector<TupleSpan> *spans);
+
+  /** @return the null bitmap of a column, bit i belongs to slot i */
+  const char *GetNullBitmap(uint32_t column_idx) { return GetData() + GetMinipageOffset(column_idx); }
+
+  /** @return the slots of a column, slot i starts at i times the column's fixed slot size */
+  const char *GetValues(uint32_t column_idx) { return GetData() + GetMinipageOffset(column_idx) + GetBitmapSize(); }
+
+  uint32_t GetCapacity() { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_CAPACITY); }
+
+  uint32_t GetTupleCount() { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_TUPLE_COUNT); }
+
+  uint32_t GetFreeSpaceRemaining() { return (GetCapacity() - GetTupleCount()) * GetTupleSpace(); }
+
+ private:
+  /** @return capacity of a page holding column_count columns whose slots add up to row_width bytes */
+  static uint32_t ComputeCapacity(uint32_t column_count, uint32_t row_width);
+
+  /** @return bytes used by a page of the given shape */
+  static uint32_t ComputeLayoutSize(uint32_t column_count, uint32_t row_width, uint32_t capacity);
+
+  static uint32_t BitmapSize(uint32_t capacity) { return (capacity + 31) / 32 * 4; }
+
+  uint32_t GetBitmapSize() { return BitmapSize(GetCapacity()); }
+
+  uint32_t GetTupleSpace() { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_TUPLE_SPACE); }
+
+  uint32_t GetColumnCount() { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_COLUMN_COUNT); }
+
+  uint32_t GetMinipageOffset(uint32_t column_idx) {
+    return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_MINIPAGES + sizeof(uint32_t) * column_idx);
+  }
+
+  char *GetUsedBitmap() { return GetData() + OFFSET_MINIPAGES + sizeof(uint32_t) * GetColumnCount(); }
+
+  char *GetDeletedBitmap() { return GetUsedBitmap() + GetBitmapSize(); }
+
+  void SetTupleCount(uint32_t tuple_count) { memcpy(GetData() + OFFSET_TUPLE_COUNT, &tuple_count, sizeof(uint32_t)); }
+
+  /** @return true if the slot holds a tuple that is not marked deleted */
+  bool IsLive(uint32_t slot) {
+    return slot < GetCapacity() && TestBit(GetUsedBitmap(), slot) && !TestBit(GetDeletedBitmap(), slot);
+  }
+
+  /** Write the values of row into slot. */
+  void WriteSlot(uint32_t slot, const Row &row, const Schema *schema);
+
+  static bool TestBit(const char *bitmap, uint32_t i) { return (bitmap[i / 8] >> (i % 8)) & 1; }
+
+  static void SetBit(char *bitmap, uint32_t i) { bitmap[i / 8] |= static_cast<char>(1 << (i % 8)); }
+
+  static void ClearBit(char *bitmap, uint32_t i) { bitmap[i / 8] &= static_cast<char>(~(1 << (i % 8))); }
+
+ private:
+  static constexpr size_t OFFSET_CAPACITY = 16;
+  static constexpr size_t OFFSET_TUPLE_COUNT = 20;
+  static constexpr size_t OFFSET_TUPLE_SPACE = 24;
+  static constexpr size_t OFFSET_COLUMN_COUNT = 28;
+  static constexpr size_t OFFSET_MINIPAGES = 32;
+  static constexpr uint32_t MIN_CAPACITY = 4;
+};
+
+#endif  // MINISQL_PAX_PAGE_H
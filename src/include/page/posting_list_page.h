@@ -0,0 +1,79 @@
+#ifndef MINISQL_POSTING_LIST_PAGE_H
+#define MINISQL_POSTING_LIST_PAGE_H
+
+#include <cstdint>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/config.h"
+#include "common/rowid.h"
+
+/**
+ * Posting list page, holding part of the sorted RowIds of a key of a non-unique index that has several rows. A key
+ * with a single row keeps its RowId in the leaf, a key with more keeps a reference to the first page of its list in
+ * place of the RowId (see MakeReference). The pages of a list are chained and sorted: every RowId of a page is smaller
+ * than those of the next page, and no page is empty.
+ *
+ * A posting list is only read with the leaf holding its key latched, and only changed with that leaf write latched, so
+ * the pages of the list are not latched themselves.
+ *
+ * Format (size in byte):
+ *  --------------------------------------------------------
+ * | NextPageId (4) | Size (4) | RowId (8) | RowId (8) | ... |
+ *  --------------------------------------------------------
+ */
+class PostingListPage {
+ public:
+  /** @return the value a leaf keeps for the list starting at first_page_id */
+  static RowId MakeReference(page_id_t first_page_id) {
+    return RowId(INVALID_PAGE_ID, static_cast<uint32_t>(first_page_id));
+  }
+
+  /** @return true if value is a reference to a posting list rather than the RowId of a row */
+  static bool IsReference(const RowId &value) {
+    return value.GetPageId() == INVALID_PAGE_ID && value.GetSlotNum() != 0;
+  }
+
+  static page_id_t GetFirstPageId(const RowId &reference) { return static_cast<page_id_t>(reference.GetSlotNum()); }
+
+  /**
+   * Store sorted RowIds in a new list, filling its pages.
+   * @return the first page of the list, INVALID_PAGE_ID if the pages could not be allocated
+   */
+  static page_id_t Create(BufferPoolManager *buffer_pool_manager, const std::vector<RowId> &rids);
+
+  /**
+   * Add rid to the list, a full page is split in two.
+   * @return false if rid is already in the list or a page could not be allocated
+   */
+  static bool Insert(BufferPoolManager *buffer_pool_manager, page_id_t first_page_id, const RowId &rid);
+
+  /**
+   * Remove rid from the list. The first page of the list is kept, so that the reference to it stays valid.
+   * @param[out] only_left the RowId left if the list holds a single one now, INVALID_ROWID otherwise
+   * @return false if rid is not in the list
+   */
+  static bool Remove(BufferPoolManager *buffer_pool_manager, page_id_t first_page_id, const RowId &rid,
+                     RowId *only_left);
+
+  /**
+   * Append the RowIds of the list to result, in order.
+   * @return false if a page of the list could not be fetched
+   */
+  static bool Read(BufferPoolManager *buffer_pool_manager, page_id_t first_page_id, std::vector<RowId> *result);
+
+  /** Delete the pages of the list starting at first_page_id. */
+  static void Free(BufferPoolManager *buffer_pool_manager, page_id_t first_page_id);
+
+  static constexpr uint32_t MAX_SIZE = (PAGE_SIZE - 2 * sizeof(uint32_t)) / sizeof(RowId);
+
+ private:
+  /** @return index of the first RowId of the page not less than rid */
+  uint32_t LowerBound(const RowId &rid) const;
+
+  page_id_t next_page_id_;
+  uint32_t size_;
+  RowId rids_[0];
+};
+
+#endif  // MINISQL_POSTING_LIST_PAGE_H
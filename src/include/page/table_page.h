@@ -15,9 +15,15 @@
  *  ----------------------------------------------------------------
  *  | TupleCount (4) | Tuple_1 offset (4) | Tuple_1 size (4) | ... |
  *  ----------------------------------------------------------------
+ *
+ *  The high bits of a tuple size are flags. Besides the deleted flag, an update that does not fit in the page moves
+ *  the tuple to another page and leaves a forwarding slot behind, whose 8 bytes hold the rid of the new slot, so that
+ *  the row keeps its rid. The moved tuple is stored after the rid of its home slot and is flagged as relocated: rid
+ *  walks skip it, scans of its page report it under the home rid.
  **/
 
 #include <cstring>
+#include <vector>
 
 #include "common/macros.h"
 #include "common/rowid.h"
@@ -27,6 +33,15 @@
 #include "transaction/log_manager.h"
 #include "transaction/transaction.h"
 
+/**
+ * Location of one live tuple inside a table page.
+ */
+struct TupleSpan {
+  RowId rid;
+  uint32_t offset;  // offset of the serialized tuple from the start of the page
+  uint32_t size;    // size of the serialized tuple in bytes
+};
+
 class TablePage : public Page {
  public:
   void Init(page_id_t page_id, page_id_t prev_id, LogManager *log_mgr, Transaction *txn);
@@ -47,11 +62,33 @@ class TablePage : public Page {
 
   bool InsertTuple(Row &row, Schema *schema, Transaction *txn, LockManager *lock_manager, LogManager *log_manager);
 
+  /**
+   * Insert row as the relocated tuple of the row whose home slot is home_rid. The rid of row is set to its new slot.
+   */
+  bool InsertRelocatedTuple(Row &row, const RowId &home_rid, Schema *schema, Transaction *txn,
+                            LockManager *lock_manager, LogManager *log_manager);
+
   bool MarkDelete(const RowId &rid, Transaction *txn, LockManager *lock_manager, LogManager *log_manager);
 
+  /**
+   * Update the tuple in place, moving the tuples in front of it if its size changes.
+   * @return false if the slot holds no tuple, is a forwarding slot, or the page has no room for the new image
+   */
   bool UpdateTuple(const Row &new_row, Row *old_row, Schema *schema, Transaction *txn, LockManager *lock_manager,
                    LogManager *log_manager);
 
+  /**
+   * @param[out] target the slot holding the tuple of the row
+   * @return true if the slot of rid is a forwarding slot, also if it is marked deleted
+   */
+  bool GetForwardRowId(const RowId &rid, RowId *target);
+
+  /**
+   * Turn the slot of rid into a forwarding slot pointing at target, dropping the tuple stored in it if any.
+   * @return false if the slot is empty, deleted or relocated, or the page has no room for the rid
+   */
+  bool SetForwardRowId(const RowId &rid, const RowId &target);
+
   void ApplyDelete(const RowId &rid, Transaction *txn, LogManager *log_manager);
 
   void RollbackDelete(const RowId &rid, Transaction *txn, LogManager *log_manager);
@@ -62,7 +99,49 @@ class TablePage : public Page {
 
   bool GetNextTupleRid(const RowId &cur_rid, RowId *next_rid);
 
+  /**
+   * @return the serialized tuple in the slot of rid, also if it is marked deleted, nullptr if the slot is empty or
+   * forwarding
+   */
+  const char *GetTupleData(const RowId &rid) {
+    uint32_t slot_num = rid.GetSlotNum();
+    if (slot_num >= GetTupleCount() || GetTupleSize(slot_num) == 0 || IsForward(GetTupleSize(slot_num))) {
+      return nullptr;
+    }
+    uint32_t header_size = IsRelocated(GetTupleSize(slot_num)) ? SIZE_ROW_ID : 0;
+    return GetData() + GetTupleOffsetAtSlot(slot_num) + header_size;
+  }
+
+  /**
+   * @return true if the slot of rid holds a tuple or forwards to one, and is not marked deleted
+   */
+  bool IsTupleLive(const RowId &rid) {
+    return rid.GetSlotNum() < GetTupleCount() && !IsDeleted(GetTupleSize(rid.GetSlotNum()));
+  }
+
+  /**
+   * Append the location of every live tuple of this page to spans, in slot order. Forwarding slots are skipped, a
+   * relocated tuple is listed under the rid of its home slot.
+   */
+  void GetTupleSpans(std::vector<TupleSpan> *spans);
+
+  uint32_t GetFreeSpaceRemaining() {
+    return GetFreeSpacePointer() - SIZE_TABLE_PAGE_HEADER - SIZE_TUPLE * GetTupleCount();
+  }
+
  private:
+  /**
+   * Insert row, after home_rid if not null, see InsertRelocatedTuple.
+   */
+  bool PlaceTuple(Row &row, Schema *schema, const RowId *home_rid);
+
+  /**
+   * Grow or shrink the tuple in a slot to new_size bytes, shifting the tuples stored in front of it. The caller makes
+   * sure the page has room and sets the size of the slot afterwards.
+   * @return the new offset of the tuple, whose content is undefined
+   */
+  uint32_t ResizeTuple(uint32_t slot_num, uint32_t new_size);
+
   uint32_t GetFreeSpacePointer() {
     return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_FREE_SPACE);
   }
@@ -75,10 +154,6 @@ class TablePage : public Page {
 
   void SetTupleCount(uint32_t tuple_count) { memcpy(GetData() + OFFSET_TUPLE_COUNT, &tuple_count, sizeof(uint32_t)); }
 
-  uint32_t GetFreeSpaceRemaining() {
-    return GetFreeSpacePointer() - SIZE_TABLE_PAGE_HEADER - SIZE_TUPLE * GetTupleCount();
-  }
-
   uint32_t GetTupleOffsetAtSlot(uint32_t slot_num) {
     return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_TUPLE_OFFSET + SIZE_TUPLE * slot_num);
   }
@@ -101,9 +176,20 @@ class TablePage : public Page {
 
   static uint32_t UnsetDeletedFlag(uint32_t tuple_size) { return static_cast<uint32_t>(tuple_size & (~DELETE_MASK)); }
 
+  static bool IsForward(uint32_t tuple_size) { return static_cast<bool>(tuple_size & FORWARD_MASK); }
+
+  static bool IsRelocated(uint32_t tuple_size) { return static_cast<bool>(tuple_size & RELOCATED_MASK); }
+
+  /** @return bytes the tuple takes in the page, without the flags */
+  static uint32_t GetStoredSize(uint32_t tuple_size) { return tuple_size & SIZE_MASK; }
+
  private:
   static_assert(sizeof(page_id_t) == 4);
-  static constexpr uint64_t DELETE_MASK = (1U << (8 * sizeof(uint32_t) - 1));
+  static constexpr uint32_t DELETE_MASK = (1U << (8 * sizeof(uint32_t) - 1));
+  static constexpr uint32_t FORWARD_MASK = (1U << (8 * sizeof(uint32_t) - 2));
+  static constexpr uint32_t RELOCATED_MASK = (1U << (8 * sizeof(uint32_t) - 3));
+  static constexpr uint32_t SIZE_MASK = RELOCATED_MASK - 1;
+  static constexpr size_t SIZE_ROW_ID = sizeof(int64_t);
   static constexpr size_t SIZE_TABLE_PAGE_HEADER = 24;
   static constexpr size_t SIZE_TUPLE = 8;
   static constexpr size_t OFFSET_PREV_PAGE_ID = 8;
@@ -115,6 +201,9 @@ class TablePage : public Page {
 
  public:
   static constexpr size_t SIZE_MAX_ROW = PAGE_SIZE - SIZE_TABLE_PAGE_HEADER - SIZE_TUPLE;
+  // a relocated tuple is stored after its home rid
+  static constexpr size_t SIZE_RELOCATION_HEADER = SIZE_ROW_ID;
+  static constexpr size_t SIZE_MAX_RELOCATED_ROW = SIZE_MAX_ROW - SIZE_RELOCATION_HEADER;
 };
 
 #endif
\ No newline at end of file
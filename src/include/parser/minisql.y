@@ -101,6 +101,16 @@ sql_create_table:
     SyntaxNodeAddChildren($$, $3);
     SyntaxNodeAddChildren($$, list_node);
   }
+  | CREATE TABLE IDENTIFIER '(' column_definition_list ')' USING IDENTIFIER {
+    $$ = CreateSyntaxNode(kNodeCreateTable, NULL);
+    pSyntaxNode list_node = CreateSyntaxNode(kNodeColumnDefinitionList, NULL);
+    SyntaxNodeAddChildren(list_node, $5);
+    SyntaxNodeAddChildren($$, $3);
+    SyntaxNodeAddChildren($$, list_node);
+    pSyntaxNode format_node = CreateSyntaxNode(kNodeTableFormat, "table format");
+    SyntaxNodeAddChildren(format_node, $8);
+    SyntaxNodeAddChildren($$, format_node);
+  }
   ;
 
 column_list:
@@ -180,6 +190,25 @@ sql_create_index:
       SyntaxNodeAddChildren(index_type_node, $10);
       SyntaxNodeAddChildren($$, index_type_node);
   }
+  | CREATE UNIQUE INDEX IDENTIFIER ON IDENTIFIER '(' column_list ')' {
+    $$ = CreateSyntaxNode(kNodeCreateIndex, "unique");
+    SyntaxNodeAddChildren($$, $4);
+    SyntaxNodeAddChildren($$, $6);
+    pSyntaxNode index_keys_node = CreateSyntaxNode(kNodeColumnList, "index keys");
+    SyntaxNodeAddChildren(index_keys_node, $8);
+    SyntaxNodeAddChildren($$, index_keys_node);
+  }
+  | CREATE UNIQUE INDEX IDENTIFIER ON IDENTIFIER '(' column_list ')' USING IDENTIFIER {
+      $$ = CreateSyntaxNode(kNodeCreateIndex, "unique");
+      SyntaxNodeAddChildren($$, $4);
+      SyntaxNodeAddChildren($$, $6);
+      pSyntaxNode index_keys_node = CreateSyntaxNode(kNodeColumnList, "index keys");
+      SyntaxNodeAddChildren(index_keys_node, $8);
+      SyntaxNodeAddChildren($$, index_keys_node);
+      pSyntaxNode index_type_node = CreateSyntaxNode(kNodeIndexType, "index type");
+      SyntaxNodeAddChildren(index_type_node, $11);
+      SyntaxNodeAddChildren($$, index_type_node);
+  }
   ;
 
 sql_drop_index:
@@ -43,7 +43,8 @@ typedef enum {
   kNodeIndexType,            /** type of index */
   kNodeTrxBegin,             /** begin transaction command */
   kNodeTrxCommit,            /** commit transaction command */
-  kNodeTrxRollback           /** rollback transaction command */
+  kNodeTrxRollback,          /** rollback transaction command */
+  kNodeTableFormat           /** storage format of a table, eg: columnar */
 } SyntaxNodeType;
 
 /**
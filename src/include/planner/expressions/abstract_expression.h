@@ -9,6 +9,7 @@
 #include <vector>
 
 #include "record/row.h"
+#include "record/row_view.h"
 #include "record/schema.h"
 
 class AbstractExpression;
@@ -36,6 +37,12 @@ class AbstractExpression {
   /** @return The field obtained by evaluating the row */
   virtual Field Evaluate(const Row *row) const = 0;
 
+  /**
+   * Evaluate the expression on a tuple read in place. Char fields in the result may borrow the tuple's bytes or the
+   * expression's constants, so the result must not outlive either.
+   */
+  virtual Field Evaluate(const RowView &row) const = 0;
+
   /**
    * Returns the field obtained by evaluating a JOIN.
    * @param left_row The left row
@@ -45,6 +45,9 @@ class Planner {
 
   Schema *MakeOutputSchema(const std::vector<std::pair<std::string, AbstractExpressionRef>> &exprs);
 
+  /** @return the columns of the table a select reads, in its projection or its predicate */
+  std::vector<bool> MakeColumnMask(const std::shared_ptr<SelectStatement> &statement);
+
   /** Catalog will be used during the planning process. SHOULD ONLY BE USED IN
    * CODE PATH OF `PlanQuery`.
    */
@@ -10,7 +10,7 @@
 #include "record/schema.h"
 
 /**
- *  Row format:
+ *  Row format (tables in the fixed-width format are described in Schema::CanBeFixedWidth):
  * -------------------------------------------
  * | Header | Field-1 | ... | Field-N |
  * -------------------------------------------
@@ -18,11 +18,26 @@
  * --------------------------------------------
  * | Field Nums | Null bitmap |
  * -------------------------------------------
+ *  A char value stored out of line (see ExternalValue) is written as its length with EXTERNAL_FLAG set, followed by
+ *  the id of its first overflow page instead of its bytes.
  *
  *
  */
 class Row {
  public:
+  /** A char value stored out of line in a chain of overflow pages, see OverflowPage. */
+  struct ExternalValue {
+    uint32_t column_idx;
+    uint32_t length;
+    page_id_t first_page_id;
+  };
+
+  /** Set in the length prefix of a char value that is stored out of line. */
+  static constexpr uint32_t EXTERNAL_FLAG = 0x80000000;
+
+  /** Serialized size of an out-of-line value: its flagged length and its first page id. */
+  static constexpr uint32_t EXTERNAL_POINTER_SIZE = 2 * sizeof(uint32_t);
+
   /**
    * Row used for insert
    * Field integrity should check by upper level
@@ -64,6 +79,7 @@ class Row {
     for (auto &field : other.fields_) {
       fields_.push_back(new Field(*field));
     }
+    external_ = other.external_;
   }
 
   /**
@@ -75,6 +91,7 @@ class Row {
     for (auto &field : other.fields_) {
       fields_.push_back(new Field(*field));
     }
+    external_ = other.external_;
     return *this;
   }
 
@@ -85,6 +102,13 @@ class Row {
 
   uint32_t DeserializeFrom(char *buf, Schema *schema);
 
+  /**
+   * Deserialize only the columns set in needed_columns, the bytes of the others are skipped and they are left as null
+   * fields, so that the row keeps one field per column. Columns past the end of needed_columns are deserialized.
+   * @return the size of the whole serialized row
+   */
+  uint32_t DeserializeFrom(char *buf, Schema *schema, const std::vector<bool> &needed_columns);
+
   /**
    * For empty row, return 0
    * For non-empty row with null fields, eg: |null|null|null|, return header size only
@@ -92,6 +116,12 @@ class Row {
    */
   uint32_t GetSerializedSize(Schema *schema) const;
 
+  /**
+   * @return false if the row can not be stored with schema, i.e. a char field is longer than its column in the
+   * fixed-width format
+   */
+  bool FitsSchema(const Schema *schema) const;
+
   void GetKeyFromRow(const Schema *schema, const Schema *key_schema, Row &key_row);
 
   inline const RowId GetRowId() const { return rid_; }
@@ -107,9 +137,45 @@ class Row {
 
   inline size_t GetFieldCount() const { return fields_.size(); }
 
+  /**
+   * Serialize the char value of column idx as a pointer to the overflow pages starting at first_page_id, which must
+   * already hold it. The field keeps its value.
+   */
+  void SetExternal(uint32_t idx, page_id_t first_page_id);
+
+  /** @return true if the value of column idx is serialized as a pointer to overflow pages */
+  bool IsExternal(uint32_t idx) const;
+
+  /**
+   * The out-of-line values of the row. After DeserializeFrom the fields of these columns are null placeholders, see
+   * OverflowPage::ReadExternalValues.
+   */
+  inline const std::vector<ExternalValue> &GetExternalValues() const { return external_; }
+
+  inline void ClearExternalValues() { external_.clear(); }
+
  private:
+  /**
+   * Fixed-width counterparts of SerializeTo and DeserializeFrom, see Schema::CanBeFixedWidth for the format
+   */
+  uint32_t SerializeFixedTo(char *buf, Schema *schema) const;
+
+  uint32_t DeserializeFixedFrom(char *buf, Schema *schema, const std::vector<bool> *needed_columns);
+
+  /** @return the out-of-line value of column idx, nullptr if the value is stored in the tuple */
+  const ExternalValue *FindExternal(uint32_t idx) const;
+
+  /** @return true if buf holds the pointer of an out-of-line value of a column of type type */
+  static bool IsExternalAt(const char *buf, TypeId type, bool is_null) {
+    return !is_null && type == kTypeChar && (MACH_READ_UINT32(buf) & EXTERNAL_FLAG);
+  }
+
+  /** Read the pointer of an out-of-line value into external_, the field of column idx is left null. */
+  uint32_t DeserializeExternalFrom(const char *buf, uint32_t idx);
+
   RowId rid_{};
   std::vector<Field *> fields_; /** Make sure that all field ptr are destructed*/
+  std::vector<ExternalValue> external_;
 };
 
 #endif  // MINISQL_ROW_H
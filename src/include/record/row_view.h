@@ -0,0 +1,126 @@
+#ifndef MINISQL_ROW_VIEW_H
+#define MINISQL_ROW_VIEW_H
+
+#include "common/rowid.h"
+#include "record/field.h"
+#include "record/row.h"
+#include "record/schema.h"
+
+class BufferPoolManager;
+
+/**
+ * RowView reads a tuple in place, in the format written by Row::SerializeTo, without deserializing it.
+ *
+ * The view only points at the serialized bytes, which must stay valid (e.g. the page stays pinned and latched) for as
+ * long as the view and the fields taken from it are used. Column offsets are decoded on demand from the null bitmap
+ * and the length prefixes; the last decoded offset is remembered, so reading the columns in order costs one step per
+ * column. In the fixed-width format the offsets come straight from the schema. A view can also read a tuple of a PAX
+ * page, whose columns lie in separate minipages. Nothing is allocated, a view is meant to be reused with Reset for
+ * every tuple of a scan. A char value stored out of line is only read from its overflow pages when GetField or ToRow
+ * asks for it, which needs the buffer pool set with SetBufferPoolManager.
+ */
+class RowView {
+ public:
+  RowView() = default;
+
+  RowView(const char *data, const Schema *schema, RowId rid = INVALID_ROWID) { Reset(data, schema, rid); }
+
+  /**
+   * Point the view at another serialized tuple.
+   */
+  void Reset(const char *data, const Schema *schema, RowId rid = INVALID_ROWID);
+
+  /**
+   * Point the view at the tuple in slot of a PAX page.
+   * @param null_bitmaps null bitmap of each column, bit slot belongs to the tuple
+   * @param values slots of each column, the tuple's value is at slot times the column's fixed slot size
+   */
+  void ResetColumnar(const char *const *null_bitmaps, const char *const *values, uint32_t slot, const Schema *schema,
+                     RowId rid = INVALID_ROWID);
+
+  /**
+   * Set the buffer pool the overflow pages of out-of-line values are read from, Reset forgets it.
+   */
+  inline void SetBufferPoolManager(BufferPoolManager *buffer_pool_manager) {
+    buffer_pool_manager_ = buffer_pool_manager;
+  }
+
+  inline RowId GetRowId() const { return rid_; }
+
+  /** @return the serialized tuple, nullptr for a tuple of a PAX page */
+  inline const char *GetData() const { return data_; }
+
+  inline uint32_t GetFieldCount() const { return field_count_; }
+
+  inline bool IsNull(uint32_t idx) const {
+    if (null_bitmaps_ != nullptr) {
+      return (null_bitmaps_[idx][slot_ / 8] >> (slot_ % 8)) & 1;
+    }
+    return (bitmap_[idx / 8] >> (idx % 8)) & 1;
+  }
+
+  /** @return the bytes of column idx as Field::SerializeTo writes them */
+  const char *GetFieldData(uint32_t idx) const;
+
+  /** @return the value of an int column, which must not be null */
+  int32_t GetInt(uint32_t idx) const;
+
+  /** @return the value of a float column, which must not be null */
+  float GetFloat(uint32_t idx) const;
+
+  /** @return true if the value of column idx is stored out of line, see Row::ExternalValue */
+  bool IsExternal(uint32_t idx) const;
+
+  /** @return the pointer to the out-of-line value of column idx */
+  Row::ExternalValue GetExternalValue(uint32_t idx) const;
+
+  /**
+   * @param[out] len length of the string
+   * @return the bytes of a char column, not null terminated, the column must not be null nor stored out of line
+   */
+  const char *GetChars(uint32_t idx, uint32_t *len) const;
+
+  /**
+   * @return a field borrowing the column's bytes, a char field does not own its data and must not outlive the view's
+   * buffer. An out-of-line value is read from its overflow pages into a field that owns its data.
+   */
+  Field GetField(uint32_t idx) const;
+
+  /**
+   * Compare column idx of this view with column other_idx of other, which must have the same type.
+   * @return negative, zero or positive like memcmp, a null on either side compares equal
+   */
+  int CompareField(uint32_t idx, const RowView &other, uint32_t other_idx) const;
+
+  /** @return offset of column idx from the start of the tuple, not available for a PAX tuple */
+  uint32_t GetFieldOffset(uint32_t idx) const;
+
+  /** @return size of the value of column idx in the variable-length format, 0 if it is null */
+  uint32_t GetFieldSize(uint32_t idx) const;
+
+  /** @return size of the whole serialized tuple, not available for a PAX tuple */
+  uint32_t GetSerializedSize() const;
+
+  /**
+   * Deserialize the tuple into row, which must have no fields. Out-of-line values are read as well if the view has a
+   * buffer pool.
+   */
+  void ToRow(Row *row) const;
+
+ private:
+  const char *data_{nullptr};
+  const Schema *schema_{nullptr};
+  BufferPoolManager *buffer_pool_manager_{nullptr};
+  RowId rid_{};
+  uint32_t field_count_{0};
+  const char *bitmap_{nullptr};
+  // minipages of a PAX tuple, null for a serialized tuple
+  const char *const *null_bitmaps_{nullptr};
+  const char *const *values_{nullptr};
+  uint32_t slot_{0};
+  // last decoded column offset, offsets are decoded forward from it
+  mutable uint32_t cached_idx_{0};
+  mutable uint32_t cached_offset_{0};
+};
+
+#endif  // MINISQL_ROW_VIEW_H
@@ -2,6 +2,7 @@
 #include <iostream>
 #include <vector>
 
+#include "common/config.h"
 #include "common/dberr.h"
 #include "common/macros.h"
 #include "glog/logging.h"
@@ -56,16 +57,58 @@ class Schema {//schema是一张表的所有信息，可以理解为一张表的
   }
 
   /**
-   * Deep copy schema
+   * Deep copy schema, the tuple format is copied too
    */
   static Schema *DeepCopySchema(const Schema *from) {
     std::vector<Column *> cols;
     for (uint32_t i = 0; i < from->GetColumnCount(); i++) {
       cols.push_back(new Column(from->GetColumn(i)));
     }
-    return new Schema(cols, true);
+    auto schema = new Schema(cols, true);
+    schema->SetFixedWidth(from->fixed_width_);
+    schema->SetColumnar(from->columnar_);
+    return schema;
   }
 
+  /**
+   * Fixed-width tuple format:
+   * -------------------------------------------------------
+   * | Null bitmap | Slot-1 | ... | Slot-N |
+   * -------------------------------------------------------
+   * Every column owns a slot at a constant offset, null or not. An int or float slot holds the value, a char(n) slot
+   * holds the 4-byte length followed by n bytes. The bitmap and the slots are padded to 4 bytes.
+   *
+   * @return true if every column has a bounded size and the whole row is at most max_size
+   */
+  bool CanBeFixedWidth(uint32_t max_size = FIXED_WIDTH_MAX_ROW_SIZE) const;
+
+  /**
+   * Switch between the variable-length format of Row::SerializeTo and the fixed-width format, the offsets of the
+   * slots are computed here. Only allowed before any tuple is stored with this schema.
+   */
+  void SetFixedWidth(bool fixed_width);
+
+  /**
+   * Store the table in PAX pages, one minipage per column (see PaxPage). Columnar tables use the fixed-width format,
+   * which is turned on as well.
+   */
+  void SetColumnar(bool columnar);
+
+  inline bool IsColumnar() const { return columnar_; }
+
+  inline bool IsFixedWidth() const { return fixed_width_; }
+
+  /** @return offset of the slot of column idx from the start of a fixed-width tuple */
+  inline uint32_t GetFixedOffset(uint32_t idx) const { return fixed_offsets_[idx]; }
+
+  /** @return size of the slot of column idx in the fixed-width format */
+  inline uint32_t GetFixedSlotSize(uint32_t idx) const {
+    return (idx + 1 == fixed_offsets_.size() ? fixed_size_ : fixed_offsets_[idx + 1]) - fixed_offsets_[idx];
+  }
+
+  /** @return size of every fixed-width tuple */
+  inline uint32_t GetFixedSize() const { return fixed_size_; }
+
   /**
    * Only used in table
    */
@@ -86,6 +129,10 @@ class Schema {//schema是一张表的所有信息，可以理解为一张表的
   static constexpr uint32_t SCHEMA_MAGIC_NUM = 200715;
   std::vector<Column *> columns_;//vector指向列的指针
   bool is_manage_ = false; /** if false, don't need to delete pointer to column */
+  bool fixed_width_ = false;             /** tuples of this schema use the fixed-width format */
+  std::vector<uint32_t> fixed_offsets_;  /** slot offset of each column in the fixed-width format */
+  uint32_t fixed_size_ = 0;              /** size of a fixed-width tuple */
+  bool columnar_ = false;                /** the table is stored in PAX pages */
 };
 
 using IndexSchema = Schema;
@@ -0,0 +1,156 @@
+#ifndef MINISQL_ASYNC_IO_H
+#define MINISQL_ASYNC_IO_H
+
+#include <sys/types.h>
+#include <sys/uio.h>
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "common/config.h"
+
+/**
+ * AsyncIOHandle describes one asynchronous read or write of a buffer at a file offset, and is the completion handle
+ * the submitter waits on. The buffer must stay valid until the request has completed.
+ */
+class AsyncIOHandle {
+  friend class IoUringIOEngine;
+  friend class ThreadPoolIOEngine;
+
+ public:
+  /**
+   * @param on_complete called with the number of bytes transferred, or -errno, before waiters are woken up
+   */
+  AsyncIOHandle(bool is_write, int fd, char *data, size_t size, size_t offset,
+                std::function<void(ssize_t)> on_complete = nullptr);
+
+  /** @return a handle that is already complete, for requests that need no I/O */
+  static std::shared_ptr<AsyncIOHandle> Completed(bool ok);
+
+  /**
+   * Block until the request has completed.
+   * @return true if the request succeeded
+   */
+  bool Wait();
+
+  /** @return true if the request has completed */
+  bool IsDone();
+
+ private:
+  /** Record the result of the request and wake up all waiters. */
+  void Complete(ssize_t result);
+
+  bool is_write_;
+  int fd_;
+  size_t offset_;     // file offset of the part of the buffer not transferred yet
+  struct iovec iov_;  // part of the buffer not transferred yet
+  size_t transferred_{0};
+  std::function<void(ssize_t)> on_complete_;
+  std::mutex latch_;
+  std::condition_variable cv_;
+  bool done_{false};
+  bool ok_{false};
+};
+
+using IOHandle = std::shared_ptr<AsyncIOHandle>;
+
+/**
+ * AsyncIOEngine executes AsyncIOHandle requests in the background.
+ */
+class AsyncIOEngine {
+ public:
+  virtual ~AsyncIOEngine() = default;
+
+  /**
+   * Start executing a request, the request completes through its handle.
+   */
+  virtual void Submit(const IOHandle &handle) = 0;
+
+  /**
+   * Create the best engine available: io_uring if the kernel supports it, a thread pool otherwise.
+   * @param queue_depth maximum number of requests in flight
+   */
+  static std::unique_ptr<AsyncIOEngine> Create(size_t queue_depth = ASYNC_IO_QUEUE_DEPTH);
+};
+
+/**
+ * Engine built on a io_uring instance. Requests are submitted by the calling thread, completions are reaped by a
+ * dedicated thread.
+ */
+class IoUringIOEngine : public AsyncIOEngine {
+ public:
+  /** @return nullptr if io_uring is not available */
+  static std::unique_ptr<IoUringIOEngine> Create(size_t queue_depth);
+
+  ~IoUringIOEngine() override;
+
+  void Submit(const IOHandle &handle) override;
+
+ private:
+  IoUringIOEngine() = default;
+
+  /**
+   * Fill the next submission queue entry and submit it, must be called with submit_latch_ held.
+   * @return 0, or -errno if the entry could not be submitted, it is then taken back from the queue
+   */
+  int PushSubmission(uint8_t opcode, int fd, uint64_t addr, uint32_t len, uint64_t offset, uint64_t user_data);
+
+  /** Submit the rest of the buffer of a request, must be called with submit_latch_ held. */
+  int PushRequest(IOHandle *handle);
+
+  /** Body of the completion thread. */
+  void ReapCompletions();
+
+ private:
+  int ring_fd_{-1};
+  // submission queue ring
+  void *sq_ring_{nullptr};
+  size_t sq_ring_size_{0};
+  unsigned *sq_tail_{nullptr};
+  unsigned *sq_mask_{nullptr};
+  unsigned *sq_array_{nullptr};
+  void *sqes_{nullptr};
+  size_t sqes_size_{0};
+  // completion queue ring
+  void *cq_ring_{nullptr};
+  size_t cq_ring_size_{0};
+  unsigned *cq_head_{nullptr};
+  unsigned *cq_tail_{nullptr};
+  unsigned *cq_mask_{nullptr};
+  void *cqes_{nullptr};
+  unsigned cq_entries_{0};
+
+  std::mutex submit_latch_;
+  std::condition_variable submit_cv_;  // signaled when requests complete
+  unsigned in_flight_{0};              // submitted but not yet reaped, never more than cq_entries_
+  std::thread reaper_;
+};
+
+/**
+ * Fallback engine executing requests with pread/pwrite on a small pool of threads.
+ */
+class ThreadPoolIOEngine : public AsyncIOEngine {
+ public:
+  explicit ThreadPoolIOEngine(size_t num_threads = ASYNC_IO_THREADS);
+
+  ~ThreadPoolIOEngine() override;
+
+  void Submit(const IOHandle &handle) override;
+
+ private:
+  void Work();
+
+ private:
+  std::mutex latch_;
+  std::condition_variable cv_;
+  std::deque<IOHandle> queue_;
+  bool stop_{false};
+  std::vector<std::thread> workers_;
+};
+
+#endif  // MINISQL_ASYNC_IO_H
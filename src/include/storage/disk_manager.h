@@ -2,19 +2,27 @@
 #define DISK_MGR_H
 
 #include <atomic>
-#include <fstream>
 #include <iostream>
+#include <memory>
 #include <mutex>
+#include <set>
+#include <shared_mutex>
 #include <string>
+#include <vector>
 
 #include "common/config.h"
 #include "common/macros.h"
 #include "page/bitmap_page.h"
 #include "page/disk_file_meta_page.h"
+#include "storage/async_io.h"
 
 /**
  * DiskManager takes care of the allocation and de allocation of pages within a database. It performs the reading and
  * writing of pages to and from disk, providing a logical file layer within the context of a database management system.
+ * Pages are read and written with pread/pwrite at explicit offsets, so accesses to different pages need no lock, and
+ * writes only become durable when Sync is called.
+ * The meta page and the bitmap pages are kept in memory, allocation never does I/O except for loading a bitmap page
+ * the first time its extent is touched. Changes to them are written back by Sync and Close.
  *
  * Disk page storage format: (Free Page BitMap Size = PAGE_SIZE * 8, we note it as N)
  * | Meta Page | Free Page BitMap 1 | Page 1 | Page 2 | ....
@@ -42,6 +50,17 @@ class DiskManager {
    */
   void WritePage(page_id_t logical_page_id, const char *page_data);
 
+  /**
+   * Start reading a page in the background, page_data must stay valid until the returned handle completes.
+   * Pages beyond the end of the file read as zeros, like ReadPage.
+   */
+  IOHandle ReadPageAsync(page_id_t logical_page_id, char *page_data);
+
+  /**
+   * Start writing a page in the background, page_data must stay valid until the returned handle completes.
+   */
+  IOHandle WritePageAsync(page_id_t logical_page_id, const char *page_data);
+
   /**
    * Get next free page from disk
    * @return logical page id of allocated page
@@ -58,6 +77,11 @@ class DiskManager {
    */
   bool IsPageFree(page_id_t logical_page_id);
 
+  /**
+   * Write back the meta page and the modified bitmap pages, then force all pages written so far to stable storage.
+   */
+  void Sync();
+
   /**
    * Shut down the disk manager and close all the file resources.
    */
@@ -75,7 +99,7 @@ class DiskManager {
   /**
    * Helper function to get disk file size
    */
-  int GetFileSize(const std::string &file_name);
+  static size_t GetFileSize(int fd);
 
   /**
    * Read physical page from disk
@@ -92,14 +116,38 @@ class DiskManager {
    */
   page_id_t MapPageId(page_id_t logical_page_id);
 
+  /**
+   * Get the cached bitmap page of an extent, reading it from disk the first time. Must be called with db_io_latch_
+   * held.
+   */
+  BitmapPage<PAGE_SIZE> *GetBitmapPage(uint32_t extent_id);
+
+  /**
+   * Write the meta page and the modified bitmap pages back. Must be called with db_io_latch_ held.
+   */
+  void WriteBackAllocationPages();
+
  private:
-  // stream to write db file
-  std::fstream db_io_;
+  // file descriptor of the db file
+  int db_io_fd_{-1};
   std::string file_name_;
-  // with multiple buffer pool instances, need to protect file access
+  // file size in bytes, only ever grows while the db file is open
+  std::atomic<size_t> file_size_{0};
+  // protects the meta page and the bitmap pages, reads and writes of data pages need no lock
   std::recursive_mutex db_io_latch_;
-  bool closed{false};
+  std::atomic<bool> closed{false};
+  // held shared while an async request is submitted and exclusively by Close, so that no request is submitted while
+  // Close tears io_engine_ down, taken before db_io_latch_
+  std::shared_mutex close_latch_;
   char meta_data_[PAGE_SIZE];
+  bool meta_dirty_{false};
+  // cached bitmap pages indexed by extent id, loaded on first use, protected by db_io_latch_
+  std::vector<std::unique_ptr<char[]>> bitmaps_;
+  std::vector<bool> bitmap_dirty_;
+  // extents below num_extents_ that still have free pages, allocation takes the first one
+  std::set<uint32_t> free_extents_;
+  // executes ReadPageAsync and WritePageAsync, io_uring when available
+  std::unique_ptr<AsyncIOEngine> io_engine_;
 };
 
 #endif
\ No newline at end of file
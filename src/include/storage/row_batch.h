@@ -0,0 +1,82 @@
+#ifndef MINISQL_ROW_BATCH_H
+#define MINISQL_ROW_BATCH_H
+
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "page/pax_page.h"
+#include "page/table_page.h"
+#include "record/row.h"
+#include "record/row_view.h"
+#include "record/schema.h"
+
+/**
+ * RowBatch holds all live tuples of one table heap page, filled by TableHeap::ScanPage.
+ *
+ * The tuples are not copied: the batch keeps the page pinned and read latched and only records where each tuple lies
+ * in it, so the page must be released with Release before the same thread modifies the table. The batch is released
+ * when it is refilled or destroyed as well.
+ */
+class RowBatch {
+  friend class TableHeap;
+
+ public:
+  RowBatch() = default;
+
+  RowBatch(const RowBatch &other) = delete;
+
+  RowBatch &operator=(const RowBatch &other) = delete;
+
+  ~RowBatch() { Release(); }
+
+  /** @return number of live tuples in the page */
+  inline size_t Size() const { return spans_.size(); }
+
+  inline bool Empty() const { return spans_.empty(); }
+
+  inline const TupleSpan &GetSpan(size_t i) const { return spans_[i]; }
+
+  inline RowId GetRowId(size_t i) const { return spans_[i].rid; }
+
+  /** @return the serialized tuple i, valid until the batch is released. Not available for a PAX page. */
+  inline char *GetTupleData(size_t i) const {
+    ASSERT(!columnar_, "Tuples of a PAX page are not contiguous.");
+    return page_->GetData() + spans_[i].offset;
+  }
+
+  /**
+   * Point view at tuple i, in place in the page whatever its format. Out-of-line values are read through the view
+   * only if asked for.
+   */
+  void GetView(size_t i, const Schema *schema, RowView *view) const;
+
+  /**
+   * Deserialize tuple i into row, which must have no fields. The rid of row is set as well.
+   * @param needed_columns if not null, only these columns are deserialized, see Row::DeserializeFrom. In a PAX page
+   * the other columns' minipages are not read at all, nor are the overflow pages of their out-of-line values
+   */
+  void GetRow(size_t i, Row *row, Schema *schema, const std::vector<bool> *needed_columns = nullptr) const;
+
+  /** @return the page the batch was read from, INVALID_PAGE_ID if the batch holds no page */
+  inline page_id_t GetPageId() const { return page_ == nullptr ? INVALID_PAGE_ID : page_->GetTablePageId(); }
+
+  /** @return the page following the batch's page in the heap, INVALID_PAGE_ID at the end of the heap */
+  inline page_id_t GetNextPageId() const { return next_page_id_; }
+
+  /**
+   * Unlatch and unpin the page. The spans are dropped as well.
+   */
+  void Release();
+
+ private:
+  BufferPoolManager *buffer_pool_manager_{nullptr};
+  TablePage *page_{nullptr};
+  page_id_t next_page_id_{INVALID_PAGE_ID};
+  std::vector<TupleSpan> spans_;
+  // set for a PAX page, whose tuples are read from the minipages of their columns
+  bool columnar_{false};
+  std::vector<const char *> null_bitmaps_;
+  std::vector<const char *> values_;
+};
+
+#endif  // MINISQL_ROW_BATCH_H
@@ -1,10 +1,22 @@
 #ifndef MINISQL_TABLE_HEAP_H
 #define MINISQL_TABLE_HEAP_H
 
+#include <mutex>
+#include <set>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
 #include "buffer/buffer_pool_manager.h"
+#include "buffer/read_ahead.h"
+#include "page/free_space_map_page.h"
 #include "page/header_page.h"
+#include "page/overflow_page.h"
+#include "page/pax_page.h"
 #include "page/table_page.h"
+#include "storage/row_batch.h"
 #include "storage/table_iterator.h"
+#include "storage/zone_map.h"
 #include "transaction/lock_manager.h"
 #include "transaction/log_manager.h"
 
@@ -18,9 +30,14 @@ class TableHeap {
     return new TableHeap(buffer_pool_manager, schema, txn, log_manager, lock_manager);
   }
 
-  static TableHeap *Create(BufferPoolManager *buffer_pool_manager, page_id_t first_page_id, Schema *schema,
-                           LogManager *log_manager, LockManager *lock_manager) {
-    return new TableHeap(buffer_pool_manager, first_page_id, schema, log_manager, lock_manager);
+  /**
+   * Open an existing table heap.
+   * @param fsm_page_id first page of the free space map of the heap, if INVALID_PAGE_ID a new map is built by walking
+   * the page chain, see GetFreeSpaceMapPageId
+   */
+  static TableHeap *Create(BufferPoolManager *buffer_pool_manager, page_id_t first_page_id, page_id_t fsm_page_id,
+                           Schema *schema, LogManager *log_manager, LockManager *lock_manager) {
+    return new TableHeap(buffer_pool_manager, first_page_id, fsm_page_id, schema, log_manager, lock_manager);
   }
 
 //  static TableHeap *Create(BufferPoolManager *buffer_pool_manager, Schema *schema, Transaction *txn,
@@ -38,13 +55,23 @@ class TableHeap {
   ~TableHeap() {}
 
   /**
-   * Insert a tuple into the table. If the tuple is too large (>= page_size), return false.
+   * Insert a tuple into the table. If the tuple is too large (>= page_size), return false. If it is larger than
+   * TOAST_TUPLE_THRESHOLD, its longest char values are first moved to overflow pages, see ToastRow.
    * @param[in/out] row Tuple Row to insert, the rid of the inserted tuple is wrapped in object row
    * @param[in] txn The transaction performing the insert
    * @return true iff the insert is successful
    */
   bool InsertTuple(Row &row, Transaction *txn);
 
+  /**
+   * Append rows at the end of the table. The tail page stays pinned and latched while rows are packed into it, new
+   * pages are allocated and linked several at a time. Free space elsewhere in the heap is not used.
+   * @param[in/out] rows Rows to insert, the rid of each inserted row is wrapped in it
+   * @param[out] rids if not null, receives the rids of the inserted rows in order
+   * @return true iff all rows were inserted, otherwise the rows before the first failure are inserted
+   */
+  bool BulkInsert(std::vector<Row> &rows, Transaction *txn, std::vector<RowId> *rids = nullptr);
+
   /**
    * Mark the tuple as deleted. The actual delete will occur when ApplyDelete is called.
    * @param[in] rid Resource id of the tuple of delete
@@ -54,7 +81,9 @@ class TableHeap {
   bool MarkDelete(const RowId &rid, Transaction *txn);
 
   /**
-   * if the new tuple is too large to fit in the old page, return false (will delete and insert)
+   * Update a tuple, the row keeps its rid. The tuple is rewritten in its page if the page has room for the new image,
+   * otherwise it is moved to another page and its slot forwards to the new one, see TablePage. A row is moved at most
+   * once: a moved row that has to move again leaves its current slot and is forwarded to the next one directly.
    * @param[in] row Tuple of new row
    * @param[in] rid Rid of the old tuple
    * @param[in] txn Transaction performing the update
@@ -84,7 +113,21 @@ class TableHeap {
    */
   bool GetTuple(Row *row, Transaction *txn);
 
-  RowId GetNextRowId(Row *row, Transaction *txn);
+  /**
+   * Find the row following row in the table.
+   * @param read_ahead if not null, told about every page the search moves to so that it can prefetch the chain
+   * @return INVALID_ROWID if row is the last one
+   */
+  RowId GetNextRowId(Row *row, Transaction *txn, ReadAhead *read_ahead = nullptr);
+
+  /**
+   * Read all live tuples of one heap page into batch, releasing what batch held before. The page stays pinned and
+   * read latched until the batch is released. A scan starts at GetFirstPageId and continues with
+   * batch.GetNextPageId() until it is INVALID_PAGE_ID.
+   * @param read_ahead if not null, told about the page so that it can prefetch the rest of the chain
+   * @return false if the page could not be fetched
+   */
+  bool ScanPage(page_id_t page_id, RowBatch &batch, Transaction *txn, ReadAhead *read_ahead = nullptr);
 
   void FreeTableHeap() {
     auto next_page_id = first_page_id_;
@@ -93,9 +136,12 @@ class TableHeap {
       auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(old_page_id));
       assert(page != nullptr);
       next_page_id = page->GetNextPageId();
+      FreeExternalValues(page);
       buffer_pool_manager_->UnpinPage(old_page_id, false);
       buffer_pool_manager_->DeletePage(old_page_id);
     }
+    DeleteFreeSpaceMap();
+    zone_map_.Clear();
   }
 
   /**
@@ -118,41 +164,162 @@ class TableHeap {
    */
   inline page_id_t GetFirstPageId() const { return first_page_id_; }
 
+  /**
+   * @return the id of the first page of the free space map, to be stored next to the first page id
+   */
+  inline page_id_t GetFreeSpaceMapPageId() const { return fsm_page_id_; }
+
+  /**
+   * Copy the ids of all heap pages, in chain order, into page_ids. The ids come from the free space map, which lists
+   * every heap page, so the chain is not walked.
+   */
+  void GetPageIds(std::vector<page_id_t> *page_ids);
+
+  /**
+   * Ask the zone map whether a page can hold a tuple satisfying (column comp_type value), see ZoneMap::MayMatch.
+   * @return false only if no tuple of the page satisfies it, the page then need not be read
+   */
+  bool PageMayMatch(page_id_t page_id, uint32_t column_idx, const std::string &comp_type, const Field &value) {
+    return zone_map_.MayMatch(page_id, column_idx, comp_type, value);
+  }
+
 private:
   /**
    * create table heap and initialize first page
    */
   explicit TableHeap(BufferPoolManager *buffer_pool_manager, Schema *schema, Transaction *txn,
-                     LogManager *log_manager, LockManager *lock_manager) :
-          buffer_pool_manager_(buffer_pool_manager),
-          schema_(schema),
-          log_manager_(log_manager),
-          lock_manager_(lock_manager) {
-      page_id_t new_page_id;
-      buffer_pool_manager_->NewPage(new_page_id);
-      first_page_id_ = new_page_id;
-      auto new_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(new_page_id));
-      new_page->WLatch();
-      new_page->Init(new_page_id,INVALID_PAGE_ID,log_manager,txn);
-      new_page->SetNextPageId(INVALID_PAGE_ID);
-      new_page->WUnlatch();
-      buffer_pool_manager_->UnpinPage(new_page->GetPageId(), true);
-  };
+                     LogManager *log_manager, LockManager *lock_manager);
+
+  explicit TableHeap(BufferPoolManager *buffer_pool_manager, page_id_t first_page_id, page_id_t fsm_page_id,
+                     Schema *schema, LogManager *log_manager, LockManager *lock_manager);
+
+  /**
+   * Insert a row whose long values are already out of line, see InsertTuple.
+   * @param home_rid if not null, row is inserted as the relocated tuple of the row at home_rid
+   */
+  bool InsertToastedTuple(Row &row, Transaction *txn, const RowId *home_rid = nullptr);
+
+  /**
+   * Update the tuple in the slot of rid in place.
+   * @param[out] forward set to the slot holding the tuple if the slot of rid is a forwarding slot
+   * @param[out] old_values receives the out-of-line values of the old image on success
+   * @return false if the slot holds no tuple or the page has no room for the new image
+   */
+  bool UpdateInPage(const Row &row, const RowId &rid, RowId *forward, std::vector<Row::ExternalValue> *old_values,
+                    Transaction *txn);
+
+  /**
+   * Move the row at rid to another page with the values of row, the slot of rid forwards to the new tuple. A tuple the
+   * row was moved to before is deleted.
+   * @param[out] old_values receives the out-of-line values of the old image on success
+   */
+  bool RelocateTuple(const Row &row, const RowId &rid, std::vector<Row::ExternalValue> *old_values, Transaction *txn);
+
+  /**
+   * Move the longest char values of row to overflow pages, longest first, until the tuple is no larger than
+   * TOAST_TUPLE_THRESHOLD or no value of at least TOAST_VALUE_MIN_SIZE bytes is left in it. The row is marked with
+   * Row::SetExternal and keeps its fields. Values already out of line are left alone, so calling it again is harmless.
+   * @return false if the overflow pages could not be allocated, the row then has no out-of-line value
+   */
+  bool ToastRow(Row &row);
+
+  /** Delete the overflow pages of the out-of-line values. */
+  void FreeExternalValues(const std::vector<Row::ExternalValue> &values);
 
-  explicit TableHeap(BufferPoolManager *buffer_pool_manager, page_id_t first_page_id, Schema *schema,
-                     LogManager *log_manager, LockManager *lock_manager)
-      : buffer_pool_manager_(buffer_pool_manager),
-        first_page_id_(first_page_id),
-        schema_(schema),
-        log_manager_(log_manager),
-        lock_manager_(lock_manager) {}
+  /** Delete the overflow pages of the out-of-line values of every live tuple of page. */
+  void FreeExternalValues(TablePage *page);
+
+  /** Append the out-of-line values of a serialized tuple to values. */
+  void GetExternalValues(const char *tuple, std::vector<Row::ExternalValue> *values);
+
+  /**
+   * Read the free space map into memory, or build it from the page chain if the heap has none yet.
+   */
+  void LoadFreeSpaceMap();
+
+  /**
+   * Allocate up to count pages, initialize them and link them behind last_page. The first new page is returned pinned
+   * and write latched, the others are unpinned. Must be called with append_latch_ held.
+   * @return nullptr if no page could be allocated
+   */
+  TablePage *AppendPages(TablePage *last_page, size_t count, Transaction *txn);
+
+  /**
+   * Add a heap page at the end of the free space map. Must be called with fsm_latch_ held.
+   */
+  void AddToFreeSpaceMap(page_id_t page_id, uint32_t free_space);
+
+  /**
+   * Record the free space of a heap page after it changed.
+   */
+  void UpdateFreeSpace(page_id_t page_id, uint32_t free_space);
+
+  /**
+   * @return a page that has at least free_space bytes free according to the free space map, INVALID_PAGE_ID if none
+   */
+  page_id_t FindPageWithFreeSpace(uint32_t free_space);
+
+  /**
+   * Delete the pages of the free space map.
+   */
+  void DeleteFreeSpaceMap();
+
+  /**
+   * Initialize a new heap page in the page format of the table.
+   */
+  void InitPage(TablePage *page, page_id_t page_id, page_id_t prev_id, Transaction *txn);
+
+  /*
+   * Tuple operations on a heap page, dispatched to PaxPage for columnar tables. The page chain fields are shared by
+   * both formats, so the heap reads them through TablePage either way. An inserted tuple widens the zone of its page.
+   */
+  bool PageInsertTuple(TablePage *page, Row &row, Transaction *txn, const RowId *home_rid = nullptr);
+
+  /**
+   * Read the row whose rid is set in row, following the forwarding slot of a moved row. page must be latched.
+   */
+  bool PageGetTuple(TablePage *page, Row *row, Transaction *txn);
+
+  bool PageFirstTupleRid(TablePage *page, RowId *first_rid);
+
+  bool PageNextTupleRid(TablePage *page, const RowId &cur_rid, RowId *next_rid);
+
+  uint32_t PageFreeSpace(TablePage *page);
+
+  /**
+   * @return bytes row takes in a heap page, in the unit of the free space map
+   */
+  uint32_t TupleSpace(const Row &row);
+
+  static PaxPage *AsPaxPage(TablePage *page) { return static_cast<PaxPage *>(page); }
 
  private:
+  /** Location and category of one heap page in the free space map. */
+  struct FreeSpaceMapSlot {
+    page_id_t map_page_id;
+    uint32_t index;
+    uint8_t category;
+  };
+
   BufferPoolManager *buffer_pool_manager_;
   page_id_t first_page_id_;
+  page_id_t fsm_page_id_{INVALID_PAGE_ID};
   Schema *schema_;
   [[maybe_unused]] LogManager *log_manager_;
   [[maybe_unused]] LockManager *lock_manager_;
+  bool columnar_;  // heap pages are PaxPages
+  // min and max of each column on every page, kept in memory only
+  ZoneMap zone_map_;
+
+  // in-memory copy of the free space map, protected by fsm_latch_
+  std::mutex fsm_latch_;
+  std::unordered_map<page_id_t, FreeSpaceMapSlot> fsm_slots_;
+  std::set<std::pair<uint8_t, page_id_t>> free_pages_;  // heap pages ordered by category
+  std::vector<page_id_t> page_directory_;                // heap pages in chain order
+  page_id_t last_page_id_{INVALID_PAGE_ID};              // last page of the chain
+  page_id_t last_fsm_page_id_{INVALID_PAGE_ID};          // last page of the free space map
+  // held while a page is appended to the chain, so that concurrent inserts do not each add one
+  std::mutex append_latch_;
 };
 
 #endif  // MINISQL_TABLE_HEAP_H
@@ -1,17 +1,31 @@
 #ifndef MINISQL_TABLE_ITERATOR_H
 #define MINISQL_TABLE_ITERATOR_H
 
+#include "buffer/read_ahead.h"
 #include "common/rowid.h"
+#include "page/table_page.h"
 #include "record/row.h"
 #include "transaction/transaction.h"
 
 class TableHeap;
 
+/**
+ * TableIterator walks the slots of a table heap page by page.
+ *
+ * The page of the current row stays pinned until the iterator moves past its last slot, so a full scan fetches every
+ * page once. The page is read latched only while the iterator steps through its slots, never between two calls, so the
+ * owner of the iterator may modify the table in the meantime. The current row is deserialized once per step into a
+ * row owned by the iterator, which operator* and operator-> return.
+ */
 class TableIterator {
 public:
   // you may define your own constructor based on your member variables
  explicit TableIterator(){}
 
+  /**
+   * Position the iterator on the first row at or after currentRowID, following the page chain if needed.
+   * INVALID_ROWID gives the end iterator.
+   */
   explicit TableIterator(TableHeap* tableHeap,RowId currentRowID);
 
   explicit TableIterator(const TableIterator &other);
@@ -32,10 +46,23 @@ public:
 
   TableIterator &operator++(int);
 
+private:
+  /**
+   * Move to the first live slot at or after slot in page page_id, or in the pages after it, and read its row.
+   * page_ must be either nullptr or the pinned page page_id.
+   */
+  void SeekFrom(page_id_t page_id, uint32_t slot);
+
+  /** Unpin the current page, if any. */
+  void ReleasePage();
+
 private:
   // add your own private member variables here
- TableHeap* tableHeap_; // 指向TableHeap对象的指针
- RowId currentRowID_;   // 当前行的RowID
+ TableHeap* tableHeap_{nullptr}; // 指向TableHeap对象的指针
+ RowId currentRowID_{INVALID_ROWID};   // 当前行的RowID
+ TablePage* page_{nullptr};  // 当前行所在的页，迭代器持有它的pin
+ Row row_;              // 当前行，每次移动时重新反序列化
+ ReadAhead readAhead_;  // 顺序扫描时预读后续的页
 };
 
 #endif  // MINISQL_TABLE_ITERATOR_H
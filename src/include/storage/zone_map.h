@@ -0,0 +1,77 @@
+#ifndef MINISQL_ZONE_MAP_H
+#define MINISQL_ZONE_MAP_H
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "common/config.h"
+#include "record/row.h"
+#include "record/schema.h"
+#include "storage/row_batch.h"
+
+/**
+ * ZoneMap keeps, for every page of a table heap, the smallest and the largest value of each column and whether the
+ * column holds a null, so that a scan can skip the pages whose values cannot satisfy a comparison.
+ *
+ * The map lives in memory only. Pages created by this process are summarized from the start and widened by every
+ * insert and update, a page of a table opened from disk is unknown until it is summarized by the first scan that
+ * reads it. Deletes never narrow a zone: a zone may be wider than the values left in the page, but never narrower, and
+ * an unknown page always matches.
+ */
+class ZoneMap {
+ public:
+  explicit ZoneMap(const Schema *schema) : schema_(schema) {}
+
+  /** Start an empty zone for a new page. */
+  void AddPage(page_id_t page_id);
+
+  /** @return true if the page has a zone */
+  bool Contains(page_id_t page_id);
+
+  /**
+   * Widen the zone of a page to include row. Nothing is done if the page has no zone. Must be called with the page
+   * write latched, so that a concurrent scan summarizing the page sees either both the tuple and the new zone or none.
+   */
+  void Add(page_id_t page_id, const Row &row);
+
+  /**
+   * Set the zone of a page that has none from its live tuples, which batch holds. Must be called with the page latched.
+   */
+  void Build(page_id_t page_id, const RowBatch &batch);
+
+  /**
+   * @param comp_type comparison as ComparisonExpression spells it, "is" and "not" test for null and ignore value
+   * @return false if no tuple of the page can satisfy (column comp_type value), true if some may or the page is unknown
+   */
+  bool MayMatch(page_id_t page_id, uint32_t column_idx, const std::string &comp_type, const Field &value);
+
+  void Clear();
+
+ private:
+  /**
+   * Range of the non-null values of one column, min and max are null if the column has none. Values stored out of
+   * line are not read to summarize them, the range of a column holding one is unbounded.
+   */
+  struct ColumnZone {
+    std::unique_ptr<Field> min;
+    std::unique_ptr<Field> max;
+    bool has_null{false};
+    bool unbounded{false};
+  };
+
+  using Zone = std::vector<ColumnZone>;
+
+  void Widen(ColumnZone &zone, const Field &field);
+
+  /** @return a copy of field that owns its data */
+  static Field *CopyField(const Field &field);
+
+  const Schema *schema_;
+  std::mutex latch_;
+  std::unordered_map<page_id_t, Zone> zones_;
+};
+
+#endif  // MINISQL_ZONE_MAP_H
@@ -1,4 +1,6 @@
 #include "index/b_plus_tree.h"
+#include <algorithm>
+#include <type_traits>
 #include <string>
 
 #include "glog/logging.h"
@@ -9,16 +11,21 @@
  * TODO: Student Implement
  */
 BPlusTree::BPlusTree(index_id_t index_id, BufferPoolManager *buffer_pool_manager, const KeyManager &KM,
-                     int leaf_max_size, int internal_max_size)
+                     int leaf_max_size, int internal_max_size, bool unique)
     : index_id_(index_id),
       buffer_pool_manager_(buffer_pool_manager),
       processor_(KM),
       leaf_max_size_(leaf_max_size),
-      internal_max_size_(internal_max_size) {
+      internal_max_size_(internal_max_size),
+      unique_(unique) {
   Page* page = buffer_pool_manager_->FetchPage(INDEX_ROOTS_PAGE_ID);
   auto index_root_page = reinterpret_cast<IndexRootsPage*>(page);
-  index_root_page->GetRootId(index_id,&root_page_id_);
-  buffer_pool_manager_->UnpinPage(INDEX_ROOTS_PAGE_ID, true);
+  page_id_t root_page_id = INVALID_PAGE_ID;
+  page->RLatch();
+  index_root_page->GetRootId(index_id, &root_page_id);
+  page->RUnlatch();
+  root_page_id_ = root_page_id;
+  buffer_pool_manager_->UnpinPage(INDEX_ROOTS_PAGE_ID, false);
     if(leaf_max_size == UNDEFINED_SIZE)
       leaf_max_size_ = (PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / (processor_.GetKeySize() + sizeof(RowId));
     if(internal_max_size == UNDEFINED_SIZE)
@@ -26,10 +33,44 @@ BPlusTree::BPlusTree(index_id_t index_id, BufferPoolManager *buffer_pool_manager
 }
 
 void BPlusTree::Destroy(page_id_t current_page_id) {
+  if (current_page_id == INVALID_PAGE_ID) {
+    // 从根开始删除整棵树，树变为空
+    if (!IsEmpty()) {
+      Destroy(root_page_id_);
+      root_page_id_ = INVALID_PAGE_ID;
+      UpdateRootPageId(0);
+    }
+    DeletePages({});
+    return;
+  }
+  auto *node = reinterpret_cast<BPlusTreePage *>(buffer_pool_manager_->FetchPage(current_page_id)->GetData());
+  if (node->IsLeafPage()) {
+    auto *leaf = reinterpret_cast<LeafPage *>(node);
+    for (int i = 0; i < leaf->GetSize(); i++) {
+      if (PostingListPage::IsReference(leaf->ValueAt(i))) {
+        PostingListPage::Free(buffer_pool_manager_, PostingListPage::GetFirstPageId(leaf->ValueAt(i)));
+      }
+    }
+  } else {
+    auto *internal = reinterpret_cast<InternalPage *>(node);
+    for (int i = 0; i < internal->GetSize(); i++) {
+      Destroy(internal->ValueAt(i));
+    }
+  }
   // 删除页
+  buffer_pool_manager_->UnpinPage(current_page_id, false);
   buffer_pool_manager_->DeletePage(current_page_id);
 }
 
+void BPlusTree::DeletePages(const std::vector<page_id_t> &page_ids) {
+  std::lock_guard<std::mutex> guard(deleted_latch_);
+  deleted_pages_.insert(deleted_pages_.end(), page_ids.begin(), page_ids.end());
+  // 还被pin住的页留下，下次再删
+  deleted_pages_.erase(std::remove_if(deleted_pages_.begin(), deleted_pages_.end(),
+                                      [&](page_id_t page_id) { return buffer_pool_manager_->DeletePage(page_id); }),
+                       deleted_pages_.end());
+}
+
 /*
  * Helper function to decide whether current b+tree is empty
  */
@@ -39,23 +80,35 @@ bool BPlusTree::IsEmpty() const { return root_page_id_ == INVALID_PAGE_ID; }
  * SEARCH
  *****************************************************************************/
 /*
- * Return the only value that associated with input key
+ * Return the values associated with input key, the only one in a unique tree
  * This method is used for point query
  * @return : true means key exists
  */
 bool BPlusTree::GetValue(const GenericKey *key, std::vector<RowId> &result, Transaction *transaction) {
-  // 强制类型转换为leafPage处理
-  if(root_page_id_==INVALID_PAGE_ID)return false;
-  auto *leaf = reinterpret_cast<::LeafPage *>(FindLeafPage(key)->GetData());
   RowId ri;
-  if (leaf->Lookup(key, ri, processor_)) {  // 找到
-    buffer_pool_manager_->UnpinPage(leaf->GetPageId(), false);
+  bool found = false;
+  Page *page = ReadLeafPage(key, false, [&](::LeafPage *leaf) { found = leaf->Lookup(key, ri, processor_); });
+  if (page == nullptr) return false;
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+  if (!found || !PostingListPage::IsReference(ri)) {
+    if (found) {
+      result.push_back(ri);
+    }
+    return found;
+  }
+  // posting list只在叶节点加锁时读，重新加读锁下降
+  page = FindLeafPage(key);
+  if (page == nullptr) return false;
+  auto *leaf = reinterpret_cast<::LeafPage *>(page->GetData());
+  found = leaf->Lookup(key, ri, processor_);
+  if (found && PostingListPage::IsReference(ri)) {
+    found = PostingListPage::Read(buffer_pool_manager_, PostingListPage::GetFirstPageId(ri), &result);
+  } else if (found) {
     result.push_back(ri);
-    return true;
-  } else {  // 没找到
-    buffer_pool_manager_->UnpinPage(leaf->GetPageId(), false);
-    return false;
   }
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+  return found;
 }
 
 /*****************************************************************************
@@ -65,14 +118,35 @@ bool BPlusTree::GetValue(const GenericKey *key, std::vector<RowId> &result, Tran
  * Insert constant key & value pair into b+ tree
  * if current tree is empty, start new tree, update root page id and insert
  * entry, otherwise insert into leaf page.
- * @return: since we only support unique key, if user try to insert duplicate
- * keys return false, otherwise return true.
+ * @return: if user try to insert a duplicate key into a unique tree, or a
+ * duplicate pair into a non-unique tree, return false, otherwise return true.
  */
 bool BPlusTree::Insert(GenericKey *key, const RowId &value, Transaction *transaction) {
-  if (IsEmpty()) {
-    StartNewTree(key, value);
-    return true;
+  // 乐观插入：只写锁叶节点，叶节点不分裂时祖先不会改变
+  bool is_root;
+  Page *page = FindLeafPageOptimistic(key, &is_root);
+  if (page != nullptr) {
+    auto *leaf = reinterpret_cast<::LeafPage *>(page->GetData());
+    RowId ri;
+    bool duplicate = leaf->Lookup(key, ri, processor_);
+    if (duplicate && !unique_) {
+      // 已有的键只在posting list中加一行，叶节点大小不变
+      bool inserted = InsertIntoPostingList(leaf, key, value);
+      page->WUnlatch();
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), inserted);
+      return inserted;
+    }
+    bool safe = !duplicate && IsSafe(leaf, Operation::INSERT, is_root);
+    if (safe) {
+      leaf->Insert(key, value, processor_);
+    }
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), safe);
+    if (duplicate || safe) {
+      return !duplicate;
+    }
   }
+  // 叶节点会分裂或树为空，重新加写锁下降
   return InsertIntoLeaf(key, value, transaction);
 }
 /*
@@ -80,6 +154,7 @@ bool BPlusTree::Insert(GenericKey *key, const RowId &value, Transaction *transac
  * User needs to first ask for new page from buffer pool manager(NOTICE: throw
  * an "out of memory" exception if returned value is nullptr), then update b+
  * tree's root page id and insert entry directly into leaf page.
+ * Must be called with root_latch_ write latched.
  */
 void BPlusTree::StartNewTree(GenericKey *key, const RowId &value) {
   // 创建新页
@@ -100,30 +175,60 @@ void BPlusTree::StartNewTree(GenericKey *key, const RowId &value) {
  * Insert constant key & value pair into leaf page
  * User needs to first find the right leaf page as insertion target, then look
  * through leaf page to see whether insert key exist or not. If exists, return
- * immediately, otherwise insert entry. Remember to deal with split if necessary.
- * @return: since we only support unique key, if user try to insert duplicate
- * keys return false, otherwise return true.
+ * immediately (a non-unique tree adds the value to the key's posting list),
+ * otherwise insert entry. Remember to deal with split if necessary.
+ * This is the pessimistic pass, every page that may split stays write latched.
+ * @return: if user try to insert a duplicate key into a unique tree, or a
+ * duplicate pair into a non-unique tree, return false, otherwise return true.
  */
 bool BPlusTree::InsertIntoLeaf(GenericKey *key, const RowId &value, Transaction *transaction) {
-  // 强制类型转换找到leaf去操作
-  Page *page = FindLeafPage(key);
+  WriteSet write_set;
+  Page *page = FindLeafPagePessimistic(key, Operation::INSERT, &write_set);
+  if (page == nullptr) {
+    StartNewTree(key, value);
+    ReleaseWriteSet(&write_set, false);
+    return true;
+  }
   auto *leaf = reinterpret_cast<::LeafPage *>(page->GetData());
   RowId ri;
 
-  // 判断是否在leaf中，是则无法插入
+  // 判断是否在leaf中，是则唯一索引无法插入
   if (leaf->Lookup(key, ri, processor_)) {
-    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    bool inserted = !unique_ && InsertIntoPostingList(leaf, key, value);
+    ReleaseWriteSet(&write_set, inserted);
+    return inserted;
+  }
+  int size = leaf->Insert(key, value, processor_);
+  if (size == leaf->GetMaxSize()) {  // 插入后需要分裂节点
+    auto *recipient = Split(leaf, transaction);
+    leaf->SetNextPageId(recipient->GetPageId());
+    InsertIntoParent(leaf, recipient->KeyAt(0), recipient, transaction);
+    buffer_pool_manager_->UnpinPage(recipient->GetPageId(), true);
+  }
+  ReleaseWriteSet(&write_set, true);
+  return true;
+}
+
+bool BPlusTree::InsertIntoPostingList(LeafPage *leaf, const GenericKey *key, const RowId &value) {
+  int index = leaf->KeyIndex(key, processor_);
+  RowId old_value = leaf->ValueAt(index);
+  if (PostingListPage::IsReference(old_value)) {
+    return PostingListPage::Insert(buffer_pool_manager_, PostingListPage::GetFirstPageId(old_value), value);
+  }
+  if (old_value == value) {
+    return false;
+  }
+  // 键的第二行：两行一起移到新的posting list
+  std::vector<RowId> rids{old_value, value};
+  if (value.Get() < old_value.Get()) {
+    std::swap(rids[0], rids[1]);
+  }
+  page_id_t first_page_id = PostingListPage::Create(buffer_pool_manager_, rids);
+  if (first_page_id == INVALID_PAGE_ID) {
     return false;
-  } else {  // 插入
-    int size = leaf->Insert(key, value, processor_);
-    if (size == leaf_max_size_) {  // 插入后需要分裂节点
-      auto *recipient = Split(leaf, transaction);
-      leaf->SetNextPageId(recipient->GetPageId());
-      InsertIntoParent(leaf, recipient->KeyAt(0), recipient, transaction);
-    }
-    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
-    return true;
   }
+  leaf->SetValueAt(index, PostingListPage::MakeReference(first_page_id));
+  return true;
 }
 
 /*
@@ -132,6 +237,8 @@ bool BPlusTree::InsertIntoLeaf(GenericKey *key, const RowId &value, Transaction
  * User needs to first ask for new page from buffer pool manager(NOTICE: throw
  * an "out of memory" exception if returned value is nullptr), then move half
  * of key & value pairs from input page to newly created page
+ * The new page is returned pinned, the caller unpins it. It is not latched: no other thread can reach it before the
+ * caller releases the latches of node and its parent.
  */
 BPlusTreeInternalPage *BPlusTree::Split(InternalPage *node, Transaction *transaction) {
   // 开辟新页
@@ -143,7 +250,6 @@ BPlusTreeInternalPage *BPlusTree::Split(InternalPage *node, Transaction *transac
   auto *recipient = reinterpret_cast<::InternalPage *>(newPage->GetData());
   recipient->Init(pageId, node->GetParentPageId(), node->GetKeySize(), internal_max_size_);
   node->MoveHalfTo(recipient, buffer_pool_manager_);
-  buffer_pool_manager_->UnpinPage(pageId, true);
   return recipient;
 }
 
@@ -158,7 +264,6 @@ BPlusTreeLeafPage *BPlusTree::Split(LeafPage *node, Transaction *transaction) {
   recipient->Init(pageId, node->GetParentPageId(), node->GetKeySize(), leaf_max_size_);
   node->MoveHalfTo(recipient);
   recipient->SetNextPageId(node->GetNextPageId());
-  buffer_pool_manager_->UnpinPage(pageId, true);
   return recipient;
 }
 
@@ -170,6 +275,7 @@ BPlusTreeLeafPage *BPlusTree::Split(LeafPage *node, Transaction *transaction) {
  * User needs to first find the parent page of old_node, parent node must be
  * adjusted to take info of new_node into account. Remember to deal with split
  * recursively if necessary.
+ * The parent of a page that splits is write latched by the caller, or old_node is the root and root_latch_ is held.
  */
 void BPlusTree::InsertIntoParent(BPlusTreePage *old_node, GenericKey *key, BPlusTreePage *new_node,
                                  Transaction *transaction) {
@@ -177,6 +283,7 @@ void BPlusTree::InsertIntoParent(BPlusTreePage *old_node, GenericKey *key, BPlus
     // 新建页
     page_id_t rootId;
     Page *page = buffer_pool_manager_->NewPage(rootId);
+    if (page == nullptr) throw("out of memory in IIP");
     auto *root = reinterpret_cast<BPlusTree::InternalPage *>(page->GetData());
 
     // 初始化新根
@@ -195,17 +302,238 @@ void BPlusTree::InsertIntoParent(BPlusTreePage *old_node, GenericKey *key, BPlus
     // 操作被分裂节点的父节点，插入新分裂节点的pageId
     int size = parent->InsertNodeAfter(old_node->GetPageId(), key, new_node->GetPageId());
     // 判断是否需要继续向上迭代
-    if (size == internal_max_size_) {
+    if (size == parent->GetMaxSize()) {
       // 分裂出父亲的兄弟
       auto *rParent = Split(parent, transaction);
       // 迭代向上
       InsertIntoParent(parent, rParent->KeyAt(0), rParent, transaction);
+      buffer_pool_manager_->UnpinPage(rParent->GetPageId(), true);
     }
     buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
     return;
   }
 }
 
+/*****************************************************************************
+ * BULK LOAD
+ *****************************************************************************/
+/*
+ * Build the tree from sorted pairs. The leaves are written left to right and each inner level fills up above them as
+ * its children are finished, only the last two nodes of each level are pinned. The number of nodes is not known in
+ * advance, the pairs of a key of a non-unique tree become one entry, so the last node of a level is evened out with
+ * the one before it at the end.
+ * The pages are not reachable before the root is published, so they are not latched.
+ */
+bool BPlusTree::BulkLoad(KeySorter *sorter, double fill_factor) {
+  ASSERT(fill_factor > 0 && fill_factor <= 1, "Invalid fill factor.");
+  root_latch_.WLock();
+  ASSERT(IsEmpty(), "Bulk load into a non-empty tree.");
+  BulkBuild build;
+  build.fill_factor = fill_factor;
+  build.levels.resize(1);
+  // 相同键的行合并为一项，多于一行时存入posting list
+  std::vector<char> group_key(processor_.GetKeySize());
+  std::vector<RowId> group;
+  auto add_group = [&]() {
+    RowId value = group[0];
+    if (group.size() > 1) {
+      page_id_t first_page_id = PostingListPage::Create(buffer_pool_manager_, group);
+      if (first_page_id == INVALID_PAGE_ID) {
+        return false;
+      }
+      build.postings.push_back(first_page_id);
+      value = PostingListPage::MakeReference(first_page_id);
+    }
+    return BulkAppendLeaf(&build, reinterpret_cast<GenericKey *>(group_key.data()), value);
+  };
+  uint64_t loaded = 0;
+  bool ok = true;
+  GenericKey *key;
+  RowId value;
+  while (ok && sorter->Next(&key, &value)) {
+    loaded++;
+    if (!group.empty() && processor_.CompareKeys(key, reinterpret_cast<GenericKey *>(group_key.data())) == 0) {
+      ok = !unique_;
+      group.push_back(value);
+      continue;
+    }
+    ok = group.empty() || add_group();
+    memcpy(group_key.data(), key, group_key.size());
+    group.assign(1, value);
+  }
+  ok = ok && loaded == sorter->Size() && (group.empty() || add_group());
+  page_id_t root_page_id = INVALID_PAGE_ID;
+  if (ok && loaded > 0) {
+    root_page_id = BulkFinish(&build);
+    ok = root_page_id != INVALID_PAGE_ID;
+  }
+  if (!ok) {
+    BulkAbort(&build);
+    root_latch_.WUnlock();
+    return false;
+  }
+  if (root_page_id != INVALID_PAGE_ID) {
+    root_page_id_ = root_page_id;
+    UpdateRootPageId(1);
+  }
+  root_latch_.WUnlock();
+  return true;
+}
+
+int BPlusTree::BulkTargetSize(const BulkBuild &build, size_t level) const {
+  int max_size = level == 0 ? leaf_max_size_ : internal_max_size_;
+  // 插入后达到max size就会分裂，容量是max size - 1
+  auto target = static_cast<int>((max_size - 1) * build.fill_factor);
+  return std::min(std::max(target, max_size / 2), max_size - 1);
+}
+
+BPlusTreePage *BPlusTree::BulkNode(BulkBuild *build, size_t level) {
+  BPlusTreePage *node = build->levels[level].node;
+  if (node != nullptr && node->GetSize() < BulkTargetSize(*build, level)) {
+    return node;
+  }
+  // 上一个满节点加入上一层，后面的节点已确定不需要和它平衡
+  BPlusTreePage *full = build->levels[level].full;
+  build->levels[level].full = nullptr;
+  if (full != nullptr && !BulkAddToParent(build, level, full)) {
+    return nullptr;
+  }
+  page_id_t page_id;
+  Page *page = buffer_pool_manager_->NewPage(page_id);
+  if (page == nullptr) {
+    return nullptr;
+  }
+  build->created.push_back(page_id);
+  if (level == 0) {
+    auto *leaf = reinterpret_cast<LeafPage *>(page->GetData());
+    leaf->Init(page_id, INVALID_PAGE_ID, processor_.GetKeySize(), leaf_max_size_);
+    if (node != nullptr) {
+      reinterpret_cast<LeafPage *>(node)->SetNextPageId(page_id);
+    }
+  } else {
+    auto *internal = reinterpret_cast<InternalPage *>(page->GetData());
+    internal->Init(page_id, INVALID_PAGE_ID, processor_.GetKeySize(), internal_max_size_);
+  }
+  build->levels[level].full = node;
+  build->levels[level].node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+  return build->levels[level].node;
+}
+
+bool BPlusTree::BulkAppendLeaf(BulkBuild *build, GenericKey *key, const RowId &value) {
+  auto *leaf = reinterpret_cast<LeafPage *>(BulkNode(build, 0));
+  if (leaf == nullptr) {
+    return false;
+  }
+  leaf->SetKeyAt(leaf->GetSize(), key);
+  leaf->SetValueAt(leaf->GetSize(), value);
+  leaf->IncreaseSize(1);
+  return true;
+}
+
+bool BPlusTree::BulkAddToParent(BulkBuild *build, size_t level, BPlusTreePage *child) {
+  if (level + 1 == build->levels.size()) {
+    build->levels.emplace_back();
+  }
+  auto *parent = reinterpret_cast<InternalPage *>(BulkNode(build, level + 1));
+  if (parent != nullptr) {
+    // the key of the first child is never looked at, it is kept as the smallest key of the subtree
+    GenericKey *key = child->IsLeafPage() ? reinterpret_cast<LeafPage *>(child)->KeyAt(0)
+                                          : reinterpret_cast<InternalPage *>(child)->KeyAt(0);
+    parent->SetKeyAt(parent->GetSize(), key);
+    parent->SetValueAt(parent->GetSize(), child->GetPageId());
+    parent->IncreaseSize(1);
+    child->SetParentPageId(parent->GetPageId());
+  }
+  buffer_pool_manager_->UnpinPage(child->GetPageId(), true);
+  return parent != nullptr;
+}
+
+template <typename N>
+bool BPlusTree::BulkEvenOut(BulkBuild *build, N *left, N *right) {
+  int left_size = left->GetSize();
+  int right_size = right->GetSize();
+  int total = left_size + right_size;
+  if (total < left->GetMaxSize()) {
+    left->PairCopy(left->PairPtrAt(left_size), right->PairPtrAt(0), right_size);
+    left->SetSize(total);
+    BulkAdopt(left, left_size, total);
+    if constexpr (std::is_same_v<N, LeafPage>) {
+      left->SetNextPageId(right->GetNextPageId());
+    }
+    page_id_t page_id = right->GetPageId();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    buffer_pool_manager_->DeletePage(page_id);
+    build->created.erase(std::find(build->created.begin(), build->created.end(), page_id));
+    return true;
+  }
+  // 两个节点都不少于min size
+  int moved = total / 2 - right_size;
+  if (moved > 0) {
+    right->PairCopy(right->PairPtrAt(moved), right->PairPtrAt(0), right_size);
+    right->PairCopy(right->PairPtrAt(0), left->PairPtrAt(left_size - moved), moved);
+    left->SetSize(left_size - moved);
+    right->SetSize(right_size + moved);
+    BulkAdopt(right, 0, moved);
+  }
+  return false;
+}
+
+void BPlusTree::BulkAdopt(InternalPage *node, int begin, int end) {
+  for (int i = begin; i < end; i++) {
+    Page *page = buffer_pool_manager_->FetchPage(node->ValueAt(i));
+    reinterpret_cast<BPlusTreePage *>(page->GetData())->SetParentPageId(node->GetPageId());
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
+  }
+}
+
+page_id_t BPlusTree::BulkFinish(BulkBuild *build) {
+  for (size_t level = 0;; level++) {
+    BulkLevel last = build->levels[level];
+    build->levels[level] = BulkLevel();
+    if (last.full == nullptr) {
+      // 这一层只有一个节点，即根
+      page_id_t root_page_id = last.node->GetPageId();
+      buffer_pool_manager_->UnpinPage(root_page_id, true);
+      return root_page_id;
+    }
+    bool merged = last.node->IsLeafPage()
+                      ? BulkEvenOut(build, reinterpret_cast<LeafPage *>(last.full),
+                                    reinterpret_cast<LeafPage *>(last.node))
+                      : BulkEvenOut(build, reinterpret_cast<InternalPage *>(last.full),
+                                    reinterpret_cast<InternalPage *>(last.node));
+    if (merged && level + 1 == build->levels.size()) {
+      page_id_t root_page_id = last.full->GetPageId();
+      buffer_pool_manager_->UnpinPage(root_page_id, true);
+      return root_page_id;
+    }
+    if (!BulkAddToParent(build, level, last.full)) {
+      if (!merged) {
+        buffer_pool_manager_->UnpinPage(last.node->GetPageId(), true);
+      }
+      return INVALID_PAGE_ID;
+    }
+    if (!merged && !BulkAddToParent(build, level, last.node)) {
+      return INVALID_PAGE_ID;
+    }
+  }
+}
+
+void BPlusTree::BulkAbort(BulkBuild *build) {
+  for (auto &level : build->levels) {
+    for (BPlusTreePage *node : {level.full, level.node}) {
+      if (node != nullptr) {
+        buffer_pool_manager_->UnpinPage(node->GetPageId(), false);
+      }
+    }
+  }
+  for (page_id_t page_id : build->created) {
+    buffer_pool_manager_->DeletePage(page_id);
+  }
+  for (page_id_t page_id : build->postings) {
+    PostingListPage::Free(buffer_pool_manager_, page_id);
+  }
+}
+
 /*****************************************************************************
  * REMOVE
  *****************************************************************************/
@@ -216,129 +544,129 @@ void BPlusTree::InsertIntoParent(BPlusTreePage *old_node, GenericKey *key, BPlus
  * delete entry from leaf page. Remember to deal with redistribute or merge if
  * necessary.
  */
-void BPlusTree::Remove(const GenericKey *key, Transaction *transaction) {
-  // 判断空
-  if (IsEmpty()) return;
+void BPlusTree::Remove(const GenericKey *key, Transaction *transaction) { RemoveEntry(key, nullptr); }
 
-  // 找到叶节点
-  Page *page = FindLeafPage(key);
+void BPlusTree::Remove(const GenericKey *key, const RowId &value, Transaction *transaction) {
+  RemoveEntry(key, &value);
+}
+
+void BPlusTree::RemoveEntry(const GenericKey *key, const RowId *value) {
+  // 乐观删除：只写锁叶节点，叶节点不下溢时祖先不会改变
+  bool is_root;
+  Page *page = FindLeafPageOptimistic(key, &is_root);
+  if (page == nullptr) return;
   auto *leaf = reinterpret_cast<::LeafPage *>(page->GetData());
+  RowId ri;
+  bool found = leaf->Lookup(key, ri, processor_);
+  // 只从posting list中删一行时叶节点大小不变
+  bool in_list = found && value != nullptr && PostingListPage::IsReference(ri);
+  bool matches = found && (value == nullptr || in_list || ri == *value);
+  bool safe = matches && !in_list && IsSafe(leaf, Operation::REMOVE, is_root);
+  bool dirty = safe;
+  if (in_list) {
+    dirty = RemoveFromPostingList(leaf, key, ri, *value);
+  } else if (safe) {
+    leaf->RemoveAndDeleteRecord(key, processor_);
+  }
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), dirty);
+  if (safe && PostingListPage::IsReference(ri)) {
+    PostingListPage::Free(buffer_pool_manager_, PostingListPage::GetFirstPageId(ri));
+  }
+  if (!matches || in_list || safe) return;
 
-  // 删除键值对
-  bool judge = leaf->KeyIndex(key, processor_) == 0;
-  int size = leaf->RemoveAndDeleteRecord(key, processor_);
-  bool deleted = false;
-  if (size < leaf->GetMinSize())
-    deleted = CoalesceOrRedistribute<BPlusTree::LeafPage>(leaf, transaction);
-  else if (judge) {  // 直接删除后调整键值对
-    GenericKey *updateKey = leaf->KeyAt(0);
-    Page *currPage = buffer_pool_manager_->FetchPage(leaf->GetParentPageId());
-    auto curr = reinterpret_cast<::InternalPage *>(currPage);
-    page_id_t value = leaf->GetPageId();
-    if(currPage!= nullptr){//当前删除叶节点不是根节点
-      while ((!curr->IsRootPage()) && curr->ValueIndex(value) == 0) {  // 对应key0一直上滤到根节点
-        buffer_pool_manager_->UnpinPage(curr->GetPageId(), false);
-        value = curr->GetPageId();
-        currPage = buffer_pool_manager_->FetchPage(curr->GetParentPageId());
-        curr = reinterpret_cast<::InternalPage *>(currPage);
-      }
-      if (curr->ValueIndex(value) != 0 && processor_.CompareKeys(updateKey, curr->KeyAt(curr->ValueIndex(value))) != 0) {
-        curr->SetKeyAt(curr->ValueIndex(value), updateKey);
-        buffer_pool_manager_->UnpinPage(curr->GetPageId(), true);
-      }
-    }
+  // 叶节点会下溢，重新加写锁下降
+  WriteSet write_set;
+  page = FindLeafPagePessimistic(key, Operation::REMOVE, &write_set);
+  if (page == nullptr) {
+    ReleaseWriteSet(&write_set, false);
+    return;
+  }
+  leaf = reinterpret_cast<::LeafPage *>(page->GetData());
+  // 两次下降之间其他线程可能已改变了这个键
+  found = leaf->Lookup(key, ri, processor_);
+  if (found && value != nullptr && PostingListPage::IsReference(ri)) {
+    ReleaseWriteSet(&write_set, RemoveFromPostingList(leaf, key, ri, *value));
+    return;
+  }
+  if (!found || (value != nullptr && !(ri == *value))) {
+    ReleaseWriteSet(&write_set, false);
+    return;
+  }
+  leaf->RemoveAndDeleteRecord(key, processor_);
+  if (leaf->IsRootPage() || leaf->GetSize() < leaf->GetMinSize()) {
+    CoalesceOrRedistribute<BPlusTree::LeafPage>(leaf, &write_set);
   }
   // unpin后才有可能删除
-  buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
-  if (deleted) buffer_pool_manager_->DeletePage(page->GetPageId());
+  ReleaseWriteSet(&write_set, true);
+  DeletePages(write_set.deleted);
+  if (PostingListPage::IsReference(ri)) {
+    PostingListPage::Free(buffer_pool_manager_, PostingListPage::GetFirstPageId(ri));
+  }
 }
 
-/* todo
+bool BPlusTree::RemoveFromPostingList(LeafPage *leaf, const GenericKey *key, const RowId &reference,
+                                      const RowId &value) {
+  page_id_t first_page_id = PostingListPage::GetFirstPageId(reference);
+  RowId only_left;
+  if (!PostingListPage::Remove(buffer_pool_manager_, first_page_id, value, &only_left)) {
+    return false;
+  }
+  // 只剩一行时放回叶节点
+  if (!(only_left == INVALID_ROWID)) {
+    leaf->SetValueAt(leaf->KeyIndex(key, processor_), only_left);
+    PostingListPage::Free(buffer_pool_manager_, first_page_id);
+  }
+  return true;
+}
+
+/*
  * User needs to first find the sibling of input page. If sibling's size + input
  * page's size > page's max size, then redistribute. Otherwise, merge.
  * Using template N to represent either internal page or leaf page.
+ * The parent of node is write latched by the caller, the sibling is latched here. A page emptied by a merge is added
+ * to write_set->deleted.
  * @return: true means target leaf page should be deleted,
- * false means no deletion happens       ???猜测只是没有删这个leaf page的意思
+ * false means no deletion happens
  */
 template <typename N>
-bool BPlusTree::CoalesceOrRedistribute(N *&node, Transaction *transaction) {
+bool BPlusTree::CoalesceOrRedistribute(N *&node, WriteSet *write_set) {
   // 直接调整根
   if (node->IsRootPage()) {
-    return AdjustRoot(node);
-  }
-
-  // 从node的父亲处获得node的index
-  int pre_index, next_index, node_index;
-  page_id_t parent_id, pre_id, node_id, next_id;
-  parent_id = node->GetParentPageId();
-  node_id = node->GetPageId();
-  Page *temp;
-  BPlusTree::InternalPage *parent;
-  N *pre;
-  N *next;
-  parent = reinterpret_cast<BPlusTree::InternalPage *>(buffer_pool_manager_->FetchPage(parent_id)->GetData());
-  node_index = parent->ValueIndex(node->GetPageId());
-
-  // redistribute
-  //  判断能否和pre节点redistribute
-  if (node_index > 0) {  // 即不是第一个节点
-    pre_index = node_index - 1;
-    pre_id = parent->ValueAt(pre_index);
-    pre = reinterpret_cast<N *>(buffer_pool_manager_->FetchPage(pre_id)->GetData());
-    // 从pre移动一个键值重建node
-    if (pre->GetSize() > pre->GetMinSize()) {  // 至少可以移动一个键值对
-      Redistribute(pre, node, 1);
-      auto child = reinterpret_cast<BPlusTreePage *>(node);
-      if (!child->IsLeafPage()) {
-        auto child_internal = reinterpret_cast<::InternalPage *>(child);
-        page_id_t answer_id = child_internal->LeftMostKeyFromCurr(buffer_pool_manager_);
-        Page* leaf_page = buffer_pool_manager_->FetchPage(answer_id);
-        auto leaf = reinterpret_cast<::LeafPage*>(leaf_page);
-        parent->SetKeyAt(node_index,leaf->KeyAt(0));
-        buffer_pool_manager_->UnpinPage(leaf->GetPageId(),false);
-      }
-      buffer_pool_manager_->UnpinPage(parent_id, true);
-      buffer_pool_manager_->UnpinPage(pre_id, true);
-      return false;
-    }
-  }
-  // 判断能否和next节点redistribute
-  if (node_index < parent->GetSize() - 1) {  // 情况包含第一个节点，以及无法和pre节点redistribute
-    next_index = node_index + 1;
-    next_id = parent->ValueAt(next_index);
-    next = reinterpret_cast<N *>(buffer_pool_manager_->FetchPage(next_id)->GetData());
-    // 从next移动一个键值重建node
-    if (next->GetSize() > next->GetMinSize()) {  // 至少可以移动一个键值对
-      Redistribute(next, node, 0);
-      auto child = reinterpret_cast<BPlusTreePage *>(next);
-      if (!child->IsLeafPage()) {
-        auto child_internal = reinterpret_cast<::InternalPage *>(child);
-        page_id_t answer_id = child_internal->LeftMostKeyFromCurr(buffer_pool_manager_);
-        Page* leaf_page = buffer_pool_manager_->FetchPage(answer_id);
-        auto leaf = reinterpret_cast<::LeafPage*>(leaf_page);
-        parent->SetKeyAt(next_index,leaf->KeyAt(0));
-        buffer_pool_manager_->UnpinPage(leaf->GetPageId(), false);
-      }
-      buffer_pool_manager_->UnpinPage(parent_id, true);
-      buffer_pool_manager_->UnpinPage(next_id, true);
-      return false;
+    if (AdjustRoot(node)) {
+      write_set->deleted.push_back(node->GetPageId());
+      return true;
     }
+    return false;
   }
 
-  // coalesce
-  if (node_index > 0) {  // 不是第一个，肯定用不到next_id
-    buffer_pool_manager_->UnpinPage(next_id, false);
-    Coalesce(pre, node, parent, node_index, transaction);
-    buffer_pool_manager_->UnpinPage(node_id, true);
-    buffer_pool_manager_->UnpinPage(parent_id, true);
-    return true;
+  // 从node的父亲处获得node的index，优先选左兄弟，最左的节点选右兄弟
+  Page *parent_page = buffer_pool_manager_->FetchPage(node->GetParentPageId());
+  auto *parent = reinterpret_cast<BPlusTree::InternalPage *>(parent_page->GetData());
+  int node_index = parent->ValueIndex(node->GetPageId());
+  int sibling_index = node_index == 0 ? 1 : node_index - 1;
+  Page *sibling_page = buffer_pool_manager_->FetchPage(parent->ValueAt(sibling_index));
+  sibling_page->WLatch();
+  auto *sibling = reinterpret_cast<N *>(sibling_page->GetData());
+
+  bool node_deleted = false;
+  if (sibling->GetSize() + node->GetSize() >= node->GetMaxSize()) {
+    // 两页放不下，从兄弟借一个键值对
+    Redistribute(sibling, node, parent, node_index == 0 ? 0 : 1);
+  } else if (node_index == 0) {
+    // 右兄弟并入node
+    Coalesce(node, sibling, parent, sibling_index, write_set);
+    write_set->deleted.push_back(sibling_page->GetPageId());
   } else {
-    buffer_pool_manager_->UnpinPage(pre_id, false);
-    Coalesce(node, next, parent, next_index, transaction);
-    buffer_pool_manager_->UnpinPage(parent_id, true);
-    buffer_pool_manager_->UnpinPage(next_id, true);
-    return false;
+    // node并入左兄弟
+    Coalesce(sibling, node, parent, node_index, write_set);
+    write_set->deleted.push_back(node->GetPageId());
+    node_deleted = true;
   }
+  sibling_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(sibling_page->GetPageId(), true);
+  buffer_pool_manager_->UnpinPage(parent_page->GetPageId(), true);
+  return node_deleted;
 }
 
 /*
@@ -347,28 +675,28 @@ bool BPlusTree::CoalesceOrRedistribute(N *&node, Transaction *transaction) {
  * take info of deletion into account. Remember to deal with coalesce or
  * redistribute recursively if necessary.
  * Using template N to represent either internal page or leaf page.
- * @param   neighbor_node      sibling page of input "node"
+ * @param   neighbor_node      sibling page of input "node", on its left
  * @param   node               input from method coalesceOrRedistribute()
  * @param   parent             parent page of input "node"
+ * @param   index              index of node in parent
  * @return  true means parent node should be deleted, false means no deletion happened
  */
 bool BPlusTree::Coalesce(LeafPage *&neighbor_node, LeafPage *&node, InternalPage *&parent, int index,
-                         Transaction *transaction) {
-  if (neighbor_node->GetNextPageId() == 0) LOG(INFO) << "Fatal error in Coalesce";
+                         WriteSet *write_set) {
   node->MoveAllTo(neighbor_node);
   parent->Remove(index);
-  if (parent->GetSize() < parent->GetMinSize())
-    return CoalesceOrRedistribute<BPlusTree::InternalPage>(parent, transaction);
+  if (parent->IsRootPage() || parent->GetSize() < parent->GetMinSize())
+    return CoalesceOrRedistribute<BPlusTree::InternalPage>(parent, write_set);
   else
     return false;
 }
 
 bool BPlusTree::Coalesce(InternalPage *&neighbor_node, InternalPage *&node, InternalPage *&parent, int index,
-                         Transaction *transaction) {
+                         WriteSet *write_set) {
   node->MoveAllTo(neighbor_node, parent->KeyAt(index), buffer_pool_manager_);
   parent->Remove(index);
-  if (parent->GetSize() < parent->GetMinSize())
-    return CoalesceOrRedistribute<BPlusTree::InternalPage>(parent, transaction);
+  if (parent->IsRootPage() || parent->GetSize() < parent->GetMinSize())
+    return CoalesceOrRedistribute<BPlusTree::InternalPage>(parent, write_set);
   else
     return false;
 }
@@ -381,40 +709,34 @@ bool BPlusTree::Coalesce(InternalPage *&neighbor_node, InternalPage *&node, Inte
  * Using template N to represent either internal page or leaf page.
  * @param   neighbor_node      sibling page of input "node"
  * @param   node               input from method coalesceOrRedistribute()
+ * @param   parent             parent page of both
  */
-void BPlusTree::Redistribute(LeafPage *neighbor_node, LeafPage *node, int index) {
-  // 获取node父亲指针
-  page_id_t parent = node->GetParentPageId();
-  auto *parent_ptr = reinterpret_cast<BPlusTree::InternalPage *>(buffer_pool_manager_->FetchPage(parent)->GetData());
-
+void BPlusTree::Redistribute(LeafPage *neighbor_node, LeafPage *node, InternalPage *parent, int index) {
   if (index == 0) {  // FTE
     neighbor_node->MoveFirstToEndOf(node);
-    int node_index = parent_ptr->ValueIndex(neighbor_node->GetPageId());
-    parent_ptr->SetKeyAt(node_index, neighbor_node->KeyAt(0));
+    int node_index = parent->ValueIndex(neighbor_node->GetPageId());
+    parent->SetKeyAt(node_index, neighbor_node->KeyAt(0));
   } else {  // LTF
     neighbor_node->MoveLastToFrontOf(node);
-    int node_index = parent_ptr->ValueIndex(node->GetPageId());
-    parent_ptr->SetKeyAt(node_index, node->KeyAt(0));
+    int node_index = parent->ValueIndex(node->GetPageId());
+    parent->SetKeyAt(node_index, node->KeyAt(0));
   }
-  buffer_pool_manager_->UnpinPage(parent, true);
 }
-void BPlusTree::Redistribute(InternalPage *neighbor_node, InternalPage *node, int index) {
-  // 获取node父亲指针
-  page_id_t parent = node->GetParentPageId();
-  auto *parent_ptr = reinterpret_cast<BPlusTree::InternalPage *>(buffer_pool_manager_->FetchPage(parent)->GetData());
-
+void BPlusTree::Redistribute(InternalPage *neighbor_node, InternalPage *node, InternalPage *parent, int index) {
+  // 移动会覆盖邻居中的新分隔键，先拷贝出来
+  GenericKey *newKey = processor_.InitKey();
   if (index == 0) {  // FTE
-    int neighbor_index = parent_ptr->ValueIndex(neighbor_node->GetPageId());
-    GenericKey *newKey = neighbor_node->KeyAt(1);
-    neighbor_node->MoveFirstToEndOf(node, parent_ptr->KeyAt(neighbor_index), buffer_pool_manager_);
-    parent_ptr->SetKeyAt(neighbor_index, newKey);
+    int neighbor_index = parent->ValueIndex(neighbor_node->GetPageId());
+    memcpy(newKey, neighbor_node->KeyAt(1), processor_.GetKeySize());
+    neighbor_node->MoveFirstToEndOf(node, parent->KeyAt(neighbor_index), buffer_pool_manager_);
+    parent->SetKeyAt(neighbor_index, newKey);
   } else {  // LTF
-    int node_index = parent_ptr->ValueIndex(node->GetPageId());
-    GenericKey *newKey = neighbor_node->KeyAt(neighbor_node->GetSize() - 1);
-    neighbor_node->MoveLastToFrontOf(node, parent_ptr->KeyAt(node_index), buffer_pool_manager_);
-    parent_ptr->SetKeyAt(node_index, newKey);
+    int node_index = parent->ValueIndex(node->GetPageId());
+    memcpy(newKey, neighbor_node->KeyAt(neighbor_node->GetSize() - 1), processor_.GetKeySize());
+    neighbor_node->MoveLastToFrontOf(node, parent->KeyAt(node_index), buffer_pool_manager_);
+    parent->SetKeyAt(node_index, newKey);
   }
-  buffer_pool_manager_->UnpinPage(parent, true);
+  free(newKey);
 }
 /*
  * Update root page if necessary
@@ -423,23 +745,24 @@ void BPlusTree::Redistribute(InternalPage *neighbor_node, InternalPage *node, in
  * case 1: when you delete the last element in root page, but root page still
  * has one last child
  * case 2: when you delete the last element in whole b+ tree
+ * Must be called with root_latch_ write latched.
  * @return : true means root page should be deleted, false means no deletion
  * happened
  */
 bool BPlusTree::AdjustRoot(BPlusTreePage *old_root_node) {
-  if (old_root_node->GetSize() > 1)  // 节点大于二，不用删除
-    return false;
   if (old_root_node->IsLeafPage()) {
-    if (old_root_node->GetSize() == 1) return false;  // root同时是leaf，节点不为0即不用删除
+    if (old_root_node->GetSize() > 0) return false;  // root同时是leaf，节点不为0即不用删除
     root_page_id_ = INVALID_PAGE_ID;
     UpdateRootPageId(0);
     return true;
   }
+  if (old_root_node->GetSize() > 1)  // 不止一个孩子，不用删除
+    return false;
 
   auto root = reinterpret_cast<BPlusTree::InternalPage *>(old_root_node);
   root_page_id_ = root->RemoveAndReturnOnlyChild();
   auto new_root_node =
-      reinterpret_cast<BPlusTree::InternalPage *>(buffer_pool_manager_->FetchPage(root_page_id_)->GetData());
+      reinterpret_cast<BPlusTreePage *>(buffer_pool_manager_->FetchPage(root_page_id_)->GetData());
   new_root_node->SetParentPageId(INVALID_PAGE_ID);
   buffer_pool_manager_->UnpinPage(root_page_id_, true);
   UpdateRootPageId(0);
@@ -455,11 +778,14 @@ bool BPlusTree::AdjustRoot(BPlusTreePage *old_root_node) {
  * @return : index iterator
  */
 IndexIterator BPlusTree::Begin() {
-  Page *page = FindLeafPage(nullptr, INVALID_PAGE_ID, true);
+  uint64_t version;
+  Page *page = ReadLeafPage(nullptr, true, [](::LeafPage *) {}, &version);
   if (page == nullptr) return IndexIterator();
   int page_id = page->GetPageId();
+  // 迭代器自己读页；page保持pin住，期间不会被删除
+  IndexIterator iter(this, buffer_pool_manager_, page_id, version);
   buffer_pool_manager_->UnpinPage(page_id, false);
-  return IndexIterator(page_id, buffer_pool_manager_);
+  return iter;
 }
 
 /*
@@ -468,12 +794,13 @@ IndexIterator BPlusTree::Begin() {
  * @return : index iterator
  */
 IndexIterator BPlusTree::Begin(const GenericKey *key) {
-  Page *page = FindLeafPage(key, INVALID_PAGE_ID, false);
+  uint64_t version;
+  Page *page = ReadLeafPage(key, false, [](::LeafPage *) {}, &version);
   if (page == nullptr) return IndexIterator();
   int page_id = page->GetPageId();
-  auto *leaf = reinterpret_cast<BPlusTree::LeafPage *>(page);
+  IndexIterator iter(this, buffer_pool_manager_, page_id, version, key);
   buffer_pool_manager_->UnpinPage(page_id, false);
-  return IndexIterator(page_id, buffer_pool_manager_, leaf->KeyIndex(key, processor_));
+  return iter;
 }
 
 /*
@@ -483,18 +810,6 @@ IndexIterator BPlusTree::Begin(const GenericKey *key) {
  */
 IndexIterator BPlusTree::End() {
   return IndexIterator();
-//  auto *page = reinterpret_cast<BPlusTreePage *>(buffer_pool_manager_->FetchPage(root_page_id_)->GetData());
-//  if (page == nullptr) return IndexIterator();
-//  page_id_t pageId = page->GetPageId();
-//  while (!page->IsLeafPage()) {
-//    auto *internalpage = reinterpret_cast<BPlusTree::InternalPage *>(page);
-//    pageId = internalpage->ValueAt(internalpage->GetSize() - 1);
-//    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
-//    page = reinterpret_cast<BPlusTreePage *>(buffer_pool_manager_->FetchPage(pageId)->GetData());
-//  }
-//  auto *leaf = reinterpret_cast<BPlusTree::LeafPage *>(page);
-//  buffer_pool_manager_->UnpinPage(pageId, false);
-//  return IndexIterator(pageId, buffer_pool_manager_, leaf->GetSize() - 1);
 }
 
 /*****************************************************************************
@@ -503,32 +818,168 @@ IndexIterator BPlusTree::End() {
 /*
  * Find leaf page containing particular key, if leftMost flag == true, find
  * the left most leaf page
- * Note: the leaf page is pinned, you need to unpin it after use.
+ * The descent crabs with read latches: a page stays latched until its child is.
+ * Note: the leaf page is pinned and read latched, you need to unlatch and unpin it after use.
  */
 Page *BPlusTree::FindLeafPage(const GenericKey *key, page_id_t page_id, bool leftMost) {
-  if (IsEmpty()) return nullptr;
+  root_latch_.RLock();
+  if (IsEmpty()) {
+    root_latch_.RUnlock();
+    return nullptr;
+  }
 
   // 当前页从b+树根节点开始
   Page *currPage = buffer_pool_manager_->FetchPage(root_page_id_);
-  page_id_t currPageId = root_page_id_;
+  currPage->RLatch();
+  root_latch_.RUnlock();
   auto *curr = reinterpret_cast<BPlusTreePage *>(currPage->GetData());
 
-  // 向下寻找直到叶节点
+  // 向下寻找直到叶节点，先锁住孩子再放开父亲
   while (!curr->IsLeafPage()) {
-    buffer_pool_manager_->UnpinPage(currPageId, false);  // 每找一层关闭上一层的内节点page
-    auto *internalPage = reinterpret_cast<BPlusTree::InternalPage *>(currPage);  // 打开上一层内节点page
-    if (leftMost)                                                                // 一路向左
-      currPageId = internalPage->ValueAt(0);
-    else
-      currPageId = internalPage->Lookup(key, processor_);
-
-    currPage = buffer_pool_manager_->FetchPage(currPageId);  // 改变当前页的指针
+    auto *internalPage = reinterpret_cast<BPlusTree::InternalPage *>(curr);
+    page_id_t childId = leftMost ? internalPage->ValueAt(0) : internalPage->Lookup(key, processor_);
+    Page *childPage = buffer_pool_manager_->FetchPage(childId);
+    childPage->RLatch();
+    currPage->RUnlatch();
+    buffer_pool_manager_->UnpinPage(currPage->GetPageId(), false);
+    currPage = childPage;
     curr = reinterpret_cast<BPlusTreePage *>(currPage->GetData());
   }
   // 在GetValue()中unpin
   return currPage;
 }
 
+template <typename F>
+Page *BPlusTree::ReadLeafPage(const GenericKey *key, bool leftMost, F &&read, uint64_t *leaf_version) {
+  for (int attempt = 0; attempt < OPTIMISTIC_READ_RETRIES; attempt++) {
+    page_id_t root_id = root_page_id_;
+    if (root_id == INVALID_PAGE_ID) return nullptr;
+    Page *currPage = buffer_pool_manager_->FetchPage(root_id);
+    uint64_t version;
+    // 读到版本后根仍未被替换，之后根的变化都会改变它的版本
+    bool valid = currPage->ReadVersion(&version) && root_page_id_ == root_id;
+    auto *curr = reinterpret_cast<BPlusTreePage *>(currPage->GetData());
+    while (valid && !curr->IsLeafPage()) {
+      auto *internalPage = reinterpret_cast<BPlusTree::InternalPage *>(curr);
+      page_id_t childId = leftMost ? internalPage->ValueAt(0) : internalPage->Lookup(key, processor_);
+      // 验证后孩子页号才可信；pin住孩子后再验证一次，父亲没变说明孩子没被删除
+      if (!currPage->ValidateVersion(version)) {
+        valid = false;
+        break;
+      }
+      Page *childPage = buffer_pool_manager_->FetchPage(childId);
+      uint64_t childVersion;
+      valid = childPage->ReadVersion(&childVersion) && currPage->ValidateVersion(version);
+      buffer_pool_manager_->UnpinPage(currPage->GetPageId(), false);
+      currPage = childPage;
+      curr = reinterpret_cast<BPlusTreePage *>(currPage->GetData());
+      version = childVersion;
+    }
+    if (valid) {
+      read(reinterpret_cast<BPlusTree::LeafPage *>(curr));
+      if (currPage->ValidateVersion(version)) {
+        if (leaf_version != nullptr) *leaf_version = version;
+        return currPage;
+      }
+    }
+    buffer_pool_manager_->UnpinPage(currPage->GetPageId(), false);
+  }
+  // 写者一直在改，退回读锁
+  Page *page = FindLeafPage(key, INVALID_PAGE_ID, leftMost);
+  if (page == nullptr) return nullptr;
+  read(reinterpret_cast<BPlusTree::LeafPage *>(page->GetData()));
+  if (leaf_version != nullptr) page->ReadVersion(leaf_version);
+  page->RUnlatch();
+  return page;
+}
+
+Page *BPlusTree::FindLeafPageOptimistic(const GenericKey *key, bool *is_root) {
+  root_latch_.RLock();
+  if (IsEmpty()) {
+    root_latch_.RUnlock();
+    return nullptr;
+  }
+  // 页的类型在页被删除前不会改变，而父亲锁住时孩子不会被删除，所以加锁前就可以判断是否为叶节点
+  Page *currPage = buffer_pool_manager_->FetchPage(root_page_id_);
+  auto *curr = reinterpret_cast<BPlusTreePage *>(currPage->GetData());
+  *is_root = curr->IsLeafPage();
+  if (curr->IsLeafPage()) {
+    currPage->WLatch();
+  } else {
+    currPage->RLatch();
+  }
+  root_latch_.RUnlock();
+
+  while (!curr->IsLeafPage()) {
+    auto *internalPage = reinterpret_cast<BPlusTree::InternalPage *>(curr);
+    Page *childPage = buffer_pool_manager_->FetchPage(internalPage->Lookup(key, processor_));
+    auto *child = reinterpret_cast<BPlusTreePage *>(childPage->GetData());
+    if (child->IsLeafPage()) {
+      childPage->WLatch();
+    } else {
+      childPage->RLatch();
+    }
+    currPage->RUnlatch();
+    buffer_pool_manager_->UnpinPage(currPage->GetPageId(), false);
+    currPage = childPage;
+    curr = child;
+  }
+  return currPage;
+}
+
+Page *BPlusTree::FindLeafPagePessimistic(const GenericKey *key, Operation op, WriteSet *write_set) {
+  root_latch_.WLock();
+  write_set->root_latched = true;
+  if (IsEmpty()) {
+    return nullptr;
+  }
+
+  Page *currPage = buffer_pool_manager_->FetchPage(root_page_id_);
+  currPage->WLatch();
+  auto *curr = reinterpret_cast<BPlusTreePage *>(currPage->GetData());
+  if (IsSafe(curr, op, true)) {
+    ReleaseWriteSet(write_set, false);
+  }
+  write_set->pages.push_back(currPage);
+
+  // 孩子安全时它的祖先都不会再被修改，全部放开
+  while (!curr->IsLeafPage()) {
+    auto *internalPage = reinterpret_cast<BPlusTree::InternalPage *>(curr);
+    currPage = buffer_pool_manager_->FetchPage(internalPage->Lookup(key, processor_));
+    currPage->WLatch();
+    curr = reinterpret_cast<BPlusTreePage *>(currPage->GetData());
+    if (IsSafe(curr, op, false)) {
+      ReleaseWriteSet(write_set, false);
+    }
+    write_set->pages.push_back(currPage);
+  }
+  return currPage;
+}
+
+bool BPlusTree::IsSafe(BPlusTreePage *node, Operation op, bool is_root) {
+  if (op == Operation::INSERT) {
+    // 插入后达到max size就会分裂
+    return node->GetSize() + 1 < node->GetMaxSize();
+  }
+  if (is_root) {
+    // 根叶节点删空时树变空，根内节点只剩一个孩子时被替换
+    return node->GetSize() > (node->IsLeafPage() ? 1 : 2);
+  }
+  return node->GetSize() > node->GetMinSize();
+}
+
+void BPlusTree::ReleaseWriteSet(WriteSet *write_set, bool is_dirty) {
+  if (write_set->root_latched) {
+    root_latch_.WUnlock();
+    write_set->root_latched = false;
+  }
+  for (Page *page : write_set->pages) {
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), is_dirty);
+  }
+  write_set->pages.clear();
+}
+
 /*
  * Update/Insert root page id in IndexRootsPage(where page_id = 0, index_roots__page is
  * defined under include/page/index_roots__page.h)
@@ -538,14 +989,16 @@ Page *BPlusTree::FindLeafPage(const GenericKey *key, page_id_t page_id, bool lef
  * updating it.
  */
 void BPlusTree::UpdateRootPageId(int insert_record) {
-  auto *index_roots_page = reinterpret_cast<IndexRootsPage *>(buffer_pool_manager_->FetchPage(INDEX_ROOTS_PAGE_ID));
-  if (insert_record != 0) {
-    // create a new record<index_id_ + root_page_id> in index_roots_page
-    index_roots_page->Insert(index_id_, root_page_id_);
-  } else {
+  Page *page = buffer_pool_manager_->FetchPage(INDEX_ROOTS_PAGE_ID);
+  auto *index_roots_page = reinterpret_cast<IndexRootsPage *>(page);
+  // the roots page is shared by every index
+  page->WLatch();
+  // a tree that was emptied keeps its record
+  if (insert_record == 0 || !index_roots_page->Insert(index_id_, root_page_id_)) {
     // update root_page_id in index_roots_page
     index_roots_page->Update(index_id_, root_page_id_);
   }
+  page->WUnlatch();
   buffer_pool_manager_->UnpinPage(INDEX_ROOTS_PAGE_ID, true);
 }
 
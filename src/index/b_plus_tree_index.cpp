@@ -1,18 +1,26 @@
 #include <algorithm>
 #include "index/b_plus_tree_index.h"
 
+#include "buffer/read_ahead.h"
 #include "index/generic_key.h"
+#include "index/key_sorter.h"
+#include "storage/table_heap.h"
 #include "utils/tree_file_mgr.h"
 BPlusTreeIndex::BPlusTreeIndex(index_id_t index_id, IndexSchema *key_schema, size_t key_size,
-                               BufferPoolManager *buffer_pool_manager)
+                               BufferPoolManager *buffer_pool_manager, bool unique)
     : Index(index_id, key_schema),
       processor_(key_schema_, key_size),
-      container_(index_id, buffer_pool_manager, processor_) {}
+      container_(index_id, buffer_pool_manager, processor_, UNDEFINED_SIZE, UNDEFINED_SIZE, unique),
+      buffer_pool_manager_(buffer_pool_manager) {}
 
 dberr_t BPlusTreeIndex::InsertEntry(const Row &key, RowId row_id, Transaction *txn) {
   // ASSERT(row_id.Get() != INVALID_ROWID.Get(), "Invalid row id for index insert.");
   GenericKey *index_key = processor_.InitKey();
-  processor_.SerializeFromKey(index_key, key, key_schema_);
+  if (processor_.SerializeFromKey(index_key, key, key_schema_) != 0) {
+    // the key can not hold the value, e.g. a char value longer than its column
+    delete index_key;
+    return DB_FAILED;
+  }
 
   bool status = container_.Insert(index_key, row_id, txn);
   delete index_key;
@@ -27,47 +35,90 @@ dberr_t BPlusTreeIndex::InsertEntry(const Row &key, RowId row_id, Transaction *t
   return DB_SUCCESS;
 }
 
+dberr_t BPlusTreeIndex::BuildFromTable(TableHeap *table_heap, Schema *schema, const std::vector<uint32_t> &key_map,
+                                       Transaction *txn) {
+  KeySorter sorter(buffer_pool_manager_, processor_.GetKeySize());
+  GenericKey *index_key = processor_.InitKey();
+  RowBatch batch;
+  RowView tuple;
+  ReadAhead read_ahead(buffer_pool_manager_);
+  bool status = true;
+  for (page_id_t page_id = table_heap->GetFirstPageId(); status && page_id != INVALID_PAGE_ID;
+       page_id = batch.GetNextPageId()) {
+    if (!table_heap->ScanPage(page_id, batch, txn, &read_ahead)) {
+      status = false;
+      break;
+    }
+    for (size_t i = 0; status && i < batch.Size(); i++) {
+      batch.GetView(i, schema, &tuple);
+      status = processor_.SerializeFromView(index_key, tuple, key_map) && sorter.Add(index_key, batch.GetRowId(i));
+    }
+  }
+  batch.Release();
+  free(index_key);
+  status = status && sorter.Finish() && container_.BulkLoad(&sorter);
+  return status ? DB_SUCCESS : DB_FAILED;
+}
+
 dberr_t BPlusTreeIndex::RemoveEntry(const Row &key, RowId row_id, Transaction *txn) {
   GenericKey *index_key = processor_.InitKey();
-  processor_.SerializeFromKey(index_key, key, key_schema_);
+  if (processor_.SerializeFromKey(index_key, key, key_schema_) != 0) {
+    // no entry has a key the index can not hold, the nearest key belongs to other rows
+    delete index_key;
+    return DB_KEY_NOT_FOUND;
+  }
 
-  container_.Remove(index_key, txn);
+  if (container_.IsUnique()) {
+    container_.Remove(index_key, txn);
+  } else {
+    container_.Remove(index_key, row_id, txn);
+  }
   delete index_key;
   return DB_SUCCESS;
 }
 
 dberr_t BPlusTreeIndex::ScanKey(const Row &key, vector<RowId> &result, Transaction *txn, string compare_operator) {
   GenericKey *index_key = processor_.InitKey();
-  processor_.SerializeFromKey(index_key, key, key_schema_);
+  // a probe the key can not hold, such as 3.5 for an int column, lies between index_key and the key next to it on the
+  // side of probe_cmp, the operator is moved onto index_key so that the same entries match
+  int probe_cmp = processor_.SerializeFromKey(index_key, key, key_schema_);
+  if ((probe_cmp > 0 && compare_operator == "<") || (probe_cmp < 0 && compare_operator == "<=")) {
+    compare_operator = probe_cmp > 0 ? "<=" : "<";
+  } else if ((probe_cmp > 0 && compare_operator == ">=") || (probe_cmp < 0 && compare_operator == ">")) {
+    compare_operator = probe_cmp > 0 ? ">" : ">=";
+  }
+  // a null never compares true, null keys sort first and are skipped by the scans from the beginning
   if (compare_operator == "=") {
-    container_.GetValue(index_key, result, txn);
-  } else if (compare_operator == ">") {
+    if (probe_cmp == 0) {
+      container_.GetValue(index_key, result, txn);
+    }
+  } else if (compare_operator == ">" || compare_operator == ">=") {
     auto iter = GetBeginIterator(index_key);
-    if (container_.GetValue(index_key, result, txn))
+    // ">" skips every entry of the equal key, a non-unique index may have several
+    while (compare_operator == ">" && iter != GetEndIterator() &&
+           processor_.CompareKeys((*iter).first, index_key) == 0) {
       ++iter;
-    for (; iter != GetEndIterator(); ++iter) {
-      result.emplace_back((*iter).second);
-    }
-  } else if (compare_operator == ">=") {
-    for (auto iter = GetBeginIterator(index_key); iter != GetEndIterator(); ++iter) {
-      result.emplace_back((*iter).second);
     }
-  } else if (compare_operator == "<") {
-    for (auto iter = GetBeginIterator(); iter != GetBeginIterator(index_key); ++iter) {
+    for (; iter != GetEndIterator(); ++iter) {
       result.emplace_back((*iter).second);
     }
-  } else if (compare_operator == "<=") {
-    for (auto iter = GetBeginIterator(); iter != GetBeginIterator(index_key); ++iter) {
-      result.emplace_back((*iter).second);
+  } else if (compare_operator == "<" || compare_operator == "<=") {
+    for (auto iter = GetBeginIterator(); iter != GetEndIterator(); ++iter) {
+      int cmp = processor_.CompareKeys((*iter).first, index_key);
+      if (cmp > 0 || (cmp == 0 && compare_operator == "<")) {
+        break;
+      }
+      if (!processor_.HasNull((*iter).first)) {
+        result.emplace_back((*iter).second);
+      }
     }
-    container_.GetValue(index_key, result, txn);
   } else if (compare_operator == "<>") {
     for (auto iter = GetBeginIterator(); iter != GetEndIterator(); ++iter) {
-      result.emplace_back((*iter).second);
+      if ((probe_cmp != 0 || processor_.CompareKeys((*iter).first, index_key) != 0) &&
+          !processor_.HasNull((*iter).first)) {
+        result.emplace_back((*iter).second);
+      }
     }
-    vector<RowId> temp;
-    if (container_.GetValue(index_key, temp, txn))
-      result.erase(find(result.begin(), result.end(), temp[0]));
   }
   delete index_key;
   if (!result.empty())
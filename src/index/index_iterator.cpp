@@ -1,14 +1,50 @@
 #include "index/index_iterator.h"
 
+#include "index/b_plus_tree.h"
 #include "index/basic_comparator.h"
 #include "index/generic_key.h"
 
 IndexIterator::IndexIterator() = default;
 
-IndexIterator::IndexIterator(page_id_t page_id, BufferPoolManager *bpm, int index)
-    : current_page_id(page_id), item_index(index), buffer_pool_manager(bpm) {
+IndexIterator::IndexIterator(BPlusTree *tree, BufferPoolManager *bpm, page_id_t page_id, uint64_t version,
+                             const GenericKey *key)
+    : tree(tree), current_page_id(page_id), leaf_version(version), buffer_pool_manager(bpm), read_ahead(bpm) {
   //每遍历到一个页面pin住，unpin在重载的++运算符中
-  page = reinterpret_cast<LeafPage *>(buffer_pool_manager->FetchPage(current_page_id));
+  frame = buffer_pool_manager->FetchPage(current_page_id);
+  if (frame == nullptr) {
+    current_page_id = INVALID_PAGE_ID;
+    return;
+  }
+  page = reinterpret_cast<LeafPage *>(frame->GetData());
+  if (key != nullptr) {
+    auto *data = reinterpret_cast<const char *>(key);
+    current_key.assign(data, data + page->GetKeySize());
+    inclusive = true;
+  }
+  // the next page id is only a prefetch hint, it need not be validated
+  read_ahead.OnPageAccess(current_page_id, page->GetNextPageId());
+  Settle();
+}
+
+IndexIterator::IndexIterator(IndexIterator &&other) noexcept
+    : tree(other.tree),
+      current_page_id(other.current_page_id),
+      frame(other.frame),
+      page(other.page),
+      leaf_version(other.leaf_version),
+      item_index(other.item_index),
+      current_key(std::move(other.current_key)),
+      inclusive(other.inclusive),
+      current_value(other.current_value),
+      postings(std::move(other.postings)),
+      posting_index(other.posting_index),
+      buffer_pool_manager(other.buffer_pool_manager),
+      read_ahead(other.read_ahead) {
+  other.current_page_id = INVALID_PAGE_ID;
+  other.frame = nullptr;
+  other.page = nullptr;
+  other.item_index = 0;
+  other.posting_index = 0;
 }
 
 IndexIterator::~IndexIterator() {
@@ -17,29 +53,161 @@ IndexIterator::~IndexIterator() {
 }
 
 std::pair<GenericKey *, RowId> IndexIterator::operator*() {
-  return  page->GetItem(item_index);
+  return std::make_pair(reinterpret_cast<GenericKey *>(current_key.data()), current_value);
 }
 
 IndexIterator &IndexIterator::operator++() {
+  Settle();
+  return *this;
+}
 
-  if(item_index != page->GetSize() - 1) item_index++;
-  else{
-    int next_id = page->GetNextPageId();
+void IndexIterator::Settle() {
+  // 当前键的posting list还没返回完
+  if (posting_index + 1 < postings.size()) {
+    current_value = postings[++posting_index];
+    return;
+  }
+  postings.clear();
+  posting_index = 0;
+  bool held = false;  // Restart返回的叶节点已加读锁
+  for (int attempt = 0;; attempt++) {
+    if (current_page_id == INVALID_PAGE_ID) {
+      return;
+    }
+    // 乐观读多次失败后才加读锁
+    bool latched = held || attempt >= OPTIMISTIC_READ_RETRIES;
+    uint64_t version = 0;
+    if (latched && !held) {
+      frame->RLatch();
+    }
+    held = false;
+    if (!frame->ReadVersion(&version) && !latched) {
+      continue;
+    }
+    // 页被合并掉了，或者变了之后没有不大于current_key的键：之后的键可能被移到了左边，从根重新找
+    bool merged = !page->IsLeafPage();
+    int index = merged ? 0 : FindPosition();
+    if (merged || (!current_key.empty() && version != leaf_version && index == 0)) {
+      if (!latched && !frame->ValidateVersion(version)) {
+        continue;
+      }
+      Restart(latched);
+      held = true;
+      attempt = -1;
+      continue;
+    }
+    if (index < page->GetSize()) {
+      auto *key = reinterpret_cast<char *>(page->KeyAt(index));
+      next_key.assign(key, key + page->GetKeySize());
+      RowId value = page->ValueAt(index);
+      if (PostingListPage::IsReference(value) && !latched) {
+        // posting list只在叶节点加锁时读
+        attempt = OPTIMISTIC_READ_RETRIES - 1;
+        continue;
+      }
+      if (latched) {
+        if (PostingListPage::IsReference(value)) {
+          PostingListPage::Read(buffer_pool_manager, PostingListPage::GetFirstPageId(value), &postings);
+        }
+        frame->RUnlatch();
+      } else if (!frame->ValidateVersion(version)) {
+        continue;
+      }
+      item_index = index;
+      current_key.swap(next_key);
+      inclusive = false;
+      leaf_version = version;
+      current_value = postings.empty() ? value : postings[0];
+      return;
+    }
+    // 当前页没有了，先pin住下一页再离开当前页，下一页不会在这之间被合并删除后复用
+    page_id_t next_id = page->GetNextPageId();
+    if (!latched && !frame->ValidateVersion(version)) {
+      continue;
+    }
+    Page *next = next_id == INVALID_PAGE_ID ? nullptr : buffer_pool_manager->FetchPage(next_id);
+    // 下一页的版本在当前页验证前读到，之后的键那时都在下一页或更右边；下一页正被写时重试，不能持有当前页的读锁等它
+    uint64_t next_version = 0;
+    bool next_read = next == nullptr || next->ReadVersion(&next_version);
+    if (latched) {
+      frame->RUnlatch();
+    }
+    if (!next_read || (!latched && !frame->ValidateVersion(version))) {
+      if (next != nullptr) buffer_pool_manager->UnpinPage(next_id, false);
+      continue;
+    }
     //unpin上一个page
-    buffer_pool_manager->UnpinPage(page->GetPageId(), false);
-    page = reinterpret_cast<IndexIterator::LeafPage *>(buffer_pool_manager->FetchPage(next_id));
-//    if(page== nullptr){
-//      auto end = new IndexIterator;
-//      return *end;
-//    }
+    buffer_pool_manager->UnpinPage(current_page_id, false);
     item_index = 0;
+    if (next == nullptr) {
+      current_page_id = INVALID_PAGE_ID;
+      frame = nullptr;
+      page = nullptr;
+      return;
+    }
     current_page_id = next_id;
+    frame = next;
+    page = reinterpret_cast<LeafPage *>(frame->GetData());
+    leaf_version = next_version;
+    read_ahead.OnPageAccess(next_id, page->GetNextPageId());
+    attempt = -1;
   }
-  return *this;
+}
+
+void IndexIterator::Restart(bool latched) {
+  // 被合并掉的页一直标记着，直到所有pin都放开后被删除
+  bool merged = !page->IsLeafPage();
+  if (latched) {
+    frame->RUnlatch();
+  }
+  buffer_pool_manager->UnpinPage(current_page_id, false);
+  if (merged) {
+    tree->DeletePages({});
+  }
+  item_index = 0;
+  bool from_start = current_key.empty();
+  frame = tree->FindLeafPage(from_start ? nullptr : reinterpret_cast<GenericKey *>(current_key.data()),
+                             INVALID_PAGE_ID, from_start);
+  if (frame == nullptr) {
+    current_page_id = INVALID_PAGE_ID;
+    page = nullptr;
+    return;
+  }
+  current_page_id = frame->GetPageId();
+  page = reinterpret_cast<LeafPage *>(frame->GetData());
+  frame->ReadVersion(&leaf_version);
+  read_ahead.OnPageAccess(current_page_id, page->GetNextPageId());
+}
+
+int IndexIterator::FindPosition() {
+  if (current_key.empty()) {
+    return 0;
+  }
+  // 当前键没被移动时直接后移，否则重新找第一个更大的键
+  if (item_index < page->GetSize() && memcmp(page->KeyAt(item_index), current_key.data(), current_key.size()) == 0) {
+    return inclusive ? item_index : item_index + 1;
+  }
+  return Seek();
+}
+
+int IndexIterator::Seek() {
+  int left = 0;
+  int right = page->GetSize();
+  while (left < right) {
+    int mid = (left + right) / 2;
+    int compare = memcmp(page->KeyAt(mid), current_key.data(), current_key.size());
+    if (compare < 0 || (compare == 0 && !inclusive)) {
+      left = mid + 1;
+    } else {
+      right = mid;
+    }
+  }
+  return left;
 }
 
 bool IndexIterator::operator==(const IndexIterator &itr) const {
-  return current_page_id == itr.current_page_id && item_index == itr.item_index;
+  return current_page_id == itr.current_page_id && item_index == itr.item_index &&
+         posting_index == itr.posting_index;
 }
 
 bool IndexIterator::operator!=(const IndexIterator &itr) const {
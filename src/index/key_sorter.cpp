@@ -0,0 +1,230 @@
+#include "index/key_sorter.h"
+
+#include <algorithm>
+#include <cstring>
+
+KeySorter::KeySorter(BufferPoolManager *buffer_pool_manager, int key_size, size_t buffer_size)
+    : buffer_pool_manager_(buffer_pool_manager),
+      key_size_(key_size),
+      entry_size_(key_size + sizeof(int64_t)),
+      entries_per_page_((PAGE_SIZE - RUN_PAGE_HEADER_SIZE) / entry_size_),
+      buffer_capacity_(std::max<size_t>(1, buffer_size / entry_size_)) {
+  ASSERT(entries_per_page_ > 0, "Key too large for a run page.");
+}
+
+KeySorter::~KeySorter() {
+  if (write_page_ != nullptr) {
+    buffer_pool_manager_->UnpinPage(write_page_->GetPageId(), true);
+    DeleteRun(write_first_page_id_);
+  }
+  for (auto &cursor : cursors_) {
+    if (cursor.page != nullptr) {
+      page_id_t page_id = cursor.page->GetPageId();
+      page_id_t next_page_id = MACH_READ_FROM(page_id_t, cursor.page->GetData() + OFFSET_NEXT_PAGE_ID);
+      buffer_pool_manager_->UnpinPage(page_id, false);
+      buffer_pool_manager_->DeletePage(page_id);
+      DeleteRun(next_page_id);
+    }
+  }
+  for (auto page_id : runs_) {
+    DeleteRun(page_id);
+  }
+}
+
+bool KeySorter::Add(const GenericKey *key, RowId rid) {
+  ASSERT(!finished_, "Pair added after Finish.");
+  if (order_.size() == buffer_capacity_ && !SpillBuffer()) {
+    return false;
+  }
+  size_t offset = buffer_.size();
+  buffer_.resize(offset + entry_size_);
+  memcpy(buffer_.data() + offset, key, key_size_);
+  MACH_WRITE_TO(int64_t, buffer_.data() + offset + key_size_, rid.Get());
+  order_.push_back(order_.size());
+  size_++;
+  return true;
+}
+
+bool KeySorter::Finish() {
+  ASSERT(!finished_, "Finish called twice.");
+  finished_ = true;
+  if (runs_.empty()) {
+    // everything fits in memory
+    std::sort(order_.begin(), order_.end(), [this](uint32_t lhs, uint32_t rhs) {
+      return Less(EntryAt(buffer_.data(), lhs), EntryAt(buffer_.data(), rhs));
+    });
+    return true;
+  }
+  if (!order_.empty() && !SpillBuffer()) {
+    return false;
+  }
+  std::vector<char>().swap(buffer_);
+  std::vector<uint32_t>().swap(order_);
+  // merge the oldest runs into longer ones until the rest can be merged at once
+  while (runs_.size() > INDEX_SORT_MERGE_FAN_IN) {
+    if (!StartMerge(INDEX_SORT_MERGE_FAN_IN)) {
+      return false;
+    }
+    BeginRun();
+    const char *entry;
+    while (NextMerged(&entry)) {
+      if (!AppendToRun(entry)) {
+        return false;
+      }
+    }
+    if (failed_) {
+      return false;
+    }
+    EndRun();
+  }
+  return StartMerge(runs_.size());
+}
+
+bool KeySorter::Next(GenericKey **key, RowId *rid) {
+  ASSERT(finished_, "Next called before Finish.");
+  const char *entry;
+  if (cursors_.empty()) {
+    if (next_sorted_ == order_.size()) {
+      return false;
+    }
+    entry = EntryAt(buffer_.data(), order_[next_sorted_++]);
+  } else if (!NextMerged(&entry)) {
+    return false;
+  }
+  *key = reinterpret_cast<GenericKey *>(const_cast<char *>(entry));
+  *rid = RowId(MACH_READ_FROM(int64_t, entry + key_size_));
+  return true;
+}
+
+bool KeySorter::Less(const char *lhs, const char *rhs) const {
+  int cmp = memcmp(lhs, rhs, key_size_);
+  if (cmp != 0) {
+    return cmp < 0;
+  }
+  return MACH_READ_FROM(int64_t, lhs + key_size_) < MACH_READ_FROM(int64_t, rhs + key_size_);
+}
+
+bool KeySorter::SpillBuffer() {
+  std::sort(order_.begin(), order_.end(), [this](uint32_t lhs, uint32_t rhs) {
+    return Less(EntryAt(buffer_.data(), lhs), EntryAt(buffer_.data(), rhs));
+  });
+  BeginRun();
+  for (auto index : order_) {
+    if (!AppendToRun(EntryAt(buffer_.data(), index))) {
+      return false;
+    }
+  }
+  EndRun();
+  buffer_.clear();
+  order_.clear();
+  return true;
+}
+
+void KeySorter::BeginRun() {
+  write_first_page_id_ = INVALID_PAGE_ID;
+  write_page_ = nullptr;
+}
+
+bool KeySorter::AppendToRun(const char *entry) {
+  uint32_t count = write_page_ == nullptr ? 0 : MACH_READ_UINT32(write_page_->GetData() + OFFSET_COUNT);
+  if (write_page_ == nullptr || count == entries_per_page_) {
+    page_id_t page_id;
+    Page *page = buffer_pool_manager_->NewPage(page_id);
+    if (page == nullptr) {
+      return false;
+    }
+    MACH_WRITE_TO(page_id_t, page->GetData() + OFFSET_NEXT_PAGE_ID, INVALID_PAGE_ID);
+    if (write_page_ == nullptr) {
+      write_first_page_id_ = page_id;
+    } else {
+      MACH_WRITE_TO(page_id_t, write_page_->GetData() + OFFSET_NEXT_PAGE_ID, page_id);
+      buffer_pool_manager_->UnpinPage(write_page_->GetPageId(), true);
+    }
+    write_page_ = page;
+    count = 0;
+  }
+  memcpy(write_page_->GetData() + RUN_PAGE_HEADER_SIZE + count * entry_size_, entry, entry_size_);
+  MACH_WRITE_UINT32(write_page_->GetData() + OFFSET_COUNT, count + 1);
+  return true;
+}
+
+void KeySorter::EndRun() {
+  if (write_page_ != nullptr) {
+    buffer_pool_manager_->UnpinPage(write_page_->GetPageId(), true);
+    runs_.push_back(write_first_page_id_);
+  }
+  BeginRun();
+}
+
+bool KeySorter::StartMerge(size_t run_count) {
+  ASSERT(current_ < 0 && heap_.empty(), "Previous merge not finished.");
+  cursors_.clear();
+  for (size_t i = 0; i < run_count; i++) {
+    Page *page = buffer_pool_manager_->FetchPage(runs_.front());
+    if (page == nullptr) {
+      return false;
+    }
+    runs_.pop_front();
+    cursors_.push_back({page, 0, MACH_READ_UINT32(page->GetData() + OFFSET_COUNT)});
+    heap_.push_back(cursors_.size() - 1);
+  }
+  std::make_heap(heap_.begin(), heap_.end(), [this](uint32_t lhs, uint32_t rhs) {
+    return Less(CursorEntry(cursors_[rhs]), CursorEntry(cursors_[lhs]));
+  });
+  return true;
+}
+
+bool KeySorter::NextMerged(const char **entry) {
+  auto greater = [this](uint32_t lhs, uint32_t rhs) {
+    return Less(CursorEntry(cursors_[rhs]), CursorEntry(cursors_[lhs]));
+  };
+  if (current_ >= 0) {
+    // the entry returned last is no longer needed, move its cursor on
+    RunCursor &cursor = cursors_[current_];
+    if (++cursor.index == cursor.count) {
+      page_id_t page_id = cursor.page->GetPageId();
+      page_id_t next_page_id = MACH_READ_FROM(page_id_t, cursor.page->GetData() + OFFSET_NEXT_PAGE_ID);
+      buffer_pool_manager_->UnpinPage(page_id, false);
+      buffer_pool_manager_->DeletePage(page_id);
+      cursor.page = nullptr;
+      if (next_page_id != INVALID_PAGE_ID) {
+        cursor.page = buffer_pool_manager_->FetchPage(next_page_id);
+        if (cursor.page == nullptr) {
+          // leave the rest of the run to the destructor
+          runs_.push_back(next_page_id);
+          current_ = -1;
+          failed_ = true;
+          return false;
+        }
+        cursor.index = 0;
+        cursor.count = MACH_READ_UINT32(cursor.page->GetData() + OFFSET_COUNT);
+      }
+    }
+    if (cursor.page != nullptr) {
+      heap_.push_back(current_);
+      std::push_heap(heap_.begin(), heap_.end(), greater);
+    }
+    current_ = -1;
+  }
+  if (heap_.empty()) {
+    return false;
+  }
+  std::pop_heap(heap_.begin(), heap_.end(), greater);
+  current_ = heap_.back();
+  heap_.pop_back();
+  *entry = CursorEntry(cursors_[current_]);
+  return true;
+}
+
+void KeySorter::DeleteRun(page_id_t page_id) {
+  while (page_id != INVALID_PAGE_ID) {
+    Page *page = buffer_pool_manager_->FetchPage(page_id);
+    if (page == nullptr) {
+      return;
+    }
+    page_id_t next_page_id = MACH_READ_FROM(page_id_t, page->GetData() + OFFSET_NEXT_PAGE_ID);
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    buffer_pool_manager_->DeletePage(page_id);
+    page_id = next_page_id;
+  }
+}
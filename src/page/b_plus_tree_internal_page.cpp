@@ -65,7 +65,7 @@ void *InternalPage::PairPtrAt(int index) { return KeyAt(index); }
  * @param pair_num
  */
 void InternalPage::PairCopy(void *dest, void *src, int pair_num) {
-  memcpy(dest, src, pair_num * (GetKeySize() + sizeof(page_id_t)));
+  memmove(dest, src, pair_num * (GetKeySize() + sizeof(page_id_t)));
 }
 /*****************************************************************************
  * LOOKUP
@@ -218,7 +218,8 @@ void InternalPage::MoveAllTo(InternalPage *recipient, GenericKey *middle_key, Bu
   // 首先拷贝来自parent的键middle_key，值是ValueAt(0)
   recipient->CopyLastFrom(middle_key, ValueAt(0), buffer_pool_manager);
   recipient->CopyNFrom(PairPtrAt(1), GetSize() - 1, buffer_pool_manager);
-  buffer_pool_manager->DeletePage(GetPageId());
+  // 本页由调用者在放开锁后删除
+  SetSize(0);
 }
 
 /*****************************************************************************
@@ -288,17 +289,3 @@ void InternalPage::CopyFirstFrom(const page_id_t value, BufferPoolManager *buffe
   buffer_pool_manager->UnpinPage(value, true);
   // 返回到上一层再unpin
 }
-//返回当前节点儿子中最小键所在的叶节点id
-page_id_t InternalPage::LeftMostKeyFromCurr(BufferPoolManager *buffer_pool_manager) {
-  Page *currPage = buffer_pool_manager->FetchPage(this->GetPageId());
-  auto *curr = reinterpret_cast<BPlusTreePage *>(currPage->GetData());
-  InternalPage *internalPage;
-  while (!curr->IsLeafPage()) {//由于curr是由this转换过来的，所以至少可以进入一次
-    buffer_pool_manager->UnpinPage(curr->GetPageId(), false);           // 每找一层关闭上一层的内节点page
-    internalPage = reinterpret_cast<::InternalPage *>(currPage);  // 打开上一层内节点page
-    currPage = buffer_pool_manager->FetchPage(internalPage->ValueAt(0));  // 改变当前页的指针
-    curr = reinterpret_cast<BPlusTreePage *>(currPage->GetData());
-  }
-  buffer_pool_manager->UnpinPage(curr->GetPageId(),false);
-  return internalPage->ValueAt(0);
-}
\ No newline at end of file
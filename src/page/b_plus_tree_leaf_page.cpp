@@ -95,7 +95,8 @@ void LeafPage::SetValueAt(int index, RowId value) {
 void *LeafPage::PairPtrAt(int index) { return KeyAt(index); }
 
 void LeafPage::PairCopy(void *dest, void *src, int pair_num) {
-  memcpy(dest, src, pair_num * (GetKeySize() + sizeof(RowId)));
+  // 区间可能重叠（插入删除时整体移动），用memmove
+  memmove(dest, src, pair_num * (GetKeySize() + sizeof(RowId)));
 }
 
 /*
@@ -208,6 +209,8 @@ int LeafPage::RemoveAndDeleteRecord(const GenericKey *key, const KeyManager &KM)
 /*
  * Remove all key & value pairs from this page to "recipient" page. Don't forget
  * to update the next_page id in the sibling page
+ * The page is then marked as no longer a leaf, so that an iterator still on it finds its key again from the root
+ * instead of following next_page_id past the moved pairs.
  */
 void LeafPage::MoveAllTo(LeafPage *recipient) {
   // 先全部移动，后修改nextPageId,最后修改当前size
@@ -215,6 +218,7 @@ void LeafPage::MoveAllTo(LeafPage *recipient) {
   recipient->CopyNFrom(PairPtrAt(0), size);
   recipient->SetNextPageId(GetNextPageId());
   SetSize(0);
+  SetPageType(IndexPageType::INVALID_INDEX_PAGE);
 }
 
 /*****************************************************************************
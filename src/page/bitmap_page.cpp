@@ -10,17 +10,24 @@ bool BitmapPage<PageSize>::AllocatePage(uint32_t &page_offset) {
   }
   uint32_t n_byte_index = next_free_page_ / 8;
   uint8_t n_bit_index = next_free_page_ % 8;
+  if (next_free_page_ >= MAX_CHARS * 8 || !IsPageFreeLow(n_byte_index, n_bit_index)) {
+    return false;//next_free_page_ does not match page_allocated_, the page is corrupted
+  }
   bytes[n_byte_index] |= (1 << n_bit_index);
   page_offset = next_free_page_;
-  for(uint32_t i=0;i<MAX_CHARS*8;i++){
-    uint32_t byte_index = i / 8;
-    uint8_t bit_index = i % 8;
-    if(IsPageFreeLow(byte_index,bit_index)){
-      next_free_page_ = i;
-      break ;
+  page_allocated_+=1;
+  //从刚分配的位置向后找下一个空闲页，跳过全满的字节，到末尾后从头回绕
+  next_free_page_ = MAX_CHARS * 8;
+  if (page_allocated_ == MAX_CHARS * 8) {
+    return true;
+  }
+  for (uint32_t i = 0; i < MAX_CHARS; i++) {
+    uint32_t byte_index = (n_byte_index + i) % MAX_CHARS;
+    if (bytes[byte_index] != 0xFF) {
+      next_free_page_ = byte_index * 8 + __builtin_ctz(static_cast<unsigned char>(~bytes[byte_index]));
+      break;
     }
   }
-  page_allocated_+=1;
   return true;
 }
 
@@ -37,7 +44,10 @@ bool BitmapPage<PageSize>::DeAllocatePage(uint32_t page_offset) {
   }
   bytes[byte_index] &= ~(1 << bit_index);
   page_allocated_-=1;
-  next_free_page_ = page_offset;
+  //总是优先分配最小的空闲页
+  if (page_offset < next_free_page_ || next_free_page_ >= MAX_CHARS * 8) {
+    next_free_page_ = page_offset;
+  }
   return true;
 }
 
@@ -0,0 +1,20 @@
+#include "page/free_space_map_page.h"
+
+int FreeSpaceMapPage::Append(page_id_t page_id, uint8_t category) {
+  if (count_ >= MAX_ENTRY_COUNT) {
+    return -1;
+  }
+  page_ids_[count_] = page_id;
+  Categories()[count_] = category;
+  return static_cast<int>(count_++);
+}
+
+uint8_t FreeSpaceMapPage::ToCategory(uint32_t free_space) {
+  uint32_t category = free_space / CATEGORY_BYTES;
+  return category > UINT8_MAX ? UINT8_MAX : static_cast<uint8_t>(category);
+}
+
+uint8_t FreeSpaceMapPage::RequiredCategory(uint32_t free_space) {
+  uint32_t category = (free_space + CATEGORY_BYTES - 1) / CATEGORY_BYTES;
+  return category > UINT8_MAX ? UINT8_MAX : static_cast<uint8_t>(category);
+}
@@ -0,0 +1,86 @@
+#include "page/overflow_page.h"
+
+#include <algorithm>
+#include <memory>
+
+page_id_t OverflowPage::WriteValue(BufferPoolManager *buffer_pool_manager, const char *data, uint32_t size) {
+  page_id_t first_page_id = INVALID_PAGE_ID;
+  OverflowPage *prev_page = nullptr;
+  page_id_t prev_page_id = INVALID_PAGE_ID;
+  uint32_t written = 0;
+  do {
+    page_id_t page_id;
+    auto page = buffer_pool_manager->NewPage(page_id);
+    if (page == nullptr) {
+      if (prev_page != nullptr) {
+        prev_page->next_page_id_ = INVALID_PAGE_ID;
+        buffer_pool_manager->UnpinPage(prev_page_id, true);
+      }
+      FreeValue(buffer_pool_manager, first_page_id);
+      return INVALID_PAGE_ID;
+    }
+    auto overflow_page = reinterpret_cast<OverflowPage *>(page->GetData());
+    overflow_page->next_page_id_ = INVALID_PAGE_ID;
+    overflow_page->data_size_ = std::min(size - written, MAX_DATA_SIZE);
+    memcpy(overflow_page->data_, data + written, overflow_page->data_size_);
+    written += overflow_page->data_size_;
+    if (prev_page != nullptr) {
+      prev_page->next_page_id_ = page_id;
+      buffer_pool_manager->UnpinPage(prev_page_id, true);
+    } else {
+      first_page_id = page_id;
+    }
+    prev_page = overflow_page;
+    prev_page_id = page_id;
+  } while (written < size);
+  buffer_pool_manager->UnpinPage(prev_page_id, true);
+  return first_page_id;
+}
+
+bool OverflowPage::ReadValue(BufferPoolManager *buffer_pool_manager, page_id_t first_page_id, char *out,
+                             uint32_t size) {
+  uint32_t read = 0;
+  for (page_id_t page_id = first_page_id; page_id != INVALID_PAGE_ID && read < size;) {
+    auto page = buffer_pool_manager->FetchPage(page_id);
+    if (page == nullptr) {
+      return false;
+    }
+    auto overflow_page = reinterpret_cast<const OverflowPage *>(page->GetData());
+    uint32_t data_size = std::min(overflow_page->data_size_, size - read);
+    memcpy(out + read, overflow_page->data_, data_size);
+    read += data_size;
+    page_id_t next_page_id = overflow_page->next_page_id_;
+    buffer_pool_manager->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+  return read == size;
+}
+
+void OverflowPage::FreeValue(BufferPoolManager *buffer_pool_manager, page_id_t first_page_id) {
+  for (page_id_t page_id = first_page_id; page_id != INVALID_PAGE_ID;) {
+    auto page = buffer_pool_manager->FetchPage(page_id);
+    if (page == nullptr) {
+      return;
+    }
+    page_id_t next_page_id = reinterpret_cast<const OverflowPage *>(page->GetData())->next_page_id_;
+    buffer_pool_manager->UnpinPage(page_id, false);
+    buffer_pool_manager->DeletePage(page_id);
+    page_id = next_page_id;
+  }
+}
+
+bool OverflowPage::ReadExternalValues(BufferPoolManager *buffer_pool_manager, Row *row) {
+  bool result = true;
+  auto &fields = row->GetFields();
+  for (const auto &value : row->GetExternalValues()) {
+    std::unique_ptr<char[]> data(new char[value.length]);
+    if (!ReadValue(buffer_pool_manager, value.first_page_id, data.get(), value.length)) {
+      result = false;
+      continue;
+    }
+    delete fields[value.column_idx];
+    fields[value.column_idx] = new Field(kTypeChar, data.get(), value.length, true);
+  }
+  row->ClearExternalValues();
+  return result;
+}
@@ -0,0 +1,196 @@
+#include "page/pax_page.h"
+
+bool PaxPage::CanStore(const Schema *schema) {
+  if (!schema->CanBeFixedWidth(PAGE_SIZE / MIN_CAPACITY)) {
+    return false;
+  }
+  uint32_t row_width = 0;
+  for (uint32_t i = 0; i < schema->GetColumnCount(); i++) {
+    const Column *col = schema->GetColumn(i);
+    row_width += col->GetType() == kTypeChar ? (sizeof(uint32_t) + col->GetLength() + 3) / 4 * 4 : col->GetLength();
+  }
+  return ComputeCapacity(schema->GetColumnCount(), row_width) >= MIN_CAPACITY;
+}
+
+uint32_t PaxPage::GetTupleSpace(const Schema *schema) {
+  uint32_t column_count = schema->GetColumnCount();
+  // the values plus one bit in each minipage's null bitmap and in the used and deleted bitmaps
+  return schema->GetFixedSize() - schema->GetFixedOffset(0) + (column_count + 2 + 7) / 8;
+}
+
+uint32_t PaxPage::ComputeLayoutSize(uint32_t column_count, uint32_t row_width, uint32_t capacity) {
+  return OFFSET_MINIPAGES + sizeof(uint32_t) * column_count + BitmapSize(capacity) * (column_count + 2) +
+         capacity * row_width;
+}
+
+uint32_t PaxPage::ComputeCapacity(uint32_t column_count, uint32_t row_width) {
+  uint32_t header_size = OFFSET_MINIPAGES + sizeof(uint32_t) * column_count;
+  if (header_size >= PAGE_SIZE) {
+    return 0;
+  }
+  // start from the capacity ignoring the padding of the bitmaps, then back off until the page fits
+  uint32_t capacity = (PAGE_SIZE - header_size) * 8 / (row_width * 8 + column_count + 2);
+  while (capacity > 0 && ComputeLayoutSize(column_count, row_width, capacity) > PAGE_SIZE) {
+    capacity--;
+  }
+  return capacity;
+}
+
+void PaxPage::Init(page_id_t page_id, page_id_t prev_id, const Schema *schema, [[maybe_unused]] LogManager *log_mgr,
+                   [[maybe_unused]] Transaction *txn) {
+  ASSERT(schema->IsFixedWidth(), "PAX pages need a fixed-width schema.");
+  memcpy(GetData(), &page_id, sizeof(page_id));
+  SetPrevPageId(prev_id);
+  SetNextPageId(INVALID_PAGE_ID);
+  uint32_t column_count = schema->GetColumnCount();
+  uint32_t row_width = schema->GetFixedSize() - schema->GetFixedOffset(0);
+  uint32_t capacity = ComputeCapacity(column_count, row_width);
+  ASSERT(capacity > 0, "Row too wide for a PAX page.");
+  uint32_t tuple_space = GetTupleSpace(schema);
+  memcpy(GetData() + OFFSET_CAPACITY, &capacity, sizeof(uint32_t));
+  memcpy(GetData() + OFFSET_TUPLE_SPACE, &tuple_space, sizeof(uint32_t));
+  memcpy(GetData() + OFFSET_COLUMN_COUNT, &column_count, sizeof(uint32_t));
+  SetTupleCount(0);
+  // the used and deleted bitmaps come first, then one minipage per column
+  uint32_t bitmap_size = BitmapSize(capacity);
+  memset(GetUsedBitmap(), 0, bitmap_size * 2);
+  uint32_t offset = OFFSET_MINIPAGES + sizeof(uint32_t) * column_count + bitmap_size * 2;
+  for (uint32_t i = 0; i < column_count; i++) {
+    memcpy(GetData() + OFFSET_MINIPAGES + sizeof(uint32_t) * i, &offset, sizeof(uint32_t));
+    memset(GetData() + offset, 0, bitmap_size);
+    offset += bitmap_size + capacity * schema->GetFixedSlotSize(i);
+  }
+}
+
+void PaxPage::WriteSlot(uint32_t slot, const Row &row, const Schema *schema) {
+  for (uint32_t i = 0; i < schema->GetColumnCount(); i++) {
+    char *null_bitmap = GetData() + GetMinipageOffset(i);
+    uint32_t slot_size = schema->GetFixedSlotSize(i);
+    char *value = null_bitmap + GetBitmapSize() + slot * slot_size;
+    memset(value, 0, slot_size);
+    Field *field = row.GetField(i);
+    if (field->IsNull()) {
+      SetBit(null_bitmap, slot);
+    } else {
+      ClearBit(null_bitmap, slot);
+      field->SerializeTo(value);
+    }
+  }
+}
+
+bool PaxPage::InsertTuple(Row &row, Schema *schema, [[maybe_unused]] Transaction *txn,
+                          [[maybe_unused]] LockManager *lock_manager, [[maybe_unused]] LogManager *log_manager) {
+  ASSERT(row.GetFieldCount() == GetColumnCount(), "Fields size do not match the page's column count.");
+  uint32_t capacity = GetCapacity();
+  if (GetTupleCount() == capacity || !row.FitsSchema(schema)) {
+    return false;
+  }
+  // the first free slot, whole bytes of the used bitmap are skipped at a time
+  char *used = GetUsedBitmap();
+  uint32_t slot = 0;
+  while (static_cast<uint8_t>(used[slot / 8]) == 0xFF) {
+    slot += 8;
+  }
+  while (TestBit(used, slot)) {
+    slot++;
+  }
+  ASSERT(slot < capacity, "Used bitmap does not match the tuple count.");
+  WriteSlot(slot, row, schema);
+  SetBit(used, slot);
+  ClearBit(GetDeletedBitmap(), slot);
+  SetTupleCount(GetTupleCount() + 1);
+  row.SetRowId(RowId(GetTablePageId(), slot));
+  return true;
+}
+
+bool PaxPage::MarkDelete(const RowId &rid, [[maybe_unused]] Transaction *txn,
+                         [[maybe_unused]] LockManager *lock_manager, [[maybe_unused]] LogManager *log_manager) {
+  if (!IsLive(rid.GetSlotNum())) {
+    return false;
+  }
+  SetBit(GetDeletedBitmap(), rid.GetSlotNum());
+  return true;
+}
+
+bool PaxPage::UpdateTuple(const Row &new_row, Row *old_row, Schema *schema, Transaction *txn,
+                          LockManager *lock_manager, [[maybe_unused]] LogManager *log_manager) {
+  ASSERT(old_row != nullptr && old_row->GetRowId().Get() != INVALID_ROWID.Get(), "invalid old row.");
+  uint32_t slot = old_row->GetRowId().GetSlotNum();
+  if (!IsLive(slot) || !new_row.FitsSchema(schema)) {
+    return false;
+  }
+  GetTuple(old_row, schema, txn, lock_manager);
+  WriteSlot(slot, new_row, schema);
+  return true;
+}
+
+void PaxPage::ApplyDelete(const RowId &rid, [[maybe_unused]] Transaction *txn,
+                          [[maybe_unused]] LogManager *log_manager) {
+  uint32_t slot = rid.GetSlotNum();
+  ASSERT(slot < GetCapacity() && TestBit(GetUsedBitmap(), slot), "Cannot have more slots than tuples.");
+  ClearBit(GetUsedBitmap(), slot);
+  ClearBit(GetDeletedBitmap(), slot);
+  SetTupleCount(GetTupleCount() - 1);
+}
+
+void PaxPage::RollbackDelete(const RowId &rid, [[maybe_unused]] Transaction *txn,
+                             [[maybe_unused]] LogManager *log_manager) {
+  uint32_t slot = rid.GetSlotNum();
+  ASSERT(slot < GetCapacity() && TestBit(GetUsedBitmap(), slot), "We can't have more slots than tuples.");
+  ClearBit(GetDeletedBitmap(), slot);
+}
+
+bool PaxPage::GetTuple(Row *row, Schema *schema, [[maybe_unused]] Transaction *txn,
+                       [[maybe_unused]] LockManager *lock_manager, const std::vector<bool> *needed_columns) {
+  ASSERT(row != nullptr && row->GetFieldCount() == 0, "Non empty field in row.");
+  uint32_t slot = row->GetRowId().GetSlotNum();
+  if (!IsLive(slot)) {
+    return false;
+  }
+  uint32_t column_count = schema->GetColumnCount();
+  auto &fields = row->GetFields();
+  fields.resize(column_count);
+  for (uint32_t i = 0; i < column_count; i++) {
+    TypeId type = schema->GetColumn(i)->GetType();
+    if (needed_columns != nullptr && i < needed_columns->size() && !(*needed_columns)[i]) {
+      fields[i] = new Field(type);
+      continue;
+    }
+    char *null_bitmap = GetData() + GetMinipageOffset(i);
+    char *value = null_bitmap + GetBitmapSize() + slot * schema->GetFixedSlotSize(i);
+    Field::DeserializeFrom(value, type, &fields[i], TestBit(null_bitmap, slot));
+  }
+  return true;
+}
+
+bool PaxPage::GetFirstTupleRid(RowId *first_rid) {
+  for (uint32_t i = 0; i < GetCapacity(); i++) {
+    if (IsLive(i)) {
+      first_rid->Set(GetTablePageId(), i);
+      return true;
+    }
+  }
+  first_rid->Set(INVALID_PAGE_ID, 0);
+  return false;
+}
+
+bool PaxPage::GetNextTupleRid(const RowId &cur_rid, RowId *next_rid) {
+  ASSERT(cur_rid.GetPageId() == GetTablePageId(), "Wrong table!");
+  for (uint32_t i = cur_rid.GetSlotNum() + 1; i < GetCapacity(); i++) {
+    if (IsLive(i)) {
+      next_rid->Set(GetTablePageId(), i);
+      return true;
+    }
+  }
+  next_rid->Set(INVALID_PAGE_ID, 0);
+  return false;
+}
+
+void PaxPage::GetTupleSpans(std::vector<TupleSpan> *spans) {
+  page_id_t page_id = GetTablePageId();
+  for (uint32_t i = 0; i < GetCapacity(); i++) {
+    if (IsLive(i)) {
+      spans->push_back({RowId(page_id, i), i, 0});
+    }
+  }
+}
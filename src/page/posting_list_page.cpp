@@ -0,0 +1,212 @@
+#include "page/posting_list_page.h"
+
+#include <algorithm>
+#include <cstring>
+
+page_id_t PostingListPage::Create(BufferPoolManager *buffer_pool_manager, const std::vector<RowId> &rids) {
+  page_id_t first_page_id = INVALID_PAGE_ID;
+  PostingListPage *prev_page = nullptr;
+  page_id_t prev_page_id = INVALID_PAGE_ID;
+  size_t written = 0;
+  do {
+    page_id_t page_id;
+    auto page = buffer_pool_manager->NewPage(page_id);
+    if (page == nullptr) {
+      if (prev_page != nullptr) {
+        buffer_pool_manager->UnpinPage(prev_page_id, true);
+      }
+      Free(buffer_pool_manager, first_page_id);
+      return INVALID_PAGE_ID;
+    }
+    auto posting_page = reinterpret_cast<PostingListPage *>(page->GetData());
+    posting_page->next_page_id_ = INVALID_PAGE_ID;
+    posting_page->size_ = std::min<size_t>(rids.size() - written, MAX_SIZE);
+    memcpy(posting_page->rids_, rids.data() + written, posting_page->size_ * sizeof(RowId));
+    written += posting_page->size_;
+    if (prev_page != nullptr) {
+      prev_page->next_page_id_ = page_id;
+      buffer_pool_manager->UnpinPage(prev_page_id, true);
+    } else {
+      first_page_id = page_id;
+    }
+    prev_page = posting_page;
+    prev_page_id = page_id;
+  } while (written < rids.size());
+  buffer_pool_manager->UnpinPage(prev_page_id, true);
+  return first_page_id;
+}
+
+bool PostingListPage::Insert(BufferPoolManager *buffer_pool_manager, page_id_t first_page_id, const RowId &rid) {
+  page_id_t page_id = first_page_id;
+  Page *page = buffer_pool_manager->FetchPage(page_id);
+  if (page == nullptr) {
+    return false;
+  }
+  auto posting_page = reinterpret_cast<PostingListPage *>(page->GetData());
+  // the page holding the first RowId not less than rid, or the last page
+  while (posting_page->next_page_id_ != INVALID_PAGE_ID &&
+         posting_page->rids_[posting_page->size_ - 1].Get() < rid.Get()) {
+    page_id_t next_page_id = posting_page->next_page_id_;
+    buffer_pool_manager->UnpinPage(page_id, false);
+    page_id = next_page_id;
+    page = buffer_pool_manager->FetchPage(page_id);
+    if (page == nullptr) {
+      return false;
+    }
+    posting_page = reinterpret_cast<PostingListPage *>(page->GetData());
+  }
+  uint32_t index = posting_page->LowerBound(rid);
+  if (index < posting_page->size_ && posting_page->rids_[index] == rid) {
+    buffer_pool_manager->UnpinPage(page_id, false);
+    return false;
+  }
+  if (posting_page->size_ == MAX_SIZE) {
+    // 页满时把后一半移到新页
+    page_id_t new_page_id;
+    Page *new_page = buffer_pool_manager->NewPage(new_page_id);
+    if (new_page == nullptr) {
+      buffer_pool_manager->UnpinPage(page_id, false);
+      return false;
+    }
+    auto new_posting_page = reinterpret_cast<PostingListPage *>(new_page->GetData());
+    uint32_t keep = MAX_SIZE / 2;
+    new_posting_page->next_page_id_ = posting_page->next_page_id_;
+    new_posting_page->size_ = MAX_SIZE - keep;
+    memcpy(new_posting_page->rids_, posting_page->rids_ + keep, new_posting_page->size_ * sizeof(RowId));
+    posting_page->next_page_id_ = new_page_id;
+    posting_page->size_ = keep;
+    if (index > keep) {
+      buffer_pool_manager->UnpinPage(page_id, true);
+      page_id = new_page_id;
+      posting_page = new_posting_page;
+      index -= keep;
+    } else {
+      buffer_pool_manager->UnpinPage(new_page_id, true);
+    }
+  }
+  memmove(posting_page->rids_ + index + 1, posting_page->rids_ + index, (posting_page->size_ - index) * sizeof(RowId));
+  posting_page->rids_[index] = rid;
+  posting_page->size_++;
+  buffer_pool_manager->UnpinPage(page_id, true);
+  return true;
+}
+
+bool PostingListPage::Remove(BufferPoolManager *buffer_pool_manager, page_id_t first_page_id, const RowId &rid,
+                             RowId *only_left) {
+  *only_left = INVALID_ROWID;
+  page_id_t prev_page_id = INVALID_PAGE_ID;
+  PostingListPage *prev_page = nullptr;
+  page_id_t page_id = first_page_id;
+  Page *page = buffer_pool_manager->FetchPage(page_id);
+  if (page == nullptr) {
+    return false;
+  }
+  auto posting_page = reinterpret_cast<PostingListPage *>(page->GetData());
+  // the previous page stays pinned, it is relinked if the page becomes empty
+  while (posting_page->next_page_id_ != INVALID_PAGE_ID &&
+         posting_page->rids_[posting_page->size_ - 1].Get() < rid.Get()) {
+    page_id_t next_page_id = posting_page->next_page_id_;
+    Page *next_page = buffer_pool_manager->FetchPage(next_page_id);
+    if (next_page == nullptr) {
+      buffer_pool_manager->UnpinPage(page_id, false);
+      if (prev_page != nullptr) {
+        buffer_pool_manager->UnpinPage(prev_page_id, false);
+      }
+      return false;
+    }
+    if (prev_page != nullptr) {
+      buffer_pool_manager->UnpinPage(prev_page_id, false);
+    }
+    prev_page_id = page_id;
+    prev_page = posting_page;
+    page_id = next_page_id;
+    posting_page = reinterpret_cast<PostingListPage *>(next_page->GetData());
+  }
+  uint32_t index = posting_page->LowerBound(rid);
+  if (index == posting_page->size_ || !(posting_page->rids_[index] == rid)) {
+    buffer_pool_manager->UnpinPage(page_id, false);
+    if (prev_page != nullptr) {
+      buffer_pool_manager->UnpinPage(prev_page_id, false);
+    }
+    return false;
+  }
+  posting_page->size_--;
+  memmove(posting_page->rids_ + index, posting_page->rids_ + index + 1, (posting_page->size_ - index) * sizeof(RowId));
+  bool prev_dirty = false;
+  if (posting_page->size_ == 0) {
+    page_id_t next_page_id = posting_page->next_page_id_;
+    if (prev_page != nullptr) {
+      prev_page->next_page_id_ = next_page_id;
+      prev_dirty = true;
+      buffer_pool_manager->UnpinPage(page_id, false);
+      buffer_pool_manager->DeletePage(page_id);
+      page_id = INVALID_PAGE_ID;
+    } else if (next_page_id != INVALID_PAGE_ID) {
+      // 首页被引用，不能删除，把下一页搬进来
+      Page *next_page = buffer_pool_manager->FetchPage(next_page_id);
+      if (next_page != nullptr) {
+        memcpy(posting_page, next_page->GetData(), PAGE_SIZE);
+        buffer_pool_manager->UnpinPage(next_page_id, false);
+        buffer_pool_manager->DeletePage(next_page_id);
+      }
+    }
+  }
+  if (page_id != INVALID_PAGE_ID) {
+    buffer_pool_manager->UnpinPage(page_id, true);
+  }
+  if (prev_page != nullptr) {
+    buffer_pool_manager->UnpinPage(prev_page_id, prev_dirty);
+  }
+  Page *first_page = buffer_pool_manager->FetchPage(first_page_id);
+  if (first_page != nullptr) {
+    auto first_posting_page = reinterpret_cast<PostingListPage *>(first_page->GetData());
+    if (first_posting_page->size_ == 1 && first_posting_page->next_page_id_ == INVALID_PAGE_ID) {
+      *only_left = first_posting_page->rids_[0];
+    }
+    buffer_pool_manager->UnpinPage(first_page_id, false);
+  }
+  return true;
+}
+
+bool PostingListPage::Read(BufferPoolManager *buffer_pool_manager, page_id_t first_page_id,
+                           std::vector<RowId> *result) {
+  for (page_id_t page_id = first_page_id; page_id != INVALID_PAGE_ID;) {
+    auto page = buffer_pool_manager->FetchPage(page_id);
+    if (page == nullptr) {
+      return false;
+    }
+    auto posting_page = reinterpret_cast<const PostingListPage *>(page->GetData());
+    result->insert(result->end(), posting_page->rids_, posting_page->rids_ + posting_page->size_);
+    page_id_t next_page_id = posting_page->next_page_id_;
+    buffer_pool_manager->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+  return true;
+}
+
+void PostingListPage::Free(BufferPoolManager *buffer_pool_manager, page_id_t first_page_id) {
+  for (page_id_t page_id = first_page_id; page_id != INVALID_PAGE_ID;) {
+    auto page = buffer_pool_manager->FetchPage(page_id);
+    if (page == nullptr) {
+      return;
+    }
+    page_id_t next_page_id = reinterpret_cast<const PostingListPage *>(page->GetData())->next_page_id_;
+    buffer_pool_manager->UnpinPage(page_id, false);
+    buffer_pool_manager->DeletePage(page_id);
+    page_id = next_page_id;
+  }
+}
+
+uint32_t PostingListPage::LowerBound(const RowId &rid) const {
+  uint32_t left = 0;
+  uint32_t right = size_;
+  while (left < right) {
+    uint32_t mid = (left + right) / 2;
+    if (rids_[mid].Get() < rid.Get()) {
+      left = mid + 1;
+    } else {
+      right = mid;
+    }
+  }
+  return left;
+}
@@ -10,8 +10,19 @@ void TablePage::Init(page_id_t page_id, page_id_t prev_id, LogManager *log_mgr,
 
 bool TablePage::InsertTuple(Row &row, Schema *schema, Transaction *txn, LockManager *lock_manager,
                             LogManager *log_manager) {
+  return PlaceTuple(row, schema, nullptr);
+}
+
+bool TablePage::InsertRelocatedTuple(Row &row, const RowId &home_rid, Schema *schema, Transaction *txn,
+                                     LockManager *lock_manager, LogManager *log_manager) {
+  return PlaceTuple(row, schema, &home_rid);
+}
+
+bool TablePage::PlaceTuple(Row &row, Schema *schema, const RowId *home_rid) {
+  uint32_t header_size = home_rid == nullptr ? 0 : SIZE_ROW_ID;
   uint32_t serialized_size = row.GetSerializedSize(schema);
   ASSERT(serialized_size > 0, "Can not have empty row.");
+  serialized_size += header_size;
   if (GetFreeSpaceRemaining() < serialized_size + SIZE_TUPLE) {
     return false;
   }
@@ -30,12 +41,16 @@ bool TablePage::InsertTuple(Row &row, Schema *schema, Transaction *txn, LockMana
   // Otherwise we claim available free space..
   SetFreeSpacePointer(GetFreeSpacePointer() - serialized_size);//设置空位大小
   //freeSpacePointer = GetData() + OFFSET_FREE_SPACE
-  uint32_t __attribute__((unused)) write_bytes = row.SerializeTo( reinterpret_cast<char*>(GetData() + GetFreeSpacePointer()), schema);
-  ASSERT(write_bytes == serialized_size, "Unexpected behavior in row serialize.");
+  if (home_rid != nullptr) {
+    int64_t home = home_rid->Get();
+    memcpy(GetData() + GetFreeSpacePointer(), &home, SIZE_ROW_ID);
+  }
+  uint32_t __attribute__((unused)) write_bytes = row.SerializeTo( reinterpret_cast<char*>(GetData() + GetFreeSpacePointer() + header_size), schema);
+  ASSERT(write_bytes + header_size == serialized_size, "Unexpected behavior in row serialize.");
 
   // Set the tuple.
   SetTupleOffsetAtSlot(i, GetFreeSpacePointer());
-  SetTupleSize(i, serialized_size);
+  SetTupleSize(i, home_rid == nullptr ? serialized_size : serialized_size | RELOCATED_MASK);
   // Set rid
   row.SetRowId(RowId(GetTablePageId(), i));
   if (i == GetTupleCount()) {
@@ -73,34 +88,79 @@ bool TablePage::UpdateTuple(const Row &new_row, Row *old_row, Schema *schema, Tr
     return false;
   }
   uint32_t tuple_size = GetTupleSize(slot_num);
-  // If the tuple is deleted, abort.
-  if (IsDeleted(tuple_size)) {
+  // If the tuple is deleted or lives in another slot, abort.
+  if (IsDeleted(tuple_size) || IsForward(tuple_size)) {
     return false;
   }
-  // If there is not enough space to update, we need to update via delete followed by an insert (not enough space).
-  if (GetFreeSpaceRemaining() + tuple_size < serialized_size) {
+  // A relocated tuple keeps its home rid in front of it.
+  uint32_t header_size = IsRelocated(tuple_size) ? SIZE_ROW_ID : 0;
+  uint32_t stored_size = GetStoredSize(tuple_size);
+  // If there is not enough space to update, the caller has to move the tuple to another page.
+  if (GetFreeSpaceRemaining() + stored_size < serialized_size + header_size) {
     return false;
   }
   // Copy out the old value.
   uint32_t tuple_offset = GetTupleOffsetAtSlot(slot_num);
-  uint32_t __attribute__((unused)) read_bytes = old_row->DeserializeFrom(GetData() + tuple_offset, schema);
-  ASSERT(tuple_size == read_bytes, "Unexpected behavior in tuple deserialize.");
+  uint32_t __attribute__((unused)) read_bytes = old_row->DeserializeFrom(GetData() + tuple_offset + header_size, schema);
+  ASSERT(stored_size == read_bytes + header_size, "Unexpected behavior in tuple deserialize.");
+  int64_t home = 0;
+  memcpy(&home, GetData() + tuple_offset, header_size);
+  // The tuple grows or shrinks in place, the tuples in front of it are shifted.
+  uint32_t new_offset = ResizeTuple(slot_num, serialized_size + header_size);
+  memcpy(GetData() + new_offset, &home, header_size);
+  new_row.SerializeTo(GetData() + new_offset + header_size, schema);
+  SetTupleSize(slot_num, (tuple_size & RELOCATED_MASK) | (serialized_size + header_size));
+  return true;
+}
+
+bool TablePage::GetForwardRowId(const RowId &rid, RowId *target) {
+  uint32_t slot_num = rid.GetSlotNum();
+  if (slot_num >= GetTupleCount() || !IsForward(GetTupleSize(slot_num))) {
+    return false;
+  }
+  int64_t forward;
+  memcpy(&forward, GetData() + GetTupleOffsetAtSlot(slot_num), SIZE_ROW_ID);
+  *target = RowId(forward);
+  return true;
+}
+
+bool TablePage::SetForwardRowId(const RowId &rid, const RowId &target) {
+  uint32_t slot_num = rid.GetSlotNum();
+  if (slot_num >= GetTupleCount()) {
+    return false;
+  }
+  uint32_t tuple_size = GetTupleSize(slot_num);
+  if (IsDeleted(tuple_size) || IsRelocated(tuple_size)) {
+    return false;
+  }
+  if (GetFreeSpaceRemaining() + GetStoredSize(tuple_size) < SIZE_ROW_ID) {
+    return false;
+  }
+  // The tuple is replaced by the rid of the slot that holds it from now on.
+  uint32_t new_offset = ResizeTuple(slot_num, SIZE_ROW_ID);
+  int64_t forward = target.Get();
+  memcpy(GetData() + new_offset, &forward, SIZE_ROW_ID);
+  SetTupleSize(slot_num, SIZE_ROW_ID | FORWARD_MASK);
+  return true;
+}
+
+uint32_t TablePage::ResizeTuple(uint32_t slot_num, uint32_t new_size) {
+  uint32_t tuple_offset = GetTupleOffsetAtSlot(slot_num);
+  uint32_t tuple_size = GetStoredSize(GetTupleSize(slot_num));
   uint32_t free_space_pointer = GetFreeSpacePointer();
   ASSERT(tuple_offset >= free_space_pointer, "Offset should appear after current free space position.");
-  memmove(GetData() + free_space_pointer + tuple_size - serialized_size, GetData() + free_space_pointer,
+  memmove(GetData() + free_space_pointer + tuple_size - new_size, GetData() + free_space_pointer,
           tuple_offset - free_space_pointer);
-  SetFreeSpacePointer(free_space_pointer + tuple_size - serialized_size);
-  new_row.SerializeTo(GetData() + tuple_offset + tuple_size - serialized_size, schema);
-  SetTupleSize(slot_num, serialized_size);
+  SetFreeSpacePointer(free_space_pointer + tuple_size - new_size);
 
-  // Update all tuple offsets.
+  // Update all tuple offsets, the resized tuple included.
   for (uint32_t i = 0; i < GetTupleCount(); ++i) {
     uint32_t tuple_offset_i = GetTupleOffsetAtSlot(i);
     if (GetTupleSize(i) > 0 && tuple_offset_i < tuple_offset + tuple_size) {
-      SetTupleOffsetAtSlot(i, tuple_offset_i + tuple_size - new_row.GetSerializedSize(schema));
+      SetTupleOffsetAtSlot(i, tuple_offset_i + tuple_size - new_size);
     }
   }
-  return true;
+  return tuple_offset + tuple_size - new_size;
 }
 
 void TablePage::ApplyDelete(const RowId &rid, Transaction *txn, LogManager *log_manager) {
@@ -108,11 +168,8 @@ void TablePage::ApplyDelete(const RowId &rid, Transaction *txn, LogManager *log_
   ASSERT(slot_num < GetTupleCount(), "Cannot have more slots than tuples.");
 
   uint32_t tuple_offset = GetTupleOffsetAtSlot(slot_num);
-  uint32_t tuple_size = GetTupleSize(slot_num);
   // Check if this is a delete operation, i.e. commit a delete.
-  if (IsDeleted(tuple_size)) {
-    tuple_size = UnsetDeletedFlag(tuple_size);
-  }
+  uint32_t tuple_size = GetStoredSize(GetTupleSize(slot_num));
 
   uint32_t free_space_pointer = GetFreeSpacePointer();
   ASSERT(tuple_offset >= free_space_pointer, "Free space appears before tuples.");
@@ -120,8 +177,8 @@ void TablePage::ApplyDelete(const RowId &rid, Transaction *txn, LogManager *log_
   memmove(GetData() + free_space_pointer + tuple_size, GetData() + free_space_pointer,
           tuple_offset - free_space_pointer);
   SetFreeSpacePointer(free_space_pointer + tuple_size);
+  // the slot stays allocated, it is reused by the next insert into this page
   SetTupleSize(slot_num, 0);
-  SetTupleCount(GetTupleCount() - 1);
   SetTupleOffsetAtSlot(slot_num, 0);
 
   // Update all tuple offsets.
@@ -154,21 +211,22 @@ bool TablePage::GetTuple(Row *row, Schema *schema, Transaction *txn, LockManager
   }
   // Otherwise get the current tuple size too.
   uint32_t tuple_size = GetTupleSize(slot_num);
-  // If the tuple is deleted, abort the transaction.
-  if (IsDeleted(tuple_size)) {
+  // If the tuple is deleted or lives in another slot, abort the transaction.
+  if (IsDeleted(tuple_size) || IsForward(tuple_size)) {
     return false;
   }
   // At this point, we have at least a shared lock on the RID. Copy the tuple data into our result.
+  uint32_t header_size = IsRelocated(tuple_size) ? SIZE_ROW_ID : 0;
   uint32_t tuple_offset = GetTupleOffsetAtSlot(slot_num);
-  uint32_t __attribute__((unused)) read_bytes = row->DeserializeFrom(GetData() + tuple_offset, schema);
-  ASSERT(tuple_size == read_bytes, "Unexpected behavior in tuple deserialize.");
+  uint32_t __attribute__((unused)) read_bytes = row->DeserializeFrom(GetData() + tuple_offset + header_size, schema);
+  ASSERT(GetStoredSize(tuple_size) == read_bytes + header_size, "Unexpected behavior in tuple deserialize.");
   return true;
 }
 
 bool TablePage::GetFirstTupleRid(RowId *first_rid) {
-  // Find and return the first valid tuple.
+  // Find and return the first valid tuple, relocated tuples are reached through their home slot.
   for (uint32_t i = 0; i < GetTupleCount(); i++) {
-    if (!IsDeleted(GetTupleSize(i))) {
+    if (!IsDeleted(GetTupleSize(i)) && !IsRelocated(GetTupleSize(i))) {
       first_rid->Set(GetTablePageId(), i);
       return true;
     }
@@ -177,11 +235,32 @@ bool TablePage::GetFirstTupleRid(RowId *first_rid) {
   return false;
 }
 
+void TablePage::GetTupleSpans(std::vector<TupleSpan> *spans) {
+  page_id_t page_id = GetTablePageId();
+  uint32_t tuple_count = GetTupleCount();
+  for (uint32_t i = 0; i < tuple_count; i++) {
+    uint32_t tuple_size = GetTupleSize(i);
+    if (IsDeleted(tuple_size) || IsForward(tuple_size)) {
+      continue;
+    }
+    uint32_t tuple_offset = GetTupleOffsetAtSlot(i);
+    if (IsRelocated(tuple_size)) {
+      // a relocated tuple is scanned where it lies, under the rid of its home slot
+      int64_t home;
+      memcpy(&home, GetData() + tuple_offset, SIZE_ROW_ID);
+      spans->push_back({RowId(home), static_cast<uint32_t>(tuple_offset + SIZE_ROW_ID),
+                        static_cast<uint32_t>(GetStoredSize(tuple_size) - SIZE_ROW_ID)});
+    } else {
+      spans->push_back({RowId(page_id, i), tuple_offset, tuple_size});
+    }
+  }
+}
+
 bool TablePage::GetNextTupleRid(const RowId &cur_rid, RowId *next_rid) {
   ASSERT(cur_rid.GetPageId() == GetTablePageId(), "Wrong table!");
   // Find and return the first valid tuple after our current slot number.
   for (auto i = cur_rid.GetSlotNum() + 1; i < GetTupleCount(); i++) {
-    if (!IsDeleted(GetTupleSize(i))) {
+    if (!IsDeleted(GetTupleSize(i)) && !IsRelocated(GetTupleSize(i))) {
       next_rid->Set(GetTablePageId(), i);
       return true;
     }
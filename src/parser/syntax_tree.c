@@ -169,6 +169,8 @@ const char *GetSyntaxNodeTypeStr(SyntaxNodeType type) {
       return "kNodeTrxCommit";
     case kNodeTrxRollback:
       return "kNodeTrxRollback";
+    case kNodeTableFormat:
+      return "kNodeTableFormat";
     default:
       return "error type";
   }
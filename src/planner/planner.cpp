@@ -49,7 +49,9 @@ AbstractPlanNodeRef Planner::PlanSelect(std::shared_ptr<SelectStatement> stateme
     }
   }
   if (available_index.empty() || statement->has_or) {
-    return make_shared<SeqScanPlanNode>(out_schema, statement->table_name_, statement->where_);
+    // a select only reads the table, its scan can be split across threads and skip the columns nobody reads
+    return make_shared<SeqScanPlanNode>(out_schema, statement->table_name_, statement->where_, true,
+                                        MakeColumnMask(statement));
   }
   return make_shared<IndexScanPlanNode>(out_schema, statement->table_name_, available_index,
                                         available_index.size() != statement->column_in_condition_.size(),
@@ -76,6 +78,19 @@ AbstractPlanNodeRef Planner::PlanUpdate(std::shared_ptr<UpdateStatement> stateme
                                           statement->update_attrs);
 }
 
+std::vector<bool> Planner::MakeColumnMask(const std::shared_ptr<SelectStatement> &statement) {
+  TableInfo *info = nullptr;
+  context_->GetCatalog()->GetTable(statement->table_name_, info);
+  std::vector<bool> column_mask(info->GetSchema()->GetColumnCount(), false);
+  for (const auto &column : statement->column_list_) {
+    column_mask[column.second->GetColIdx()] = true;
+  }
+  for (auto col_id : statement->column_in_condition_) {
+    column_mask[col_id] = true;
+  }
+  return column_mask;
+}
+
 Schema *Planner::MakeOutputSchema(const vector<std::pair<std::string, AbstractExpressionRef>> &exprs) {
   std::vector<Column *> cols;
   cols.reserve(exprs.size());
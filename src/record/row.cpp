@@ -7,6 +7,9 @@
 uint32_t Row::SerializeTo(char *buf, Schema *schema) const {
   ASSERT(schema != nullptr, "Invalid schema before serialize.");
   ASSERT(schema->GetColumnCount() == fields_.size(), "Fields size do not match schema's column size.");
+  if(schema->IsFixedWidth()){
+    return SerializeFixedTo(buf, schema);
+  }
   uint32_t cur = 0;
   uint32_t field_num = fields_.size();
   memcpy(buf+cur,&field_num,sizeof(uint32_t));cur+=sizeof(uint32_t);
@@ -19,6 +22,11 @@ uint32_t Row::SerializeTo(char *buf, Schema *schema) const {
     Field *field = fields_[i];
     if(field->IsNull()){
       bitmap[i/8] |= (1<<(i%8));
+    }else if(const ExternalValue *external = FindExternal(i)){
+      //只写指向overflow page的指针
+      MACH_WRITE_UINT32(buf+cur,external->length|EXTERNAL_FLAG);
+      MACH_WRITE_INT32(buf+cur+sizeof(uint32_t),external->first_page_id);
+      cur+=EXTERNAL_POINTER_SIZE;
     }else{
       cur+=field->SerializeTo(buf+cur);
     }
@@ -30,16 +38,22 @@ uint32_t Row::SerializeTo(char *buf, Schema *schema) const {
 uint32_t Row::DeserializeFrom(char *buf, Schema *schema) {
   ASSERT(schema != nullptr, "Invalid schema before serialize.");
   ASSERT(fields_.empty(), "Non empty field in row.");//只有空的row可以用这个方法解析
+  if(schema->IsFixedWidth()){
+    return DeserializeFixedFrom(buf, schema, nullptr);
+  }
   uint32_t cur=0;
   uint32_t field_num;
   memcpy(&field_num,buf+cur,sizeof(uint32_t));cur+=sizeof(uint32_t);
 
   char* bitmap = buf+cur;
   uint32_t bitmap_len = (field_num+7)/8;
-  memset(bitmap,0,bitmap_len);cur+=bitmap_len;
+  cur+=bitmap_len;
   fields_.clear();fields_.resize(field_num);
+  external_.clear();
   for(uint32_t i=0;i<field_num;i++){
-    if(bitmap[i/8]&(1<<(i%8))){
+    if(IsExternalAt(buf+cur,schema->GetColumns()[i]->GetType(),bitmap[i/8]&(1<<(i%8)))){
+      cur+=DeserializeExternalFrom(buf+cur,i);
+    }else if(bitmap[i/8]&(1<<(i%8))){
       cur+=Field::DeserializeFrom(buf+cur,schema->GetColumns()[i]->GetType(),&fields_[i], true);
     }else{
       cur+=Field::DeserializeFrom(buf+cur,schema->GetColumns()[i]->GetType(),&fields_[i],false);
@@ -48,20 +62,129 @@ uint32_t Row::DeserializeFrom(char *buf, Schema *schema) {
   return cur;
 }
 
+uint32_t Row::DeserializeFrom(char *buf, Schema *schema, const std::vector<bool> &needed_columns) {
+  ASSERT(schema != nullptr, "Invalid schema before serialize.");
+  ASSERT(fields_.empty(), "Non empty field in row.");
+  if(schema->IsFixedWidth()){
+    return DeserializeFixedFrom(buf, schema, &needed_columns);
+  }
+  uint32_t cur=0;
+  uint32_t field_num;
+  memcpy(&field_num,buf+cur,sizeof(uint32_t));cur+=sizeof(uint32_t);
+
+  char* bitmap = buf+cur;
+  uint32_t bitmap_len = (field_num+7)/8;
+  cur+=bitmap_len;
+  fields_.resize(field_num);
+  external_.clear();
+  for(uint32_t i=0;i<field_num;i++){
+    TypeId type = schema->GetColumns()[i]->GetType();
+    bool is_null = bitmap[i/8]&(1<<(i%8));
+    bool external = IsExternalAt(buf+cur,type,is_null);
+    if(i<needed_columns.size() && !needed_columns[i]){
+      //没人读的列只跳过它的字节，不拷贝字符串，也不读overflow page
+      fields_[i] = new Field(type);
+      if(external){
+        cur += EXTERNAL_POINTER_SIZE;
+      }else if(!is_null){
+        cur += type==kTypeChar ? sizeof(uint32_t)+MACH_READ_UINT32(buf+cur) : Type::GetTypeSize(type);
+      }
+      continue;
+    }
+    if(external){
+      cur+=DeserializeExternalFrom(buf+cur,i);
+      continue;
+    }
+    cur+=Field::DeserializeFrom(buf+cur,type,&fields_[i],is_null);
+  }
+  return cur;
+}
+
 uint32_t Row::GetSerializedSize(Schema *schema) const {
   ASSERT(schema != nullptr, "Invalid schema before serialize.");
   ASSERT(schema->GetColumnCount() == fields_.size(), "Fields size do not match schema's column size.");
+  if(schema->IsFixedWidth()){
+    return schema->GetFixedSize();
+  }
   uint32_t size = 0;
   size+=sizeof(uint32_t);
   size+=(fields_.size()+7)/8;
   for(uint32_t i=0;i<fields_.size();i++){
     if(!fields_[i]->IsNull()){
-      size+=fields_[i]->GetSerializedSize();
+      size+=FindExternal(i)!=nullptr ? EXTERNAL_POINTER_SIZE : fields_[i]->GetSerializedSize();
     }
   }
   return size;
 }
 
+void Row::SetExternal(uint32_t idx, page_id_t first_page_id) {
+  ASSERT(idx < fields_.size() && fields_[idx]->GetTypeId() == kTypeChar && !fields_[idx]->IsNull(),
+         "Only a char value can be stored out of line.");
+  ASSERT(FindExternal(idx) == nullptr, "The value is already stored out of line.");
+  external_.push_back({idx, fields_[idx]->GetLength(), first_page_id});
+}
+
+bool Row::IsExternal(uint32_t idx) const { return FindExternal(idx) != nullptr; }
+
+const Row::ExternalValue *Row::FindExternal(uint32_t idx) const {
+  for (const auto &external : external_) {
+    if (external.column_idx == idx) {
+      return &external;
+    }
+  }
+  return nullptr;
+}
+
+uint32_t Row::DeserializeExternalFrom(const char *buf, uint32_t idx) {
+  fields_[idx] = new Field(kTypeChar);
+  external_.push_back({idx, MACH_READ_UINT32(buf) & ~EXTERNAL_FLAG, MACH_READ_INT32(buf + sizeof(uint32_t))});
+  return EXTERNAL_POINTER_SIZE;
+}
+
+bool Row::FitsSchema(const Schema *schema) const {
+  if(!schema->IsFixedWidth()){
+    return true;
+  }
+  for(uint32_t i=0;i<fields_.size();i++){
+    const Column *col = schema->GetColumn(i);
+    if(col->GetType()==kTypeChar && !fields_[i]->IsNull() && fields_[i]->GetLength()>col->GetLength()){
+      return false;
+    }
+  }
+  return true;
+}
+
+//null_bitmap+slot1+slot2 ... 每个slot的位置由schema给出
+uint32_t Row::SerializeFixedTo(char *buf, Schema *schema) const {
+  ASSERT(FitsSchema(schema), "Char field longer than its column.");
+  ASSERT(external_.empty(), "The fixed-width format stores no value out of line.");
+  uint32_t size = schema->GetFixedSize();
+  memset(buf,0,size);//null的slot和char的空余部分都填0
+  for(uint32_t i=0;i<fields_.size();i++){
+    if(fields_[i]->IsNull()){
+      buf[i/8] |= (1<<(i%8));
+    }else{
+      fields_[i]->SerializeTo(buf+schema->GetFixedOffset(i));
+    }
+  }
+  return size;
+}
+
+uint32_t Row::DeserializeFixedFrom(char *buf, Schema *schema, const std::vector<bool> *needed_columns) {
+  uint32_t field_num = schema->GetColumnCount();
+  fields_.resize(field_num);
+  for(uint32_t i=0;i<field_num;i++){
+    TypeId type = schema->GetColumn(i)->GetType();
+    bool is_null = buf[i/8]&(1<<(i%8));
+    if(needed_columns!=nullptr && i<needed_columns->size() && !(*needed_columns)[i]){
+      fields_[i] = new Field(type);
+      continue;
+    }
+    Field::DeserializeFrom(buf+schema->GetFixedOffset(i),type,&fields_[i],is_null);
+  }
+  return schema->GetFixedSize();
+}
+
 void Row::GetKeyFromRow(const Schema *schema, const Schema *key_schema, Row &key_row) {
   auto columns = key_schema->GetColumns();
   std::vector<Field> fields;
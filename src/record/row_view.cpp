@@ -0,0 +1,181 @@
+#include "record/row_view.h"
+
+#include <algorithm>
+#include <memory>
+
+#include "page/overflow_page.h"
+
+void RowView::Reset(const char *data, const Schema *schema, RowId rid) {
+  data_ = data;
+  schema_ = schema;
+  buffer_pool_manager_ = nullptr;
+  rid_ = rid;
+  null_bitmaps_ = values_ = nullptr;
+  if (schema->IsFixedWidth()) {
+    field_count_ = schema->GetColumnCount();
+    bitmap_ = data;
+    return;
+  }
+  field_count_ = MACH_READ_UINT32(data);
+  bitmap_ = data + sizeof(uint32_t);
+  cached_idx_ = 0;
+  cached_offset_ = sizeof(uint32_t) + (field_count_ + 7) / 8;
+}
+
+void RowView::ResetColumnar(const char *const *null_bitmaps, const char *const *values, uint32_t slot,
+                            const Schema *schema, RowId rid) {
+  ASSERT(schema->IsFixedWidth(), "PAX tuples use the fixed-width format.");
+  data_ = nullptr;
+  schema_ = schema;
+  buffer_pool_manager_ = nullptr;
+  rid_ = rid;
+  field_count_ = schema->GetColumnCount();
+  bitmap_ = nullptr;
+  null_bitmaps_ = null_bitmaps;
+  values_ = values;
+  slot_ = slot;
+}
+
+const char *RowView::GetFieldData(uint32_t idx) const {
+  if (values_ != nullptr) {
+    return values_[idx] + slot_ * schema_->GetFixedSlotSize(idx);
+  }
+  return data_ + GetFieldOffset(idx);
+}
+
+int32_t RowView::GetInt(uint32_t idx) const {
+  ASSERT(!IsNull(idx), "Reading a null field.");
+  return MACH_READ_FROM(int32_t, GetFieldData(idx));
+}
+
+float RowView::GetFloat(uint32_t idx) const {
+  ASSERT(!IsNull(idx), "Reading a null field.");
+  return MACH_READ_FROM(float, GetFieldData(idx));
+}
+
+bool RowView::IsExternal(uint32_t idx) const {
+  if (values_ != nullptr || schema_->IsFixedWidth() || IsNull(idx) || schema_->GetColumn(idx)->GetType() != kTypeChar) {
+    return false;
+  }
+  return MACH_READ_UINT32(GetFieldData(idx)) & Row::EXTERNAL_FLAG;
+}
+
+Row::ExternalValue RowView::GetExternalValue(uint32_t idx) const {
+  ASSERT(IsExternal(idx), "The value is stored in the tuple.");
+  const char *buf = GetFieldData(idx);
+  return {idx, MACH_READ_UINT32(buf) & ~Row::EXTERNAL_FLAG, MACH_READ_INT32(buf + sizeof(uint32_t))};
+}
+
+const char *RowView::GetChars(uint32_t idx, uint32_t *len) const {
+  ASSERT(!IsNull(idx), "Reading a null field.");
+  ASSERT(!IsExternal(idx), "Reading an out-of-line value in place.");
+  const char *buf = GetFieldData(idx);
+  *len = MACH_READ_UINT32(buf);
+  return buf + sizeof(uint32_t);
+}
+
+Field RowView::GetField(uint32_t idx) const {
+  TypeId type = schema_->GetColumn(idx)->GetType();
+  if (IsNull(idx)) {
+    return Field(type);
+  }
+  switch (type) {
+    case kTypeInt:
+      return Field(kTypeInt, GetInt(idx));
+    case kTypeFloat:
+      return Field(kTypeFloat, GetFloat(idx));
+    case kTypeChar: {
+      if (IsExternal(idx)) {
+        ASSERT(buffer_pool_manager_ != nullptr, "No buffer pool to read an out-of-line value from.");
+        Row::ExternalValue value = GetExternalValue(idx);
+        std::unique_ptr<char[]> data(new char[value.length]);
+        if (!OverflowPage::ReadValue(buffer_pool_manager_, value.first_page_id, data.get(), value.length)) {
+          return Field(kTypeChar);
+        }
+        return Field(kTypeChar, data.get(), value.length, true);
+      }
+      uint32_t len;
+      const char *chars = GetChars(idx, &len);
+      return Field(kTypeChar, const_cast<char *>(chars), len, false);
+    }
+    default:
+      throw std::runtime_error("Unsupported field type in row view.");
+  }
+}
+
+int RowView::CompareField(uint32_t idx, const RowView &other, uint32_t other_idx) const {
+  if (IsNull(idx) || other.IsNull(other_idx)) {
+    return 0;
+  }
+  switch (schema_->GetColumn(idx)->GetType()) {
+    case kTypeInt: {
+      int32_t lhs = GetInt(idx), rhs = other.GetInt(other_idx);
+      return lhs < rhs ? -1 : (lhs > rhs ? 1 : 0);
+    }
+    case kTypeFloat: {
+      float lhs = GetFloat(idx), rhs = other.GetFloat(other_idx);
+      return lhs < rhs ? -1 : (lhs > rhs ? 1 : 0);
+    }
+    case kTypeChar: {
+      uint32_t lhs_len, rhs_len;
+      const char *lhs = GetChars(idx, &lhs_len);
+      const char *rhs = other.GetChars(other_idx, &rhs_len);
+      int ret = memcmp(lhs, rhs, std::min(lhs_len, rhs_len));
+      if (ret == 0 && lhs_len != rhs_len) {
+        ret = lhs_len < rhs_len ? -1 : 1;
+      }
+      return ret;
+    }
+    default:
+      throw std::runtime_error("Unsupported field type in row view.");
+  }
+}
+
+uint32_t RowView::GetFieldOffset(uint32_t idx) const {
+  ASSERT(idx <= field_count_, "Field index out of range.");
+  ASSERT(values_ == nullptr, "A PAX tuple has no offsets.");
+  if (schema_->IsFixedWidth()) {
+    return idx == field_count_ ? schema_->GetFixedSize() : schema_->GetFixedOffset(idx);
+  }
+  if (idx < cached_idx_) {
+    cached_idx_ = 0;
+    cached_offset_ = sizeof(uint32_t) + (field_count_ + 7) / 8;
+  }
+  while (cached_idx_ < idx) {
+    cached_offset_ += GetFieldSize(cached_idx_);
+    cached_idx_++;
+  }
+  return cached_offset_;
+}
+
+uint32_t RowView::GetFieldSize(uint32_t idx) const {
+  if (IsNull(idx)) {
+    return 0;
+  }
+  TypeId type = schema_->GetColumn(idx)->GetType();
+  if (type == kTypeChar) {
+    // the length prefix is read at the column's offset, which is decoded first
+    uint32_t len = MACH_READ_UINT32(GetFieldData(idx));
+    return len & Row::EXTERNAL_FLAG ? Row::EXTERNAL_POINTER_SIZE : sizeof(uint32_t) + len;
+  }
+  return Type::GetTypeSize(type);
+}
+
+uint32_t RowView::GetSerializedSize() const { return GetFieldOffset(field_count_); }
+
+void RowView::ToRow(Row *row) const {
+  row->SetRowId(rid_);
+  if (values_ != nullptr) {
+    auto &fields = row->GetFields();
+    fields.resize(field_count_);
+    for (uint32_t i = 0; i < field_count_; i++) {
+      Field::DeserializeFrom(const_cast<char *>(GetFieldData(i)), schema_->GetColumn(i)->GetType(), &fields[i],
+                             IsNull(i));
+    }
+    return;
+  }
+  row->DeserializeFrom(const_cast<char *>(data_), const_cast<Schema *>(schema_));
+  if (buffer_pool_manager_ != nullptr && !row->GetExternalValues().empty()) {
+    OverflowPage::ReadExternalValues(buffer_pool_manager_, row);
+  }
+}
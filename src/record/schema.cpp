@@ -43,4 +43,61 @@ uint32_t Schema::DeserializeFrom(char *buf, Schema *&schema) {
   }
   schema = new Schema(columns, true);//默认is_manage都是true，是否manage不应该在这里判断
   return cur;
-}
\ No newline at end of file
+}
+
+/**
+ * slot size of a column in the fixed-width format, 0 if the column has no bounded size
+ */
+static uint32_t FixedSlotSize(const Column *col) {
+  switch (col->GetType()) {
+    case kTypeInt:
+    case kTypeFloat:
+      return col->GetLength();
+    case kTypeChar:
+      return (sizeof(uint32_t) + col->GetLength() + 3) / 4 * 4;
+    default:
+      return 0;
+  }
+}
+
+bool Schema::CanBeFixedWidth(uint32_t max_size) const {
+  if (columns_.empty()) {
+    return false;
+  }
+  uint32_t size = (GetColumnCount() + 31) / 32 * 4;
+  for (const auto *col : columns_) {
+    uint32_t slot = FixedSlotSize(col);
+    if (slot == 0 || slot > max_size) {
+      return false;
+    }
+    size += slot;
+  }
+  return size <= max_size;
+}
+
+void Schema::SetFixedWidth(bool fixed_width) {
+  fixed_width_ = fixed_width;
+  fixed_offsets_.clear();
+  fixed_size_ = 0;
+  if (!fixed_width) {
+    columnar_ = false;
+    return;
+  }
+  //bitmap按4字节对齐，之后每个slot也是4字节的倍数
+  uint32_t cur = (GetColumnCount() + 31) / 32 * 4;
+  fixed_offsets_.reserve(columns_.size());
+  for (const auto *col : columns_) {
+    uint32_t slot = FixedSlotSize(col);
+    ASSERT(slot != 0, "Column type has no fixed width.");
+    fixed_offsets_.push_back(cur);
+    cur += slot;
+  }
+  fixed_size_ = cur;
+}
+
+void Schema::SetColumnar(bool columnar) {
+  if (columnar && !fixed_width_) {
+    SetFixedWidth(true);
+  }
+  columnar_ = columnar;
+}
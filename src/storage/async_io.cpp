@@ -0,0 +1,329 @@
+#include "storage/async_io.h"
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include "common/macros.h"
+#include "glog/logging.h"
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#define MINISQL_HAVE_IO_URING 1
+#endif
+
+/*****************************************************************************
+ * AsyncIOHandle
+ *****************************************************************************/
+AsyncIOHandle::AsyncIOHandle(bool is_write, int fd, char *data, size_t size, size_t offset,
+                             std::function<void(ssize_t)> on_complete)
+    : is_write_(is_write), fd_(fd), offset_(offset), on_complete_(std::move(on_complete)) {
+  iov_.iov_base = data;
+  iov_.iov_len = size;
+}
+
+IOHandle AsyncIOHandle::Completed(bool ok) {
+  auto handle = std::make_shared<AsyncIOHandle>(false, -1, nullptr, 0, 0);
+  handle->done_ = true;
+  handle->ok_ = ok;
+  return handle;
+}
+
+bool AsyncIOHandle::Wait() {
+  std::unique_lock<std::mutex> lock(latch_);
+  cv_.wait(lock, [this] { return done_; });
+  return ok_;
+}
+
+bool AsyncIOHandle::IsDone() {
+  std::scoped_lock<std::mutex> lock(latch_);
+  return done_;
+}
+
+void AsyncIOHandle::Complete(ssize_t result) {
+  if (on_complete_) {
+    on_complete_(result);
+  }
+  std::scoped_lock<std::mutex> lock(latch_);
+  done_ = true;
+  ok_ = result >= 0;
+  cv_.notify_all();
+}
+
+std::unique_ptr<AsyncIOEngine> AsyncIOEngine::Create(size_t queue_depth) {
+  auto io_uring = IoUringIOEngine::Create(queue_depth);
+  if (io_uring != nullptr) {
+    return io_uring;
+  }
+  return std::make_unique<ThreadPoolIOEngine>();
+}
+
+/*****************************************************************************
+ * IoUringIOEngine
+ *****************************************************************************/
+#ifdef MINISQL_HAVE_IO_URING
+// liburing is not required, the three system calls are used directly
+static int IoUringSetup(unsigned entries, struct io_uring_params *params) {
+  return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+static int IoUringEnter(int ring_fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+  return static_cast<int>(syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+std::unique_ptr<IoUringIOEngine> IoUringIOEngine::Create(size_t queue_depth) {
+  struct io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  int ring_fd = IoUringSetup(queue_depth, &params);
+  if (ring_fd < 0) {
+    return nullptr;
+  }
+  std::unique_ptr<IoUringIOEngine> engine(new IoUringIOEngine());
+  engine->ring_fd_ = ring_fd;
+  engine->sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  engine->cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+  if (params.features & IORING_FEAT_SINGLE_MMAP) {
+    engine->sq_ring_size_ = engine->cq_ring_size_ = std::max(engine->sq_ring_size_, engine->cq_ring_size_);
+  }
+  engine->sq_ring_ = mmap(nullptr, engine->sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd,
+                          IORING_OFF_SQ_RING);
+  if (engine->sq_ring_ == MAP_FAILED) {
+    engine->sq_ring_ = nullptr;
+    return nullptr;
+  }
+  if (params.features & IORING_FEAT_SINGLE_MMAP) {
+    engine->cq_ring_ = engine->sq_ring_;
+  } else {
+    engine->cq_ring_ = mmap(nullptr, engine->cq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd,
+                            IORING_OFF_CQ_RING);
+    if (engine->cq_ring_ == MAP_FAILED) {
+      engine->cq_ring_ = nullptr;
+      return nullptr;
+    }
+  }
+  engine->sqes_size_ = params.sq_entries * sizeof(struct io_uring_sqe);
+  engine->sqes_ = mmap(nullptr, engine->sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd,
+                       IORING_OFF_SQES);
+  if (engine->sqes_ == MAP_FAILED) {
+    engine->sqes_ = nullptr;
+    return nullptr;
+  }
+  auto *sq = static_cast<char *>(engine->sq_ring_);
+  engine->sq_tail_ = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+  engine->sq_mask_ = reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+  engine->sq_array_ = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+  auto *cq = static_cast<char *>(engine->cq_ring_);
+  engine->cq_head_ = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+  engine->cq_tail_ = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+  engine->cq_mask_ = reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+  engine->cqes_ = cq + params.cq_off.cqes;
+  // the submission queue is drained by every io_uring_enter, bounding the requests in flight by the size of the
+  // submission queue keeps the completion queue from overflowing
+  engine->cq_entries_ = std::min(params.sq_entries, params.cq_entries);
+  engine->reaper_ = std::thread(&IoUringIOEngine::ReapCompletions, engine.get());
+  return engine;
+}
+
+IoUringIOEngine::~IoUringIOEngine() {
+  if (reaper_.joinable()) {
+    // wait for the requests in flight, then wake the reaper up with a nop carrying no handle
+    std::unique_lock<std::mutex> lock(submit_latch_);
+    submit_cv_.wait(lock, [this] { return in_flight_ == 0; });
+    PushSubmission(IORING_OP_NOP, -1, 0, 0, 0, 0);
+    lock.unlock();
+    reaper_.join();
+  }
+  if (sqes_ != nullptr) munmap(sqes_, sqes_size_);
+  if (cq_ring_ != nullptr && cq_ring_ != sq_ring_) munmap(cq_ring_, cq_ring_size_);
+  if (sq_ring_ != nullptr) munmap(sq_ring_, sq_ring_size_);
+  if (ring_fd_ >= 0) close(ring_fd_);
+}
+
+void IoUringIOEngine::Submit(const IOHandle &handle) {
+  std::unique_lock<std::mutex> lock(submit_latch_);
+  submit_cv_.wait(lock, [this] { return in_flight_ < cq_entries_; });
+  // the completion thread owns this reference until the request is reaped
+  auto *user_data = new IOHandle(handle);
+  int ret = PushRequest(user_data);
+  lock.unlock();
+  if (ret < 0) {
+    delete user_data;
+    handle->Complete(ret);
+  }
+}
+
+int IoUringIOEngine::PushRequest(IOHandle *handle) {
+  return PushSubmission((*handle)->is_write_ ? IORING_OP_WRITEV : IORING_OP_READV, (*handle)->fd_,
+                        reinterpret_cast<uint64_t>(&(*handle)->iov_), 1, (*handle)->offset_,
+                        reinterpret_cast<uint64_t>(handle));
+}
+
+int IoUringIOEngine::PushSubmission(uint8_t opcode, int fd, uint64_t addr, uint32_t len, uint64_t offset,
+                                    uint64_t user_data) {
+  unsigned tail = *sq_tail_;
+  unsigned index = tail & *sq_mask_;
+  auto *sqe = static_cast<struct io_uring_sqe *>(sqes_) + index;
+  memset(sqe, 0, sizeof(*sqe));
+  sqe->opcode = opcode;
+  sqe->fd = fd;
+  sqe->addr = addr;
+  sqe->len = len;
+  sqe->off = offset;
+  sqe->user_data = user_data;
+  sq_array_[index] = index;
+  __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+  int ret;
+  do {
+    ret = IoUringEnter(ring_fd_, 1, 0, 0);
+  } while (ret < 0 && (errno == EINTR || errno == EAGAIN || errno == EBUSY));
+  if (ret < 1) {
+    // the kernel did not take the entry, and no one else submits while submit_latch_ is held
+    int err = ret < 0 ? errno : EAGAIN;
+    LOG(ERROR) << "io_uring_enter failed: " << strerror(err);
+    __atomic_store_n(sq_tail_, tail, __ATOMIC_RELEASE);
+    return -err;
+  }
+  in_flight_++;
+  return 0;
+}
+
+void IoUringIOEngine::ReapCompletions() {
+  bool stop = false;
+  while (!stop) {
+    int ret = IoUringEnter(ring_fd_, 0, 1, IORING_ENTER_GETEVENTS);
+    if (ret < 0 && errno != EINTR) {
+      LOG(ERROR) << "io_uring_enter failed: " << strerror(errno);
+    }
+    unsigned head = *cq_head_;
+    unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+    unsigned reaped = 0;
+    std::vector<IOHandle *> partial;
+    for (; head != tail; head++, reaped++) {
+      auto *cqe = static_cast<struct io_uring_cqe *>(cqes_) + (head & *cq_mask_);
+      if (cqe->user_data == 0) {
+        stop = true;
+        continue;
+      }
+      auto *handle = reinterpret_cast<IOHandle *>(cqe->user_data);
+      auto &request = **handle;
+      int res = cqe->res;
+      if (res == -EINTR) {
+        partial.push_back(handle);
+        continue;
+      }
+      if (res > 0 && static_cast<size_t>(res) < request.iov_.iov_len) {
+        // a short transfer, the rest is submitted again like pread/pwrite would be called again
+        request.transferred_ += res;
+        request.iov_.iov_base = static_cast<char *>(request.iov_.iov_base) + res;
+        request.iov_.iov_len -= res;
+        request.offset_ += res;
+        partial.push_back(handle);
+        continue;
+      }
+      // 0 is the end of the file, the bytes transferred so far are the result
+      request.Complete(res < 0 ? res : static_cast<ssize_t>(request.transferred_ + res));
+      delete handle;
+    }
+    __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+    if (reaped > 0) {
+      std::vector<std::pair<IOHandle *, int>> failed;
+      {
+        std::scoped_lock<std::mutex> lock(submit_latch_);
+        // the resubmitted requests take the places of reaped ones, so in_flight_ stays within cq_entries_
+        in_flight_ -= reaped;
+        for (auto handle : partial) {
+          int ret = PushRequest(handle);
+          if (ret < 0) {
+            failed.emplace_back(handle, ret);
+          }
+        }
+        submit_cv_.notify_all();
+      }
+      for (auto &[handle, ret] : failed) {
+        (*handle)->Complete(ret);
+        delete handle;
+      }
+    }
+  }
+}
+#else
+std::unique_ptr<IoUringIOEngine> IoUringIOEngine::Create(size_t queue_depth) { return nullptr; }
+
+IoUringIOEngine::~IoUringIOEngine() = default;
+
+void IoUringIOEngine::Submit(const IOHandle &handle) { ASSERT(false, "io_uring is not available."); }
+
+int IoUringIOEngine::PushSubmission(uint8_t opcode, int fd, uint64_t addr, uint32_t len, uint64_t offset,
+                                    uint64_t user_data) {
+  return -ENOSYS;
+}
+
+int IoUringIOEngine::PushRequest(IOHandle *handle) { return -ENOSYS; }
+
+void IoUringIOEngine::ReapCompletions() {}
+#endif
+
+/*****************************************************************************
+ * ThreadPoolIOEngine
+ *****************************************************************************/
+ThreadPoolIOEngine::ThreadPoolIOEngine(size_t num_threads) {
+  for (size_t i = 0; i < num_threads; i++) {
+    workers_.emplace_back(&ThreadPoolIOEngine::Work, this);
+  }
+}
+
+ThreadPoolIOEngine::~ThreadPoolIOEngine() {
+  {
+    std::scoped_lock<std::mutex> lock(latch_);
+    stop_ = true;
+    cv_.notify_all();
+  }
+  for (auto &worker : workers_) {
+    worker.join();
+  }
+}
+
+void ThreadPoolIOEngine::Submit(const IOHandle &handle) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  queue_.push_back(handle);
+  cv_.notify_one();
+}
+
+void ThreadPoolIOEngine::Work() {
+  while (true) {
+    IOHandle handle;
+    {
+      std::unique_lock<std::mutex> lock(latch_);
+      // requests still queued are finished before the pool shuts down
+      cv_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+      if (queue_.empty()) {
+        return;
+      }
+      handle = std::move(queue_.front());
+      queue_.pop_front();
+    }
+    auto *data = static_cast<char *>(handle->iov_.iov_base);
+    size_t size = handle->iov_.iov_len;
+    size_t done = 0;
+    ssize_t result = 0;
+    while (done < size) {
+      ssize_t rc = handle->is_write_ ? pwrite(handle->fd_, data + done, size - done, handle->offset_ + done)
+                                     : pread(handle->fd_, data + done, size - done, handle->offset_ + done);
+      if (rc < 0 && errno == EINTR) {
+        continue;
+      }
+      if (rc < 0) {
+        result = -errno;
+        break;
+      }
+      if (rc == 0) {
+        break;
+      }
+      done += rc;
+    }
+    handle->Complete(result < 0 ? result : static_cast<ssize_t>(done));
+  }
+}
@@ -1,6 +1,9 @@
 #include "storage/disk_manager.h"
 
+#include <fcntl.h>
 #include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
 #include <filesystem>
 #include <stdexcept>
 
@@ -9,28 +12,45 @@
 
 DiskManager::DiskManager(const std::string &db_file) : file_name_(db_file) {
   std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
-  db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
-  // directory or file does not exist
-  if (!db_io_.is_open()) {
-    db_io_.clear();
-    // create a new file
-    std::filesystem::path p = db_file;
-    if (p.has_parent_path()) std::filesystem::create_directories(p.parent_path());
-    db_io_.open(db_file, std::ios::binary | std::ios::trunc | std::ios::out);
-    db_io_.close();
-    // reopen with original mode
-    db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
-    if (!db_io_.is_open()) {
-      throw std::exception();
-    }
+  // directory does not exist
+  std::filesystem::path p = db_file;
+  if (p.has_parent_path()) std::filesystem::create_directories(p.parent_path());
+  // open the file, create it if it does not exist
+  db_io_fd_ = open(db_file.c_str(), O_RDWR | O_CREAT, 0644);
+  if (db_io_fd_ < 0) {
+    throw std::exception();
   }
+  file_size_ = GetFileSize(db_io_fd_);
   ReadPhysicalPage(META_PAGE_ID, meta_data_);
+  auto meta_page = reinterpret_cast<DiskFileMetaPage *>(meta_data_);
+  for (uint32_t extent_id = 0; extent_id < meta_page->GetExtentNums(); extent_id++) {
+    if (meta_page->GetExtentUsedPage(extent_id) < BITMAP_SIZE) {
+      free_extents_.insert(extent_id);
+    }
+  }
+  io_engine_ = AsyncIOEngine::Create();
+}
+
+void DiskManager::Sync() {
+  std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
+  if (closed) {
+    return;
+  }
+  WriteBackAllocationPages();
+  if (fsync(db_io_fd_) != 0) {
+    LOG(ERROR) << "I/O error while syncing " << file_name_;
+  }
 }
 
 void DiskManager::Close() {
+  std::unique_lock<std::shared_mutex> close_lock(close_latch_);
   std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
   if (!closed) {
-    db_io_.close();
+    // finish the requests in flight before the file goes away
+    io_engine_.reset();
+    Sync();
+    close(db_io_fd_);
+    db_io_fd_ = -1;
     closed = true;
   }
 }
@@ -45,36 +65,81 @@ void DiskManager::WritePage(page_id_t logical_page_id, const char *page_data) {
   WritePhysicalPage(MapPageId(logical_page_id), page_data);
 }
 
+IOHandle DiskManager::ReadPageAsync(page_id_t logical_page_id, char *page_data) {
+  ASSERT(logical_page_id >= 0, "Invalid page id.");
+  std::shared_lock<std::shared_mutex> close_lock(close_latch_);
+  size_t offset = static_cast<size_t>(MapPageId(logical_page_id)) * PAGE_SIZE;
+  if (closed || offset >= file_size_.load(std::memory_order_acquire)) {
+    memset(page_data, 0, PAGE_SIZE);
+    return AsyncIOHandle::Completed(true);
+  }
+  auto handle = std::make_shared<AsyncIOHandle>(false, db_io_fd_, page_data, PAGE_SIZE, offset, [page_data](ssize_t rc) {
+    if (rc < 0) {
+      LOG(ERROR) << "I/O error while reading";
+    }
+    // if file ends before reading PAGE_SIZE
+    size_t read_count = rc < 0 ? 0 : static_cast<size_t>(rc);
+    if (read_count < PAGE_SIZE) {
+      memset(page_data + read_count, 0, PAGE_SIZE - read_count);
+    }
+  });
+  io_engine_->Submit(handle);
+  return handle;
+}
+
+IOHandle DiskManager::WritePageAsync(page_id_t logical_page_id, const char *page_data) {
+  ASSERT(logical_page_id >= 0, "Invalid page id.");
+  std::shared_lock<std::shared_mutex> close_lock(close_latch_);
+  if (closed) {
+    return AsyncIOHandle::Completed(true);
+  }
+  size_t offset = static_cast<size_t>(MapPageId(logical_page_id)) * PAGE_SIZE;
+  auto handle = std::make_shared<AsyncIOHandle>(
+      true, db_io_fd_, const_cast<char *>(page_data), PAGE_SIZE, offset, [this, offset](ssize_t rc) {
+        if (rc != PAGE_SIZE) {
+          LOG(ERROR) << "I/O error while writing";
+          return;
+        }
+        size_t end = offset + PAGE_SIZE;
+        size_t file_size = file_size_.load(std::memory_order_relaxed);
+        while (file_size < end && !file_size_.compare_exchange_weak(file_size, end, std::memory_order_acq_rel)) {
+        }
+      });
+  io_engine_->Submit(handle);
+  return handle;
+}
+
 /**
  * TODO: Student Implement
  */
 page_id_t DiskManager::AllocatePage() {
+  std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
   //强制类型初始化，操作metaPage
   auto metaPage = reinterpret_cast<DiskFileMetaPage *>(meta_data_);
   if (metaPage->GetAllocatedPages() >= MAX_VALID_PAGE_ID) return INVALID_PAGE_ID;
 
-  //Find可分配page的extent
+  //Find可分配page的extent：优先用已有extent中的空闲页，否则开一个新的extent
   u_int32_t extentsN = metaPage->GetExtentNums();
-  u_int32_t extenti;
-  for(extenti = 0;extenti<extentsN;extenti++){
-    if(metaPage->extent_used_page_[extenti]<BITMAP_SIZE)
-      break;
-  }
-
-  //计算物理页号
-  u_int32_t physical_page_id = extenti * (BITMAP_SIZE + 1) + 1;//每个extent内有BITMAP_SIZE个数据页和一个位图页
-                                                               //再加上metaPage是物理页
-  char str[PAGE_SIZE]={'\0'};
-  ReadPhysicalPage(physical_page_id, str);
+  u_int32_t extenti = free_extents_.empty() ? extentsN : *free_extents_.begin();
 
   //处理位图页
-  BitmapPage<PAGE_SIZE> *bMap = reinterpret_cast<BitmapPage<PAGE_SIZE> *>(str);
+  BitmapPage<PAGE_SIZE> *bMap = GetBitmapPage(extenti);
   u_int32_t page_offset = 0;
-  bMap->AllocatePage(page_offset);
-  WritePhysicalPage(physical_page_id, str);
+  if (!bMap->AllocatePage(page_offset)) {
+    LOG(ERROR) << "Bitmap of extent " << extenti << " does not match the meta page";
+    free_extents_.erase(extenti);
+    return INVALID_PAGE_ID;
+  }
+  bitmap_dirty_[extenti] = true;
   metaPage->num_allocated_pages_++;
   metaPage->extent_used_page_[extenti]++;
   metaPage->num_extents_ = extenti + 1 > extentsN? extenti + 1: extentsN;
+  meta_dirty_ = true;
+  if (metaPage->extent_used_page_[extenti] < BITMAP_SIZE) {
+    free_extents_.insert(extenti);
+  } else {
+    free_extents_.erase(extenti);
+  }
   return  extenti * BITMAP_SIZE + page_offset;
 }
 
@@ -82,36 +147,68 @@ page_id_t DiskManager::AllocatePage() {
  * TODO: Student Implement
  */
 void DiskManager::DeAllocatePage(page_id_t logical_page_id) {
+  if (logical_page_id < 0 || logical_page_id > MAX_VALID_PAGE_ID) return;
+  std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
   //强制类型初始化，操作metaPage
   auto metaPage = reinterpret_cast<DiskFileMetaPage *>(meta_data_);
-
-  //计算物理页号
-  u_int32_t physical_page_id = logical_page_id + 1 + logical_page_id / BITMAP_SIZE - logical_page_id % BITMAP_SIZE;
-  char str[PAGE_SIZE]={'\0'};
-  ReadPhysicalPage(physical_page_id, str);
+  uint32_t extent_id = logical_page_id / BITMAP_SIZE;
+  if (extent_id >= metaPage->GetExtentNums()) {
+    return;//the extent has never been used
+  }
 
   //处理位图页
-  BitmapPage<PAGE_SIZE>* bMap = reinterpret_cast<BitmapPage<PAGE_SIZE>*>(str);
+  BitmapPage<PAGE_SIZE>* bMap = GetBitmapPage(extent_id);
   uint32_t page_offset = logical_page_id % BITMAP_SIZE;
-  bMap->DeAllocatePage(page_offset);
-  WritePhysicalPage(logical_page_id + 1 + logical_page_id / BITMAP_SIZE - logical_page_id % BITMAP_SIZE, str);
+  if (!bMap->DeAllocatePage(page_offset)) {
+    return;//page is already free
+  }
+  bitmap_dirty_[extent_id] = true;
   metaPage->num_allocated_pages_--;
-  metaPage->extent_used_page_[logical_page_id / BITMAP_SIZE]--;
+  metaPage->extent_used_page_[extent_id]--;
+  meta_dirty_ = true;
+  free_extents_.insert(extent_id);
 }
 
 /**
  * TODO: Student Implement
  */
 bool DiskManager::IsPageFree(page_id_t logical_page_id) {
-  if(logical_page_id > MAX_VALID_PAGE_ID) return false;
-  //计算物理页号
-  char str[PAGE_SIZE]={'\0'};
-  u_int32_t  physical_page_id = logical_page_id + 1 + logical_page_id / BITMAP_SIZE - logical_page_id % BITMAP_SIZE;
-  ReadPhysicalPage(physical_page_id, str);
+  if(logical_page_id < 0 || logical_page_id > MAX_VALID_PAGE_ID) return false;
+  std::scoped_lock<std::recursive_mutex> lock(db_io_latch_);
+  auto metaPage = reinterpret_cast<DiskFileMetaPage *>(meta_data_);
+  uint32_t extent_id = logical_page_id / BITMAP_SIZE;
+  if (extent_id >= metaPage->GetExtentNums()) {
+    return true;//the extent has never been used
+  }
 
   //处理位图页
-  BitmapPage<PAGE_SIZE> *bMap = reinterpret_cast<BitmapPage<PAGE_SIZE> *>(str);
-  return bMap->IsPageFree(logical_page_id % BITMAP_SIZE);
+  return GetBitmapPage(extent_id)->IsPageFree(logical_page_id % BITMAP_SIZE);
+}
+
+BitmapPage<PAGE_SIZE> *DiskManager::GetBitmapPage(uint32_t extent_id) {
+  if (extent_id >= bitmaps_.size()) {
+    bitmaps_.resize(extent_id + 1);
+    bitmap_dirty_.resize(extent_id + 1, false);
+  }
+  if (bitmaps_[extent_id] == nullptr) {
+    //每个extent内有BITMAP_SIZE个数据页和一个位图页，再加上metaPage是物理页
+    bitmaps_[extent_id] = std::make_unique<char[]>(PAGE_SIZE);
+    ReadPhysicalPage(extent_id * (BITMAP_SIZE + 1) + 1, bitmaps_[extent_id].get());
+  }
+  return reinterpret_cast<BitmapPage<PAGE_SIZE> *>(bitmaps_[extent_id].get());
+}
+
+void DiskManager::WriteBackAllocationPages() {
+  for (uint32_t extent_id = 0; extent_id < bitmaps_.size(); extent_id++) {
+    if (bitmap_dirty_[extent_id]) {
+      WritePhysicalPage(extent_id * (BITMAP_SIZE + 1) + 1, bitmaps_[extent_id].get());
+      bitmap_dirty_[extent_id] = false;
+    }
+  }
+  if (meta_dirty_) {
+    WritePhysicalPage(META_PAGE_ID, meta_data_);
+    meta_dirty_ = false;
+  }
 }
 
 /**
@@ -119,45 +216,67 @@ bool DiskManager::IsPageFree(page_id_t logical_page_id) {
  */
 page_id_t DiskManager::MapPageId(page_id_t logical_page_id) { return logical_page_id + 1 + logical_page_id / BITMAP_SIZE + 1; }
 
-int DiskManager::GetFileSize(const std::string &file_name) {
+size_t DiskManager::GetFileSize(int fd) {
   struct stat stat_buf;
-  int rc = stat(file_name.c_str(), &stat_buf);
-  return rc == 0 ? stat_buf.st_size : -1;
+  int rc = fstat(fd, &stat_buf);
+  return rc == 0 ? stat_buf.st_size : 0;
 }
 
 void DiskManager::ReadPhysicalPage(page_id_t physical_page_id, char *page_data) {
-  int offset = physical_page_id * PAGE_SIZE;
+  size_t offset = static_cast<size_t>(physical_page_id) * PAGE_SIZE;
   // check if read beyond file length
-  if (offset >= GetFileSize(file_name_)) {
+  if (closed || offset >= file_size_.load(std::memory_order_acquire)) {
 #ifdef ENABLE_BPM_DEBUG
     LOG(INFO) << "Read less than a page" << std::endl;
 #endif
     memset(page_data, 0, PAGE_SIZE);
-  } else {
-    // set read cursor to offset
-    db_io_.seekp(offset);
-    db_io_.read(page_data, PAGE_SIZE);
-    // if file ends before reading PAGE_SIZE
-    int read_count = db_io_.gcount();
-    if (read_count < PAGE_SIZE) {
+    return;
+  }
+  size_t read_count = 0;
+  while (read_count < PAGE_SIZE) {
+    ssize_t rc = pread(db_io_fd_, page_data + read_count, PAGE_SIZE - read_count, offset + read_count);
+    if (rc < 0 && errno == EINTR) {
+      continue;
+    }
+    if (rc < 0) {
+      LOG(ERROR) << "I/O error while reading";
+    }
+    if (rc <= 0) {
+      break;
+    }
+    read_count += rc;
+  }
+  // if file ends before reading PAGE_SIZE
+  if (read_count < PAGE_SIZE) {
 #ifdef ENABLE_BPM_DEBUG
-      LOG(INFO) << "Read less than a page" << std::endl;
+    LOG(INFO) << "Read less than a page" << std::endl;
 #endif
-      memset(page_data + read_count, 0, PAGE_SIZE - read_count);
-    }
+    memset(page_data + read_count, 0, PAGE_SIZE - read_count);
   }
 }
 
 void DiskManager::WritePhysicalPage(page_id_t physical_page_id, const char *page_data) {
-  size_t offset = static_cast<size_t>(physical_page_id) * PAGE_SIZE;
-  // set write cursor to offset
-  db_io_.seekp(offset);
-  db_io_.write(page_data, PAGE_SIZE);
-  // check for I/O error
-  if (db_io_.bad()) {
-    LOG(ERROR) << "I/O error while writing";
+  // writes after Close are dropped, e.g. a buffer pool destroyed after its disk manager was closed
+  if (closed) {
     return;
   }
-  // needs to flush to keep disk file in sync
-  db_io_.flush();
-}
\ No newline at end of file
+  size_t offset = static_cast<size_t>(physical_page_id) * PAGE_SIZE;
+  size_t write_count = 0;
+  while (write_count < PAGE_SIZE) {
+    ssize_t rc = pwrite(db_io_fd_, page_data + write_count, PAGE_SIZE - write_count, offset + write_count);
+    if (rc < 0 && errno == EINTR) {
+      continue;
+    }
+    // check for I/O error
+    if (rc <= 0) {
+      LOG(ERROR) << "I/O error while writing";
+      return;
+    }
+    write_count += rc;
+  }
+  // the file only grows, a concurrent write may already have extended it further
+  size_t end = offset + PAGE_SIZE;
+  size_t file_size = file_size_.load(std::memory_order_relaxed);
+  while (file_size < end && !file_size_.compare_exchange_weak(file_size, end, std::memory_order_acq_rel)) {
+  }
+}
@@ -0,0 +1,43 @@
+#include "storage/row_batch.h"
+
+#include "page/overflow_page.h"
+
+void RowBatch::GetRow(size_t i, Row *row, Schema *schema, const std::vector<bool> *needed_columns) const {
+  ASSERT(page_ != nullptr, "Reading from a released batch.");
+  row->SetRowId(spans_[i].rid);
+  if (columnar_) {
+    static_cast<PaxPage *>(page_)->GetTuple(row, schema, nullptr, nullptr, needed_columns);
+    return;
+  }
+  uint32_t __attribute__((unused)) read_bytes = needed_columns == nullptr
+                                                    ? row->DeserializeFrom(GetTupleData(i), schema)
+                                                    : row->DeserializeFrom(GetTupleData(i), schema, *needed_columns);
+  ASSERT(read_bytes == spans_[i].size, "Unexpected behavior in tuple deserialize.");
+  // only the out-of-line values of the needed columns are left to read
+  if (!row->GetExternalValues().empty()) {
+    OverflowPage::ReadExternalValues(buffer_pool_manager_, row);
+  }
+}
+
+void RowBatch::GetView(size_t i, const Schema *schema, RowView *view) const {
+  ASSERT(page_ != nullptr, "Reading from a released batch.");
+  if (columnar_) {
+    view->ResetColumnar(null_bitmaps_.data(), values_.data(), spans_[i].offset, schema, spans_[i].rid);
+  } else {
+    view->Reset(GetTupleData(i), schema, spans_[i].rid);
+    view->SetBufferPoolManager(buffer_pool_manager_);
+  }
+}
+
+void RowBatch::Release() {
+  if (page_ != nullptr) {
+    page_->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page_->GetTablePageId(), false);
+    page_ = nullptr;
+  }
+  spans_.clear();
+  columnar_ = false;
+  null_bitmaps_.clear();
+  values_.clear();
+  next_page_id_ = INVALID_PAGE_ID;
+}
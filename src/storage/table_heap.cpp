@@ -1,47 +1,219 @@
 #include "storage/table_heap.h"
 
+#include <algorithm>
+
+TableHeap::TableHeap(BufferPoolManager *buffer_pool_manager, Schema *schema, Transaction *txn,
+                     LogManager *log_manager, LockManager *lock_manager)
+    : buffer_pool_manager_(buffer_pool_manager),
+      schema_(schema),
+      log_manager_(log_manager),
+      lock_manager_(lock_manager),
+      columnar_(schema->IsColumnar()),
+      zone_map_(schema) {
+  page_id_t new_page_id;
+  auto new_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->NewPage(new_page_id));
+  ASSERT(new_page != nullptr, "Failed to allocate the first page of a table heap.");
+  first_page_id_ = new_page_id;
+  new_page->WLatch();
+  InitPage(new_page,new_page_id,INVALID_PAGE_ID,txn);
+  uint32_t free_space = PageFreeSpace(new_page);
+  new_page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(new_page_id, true);
+  std::scoped_lock<std::mutex> lock(fsm_latch_);
+  AddToFreeSpaceMap(new_page_id, free_space);
+}
+
+TableHeap::TableHeap(BufferPoolManager *buffer_pool_manager, page_id_t first_page_id, page_id_t fsm_page_id,
+                     Schema *schema, LogManager *log_manager, LockManager *lock_manager)
+    : buffer_pool_manager_(buffer_pool_manager),
+      first_page_id_(first_page_id),
+      fsm_page_id_(fsm_page_id),
+      schema_(schema),
+      log_manager_(log_manager),
+      lock_manager_(lock_manager),
+      columnar_(schema->IsColumnar()),
+      zone_map_(schema) {
+  LoadFreeSpaceMap();
+}
+
+bool TableHeap::InsertTuple(Row &row, Transaction *txn) {
+  if(!ToastRow(row)){
+    return false;
+  }
+  bool inserted = InsertToastedTuple(row, txn);
+  if(!inserted){
+    FreeExternalValues(row.GetExternalValues());
+  }
+  //元组里只存指针，调用者的row仍保留完整的值
+  row.ClearExternalValues();
+  return inserted;
+}
+
 /**
  * TODO: USE Transaction and lock
  */
-bool TableHeap::InsertTuple(Row &row, Transaction *txn) {
+bool TableHeap::InsertToastedTuple(Row &row, Transaction *txn, const RowId *home_rid) {
   uint32_t tuple_size = row.GetSerializedSize(schema_);
-  if(tuple_size>PAGE_SIZE){
+  uint32_t max_size = home_rid == nullptr ? TablePage::SIZE_MAX_ROW : TablePage::SIZE_MAX_RELOCATED_ROW;
+  if(tuple_size>max_size || !row.FitsSchema(schema_)){
     return false;
   }
-  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(first_page_id_));
-  if(page== nullptr)return false;
-  page->WLatch();
-  bool insertResult = page->InsertTuple(row,schema_,txn,lock_manager_,log_manager_);
-  page->WUnlatch();
-  buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
-  while(!insertResult){//break if success
-    page_id_t next_id = page->GetNextPageId();
-    if(next_id!=INVALID_PAGE_ID){
-      page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(next_id));
-      page->WLatch();
-      insertResult = page->InsertTuple(row,schema_,txn,lock_manager_,log_manager_);
-      page->WUnlatch();
-      buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
-    }else{
-      //attach a page
-      page_id_t new_page_id;
-      buffer_pool_manager_->NewPage(new_page_id);
-      auto new_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(new_page_id));
-      new_page->WLatch();
-      new_page->Init(new_page_id,page->GetPageId(),log_manager_,txn);
-      new_page->SetNextPageId(INVALID_PAGE_ID);
+  //room for the tuple and its slot, and for the home rid of a relocated tuple
+  uint32_t required = TupleSpace(row) + (home_rid == nullptr ? 0 : TablePage::SIZE_RELOCATION_HEADER);
+  std::unique_lock<std::mutex> append_lock(append_latch_, std::defer_lock);
+  while(true){
+    //jump to a page the free space map says has room
+    page_id_t page_id = FindPageWithFreeSpace(required);
+    if(page_id!=INVALID_PAGE_ID){
+      auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+      if(page== nullptr)return false;
       page->WLatch();
-      page->SetNextPageId(new_page_id);
+      bool insertResult = PageInsertTuple(page,row,txn,home_rid);
+      uint32_t free_space = PageFreeSpace(page);
       page->WUnlatch();
-      buffer_pool_manager_->UnpinPage(page->GetPageId(), true);
-      insertResult = new_page->InsertTuple(row,schema_,txn,lock_manager_,log_manager_);
-      new_page->WUnlatch();
-      buffer_pool_manager_->UnpinPage(new_page->GetPageId(), true);
-      break ;
+      buffer_pool_manager_->UnpinPage(page_id, insertResult);
+      //a concurrent insert may have used the space, the map is corrected and the search goes on
+      UpdateFreeSpace(page_id, free_space);
+      if(insertResult){
+        return true;
+      }
+      continue;
     }
+    //no page has room, search again once no other insert is attaching a page
+    if(!append_lock.owns_lock()){
+      append_lock.lock();
+      continue;
+    }
+    //attach a page at the end of the chain
+    page_id_t last_page_id;
+    {
+      std::scoped_lock<std::mutex> lock(fsm_latch_);
+      last_page_id = last_page_id_;
+    }
+    page_id_t new_page_id;
+    auto new_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->NewPage(new_page_id));
+    if(new_page== nullptr){
+      return false;
+    }
+    auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(last_page_id));
+    if(page== nullptr){
+      buffer_pool_manager_->UnpinPage(new_page_id, false);
+      buffer_pool_manager_->DeletePage(new_page_id);
+      return false;
+    }
+    new_page->WLatch();
+    InitPage(new_page,new_page_id,last_page_id,txn);
+    bool insertResult = PageInsertTuple(new_page,row,txn,home_rid);
+    uint32_t free_space = PageFreeSpace(new_page);
+    new_page->WUnlatch();
+    page->WLatch();
+    page->SetNextPageId(new_page_id);
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(last_page_id, true);
+    buffer_pool_manager_->UnpinPage(new_page_id, true);
+    std::scoped_lock<std::mutex> lock(fsm_latch_);
+    AddToFreeSpaceMap(new_page_id, free_space);
+    return insertResult;
   }
-  if(insertResult)return true;
-  else return false;
+}
+
+bool TableHeap::BulkInsert(std::vector<Row> &rows, Transaction *txn, std::vector<RowId> *rids) {
+  if (rows.empty()) {
+    return true;
+  }
+  std::scoped_lock<std::mutex> append_lock(append_latch_);
+  page_id_t last_page_id;
+  {
+    std::scoped_lock<std::mutex> lock(fsm_latch_);
+    last_page_id = last_page_id_;
+  }
+  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(last_page_id));
+  if (page == nullptr) {
+    return false;
+  }
+  page->WLatch();
+  bool result = true;
+  for (size_t i = 0; i < rows.size(); i++) {
+    if (!ToastRow(rows[i])) {
+      result = false;
+      break;
+    }
+    if (rows[i].GetSerializedSize(schema_) > TablePage::SIZE_MAX_ROW || !rows[i].FitsSchema(schema_)) {
+      FreeExternalValues(rows[i].GetExternalValues());
+      rows[i].ClearExternalValues();
+      result = false;
+      break;
+    }
+    if (PageInsertTuple(page, rows[i], txn)) {
+      rows[i].ClearExternalValues();
+      if (rids != nullptr) {
+        rids->push_back(rows[i].GetRowId());
+      }
+      continue;
+    }
+    // the tail is full, estimate how many pages the remaining rows need and attach them at once
+    size_t remaining_bytes = 0;
+    for (size_t j = i; j < rows.size() && remaining_bytes < BULK_INSERT_PAGE_BATCH * TablePage::SIZE_MAX_ROW; j++) {
+      remaining_bytes += TupleSpace(rows[j]);
+    }
+    size_t count = std::min<size_t>((remaining_bytes + TablePage::SIZE_MAX_ROW - 1) / TablePage::SIZE_MAX_ROW,
+                                    BULK_INSERT_PAGE_BATCH);
+    auto new_page = AppendPages(page, std::max<size_t>(count, 1), txn);
+    page_id_t page_id = page->GetTablePageId();
+    uint32_t free_space = PageFreeSpace(page);
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page_id, true);
+    UpdateFreeSpace(page_id, free_space);
+    if (new_page == nullptr) {
+      FreeExternalValues(rows[i].GetExternalValues());
+      rows[i].ClearExternalValues();
+      return false;
+    }
+    page = new_page;
+    // the row is retried in the new page, its values stay out of line
+    i--;
+  }
+  page_id_t page_id = page->GetTablePageId();
+  uint32_t free_space = PageFreeSpace(page);
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(page_id, true);
+  UpdateFreeSpace(page_id, free_space);
+  return result;
+}
+
+TablePage *TableHeap::AppendPages(TablePage *last_page, size_t count, Transaction *txn) {
+  TablePage *first_page = nullptr;
+  TablePage *prev_page = last_page;
+  std::vector<std::pair<page_id_t, uint32_t>> new_pages;
+  for (size_t i = 0; i < count; i++) {
+    page_id_t new_page_id;
+    auto new_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->NewPage(new_page_id));
+    if (new_page == nullptr) {
+      break;
+    }
+    new_page->WLatch();
+    InitPage(new_page, new_page_id, prev_page->GetTablePageId(), txn);
+    // last_page is latched by the caller, the pages in between are not visible to anyone yet
+    prev_page->SetNextPageId(new_page_id);
+    if (prev_page != last_page && prev_page != first_page) {
+      prev_page->WUnlatch();
+      buffer_pool_manager_->UnpinPage(prev_page->GetTablePageId(), true);
+    }
+    new_pages.emplace_back(new_page_id, PageFreeSpace(new_page));
+    if (first_page == nullptr) {
+      first_page = new_page;
+    }
+    prev_page = new_page;
+  }
+  if (prev_page != last_page && prev_page != first_page) {
+    prev_page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(prev_page->GetTablePageId(), true);
+  }
+  std::scoped_lock<std::mutex> lock(fsm_latch_);
+  for (auto &new_page : new_pages) {
+    AddToFreeSpaceMap(new_page.first, new_page.second);
+  }
+  return first_page;
 }
 
 bool TableHeap::MarkDelete(const RowId &rid, Transaction *txn) {
@@ -53,9 +225,19 @@ bool TableHeap::MarkDelete(const RowId &rid, Transaction *txn) {
   }
   // Otherwise, mark the tuple as deleted.
   page->WLatch();
-  page->MarkDelete(rid, txn, lock_manager_, log_manager_);
+  RowId target = INVALID_ROWID;
+  if (columnar_) {
+    AsPaxPage(page)->MarkDelete(rid, txn, lock_manager_, log_manager_);
+  } else {
+    page->GetForwardRowId(rid, &target);
+    page->MarkDelete(rid, txn, lock_manager_, log_manager_);
+  }
   page->WUnlatch();
   buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
+  // scans read a relocated tuple in its own page, it is marked as well
+  if (target.GetPageId() != INVALID_PAGE_ID) {
+    MarkDelete(target, txn);
+  }
   return true;
 }
 
@@ -63,17 +245,116 @@ bool TableHeap::MarkDelete(const RowId &rid, Transaction *txn) {
  * TODO: Student Implement
  */
 bool TableHeap::UpdateTuple(const Row &row, const RowId &rid, Transaction *txn) {
-  auto old_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
-  old_page->WLatch();
+  if(!row.FitsSchema(schema_)){
+    return false;
+  }
+  //长的值先写到overflow page，row是const的，只在需要时复制一份
+  const Row *new_row = &row;
+  Row toasted;
+  if(!schema_->IsFixedWidth() && row.GetSerializedSize(schema_)>TOAST_TUPLE_THRESHOLD){
+    toasted = row;
+    if(!ToastRow(toasted)){
+      return false;
+    }
+    new_row = &toasted;
+  }
+  //先在元组所在的页原地更新，页内放不下再把元组搬到别的页，rid始终不变
+  std::vector<Row::ExternalValue> old_values;
+  RowId target = INVALID_ROWID;
+  bool update_result = UpdateInPage(*new_row, rid, &target, &old_values, txn);
+  if(!update_result && target.GetPageId()!=INVALID_PAGE_ID){
+    //元组之前被搬走过，在它现在所在的页更新
+    RowId ignored;
+    update_result = UpdateInPage(*new_row, target, &ignored, &old_values, txn);
+  }
+  if(!update_result && !columnar_){
+    update_result = RelocateTuple(*new_row, rid, &old_values, txn);
+  }
+  //旧元组不再指向它的overflow page，更新失败则新写的没人指向
+  FreeExternalValues(update_result ? old_values : new_row->GetExternalValues());
+  return update_result;
+}
+
+bool TableHeap::UpdateInPage(const Row &row, const RowId &rid, RowId *forward,
+                             std::vector<Row::ExternalValue> *old_values, Transaction *txn) {
+  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
+  if(page== nullptr){
+    return false;
+  }
+  page->WLatch();
   Row old_row = Row(rid);
-//  old_page->GetTuple(&old_row,schema_,txn,lock_manager_);只要有rid就行
-  bool update_result = old_page->UpdateTuple(row,&old_row,schema_,txn,lock_manager_,log_manager_);
-  //要求old_row的field是空的
-  old_page->WUnlatch();
-  buffer_pool_manager_->UnpinPage(old_page->GetPageId(), true);
+  bool update_result = false;
+  if(columnar_){
+    update_result = AsPaxPage(page)->UpdateTuple(row,&old_row,schema_,txn,lock_manager_,log_manager_);
+  }else if(!page->GetForwardRowId(rid,forward)){
+    //要求old_row的field是空的
+    update_result = page->UpdateTuple(row,&old_row,schema_,txn,lock_manager_,log_manager_);
+  }
+  if(update_result){
+    zone_map_.Add(rid.GetPageId(), row);
+    const auto &values = old_row.GetExternalValues();
+    old_values->insert(old_values->end(), values.begin(), values.end());
+  }
+  uint32_t free_space = PageFreeSpace(page);
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(rid.GetPageId(), update_result);
+  UpdateFreeSpace(rid.GetPageId(), free_space);
   return update_result;
 }
 
+bool TableHeap::RelocateTuple(const Row &row, const RowId &rid, std::vector<Row::ExternalValue> *old_values,
+                              Transaction *txn) {
+  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
+  if(page== nullptr){
+    return false;
+  }
+  page->RLatch();
+  bool live = page->IsTupleLive(rid);
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(rid.GetPageId(), false);
+  if(!live){
+    return false;
+  }
+  //新的元组先写到有空间的页，它的rid由插入设置
+  Row relocated(row);
+  if(!InsertToastedTuple(relocated, txn, &rid)){
+    return false;
+  }
+  RowId new_rid = relocated.GetRowId();
+  page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
+  ASSERT(page!= nullptr,"home page not found when relocating a tuple");
+  page->WLatch();
+  RowId old_target = INVALID_ROWID;
+  std::vector<Row::ExternalValue> values;
+  if(!page->GetForwardRowId(rid,&old_target)){
+    GetExternalValues(page->GetTupleData(rid),&values);
+  }
+  //原来的槽只留下新位置的rid
+  bool forward_result = page->IsTupleLive(rid) && page->SetForwardRowId(rid,new_rid);
+  uint32_t free_space = PageFreeSpace(page);
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(rid.GetPageId(), forward_result);
+  UpdateFreeSpace(rid.GetPageId(), free_space);
+  if(!forward_result){
+    //撤销插入，新元组的overflow page由调用者释放
+    auto new_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(new_rid.GetPageId()));
+    ASSERT(new_page!= nullptr,"page not found when removing a relocated tuple");
+    new_page->WLatch();
+    new_page->ApplyDelete(new_rid,txn,log_manager_);
+    free_space = PageFreeSpace(new_page);
+    new_page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(new_rid.GetPageId(), true);
+    UpdateFreeSpace(new_rid.GetPageId(), free_space);
+    return false;
+  }
+  old_values->insert(old_values->end(), values.begin(), values.end());
+  //之前搬过的元组没用了，连同它的overflow page一起删除
+  if(old_target.GetPageId()!=INVALID_PAGE_ID){
+    ApplyDelete(old_target, txn);
+  }
+  return true;
+}
+
 /**
  * TODO: USE Transaction and lock
  */
@@ -86,9 +367,24 @@ void TableHeap::ApplyDelete(const RowId &rid, Transaction *txn) {
   ASSERT(page!= nullptr,"page not found when delete");
   // Otherwise, apply delete
   page->WLatch();
-  page->ApplyDelete(rid,txn,log_manager_);
+  std::vector<Row::ExternalValue> external_values;
+  RowId target = INVALID_ROWID;
+  if(columnar_){
+    AsPaxPage(page)->ApplyDelete(rid,txn,log_manager_);
+  }else{
+    page->GetForwardRowId(rid,&target);
+    GetExternalValues(page->GetTupleData(rid),&external_values);
+    page->ApplyDelete(rid,txn,log_manager_);
+  }
+  uint32_t free_space = PageFreeSpace(page);
   page->WUnlatch();
-  buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
+  buffer_pool_manager_->UnpinPage(rid.GetPageId(), true);
+  UpdateFreeSpace(rid.GetPageId(), free_space);
+  FreeExternalValues(external_values);
+  //行被搬走过，它的元组在另一个槽里
+  if(target.GetPageId()!=INVALID_PAGE_ID){
+    ApplyDelete(target, txn);
+  }
 }
 
 void TableHeap::RollbackDelete(const RowId &rid, Transaction *txn) {
@@ -97,9 +393,18 @@ void TableHeap::RollbackDelete(const RowId &rid, Transaction *txn) {
   assert(page != nullptr);
   // Rollback to delete.
   page->WLatch();
-  page->RollbackDelete(rid, txn, log_manager_);
+  RowId target = INVALID_ROWID;
+  if (columnar_) {
+    AsPaxPage(page)->RollbackDelete(rid, txn, log_manager_);
+  } else {
+    page->GetForwardRowId(rid, &target);
+    page->RollbackDelete(rid, txn, log_manager_);
+  }
   page->WUnlatch();
   buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
+  if (target.GetPageId() != INVALID_PAGE_ID) {
+    RollbackDelete(target, txn);
+  }
 }
 
 /**
@@ -108,60 +413,356 @@ void TableHeap::RollbackDelete(const RowId &rid, Transaction *txn) {
 bool TableHeap::GetTuple(Row *row, Transaction *txn) {
   auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(row->GetRowId().GetPageId()));
   page->RLatch();
-  bool get_result = page->GetTuple(row,schema_,txn, lock_manager_);
+  bool get_result = PageGetTuple(page,row,txn);
   page->RUnlatch();
   buffer_pool_manager_->UnpinPage(page->GetPageId(),false);
   return get_result;
 }
 
 /*define by liliyang*/
-RowId TableHeap::GetNextRowId(Row *row, Transaction *txn) {
+RowId TableHeap::GetNextRowId(Row *row, Transaction *txn, ReadAhead *read_ahead) {
   RowId r_id = row->GetRowId();
   auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(r_id.GetPageId()));
   page->RLatch();
   RowId n_id;
-  bool get_result = page->GetNextTupleRid(r_id,&n_id);
+  bool get_result = PageNextTupleRid(page,r_id,&n_id);
+  page_id_t next_page_id = page->GetNextPageId();
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
   if(get_result){//如果在当前页有下一条记录
-    page->RUnlatch();
-    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
     return n_id;
   }
-  page->RUnlatch();
-  buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
   //看下一页
-  auto next_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page->GetNextPageId()));
-  if(next_page==NULL){
-      return INVALID_ROWID;//最后一条记录了，返回
+  while(next_page_id != INVALID_PAGE_ID){
+    auto next_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(next_page_id));
+    if(next_page==NULL){
+      return INVALID_ROWID;
+    }
+    next_page->RLatch();
+    get_result = PageFirstTupleRid(next_page,&r_id);
+    page_id_t page_id = next_page_id;
+    next_page_id = next_page->GetNextPageId();
+    next_page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    // start reading the rest of the chain while the caller works on this page
+    if (read_ahead != nullptr) {
+      read_ahead->OnPageAccess(page_id, next_page_id);
+    }
+    if(get_result){//一旦获取成功就返回
+      return r_id;
+    }
+    //否则继续寻找下一页
   }
+  return INVALID_ROWID;//最后一条记录了，返回
+}
 
-  while(true){
-      next_page->RLatch();
-      get_result = next_page->GetFirstTupleRid(&r_id);
-      if(get_result){//一旦获取成功就返回
-        buffer_pool_manager_->UnpinPage(next_page->GetPageId(), false);
-        next_page->RUnlatch();
-        return r_id;
-      }
-      //否则继续寻找下一页
-      buffer_pool_manager_->UnpinPage(next_page->GetPageId(), false);
-      next_page->RUnlatch();
-      next_page =  reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(next_page->GetNextPageId()));
-      if(next_page==NULL){
-        return INVALID_ROWID;//最后一条记录了，返回
-      }
+bool TableHeap::ScanPage(page_id_t page_id, RowBatch &batch, Transaction *txn, ReadAhead *read_ahead) {
+  batch.Release();
+  auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+  if (page == nullptr) {
+    return false;
+  }
+  page->RLatch();
+  batch.buffer_pool_manager_ = buffer_pool_manager_;
+  batch.page_ = page;
+  batch.next_page_id_ = page->GetNextPageId();
+  if (columnar_) {
+    auto pax_page = AsPaxPage(page);
+    batch.columnar_ = true;
+    pax_page->GetTupleSpans(&batch.spans_);
+    // the views of the batch read the minipages directly
+    for (uint32_t i = 0; i < schema_->GetColumnCount(); i++) {
+      batch.null_bitmaps_.push_back(pax_page->GetNullBitmap(i));
+      batch.values_.push_back(pax_page->GetValues(i));
+    }
+  } else {
+    page->GetTupleSpans(&batch.spans_);
+  }
+  // pages of a table opened from disk are summarized by the first scan that reads them
+  if (!zone_map_.Contains(page_id)) {
+    zone_map_.Build(page_id, batch);
   }
+  if (read_ahead != nullptr) {
+    read_ahead->OnPageAccess(page_id, batch.next_page_id_);
+  }
+  return true;
 }
 
 void TableHeap::DeleteTable(page_id_t page_id) {
-  if (page_id != INVALID_PAGE_ID) {
+  bool whole_table = page_id == INVALID_PAGE_ID;
+  if (whole_table) {
+    page_id = first_page_id_;
+  }
+  while (page_id != INVALID_PAGE_ID) {
     auto temp_table_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));  // 删除table_heap
-    if (temp_table_page->GetNextPageId() != INVALID_PAGE_ID)
-      DeleteTable(temp_table_page->GetNextPageId());
+    if (temp_table_page == nullptr) {
+      break;
+    }
+    page_id_t next_page_id = temp_table_page->GetNextPageId();
+    FreeExternalValues(temp_table_page);
     buffer_pool_manager_->UnpinPage(page_id, false);
     buffer_pool_manager_->DeletePage(page_id);
+    page_id = next_page_id;
+  }
+  if (whole_table) {
+    DeleteFreeSpaceMap();
+    zone_map_.Clear();
+  }
+}
+
+void TableHeap::LoadFreeSpaceMap() {
+  std::scoped_lock<std::mutex> lock(fsm_latch_);
+  if (fsm_page_id_ != INVALID_PAGE_ID) {
+    for (page_id_t map_page_id = fsm_page_id_; map_page_id != INVALID_PAGE_ID;) {
+      auto map_page = reinterpret_cast<FreeSpaceMapPage *>(buffer_pool_manager_->FetchPage(map_page_id)->GetData());
+      for (uint32_t i = 0; i < map_page->GetCount(); i++) {
+        page_id_t page_id = map_page->GetPageId(i);
+        uint8_t category = map_page->GetCategory(i);
+        fsm_slots_[page_id] = {map_page_id, i, category};
+        free_pages_.emplace(category, page_id);
+        // pages are listed in chain order
+        page_directory_.push_back(page_id);
+        last_page_id_ = page_id;
+      }
+      last_fsm_page_id_ = map_page_id;
+      page_id_t next_map_page_id = map_page->GetNextPageId();
+      buffer_pool_manager_->UnpinPage(map_page_id, false);
+      map_page_id = next_map_page_id;
+    }
+    return;
+  }
+  // a heap without a free space map, e.g. opened from its first page id only
+  for (page_id_t page_id = first_page_id_; page_id != INVALID_PAGE_ID;) {
+    auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+    page->RLatch();
+    uint32_t free_space = PageFreeSpace(page);
+    page_id_t next_page_id = page->GetNextPageId();
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    AddToFreeSpaceMap(page_id, free_space);
+    page_id = next_page_id;
+  }
+}
+
+void TableHeap::AddToFreeSpaceMap(page_id_t page_id, uint32_t free_space) {
+  uint8_t category = FreeSpaceMapPage::ToCategory(free_space);
+  FreeSpaceMapPage *map_page = nullptr;
+  int index = -1;
+  if (last_fsm_page_id_ != INVALID_PAGE_ID) {
+    map_page = reinterpret_cast<FreeSpaceMapPage *>(buffer_pool_manager_->FetchPage(last_fsm_page_id_)->GetData());
+    index = map_page->Append(page_id, category);
+  }
+  if (index < 0) {
+    // the last map page is full, or there is none yet
+    page_id_t new_map_page_id;
+    auto new_page = buffer_pool_manager_->NewPage(new_map_page_id);
+    ASSERT(new_page != nullptr, "Failed to allocate a free space map page.");
+    auto new_map_page = reinterpret_cast<FreeSpaceMapPage *>(new_page->GetData());
+    new_map_page->Init();
+    index = new_map_page->Append(page_id, category);
+    if (map_page != nullptr) {
+      map_page->SetNextPageId(new_map_page_id);
+      buffer_pool_manager_->UnpinPage(last_fsm_page_id_, true);
+    } else {
+      fsm_page_id_ = new_map_page_id;
+    }
+    last_fsm_page_id_ = new_map_page_id;
+  }
+  buffer_pool_manager_->UnpinPage(last_fsm_page_id_, true);
+  fsm_slots_[page_id] = {last_fsm_page_id_, static_cast<uint32_t>(index), category};
+  free_pages_.emplace(category, page_id);
+  page_directory_.push_back(page_id);
+  last_page_id_ = page_id;
+}
+
+void TableHeap::UpdateFreeSpace(page_id_t page_id, uint32_t free_space) {
+  uint8_t category = FreeSpaceMapPage::ToCategory(free_space);
+  std::scoped_lock<std::mutex> lock(fsm_latch_);
+  auto iter = fsm_slots_.find(page_id);
+  if (iter == fsm_slots_.end() || iter->second.category == category) {
+    return;
+  }
+  FreeSpaceMapSlot &slot = iter->second;
+  free_pages_.erase({slot.category, page_id});
+  free_pages_.emplace(category, page_id);
+  slot.category = category;
+  auto map_page = reinterpret_cast<FreeSpaceMapPage *>(buffer_pool_manager_->FetchPage(slot.map_page_id)->GetData());
+  map_page->SetCategory(slot.index, category);
+  buffer_pool_manager_->UnpinPage(slot.map_page_id, true);
+}
+
+page_id_t TableHeap::FindPageWithFreeSpace(uint32_t free_space) {
+  uint8_t category = FreeSpaceMapPage::RequiredCategory(free_space);
+  std::scoped_lock<std::mutex> lock(fsm_latch_);
+  // the fullest page that still has room keeps the other pages free for larger tuples
+  auto iter = free_pages_.lower_bound({category, INVALID_PAGE_ID});
+  return iter == free_pages_.end() ? INVALID_PAGE_ID : iter->second;
+}
+
+void TableHeap::DeleteFreeSpaceMap() {
+  std::scoped_lock<std::mutex> lock(fsm_latch_);
+  for (page_id_t map_page_id = fsm_page_id_; map_page_id != INVALID_PAGE_ID;) {
+    auto page = buffer_pool_manager_->FetchPage(map_page_id);
+    if (page == nullptr) {
+      break;
+    }
+    page_id_t next_map_page_id = reinterpret_cast<FreeSpaceMapPage *>(page->GetData())->GetNextPageId();
+    buffer_pool_manager_->UnpinPage(map_page_id, false);
+    buffer_pool_manager_->DeletePage(map_page_id);
+    map_page_id = next_map_page_id;
+  }
+  fsm_page_id_ = last_fsm_page_id_ = INVALID_PAGE_ID;
+  fsm_slots_.clear();
+  free_pages_.clear();
+  page_directory_.clear();
+}
+
+void TableHeap::GetPageIds(std::vector<page_id_t> *page_ids) {
+  std::scoped_lock<std::mutex> lock(fsm_latch_);
+  page_ids->insert(page_ids->end(), page_directory_.begin(), page_directory_.end());
+}
+
+void TableHeap::InitPage(TablePage *page, page_id_t page_id, page_id_t prev_id, Transaction *txn) {
+  if (columnar_) {
+    AsPaxPage(page)->Init(page_id, prev_id, schema_, log_manager_, txn);
   } else {
-    DeleteTable(first_page_id_);
+    page->Init(page_id, prev_id, log_manager_, txn);
   }
+  zone_map_.AddPage(page_id);
+}
+
+bool TableHeap::PageInsertTuple(TablePage *page, Row &row, Transaction *txn, const RowId *home_rid) {
+  bool inserted;
+  if (columnar_) {
+    inserted = AsPaxPage(page)->InsertTuple(row, schema_, txn, lock_manager_, log_manager_);
+  } else if (home_rid != nullptr) {
+    inserted = page->InsertRelocatedTuple(row, *home_rid, schema_, txn, lock_manager_, log_manager_);
+  } else {
+    inserted = page->InsertTuple(row, schema_, txn, lock_manager_, log_manager_);
+  }
+  if (inserted) {
+    zone_map_.Add(page->GetTablePageId(), row);
+  }
+  return inserted;
+}
+
+bool TableHeap::PageGetTuple(TablePage *page, Row *row, Transaction *txn) {
+  if (columnar_) {
+    return AsPaxPage(page)->GetTuple(row, schema_, txn, lock_manager_);
+  }
+  RowId rid = row->GetRowId();
+  RowId target;
+  if (page->GetForwardRowId(rid, &target)) {
+    if (!page->IsTupleLive(rid)) {
+      return false;
+    }
+    // the tuple was moved by an update, it is read from its slot under the rid of the row
+    bool same_page = target.GetPageId() == page->GetTablePageId();
+    auto target_page =
+        same_page ? page : reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(target.GetPageId()));
+    if (target_page == nullptr) {
+      return false;
+    }
+    if (!same_page) {
+      target_page->RLatch();
+    }
+    row->SetRowId(target);
+    bool result = PageGetTuple(target_page, row, txn);
+    row->SetRowId(rid);
+    if (!same_page) {
+      target_page->RUnlatch();
+      buffer_pool_manager_->UnpinPage(target.GetPageId(), false);
+    }
+    return result;
+  }
+  if (!page->GetTuple(row, schema_, txn, lock_manager_)) {
+    return false;
+  }
+  // read while the page is latched, the overflow pages are not freed before the tuple stops pointing to them
+  if (!row->GetExternalValues().empty()) {
+    OverflowPage::ReadExternalValues(buffer_pool_manager_, row);
+  }
+  return true;
+}
+
+bool TableHeap::PageFirstTupleRid(TablePage *page, RowId *first_rid) {
+  return columnar_ ? AsPaxPage(page)->GetFirstTupleRid(first_rid) : page->GetFirstTupleRid(first_rid);
+}
+
+bool TableHeap::PageNextTupleRid(TablePage *page, const RowId &cur_rid, RowId *next_rid) {
+  return columnar_ ? AsPaxPage(page)->GetNextTupleRid(cur_rid, next_rid) : page->GetNextTupleRid(cur_rid, next_rid);
+}
+
+uint32_t TableHeap::PageFreeSpace(TablePage *page) {
+  return columnar_ ? AsPaxPage(page)->GetFreeSpaceRemaining() : page->GetFreeSpaceRemaining();
+}
+
+bool TableHeap::ToastRow(Row &row) {
+  if (schema_->IsFixedWidth()) {
+    return true;
+  }
+  uint32_t size = row.GetSerializedSize(schema_);
+  while (size > TOAST_TUPLE_THRESHOLD) {
+    // the longest value still in the tuple
+    int longest = -1;
+    uint32_t longest_len = 0;
+    for (uint32_t i = 0; i < row.GetFieldCount(); i++) {
+      Field *field = row.GetField(i);
+      if (field->GetTypeId() == kTypeChar && !field->IsNull() && !row.IsExternal(i) &&
+          field->GetLength() >= TOAST_VALUE_MIN_SIZE && field->GetLength() > longest_len) {
+        longest = static_cast<int>(i);
+        longest_len = field->GetLength();
+      }
+    }
+    if (longest < 0) {
+      break;
+    }
+    page_id_t first_page_id =
+        OverflowPage::WriteValue(buffer_pool_manager_, row.GetField(longest)->GetData(), longest_len);
+    if (first_page_id == INVALID_PAGE_ID) {
+      FreeExternalValues(row.GetExternalValues());
+      row.ClearExternalValues();
+      return false;
+    }
+    row.SetExternal(longest, first_page_id);
+    size = size - sizeof(uint32_t) - longest_len + Row::EXTERNAL_POINTER_SIZE;
+  }
+  return true;
+}
+
+void TableHeap::FreeExternalValues(const std::vector<Row::ExternalValue> &values) {
+  for (const auto &value : values) {
+    OverflowPage::FreeValue(buffer_pool_manager_, value.first_page_id);
+  }
+}
+
+void TableHeap::FreeExternalValues(TablePage *page) {
+  if (schema_->IsFixedWidth()) {
+    return;
+  }
+  std::vector<TupleSpan> spans;
+  page->GetTupleSpans(&spans);
+  std::vector<Row::ExternalValue> values;
+  for (const auto &span : spans) {
+    GetExternalValues(page->GetData() + span.offset, &values);
+  }
+  FreeExternalValues(values);
+}
+
+void TableHeap::GetExternalValues(const char *tuple, std::vector<Row::ExternalValue> *values) {
+  if (tuple == nullptr || schema_->IsFixedWidth()) {
+    return;
+  }
+  RowView view(tuple, schema_);
+  for (uint32_t i = 0; i < view.GetFieldCount(); i++) {
+    if (view.IsExternal(i)) {
+      values->push_back(view.GetExternalValue(i));
+    }
+  }
+}
+
+uint32_t TableHeap::TupleSpace(const Row &row) {
+  return columnar_ ? PaxPage::GetTupleSpace(schema_) : row.GetSerializedSize(schema_) + sizeof(uint32_t) * 2;
 }
 
 /**
@@ -170,9 +771,8 @@ void TableHeap::DeleteTable(page_id_t page_id) {
 
 
 TableIterator TableHeap::Begin(Transaction *txn) {
-  auto temp_table_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(first_page_id_));
-  RowId rid;temp_table_page->GetFirstTupleRid(&rid);
-  return TableIterator(this,rid);
+  // the iterator skips empty pages at the head of the chain by itself
+  return TableIterator(this, RowId(first_page_id_, 0));
 }
 
 /**
@@ -6,18 +6,23 @@
 /**
  * TODO: Student Implement
  */
-TableIterator::TableIterator(TableHeap* tableHeap,RowId currentRowID) {
-  tableHeap_ = tableHeap;
-  currentRowID_ = currentRowID;
+TableIterator::TableIterator(TableHeap* tableHeap,RowId currentRowID)
+    : tableHeap_(tableHeap), readAhead_(tableHeap == nullptr ? nullptr : tableHeap->buffer_pool_manager_) {
+  if (tableHeap_ != nullptr && currentRowID.GetPageId() != INVALID_PAGE_ID) {
+    SeekFrom(currentRowID.GetPageId(), currentRowID.GetSlotNum());
+  }
 }
 
-TableIterator::TableIterator(const TableIterator &other) {
-  tableHeap_ = other.tableHeap_;
-  currentRowID_ = other.currentRowID_;
+TableIterator::TableIterator(const TableIterator &other)
+    : tableHeap_(other.tableHeap_), currentRowID_(other.currentRowID_), row_(other.row_), readAhead_(other.readAhead_) {
+  if (other.page_ != nullptr) {
+    // the copy holds its own pin on the page
+    page_ = reinterpret_cast<TablePage *>(tableHeap_->buffer_pool_manager_->FetchPage(other.page_->GetTablePageId()));
+  }
 }
 
 TableIterator::~TableIterator() {
-
+  ReleasePage();
 }
 
 bool TableIterator::operator==(const TableIterator &itr) const {
@@ -29,43 +34,82 @@ bool TableIterator::operator!=(const TableIterator &itr) const {
 }
 
 const Row &TableIterator::operator*() {
-  ASSERT(tableHeap_, "TableHeap is nullptr.");
-  Row* row = new Row(currentRowID_);
-  tableHeap_->GetTuple(row, nullptr);
-  ASSERT(row, "Invalid row.");
-  return *row;
+  ASSERT(page_ != nullptr, "Dereferencing the end iterator.");
+  return row_;
 }
 
 Row *TableIterator::operator->() {
-  ASSERT(tableHeap_, "TableHeap is nullptr.");
-  Row* row = new Row(currentRowID_);
-  tableHeap_->GetTuple(row, nullptr);
-  ASSERT(row, "Invalid row.");
-  return row;
+  ASSERT(page_ != nullptr, "Dereferencing the end iterator.");
+  return &row_;
 }
 
 TableIterator &TableIterator::operator=(const TableIterator &itr) noexcept {
+  if (this == &itr) {
+    return *this;
+  }
+  ReleasePage();
   tableHeap_ = itr.tableHeap_;
   currentRowID_ = itr.currentRowID_;
+  row_ = itr.row_;
+  readAhead_ = itr.readAhead_;
+  if (itr.page_ != nullptr) {
+    page_ = reinterpret_cast<TablePage *>(tableHeap_->buffer_pool_manager_->FetchPage(itr.page_->GetTablePageId()));
+  }
   return *this;
 }
 
 // ++iter
 TableIterator &TableIterator::operator++() {
-  ASSERT(tableHeap_, "TableHeap is nullptr.");
-  Row cur_row;
-  cur_row.SetRowId(currentRowID_);
-  tableHeap_->GetTuple(&cur_row, nullptr);
-  currentRowID_ = tableHeap_->GetNextRowId(&cur_row, nullptr);
+  ASSERT(page_ != nullptr, "Advancing the end iterator.");
+  SeekFrom(currentRowID_.GetPageId(), currentRowID_.GetSlotNum() + 1);
   return *this;
 }
 
 // iter++
 TableIterator &TableIterator::operator++(int) {
-  ASSERT(tableHeap_, "TableHeap is nullptr.");
-  Row cur_row;
-  cur_row.SetRowId(currentRowID_);
-  tableHeap_->GetTuple(&cur_row, nullptr);
-  currentRowID_ = tableHeap_->GetNextRowId(&cur_row, nullptr);
-  return *this;
+  return ++(*this);
+}
+
+void TableIterator::SeekFrom(page_id_t page_id, uint32_t slot) {
+  BufferPoolManager *bpm = tableHeap_->buffer_pool_manager_;
+  while (page_id != INVALID_PAGE_ID) {
+    if (page_ == nullptr) {
+      page_ = reinterpret_cast<TablePage *>(bpm->FetchPage(page_id));
+      if (page_ == nullptr) {
+        break;
+      }
+    }
+    page_->RLatch();
+    RowId rid;
+    bool found = slot == 0 ? tableHeap_->PageFirstTupleRid(page_, &rid)
+                           : tableHeap_->PageNextTupleRid(page_, RowId(page_id, slot - 1), &rid);
+    if (found) {
+      row_.destroy();
+      row_.SetRowId(rid);
+      tableHeap_->PageGetTuple(page_, &row_, nullptr);
+    }
+    page_id_t next_page_id = page_->GetNextPageId();
+    page_->RUnlatch();
+    if (found) {
+      currentRowID_ = rid;
+      return;
+    }
+    // 当前页已经没有记录，换到下一页
+    ReleasePage();
+    if (next_page_id != INVALID_PAGE_ID) {
+      readAhead_.OnPageAccess(page_id, next_page_id);
+    }
+    page_id = next_page_id;
+    slot = 0;
+  }
+  ReleasePage();
+  row_.destroy();
+  currentRowID_ = INVALID_ROWID;
+}
+
+void TableIterator::ReleasePage() {
+  if (page_ != nullptr) {
+    tableHeap_->buffer_pool_manager_->UnpinPage(page_->GetTablePageId(), false);
+    page_ = nullptr;
+  }
 }
@@ -0,0 +1,115 @@
+#include "storage/zone_map.h"
+
+void ZoneMap::AddPage(page_id_t page_id) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  zones_[page_id] = Zone(schema_->GetColumnCount());
+}
+
+bool ZoneMap::Contains(page_id_t page_id) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  return zones_.count(page_id) > 0;
+}
+
+void ZoneMap::Add(page_id_t page_id, const Row &row) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  auto iter = zones_.find(page_id);
+  if (iter == zones_.end()) {
+    return;
+  }
+  for (uint32_t i = 0; i < iter->second.size(); i++) {
+    if (row.IsExternal(i)) {
+      iter->second[i].unbounded = true;
+      continue;
+    }
+    Widen(iter->second[i], *row.GetField(i));
+  }
+}
+
+void ZoneMap::Build(page_id_t page_id, const RowBatch &batch) {
+  // summarize outside the latch, the page latch keeps the tuples stable
+  Zone zone(schema_->GetColumnCount());
+  RowView tuple;
+  for (size_t i = 0; i < batch.Size(); i++) {
+    batch.GetView(i, schema_, &tuple);
+    for (uint32_t j = 0; j < zone.size(); j++) {
+      if (tuple.IsExternal(j)) {
+        zone[j].unbounded = true;
+        continue;
+      }
+      Widen(zone[j], tuple.GetField(j));
+    }
+  }
+  std::scoped_lock<std::mutex> lock(latch_);
+  zones_.emplace(page_id, std::move(zone));
+}
+
+bool ZoneMap::MayMatch(page_id_t page_id, uint32_t column_idx, const std::string &comp_type, const Field &value) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  auto iter = zones_.find(page_id);
+  if (iter == zones_.end() || column_idx >= iter->second.size()) {
+    return true;
+  }
+  const ColumnZone &zone = iter->second[column_idx];
+  if (comp_type == "is") {
+    return zone.has_null;
+  }
+  if (comp_type == "not") {
+    return zone.min != nullptr || zone.unbounded;
+  }
+  if (zone.unbounded) {
+    return !value.IsNull();
+  }
+  // a comparison with null is never true, so is any comparison on a column without values
+  if (zone.min == nullptr || value.IsNull()) {
+    return false;
+  }
+  if (value.GetTypeId() != zone.min->GetTypeId()) {
+    return true;
+  }
+  if (comp_type == "=") {
+    return zone.min->CompareLessThanEquals(value) == CmpBool::kTrue &&
+           zone.max->CompareGreaterThanEquals(value) == CmpBool::kTrue;
+  }
+  if (comp_type == "<>") {
+    return !(zone.min->CompareEquals(value) == CmpBool::kTrue && zone.max->CompareEquals(value) == CmpBool::kTrue);
+  }
+  if (comp_type == "<") {
+    return zone.min->CompareLessThan(value) == CmpBool::kTrue;
+  }
+  if (comp_type == "<=") {
+    return zone.min->CompareLessThanEquals(value) == CmpBool::kTrue;
+  }
+  if (comp_type == ">") {
+    return zone.max->CompareGreaterThan(value) == CmpBool::kTrue;
+  }
+  if (comp_type == ">=") {
+    return zone.max->CompareGreaterThanEquals(value) == CmpBool::kTrue;
+  }
+  return true;
+}
+
+void ZoneMap::Clear() {
+  std::scoped_lock<std::mutex> lock(latch_);
+  zones_.clear();
+}
+
+void ZoneMap::Widen(ColumnZone &zone, const Field &field) {
+  if (field.IsNull()) {
+    zone.has_null = true;
+    return;
+  }
+  if (zone.min == nullptr || field.CompareLessThan(*zone.min) == CmpBool::kTrue) {
+    zone.min.reset(CopyField(field));
+  }
+  if (zone.max == nullptr || field.CompareGreaterThan(*zone.max) == CmpBool::kTrue) {
+    zone.max.reset(CopyField(field));
+  }
+}
+
+Field *ZoneMap::CopyField(const Field &field) {
+  if (field.GetTypeId() == kTypeChar) {
+    // the field may borrow its bytes from a page
+    return new Field(kTypeChar, const_cast<char *>(field.GetData()), field.GetLength(), true);
+  }
+  return new Field(field);
+}
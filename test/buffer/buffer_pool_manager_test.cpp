@@ -1,9 +1,12 @@
-#include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_manager_instance.h"
 
+#include <chrono>
 #include <cstdio>
 #include <random>
 #include <string>
+#include <thread>
 
+#include "buffer/read_ahead.h"
 #include "gtest/gtest.h"
 
 TEST(BufferPoolManagerTest, BinaryDataTest) {
@@ -16,7 +19,7 @@ TEST(BufferPoolManagerTest, BinaryDataTest) {
 
   remove(db_name.c_str());
   auto *disk_manager = new DiskManager(db_name);
-  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
 
   page_id_t page_id_temp;
   auto *page0 = bpm->NewPage(page_id_temp);
@@ -71,4 +74,142 @@ TEST(BufferPoolManagerTest, BinaryDataTest) {
 
   delete bpm;
   delete disk_manager;
-}
\ No newline at end of file
+}
+
+TEST(BufferPoolManagerTest, BackgroundFlusherTest) {
+  const std::string db_name = "bpm_flusher_test.db";
+  const size_t buffer_pool_size = 16;
+
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  bpm->StartBackgroundFlusher(0.5, 0.0);
+
+  // Scenario: dirty more than half of the pool, the flusher writes the pages back while they stay cached.
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    auto *page = bpm->NewPage(page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "flushed %d", page_id_temp);
+    EXPECT_TRUE(bpm->UnpinPage(page_id_temp, true));
+  }
+  char data[PAGE_SIZE];
+  char expected[PAGE_SIZE];
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    snprintf(expected, PAGE_SIZE, "flushed %zu", i);
+    bool flushed = false;
+    for (int retry = 0; retry < 100 && !flushed; retry++) {
+      disk_manager->ReadPage(i, data);
+      flushed = strcmp(expected, data) == 0;
+      if (!flushed) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+      }
+    }
+    EXPECT_TRUE(flushed) << "page " << i << " was not written back";
+  }
+
+  // Scenario: a page modified again after it was flushed is dirty again and survives eviction.
+  auto *page = bpm->FetchPage(0);
+  ASSERT_NE(nullptr, page);
+  snprintf(page->GetData(), PAGE_SIZE, "modified 0");
+  EXPECT_TRUE(bpm->UnpinPage(0, true));
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(page_id_temp));
+    EXPECT_TRUE(bpm->UnpinPage(page_id_temp, false));
+  }
+  page = bpm->FetchPage(0);
+  ASSERT_NE(nullptr, page);
+  EXPECT_STREQ("modified 0", page->GetData());
+  EXPECT_TRUE(bpm->UnpinPage(0, false));
+
+  bpm->StopBackgroundFlusher();
+  delete bpm;
+  delete disk_manager;
+  remove(db_name.c_str());
+}
+
+TEST(BufferPoolManagerTest, PrefetchTest) {
+  const std::string db_name = "bpm_prefetch_test.db";
+  const size_t buffer_pool_size = 16;
+  const page_id_t num_pages = 64;
+
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  char data[PAGE_SIZE];
+  for (page_id_t page_id = 0; page_id < num_pages; page_id++) {
+    memset(data, 0, PAGE_SIZE);
+    snprintf(data, PAGE_SIZE, "page %d", page_id);
+    disk_manager->WritePage(page_id, data);
+  }
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, ReplacerType::kLRUK);
+  char expected[PAGE_SIZE];
+
+  // Scenario: prefetched pages are found by FetchPage with their content read in.
+  for (page_id_t page_id = 0; page_id < 8; page_id++) {
+    bpm->Prefetch(page_id);
+  }
+  for (page_id_t page_id = 0; page_id < 8; page_id++) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(expected, PAGE_SIZE, "page %d", page_id);
+    EXPECT_STREQ(expected, page->GetData());
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+
+  // Scenario: prefetching more pages than the pool holds evicts prefetched pages nobody fetched yet.
+  for (page_id_t page_id = 8; page_id < num_pages; page_id++) {
+    bpm->Prefetch(page_id);
+  }
+  for (page_id_t page_id = 0; page_id < num_pages; page_id++) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(expected, PAGE_SIZE, "page %d", page_id);
+    EXPECT_STREQ(expected, page->GetData());
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+
+  // Scenario: a prefetch into a pool whose frames are all pinned is ignored, a cached page is never read again.
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(buffer_pool_size); page_id++) {
+    ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+  }
+  snprintf(bpm->FetchPage(0)->GetData(), PAGE_SIZE, "modified 0");
+  bpm->Prefetch(0);
+  bpm->Prefetch(num_pages - 1);
+  EXPECT_EQ(nullptr, bpm->FetchPage(num_pages - 1));
+  EXPECT_STREQ("modified 0", bpm->FetchPage(0)->GetData());
+  EXPECT_TRUE(bpm->UnpinPage(0, true));
+  EXPECT_TRUE(bpm->UnpinPage(0, false));
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(buffer_pool_size); page_id++) {
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+  EXPECT_TRUE(bpm->CheckAllUnpinned());
+
+  // Scenario: a sequential scan over a page chain reads ahead and still sees every page.
+  ReadAhead read_ahead(bpm, 4);
+  for (page_id_t page_id = 0; page_id < num_pages; page_id++) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    read_ahead.OnPageAccess(page_id, page_id + 1 < num_pages ? page_id + 1 : INVALID_PAGE_ID);
+    snprintf(expected, PAGE_SIZE, page_id == 0 ? "modified %d" : "page %d", page_id);
+    EXPECT_STREQ(expected, page->GetData());
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+
+  // Scenario: a prefetch never writes a page back, it is dropped when the pool only holds dirty pages.
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(buffer_pool_size); page_id++) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "dirty %d", page_id);
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+  bpm->Prefetch(num_pages - 1);
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(buffer_pool_size); page_id++) {
+    disk_manager->ReadPage(page_id, data);
+    snprintf(expected, PAGE_SIZE, "page %d", page_id);
+    EXPECT_STREQ(expected, data);
+  }
+
+  delete bpm;
+  delete disk_manager;
+  remove(db_name.c_str());
+}
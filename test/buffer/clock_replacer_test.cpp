@@ -0,0 +1,86 @@
+#include "buffer/clock_replacer.h"
+
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+TEST(CLOCKReplacerTest, SampleTest) {
+  CLOCKReplacer clock_replacer(7);
+
+  // Scenario: unpin six elements, i.e. add them to the replacer.
+  clock_replacer.Unpin(1);
+  clock_replacer.Unpin(2);
+  clock_replacer.Unpin(3);
+  clock_replacer.Unpin(4);
+  clock_replacer.Unpin(5);
+  clock_replacer.Unpin(6);
+  clock_replacer.Unpin(1);
+  EXPECT_EQ(6, clock_replacer.Size());
+
+  // Scenario: get three victims from the clock.
+  int value;
+  clock_replacer.Victim(&value);
+  EXPECT_EQ(1, value);
+  clock_replacer.Victim(&value);
+  EXPECT_EQ(2, value);
+  clock_replacer.Victim(&value);
+  EXPECT_EQ(3, value);
+
+  // Scenario: pin elements in the replacer.
+  // Note that 3 has already been victimized, so pinning 3 should have no effect.
+  clock_replacer.Pin(3);
+  clock_replacer.Pin(4);
+  EXPECT_EQ(2, clock_replacer.Size());
+
+  // Scenario: unpin 4. We expect that the reference bit of 4 will be set to 1.
+  clock_replacer.Unpin(4);
+
+  // Scenario: continue looking for victims. We expect these victims.
+  clock_replacer.Victim(&value);
+  EXPECT_EQ(5, value);
+  clock_replacer.Victim(&value);
+  EXPECT_EQ(6, value);
+  clock_replacer.Victim(&value);
+  EXPECT_EQ(4, value);
+  EXPECT_FALSE(clock_replacer.Victim(&value));
+}
+
+TEST(CLOCKReplacerTest, ConcurrentTest) {
+  const int num_frames = 1024;
+  const int num_threads = 4;
+  CLOCKReplacer clock_replacer(num_frames);
+
+  // Scenario: every thread unpins its own frames, then victimizes as many frames as it unpinned.
+  std::vector<std::thread> threads;
+  std::vector<std::vector<int>> victims(num_threads);
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&, t] {
+      for (int i = t; i < num_frames; i += num_threads) {
+        clock_replacer.Pin(i);
+        clock_replacer.Unpin(i);
+      }
+      for (int i = t; i < num_frames; i += num_threads) {
+        int value;
+        if (clock_replacer.Victim(&value)) {
+          victims[t].push_back(value);
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  // Scenario: no frame is handed out twice.
+  std::vector<bool> seen(num_frames, false);
+  size_t total = 0;
+  for (auto &thread_victims : victims) {
+    for (int value : thread_victims) {
+      ASSERT_FALSE(seen[value]);
+      seen[value] = true;
+      total++;
+    }
+  }
+  EXPECT_EQ(num_frames, total + clock_replacer.Size());
+}
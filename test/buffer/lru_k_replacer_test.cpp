@@ -0,0 +1,145 @@
+#include "buffer/lru_k_replacer.h"
+
+#include <atomic>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+
+TEST(LRUKReplacerTest, SampleTest) {
+  LRUKReplacer lru_k_replacer(7, 2);
+
+  // Scenario: frames 1-6 are accessed once, frame 1 is accessed a second time.
+  for (int i = 1; i <= 6; i++) {
+    lru_k_replacer.Pin(i);
+  }
+  lru_k_replacer.Pin(1);
+  for (int i = 1; i <= 6; i++) {
+    lru_k_replacer.Unpin(i);
+  }
+  EXPECT_EQ(6, lru_k_replacer.Size());
+
+  // Scenario: frames with less than k accesses go first, in the order of their first access.
+  int value;
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(2, value);
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(3, value);
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(4, value);
+
+  // Scenario: pinning takes a frame out of the replacer, frame 3 is already gone.
+  lru_k_replacer.Pin(3);
+  lru_k_replacer.Pin(5);
+  EXPECT_EQ(2, lru_k_replacer.Size());
+
+  // Scenario: frame 5 now has two accesses, frame 6 still one. The victim order is 6, then 1 whose second last
+  // access is older than the one of 5.
+  lru_k_replacer.Unpin(5);
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(6, value);
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(1, value);
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(5, value);
+  EXPECT_FALSE(lru_k_replacer.Victim(&value));
+
+  // Scenario: a removed frame starts over with an empty history.
+  lru_k_replacer.Pin(1);
+  lru_k_replacer.Pin(1);
+  lru_k_replacer.Unpin(1);
+  lru_k_replacer.Remove(1);
+  EXPECT_EQ(0, lru_k_replacer.Size());
+  lru_k_replacer.Pin(2);
+  lru_k_replacer.Unpin(2);
+  lru_k_replacer.Pin(1);
+  lru_k_replacer.Unpin(1);
+  ASSERT_TRUE(lru_k_replacer.Victim(&value));
+  EXPECT_EQ(2, value);
+}
+
+/**
+ * Run point lookups on num_hot_pages pages of a buffer pool of num_frames frames while another thread scans
+ * num_scan_pages other pages once, and return the hit rate of the lookups. A lookup marks the page in its frame
+ * without dirtying it, so a page that was evicted and read back from disk has lost the mark and counts as a miss.
+ */
+static double HotPageHitRate(ReplacerType replacer_type, size_t num_frames, int num_hot_pages, int num_scan_pages,
+                             int scan_pages_per_lookup) {
+  const std::string db_name = "lru_k_scan_resistance_test.db";
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(num_frames, disk_manager, replacer_type, 2);
+  std::vector<page_id_t> scan_pages(num_scan_pages);
+  std::vector<page_id_t> hot_pages(num_hot_pages);
+  for (auto *pages : {&scan_pages, &hot_pages}) {
+    for (auto &page_id : *pages) {
+      EXPECT_NE(nullptr, bpm->NewPage(page_id));
+      EXPECT_TRUE(bpm->FlushPage(page_id));
+      EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+    }
+  }
+  auto lookup = [bpm](page_id_t page_id) {
+    Page *page = bpm->FetchPage(page_id);
+    EXPECT_NE(nullptr, page);
+    if (page == nullptr) {
+      return false;
+    }
+    bool hit = page->GetData()[0] == 1;
+    page->GetData()[0] = 1;
+    bpm->UnpinPage(page_id, false);
+    return hit;
+  };
+  // warm up the index pages, then run point lookups while a full table scan streams through the pool
+  for (int round = 0; round < 2; round++) {
+    for (auto page_id : hot_pages) {
+      lookup(page_id);
+    }
+  }
+  const int num_lookups = num_scan_pages / scan_pages_per_lookup;
+  std::atomic<int> scanned{0};
+  std::atomic<int> looked_up{0};
+  std::thread scan([&] {
+    for (int i = 0; i < num_scan_pages; i++) {
+      // keep the two threads close, so that scan_pages_per_lookup pages are scanned per lookup
+      while (i / scan_pages_per_lookup > looked_up.load() + 1) {
+        std::this_thread::yield();
+      }
+      EXPECT_NE(nullptr, bpm->FetchPage(scan_pages[i]));
+      bpm->UnpinPage(scan_pages[i], false);
+      scanned.store(i + 1);
+    }
+  });
+  int hits = 0;
+  for (int i = 0; i < num_lookups; i++) {
+    while (scanned.load() < i * scan_pages_per_lookup) {
+      std::this_thread::yield();
+    }
+    hits += lookup(hot_pages[i % num_hot_pages]);
+    looked_up.store(i + 1);
+  }
+  scan.join();
+  EXPECT_TRUE(bpm->CheckAllUnpinned());
+  delete bpm;
+  delete disk_manager;
+  remove(db_name.c_str());
+  return static_cast<double>(hits) / num_lookups;
+}
+
+TEST(LRUKReplacerTest, ScanResistanceTest) {
+  const size_t num_frames = 64;
+  const int num_hot_pages = 32;
+  const int num_scan_pages = 4000;
+  const int scan_pages_per_lookup = 4;
+
+  double lru_hit_rate =
+      HotPageHitRate(ReplacerType::kLRU, num_frames, num_hot_pages, num_scan_pages, scan_pages_per_lookup);
+  double lru_k_hit_rate =
+      HotPageHitRate(ReplacerType::kLRUK, num_frames, num_hot_pages, num_scan_pages, scan_pages_per_lookup);
+
+  // a scan touching every page once must not push the index pages out of a LRU-K pool, while a LRU pool loses them
+  EXPECT_GT(lru_k_hit_rate, 0.99);
+  EXPECT_LT(lru_hit_rate, 0.5);
+}
@@ -0,0 +1,113 @@
+#include "buffer/parallel_buffer_pool_manager.h"
+
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+TEST(ParallelBufferPoolManagerTest, SampleTest) {
+  const std::string db_name = "parallel_bpm_test.db";
+  const size_t num_instances = 4;
+  const size_t pool_size = 5;
+
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(num_instances, pool_size, disk_manager);
+  ASSERT_EQ(num_instances * pool_size, bpm->GetPoolSize());
+
+  // Scenario: page ids are handed out in order and every shard accepts its own pages.
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < num_instances * pool_size; ++i) {
+    auto *page = bpm->NewPage(page_id_temp);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(i, page_id_temp);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id_temp);
+  }
+
+  // Scenario: every shard is full, the next page would go to shard 0 and must fail without leaking the page id.
+  EXPECT_EQ(nullptr, bpm->NewPage(page_id_temp));
+  EXPECT_EQ(INVALID_PAGE_ID, page_id_temp);
+
+  // Scenario: freeing a frame in shard 0 makes room for exactly the next page id.
+  EXPECT_TRUE(bpm->UnpinPage(0, true));
+  auto *page = bpm->NewPage(page_id_temp);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(num_instances * pool_size, page_id_temp);
+  EXPECT_TRUE(bpm->UnpinPage(page_id_temp, false));
+
+  // Scenario: page 0 was written back when it was evicted and can be read again.
+  for (size_t i = 1; i < num_instances * pool_size; ++i) {
+    EXPECT_TRUE(bpm->UnpinPage(i, true));
+  }
+  page = bpm->FetchPage(0);
+  ASSERT_NE(nullptr, page);
+  EXPECT_STREQ("page 0", page->GetData());
+  EXPECT_TRUE(bpm->UnpinPage(0, false));
+  EXPECT_TRUE(bpm->CheckAllUnpinned());
+
+  // Scenario: threads working on different shards see their own data.
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < num_instances; t++) {
+    threads.emplace_back([bpm, t] {
+      for (int round = 0; round < 100; round++) {
+        for (size_t i = t; i < num_instances * pool_size; i += num_instances) {
+          auto *p = bpm->FetchPage(i);
+          ASSERT_NE(nullptr, p);
+          char expected[PAGE_SIZE];
+          snprintf(expected, PAGE_SIZE, "page %zu", i);
+          EXPECT_STREQ(expected, p->GetData());
+          bpm->UnpinPage(i, false);
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_TRUE(bpm->CheckAllUnpinned());
+
+  delete bpm;
+  delete disk_manager;
+  remove(db_name.c_str());
+}
+
+TEST(ParallelBufferPoolManagerTest, NewPageInAnotherShardTest) {
+  const std::string db_name = "parallel_bpm_new_page_test.db";
+  const size_t num_instances = 4;
+  const size_t pool_size = 2;
+
+  remove(db_name.c_str());
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(num_instances, pool_size, disk_manager);
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < num_instances * pool_size; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(page_id_temp));
+  }
+
+  // Scenario: only shard 2 has a free frame, the next page ids belong to shards 0 and 1 but the page still fits.
+  EXPECT_TRUE(bpm->UnpinPage(2, true));
+  ASSERT_NE(nullptr, bpm->NewPage(page_id_temp));
+  EXPECT_EQ(2U, page_id_temp % num_instances);
+  EXPECT_FALSE(bpm->IsPageFree(page_id_temp));
+
+  // Scenario: no shard has a free frame, the ids tried are given back.
+  EXPECT_EQ(nullptr, bpm->NewPage(page_id_temp));
+  EXPECT_EQ(INVALID_PAGE_ID, page_id_temp);
+  for (page_id_t i = num_instances * pool_size; i < static_cast<page_id_t>(num_instances * pool_size + 2); i++) {
+    EXPECT_TRUE(bpm->IsPageFree(i));
+  }
+
+  for (size_t i = 0; i < num_instances * pool_size; ++i) {
+    if (i != 2) {
+      EXPECT_TRUE(bpm->UnpinPage(i, false));
+    }
+  }
+  EXPECT_TRUE(bpm->UnpinPage(num_instances * pool_size + 2, false));
+  EXPECT_TRUE(bpm->CheckAllUnpinned());
+
+  delete bpm;
+  delete disk_manager;
+  remove(db_name.c_str());
+}
@@ -125,4 +125,459 @@ TEST(CatalogTest, CatalogIndexTest) {
     ASSERT_EQ(rid.Get(), ret_02[i].Get());
   }
   delete db_02;
-}
\ No newline at end of file
+}
+
+TEST(CatalogTest, CatalogFixedWidthTableTest) {
+  auto db_01 = new DBStorageEngine(db_file_name, true);
+  auto &catalog_01 = db_01->catalog_mgr_;
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 16, 1, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  schema->SetFixedWidth(true);
+  std::vector<Column *> other_columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                         new Column("name", TypeId::kTypeChar, 16, 1, true, false)};
+  auto other_schema = std::make_shared<Schema>(other_columns);
+  Transaction txn;
+  TableInfo *table_info = nullptr;
+  TableInfo *other_info = nullptr;
+  ASSERT_EQ(DB_SUCCESS, catalog_01->CreateTable("fixed", schema.get(), &txn, table_info));
+  ASSERT_EQ(DB_SUCCESS, catalog_01->CreateTable("variable", other_schema.get(), &txn, other_info));
+  ASSERT_TRUE(table_info->GetSchema()->IsFixedWidth());
+  ASSERT_FALSE(other_info->GetSchema()->IsFixedWidth());
+  std::vector<RowId> rids;
+  for (int i = 0; i < 100; i++) {
+    std::string name = "name-" + std::to_string(i);
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i),
+                              Field(TypeId::kTypeChar, const_cast<char *>(name.c_str()), name.size(), true)};
+    Row row(fields);
+    ASSERT_TRUE(table_info->GetTableHeap()->InsertTuple(row, &txn));
+    Row other_row(fields);
+    ASSERT_TRUE(other_info->GetTableHeap()->InsertTuple(other_row, &txn));
+    rids.push_back(row.GetRowId());
+  }
+  // a name longer than char(16) is refused rather than truncated
+  std::string long_name(17, 'x');
+  std::vector<Field> long_fields{Field(TypeId::kTypeInt, 100),
+                                 Field(TypeId::kTypeChar, const_cast<char *>(long_name.c_str()), long_name.size(), true)};
+  Row long_row(long_fields);
+  ASSERT_FALSE(table_info->GetTableHeap()->InsertTuple(long_row, &txn));
+  ASSERT_TRUE(other_info->GetTableHeap()->InsertTuple(long_row, &txn));
+  // nor can an index key hold it
+  IndexInfo *index_info = nullptr;
+  ASSERT_EQ(DB_FAILED, catalog_01->CreateIndex("variable", "name_idx", {"name"}, &txn, index_info, "bptree", false));
+  delete db_01;
+
+  // the format of each table survives a restart
+  auto db_02 = new DBStorageEngine(db_file_name, false);
+  auto &catalog_02 = db_02->catalog_mgr_;
+  ASSERT_EQ(DB_SUCCESS, catalog_02->GetTable("fixed", table_info));
+  ASSERT_EQ(DB_SUCCESS, catalog_02->GetTable("variable", other_info));
+  ASSERT_TRUE(table_info->GetSchema()->IsFixedWidth());
+  ASSERT_FALSE(other_info->GetSchema()->IsFixedWidth());
+  for (int i = 0; i < 100; i++) {
+    Row row(rids[i]);
+    ASSERT_TRUE(table_info->GetTableHeap()->GetTuple(&row, &txn));
+    EXPECT_EQ(CmpBool::kTrue, row.GetField(0)->CompareEquals(Field(TypeId::kTypeInt, i)));
+    std::string name = "name-" + std::to_string(i);
+    EXPECT_EQ(name, std::string(row.GetField(1)->GetData(), row.GetField(1)->GetLength()));
+  }
+  size_t count = 0;
+  for (auto iter = other_info->GetTableHeap()->Begin(&txn); iter != other_info->GetTableHeap()->End(); ++iter) {
+    count++;
+  }
+  EXPECT_EQ(101, count);
+  delete db_02;
+}
+
+TEST(CatalogTest, CatalogColumnarTableTest) {
+  auto db_01 = new DBStorageEngine(db_file_name, true);
+  auto &catalog_01 = db_01->catalog_mgr_;
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 16, 1, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  schema->SetColumnar(true);
+  Transaction txn;
+  TableInfo *table_info = nullptr;
+  ASSERT_EQ(DB_SUCCESS, catalog_01->CreateTable("columnar", schema.get(), &txn, table_info));
+  ASSERT_TRUE(table_info->GetSchema()->IsColumnar());
+  std::vector<RowId> rids;
+  for (int i = 0; i < 1000; i++) {
+    std::string name = "name-" + std::to_string(i);
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i),
+                              Field(TypeId::kTypeChar, const_cast<char *>(name.c_str()), name.size(), true)};
+    Row row(fields);
+    ASSERT_TRUE(table_info->GetTableHeap()->InsertTuple(row, &txn));
+    rids.push_back(row.GetRowId());
+  }
+  // the index is filled from the existing rows, read in place from the minipages
+  IndexInfo *index_info = nullptr;
+  ASSERT_EQ(DB_SUCCESS, catalog_01->CreateIndex("columnar", "name_idx", {"name"}, &txn, index_info, "bptree"));
+  delete db_01;
+
+  auto db_02 = new DBStorageEngine(db_file_name, false);
+  auto &catalog_02 = db_02->catalog_mgr_;
+  ASSERT_EQ(DB_SUCCESS, catalog_02->GetTable("columnar", table_info));
+  ASSERT_TRUE(table_info->GetSchema()->IsColumnar());
+  ASSERT_EQ(DB_SUCCESS, catalog_02->GetIndex("columnar", "name_idx", index_info));
+  for (int i = 0; i < 1000; i += 37) {
+    Row row(rids[i]);
+    ASSERT_TRUE(table_info->GetTableHeap()->GetTuple(&row, &txn));
+    EXPECT_EQ(CmpBool::kTrue, row.GetField(0)->CompareEquals(Field(TypeId::kTypeInt, i)));
+    std::string name = "name-" + std::to_string(i);
+    std::vector<Field> key_fields{Field(TypeId::kTypeChar, const_cast<char *>(name.c_str()), name.size(), true)};
+    Row key(key_fields);
+    std::vector<RowId> result;
+    ASSERT_EQ(DB_SUCCESS, index_info->GetIndex()->ScanKey(key, result, &txn));
+    ASSERT_EQ(1, result.size());
+    EXPECT_EQ(rids[i].Get(), result[0].Get());
+  }
+  delete db_02;
+}
+
+TEST(CatalogTest, CatalogNonUniqueIndexTest) {
+  auto db_01 = new DBStorageEngine(db_file_name, true);
+  auto &catalog_01 = db_01->catalog_mgr_;
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("grp", TypeId::kTypeInt, 1, false, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  Transaction txn;
+  TableInfo *table_info = nullptr;
+  ASSERT_EQ(DB_SUCCESS, catalog_01->CreateTable("groups", schema.get(), &txn, table_info));
+  for (int i = 0; i < 1000; i++) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeInt, i % 10)};
+    Row row(fields);
+    ASSERT_TRUE(table_info->GetTableHeap()->InsertTuple(row, &txn));
+  }
+  // the rows have duplicate groups, only a non-unique index can be built on them
+  IndexInfo *index_info = nullptr;
+  ASSERT_EQ(DB_FAILED, catalog_01->CreateIndex("groups", "grp_unique", {"grp"}, &txn, index_info, "bptree"));
+  ASSERT_EQ(DB_SUCCESS, catalog_01->CreateIndex("groups", "grp_idx", {"grp"}, &txn, index_info, "bptree", false));
+  ASSERT_FALSE(index_info->GetIndexMetadata().IsUnique());
+  delete db_01;
+
+  auto db_02 = new DBStorageEngine(db_file_name, false);
+  auto &catalog_02 = db_02->catalog_mgr_;
+  ASSERT_EQ(DB_SUCCESS, catalog_02->GetIndex("groups", "grp_idx", index_info));
+  ASSERT_FALSE(index_info->GetIndexMetadata().IsUnique());
+  std::vector<Field> key_fields{Field(TypeId::kTypeInt, 3)};
+  Row key(key_fields);
+  std::vector<RowId> result;
+  ASSERT_EQ(DB_SUCCESS, index_info->GetIndex()->ScanKey(key, result, &txn));
+  ASSERT_EQ(100, result.size());
+  result.clear();
+  ASSERT_EQ(DB_SUCCESS, index_info->GetIndex()->ScanKey(key, result, &txn, ">"));
+  ASSERT_EQ(600, result.size());
+  result.clear();
+  ASSERT_EQ(DB_SUCCESS, index_info->GetIndex()->ScanKey(key, result, &txn, "<="));
+  ASSERT_EQ(400, result.size());
+  result.clear();
+  ASSERT_EQ(DB_SUCCESS, index_info->GetIndex()->ScanKey(key, result, &txn, "<>"));
+  ASSERT_EQ(900, result.size());
+  // removing a row leaves the other rows of its key
+  result.clear();
+  ASSERT_EQ(DB_SUCCESS, index_info->GetIndex()->ScanKey(key, result, &txn));
+  ASSERT_EQ(DB_SUCCESS, index_info->GetIndex()->RemoveEntry(key, result[0], &txn));
+  result.clear();
+  ASSERT_EQ(DB_SUCCESS, index_info->GetIndex()->ScanKey(key, result, &txn));
+  ASSERT_EQ(99, result.size());
+  delete db_02;
+}
+
+TEST(CatalogTest, CatalogOutOfLineKeyTest) {
+  auto db_01 = new DBStorageEngine(db_file_name, true);
+  auto &catalog_01 = db_01->catalog_mgr_;
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 32, 1, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  Transaction txn;
+  TableInfo *table_info = nullptr;
+  ASSERT_EQ(DB_SUCCESS, catalog_01->CreateTable("names", schema.get(), &txn, table_info));
+  // a name far longer than its column is moved out of line by the heap
+  std::string long_name(2 * TOAST_TUPLE_THRESHOLD, 'n');
+  for (int i = 0; i < 100; i++) {
+    std::string name = i == 50 ? long_name : "name-" + std::to_string(i);
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i),
+                              Field(TypeId::kTypeChar, const_cast<char *>(name.c_str()), name.size(), true)};
+    Row row(fields);
+    ASSERT_TRUE(table_info->GetTableHeap()->InsertTuple(row, &txn));
+  }
+  // the index can not hold that key, creating it fails instead of aborting
+  IndexInfo *index_info = nullptr;
+  ASSERT_EQ(DB_FAILED, catalog_01->CreateIndex("names", "name_idx", {"name"}, &txn, index_info, "bptree", false));
+  ASSERT_EQ(DB_SUCCESS, catalog_01->CreateIndex("names", "id_idx", {"id"}, &txn, index_info, "bptree"));
+  ASSERT_EQ(DB_INDEX_NOT_FOUND, catalog_01->GetIndex("names", "name_idx", index_info));
+  delete db_01;
+}
+
+TEST(CatalogTest, CatalogReplacerTypeTest) {
+  // a small pool, so that pages are evicted and read back through each replacement policy, with and without the
+  // background flusher
+  std::vector<std::pair<ReplacerType, bool>> configs = {{ReplacerType::kLRU, true},   {ReplacerType::kLRU, false},
+                                                        {ReplacerType::kLRUK, true},  {ReplacerType::kLRUK, false},
+                                                        {ReplacerType::kClock, true}, {ReplacerType::kClock, false}};
+  for (auto [replacer_type, background_flusher] : configs) {
+    auto db_01 = new DBStorageEngine(db_file_name, true, 32, DEFAULT_BUFFER_POOL_INSTANCES, replacer_type,
+                                     DEFAULT_LRUK_REPLACER_K, background_flusher);
+    std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                     new Column("name", TypeId::kTypeChar, 64, 1, true, false)};
+    auto schema = std::make_shared<Schema>(columns);
+    Transaction txn;
+    TableInfo *table_info = nullptr;
+    ASSERT_EQ(DB_SUCCESS, db_01->catalog_mgr_->CreateTable("table-1", schema.get(), &txn, table_info));
+    const int row_count = 5000;
+    for (int i = 0; i < row_count; i++) {
+      std::string name = "name-" + std::to_string(i);
+      std::vector<Field> fields{Field(TypeId::kTypeInt, i),
+                                Field(TypeId::kTypeChar, const_cast<char *>(name.c_str()), name.size(), true)};
+      Row row(fields);
+      ASSERT_TRUE(table_info->GetTableHeap()->InsertTuple(row, &txn));
+    }
+    delete db_01;
+    auto db_02 = new DBStorageEngine(db_file_name, false, 32, DEFAULT_BUFFER_POOL_INSTANCES, replacer_type,
+                                     DEFAULT_LRUK_REPLACER_K, background_flusher);
+    ASSERT_EQ(DB_SUCCESS, db_02->catalog_mgr_->GetTable("table-1", table_info));
+    int count = 0;
+    for (auto iter = table_info->GetTableHeap()->Begin(&txn); iter != table_info->GetTableHeap()->End(); ++iter) {
+      ASSERT_EQ(CmpBool::kTrue, (*iter).GetField(0)->CompareEquals(Field(TypeId::kTypeInt, count)));
+      count++;
+    }
+    ASSERT_EQ(row_count, count);
+    delete db_02;
+  }
+}
+
+/**
+ * Rewrite the metadata record of a table in the layout used before the free space map and the tuple format were
+ * recorded: magic number 344528 | table id | name | first page id | schema.
+ */
+static void WritePreFreeSpaceMapRecord(DBStorageEngine *db, TableInfo *table_info) {
+  Page *catalog_page = db->bpm_->FetchPage(CATALOG_META_PAGE_ID);
+  CatalogMeta *meta = CatalogMeta::DeserializeFrom(catalog_page->GetData());
+  db->bpm_->UnpinPage(CATALOG_META_PAGE_ID, false);
+  page_id_t meta_page_id = meta->GetTableMetaPages()->at(table_info->GetTableId());
+  delete meta;
+  char *buf = db->bpm_->FetchPage(meta_page_id)->GetData();
+  MACH_WRITE_UINT32(buf, 344528);
+  buf += sizeof(uint32_t);
+  MACH_WRITE_TO(table_id_t, buf, table_info->GetTableId());
+  buf += sizeof(table_id_t);
+  std::string name = table_info->GetTableName();
+  MACH_WRITE_UINT32(buf, name.size());
+  buf += sizeof(uint32_t);
+  memcpy(buf, name.c_str(), name.size());
+  buf += name.size();
+  MACH_WRITE_INT32(buf, table_info->GetTableHeap()->GetFirstPageId());
+  buf += sizeof(int32_t);
+  table_info->GetSchema()->SerializeTo(buf);
+  db->bpm_->UnpinPage(meta_page_id, true);
+}
+
+TEST(CatalogTest, CatalogPreFreeSpaceMapTableTest) {
+  auto db_01 = new DBStorageEngine(db_file_name, true);
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 64, 1, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  Transaction txn;
+  TableInfo *table_info = nullptr;
+  ASSERT_EQ(DB_SUCCESS, db_01->catalog_mgr_->CreateTable("legacy", schema.get(), &txn, table_info));
+  const int row_count = 1000;
+  for (int i = 0; i < row_count; i++) {
+    std::string name = "name-" + std::to_string(i);
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i),
+                              Field(TypeId::kTypeChar, const_cast<char *>(name.c_str()), name.size(), true)};
+    Row row(fields);
+    ASSERT_TRUE(table_info->GetTableHeap()->InsertTuple(row, &txn));
+  }
+  WritePreFreeSpaceMapRecord(db_01, table_info);
+  delete db_01;
+
+  // the table is still opened, its heap rebuilds a free space map which is then recorded
+  auto db_02 = new DBStorageEngine(db_file_name, false);
+  ASSERT_EQ(DB_SUCCESS, db_02->catalog_mgr_->GetTable("legacy", table_info));
+  ASSERT_FALSE(table_info->GetSchema()->IsFixedWidth());
+  page_id_t fsm_page_id = table_info->GetTableHeap()->GetFreeSpaceMapPageId();
+  ASSERT_NE(INVALID_PAGE_ID, fsm_page_id);
+  std::string name = "name-" + std::to_string(row_count);
+  std::vector<Field> fields{Field(TypeId::kTypeInt, row_count),
+                            Field(TypeId::kTypeChar, const_cast<char *>(name.c_str()), name.size(), true)};
+  Row row(fields);
+  ASSERT_TRUE(table_info->GetTableHeap()->InsertTuple(row, &txn));
+  delete db_02;
+
+  auto db_03 = new DBStorageEngine(db_file_name, false);
+  ASSERT_EQ(DB_SUCCESS, db_03->catalog_mgr_->GetTable("legacy", table_info));
+  ASSERT_EQ(fsm_page_id, table_info->GetTableHeap()->GetFreeSpaceMapPageId());
+  int count = 0;
+  for (auto iter = table_info->GetTableHeap()->Begin(&txn); iter != table_info->GetTableHeap()->End(); ++iter) {
+    ASSERT_EQ(CmpBool::kTrue, (*iter).GetField(0)->CompareEquals(Field(TypeId::kTypeInt, count)));
+    count++;
+  }
+  ASSERT_EQ(row_count + 1, count);
+  delete db_03;
+}
+
+TEST(CatalogTest, CatalogPreFormatTableTest) {
+  // a table of fixed-length columns written before the tuple format was recorded holds variable-length tuples
+  auto db_01 = new DBStorageEngine(db_file_name, true);
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("account", TypeId::kTypeFloat, 1, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  ASSERT_TRUE(schema->CanBeFixedWidth());
+  Transaction txn;
+  TableInfo *table_info = nullptr;
+  ASSERT_EQ(DB_SUCCESS, db_01->catalog_mgr_->CreateTable("legacy", schema.get(), &txn, table_info));
+  ASSERT_FALSE(table_info->GetSchema()->IsFixedWidth());
+  const int row_count = 1000;
+  for (int i = 0; i < row_count; i++) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeFloat, i * 0.5f)};
+    Row row(fields);
+    ASSERT_TRUE(table_info->GetTableHeap()->InsertTuple(row, &txn));
+  }
+  WritePreFreeSpaceMapRecord(db_01, table_info);
+  delete db_01;
+
+  // the table keeps the variable format when it is loaded, and when its record is written back and loaded again
+  for (int open = 0; open < 2; open++) {
+    auto db_02 = new DBStorageEngine(db_file_name, false);
+    ASSERT_EQ(DB_SUCCESS, db_02->catalog_mgr_->GetTable("legacy", table_info));
+    ASSERT_FALSE(table_info->GetSchema()->IsFixedWidth());
+    ASSERT_FALSE(table_info->GetSchema()->IsColumnar());
+    int count = 0;
+    for (auto iter = table_info->GetTableHeap()->Begin(&txn); iter != table_info->GetTableHeap()->End(); ++iter) {
+      ASSERT_EQ(CmpBool::kTrue, (*iter).GetField(0)->CompareEquals(Field(TypeId::kTypeInt, count)));
+      ASSERT_EQ(CmpBool::kTrue, (*iter).GetField(1)->CompareEquals(Field(TypeId::kTypeFloat, count * 0.5f)));
+      count++;
+    }
+    ASSERT_EQ(row_count, count);
+    delete db_02;
+  }
+}
+
+TEST(CatalogTest, CatalogTwoTablesTest) {
+  // every table gets its own id, so a second table does not take the catalog entry of the first
+  auto db_01 = new DBStorageEngine(db_file_name, true);
+  auto &catalog_01 = db_01->catalog_mgr_;
+  std::vector<Column *> columns_1 = {new Column("id", TypeId::kTypeInt, 0, false, false)};
+  std::vector<Column *> columns_2 = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                     new Column("account", TypeId::kTypeFloat, 1, true, false)};
+  auto schema_1 = std::make_shared<Schema>(columns_1);
+  auto schema_2 = std::make_shared<Schema>(columns_2);
+  Transaction txn;
+  TableInfo *table_info_1 = nullptr;
+  TableInfo *table_info_2 = nullptr;
+  ASSERT_EQ(DB_SUCCESS, catalog_01->CreateTable("table-1", schema_1.get(), &txn, table_info_1));
+  ASSERT_EQ(DB_SUCCESS, catalog_01->CreateTable("table-2", schema_2.get(), &txn, table_info_2));
+  ASSERT_NE(table_info_1->GetTableId(), table_info_2->GetTableId());
+  std::vector<Field> fields{Field(TypeId::kTypeInt, 1)};
+  Row row(fields);
+  ASSERT_TRUE(table_info_1->GetTableHeap()->InsertTuple(row, &txn));
+  delete db_01;
+
+  auto db_02 = new DBStorageEngine(db_file_name, false);
+  auto &catalog_02 = db_02->catalog_mgr_;
+  ASSERT_EQ(DB_SUCCESS, catalog_02->GetTable("table-1", table_info_1));
+  ASSERT_EQ(DB_SUCCESS, catalog_02->GetTable("table-2", table_info_2));
+  ASSERT_NE(table_info_1->GetTableId(), table_info_2->GetTableId());
+  ASSERT_EQ(1, table_info_1->GetSchema()->GetColumnCount());
+  ASSERT_EQ(2, table_info_2->GetSchema()->GetColumnCount());
+  int count = 0;
+  for (auto iter = table_info_1->GetTableHeap()->Begin(&txn); iter != table_info_1->GetTableHeap()->End(); ++iter) {
+    count++;
+  }
+  ASSERT_EQ(1, count);
+  ASSERT_TRUE(table_info_2->GetTableHeap()->Begin(&txn) == table_info_2->GetTableHeap()->End());
+  delete db_02;
+}
+
+/**
+ * Rewrite the metadata record of an index in the layout used before is_unique_ was recorded and the keys were
+ * normalized: magic number 344528 | index id | name | table id | key count | key map.
+ */
+static void WritePreNormalizedIndexRecord(DBStorageEngine *db, IndexInfo *index_info, table_id_t table_id) {
+  IndexMetadata index_meta = index_info->GetIndexMetadata();
+  Page *catalog_page = db->bpm_->FetchPage(CATALOG_META_PAGE_ID);
+  CatalogMeta *meta = CatalogMeta::DeserializeFrom(catalog_page->GetData());
+  db->bpm_->UnpinPage(CATALOG_META_PAGE_ID, false);
+  page_id_t meta_page_id = meta->GetIndexMetaPages()->at(index_meta.GetIndexId());
+  delete meta;
+  char *buf = db->bpm_->FetchPage(meta_page_id)->GetData();
+  MACH_WRITE_UINT32(buf, 344528);
+  buf += sizeof(uint32_t);
+  MACH_WRITE_TO(index_id_t, buf, index_meta.GetIndexId());
+  buf += sizeof(index_id_t);
+  std::string name = index_meta.GetIndexName();
+  MACH_WRITE_UINT32(buf, name.size());
+  buf += sizeof(uint32_t);
+  memcpy(buf, name.c_str(), name.size());
+  buf += name.size();
+  MACH_WRITE_TO(table_id_t, buf, table_id);
+  buf += sizeof(table_id_t);
+  MACH_WRITE_UINT32(buf, index_meta.GetIndexColumnCount());
+  buf += sizeof(uint32_t);
+  for (uint32_t column : index_meta.GetKeyMapping()) {
+    MACH_WRITE_UINT32(buf, column);
+    buf += sizeof(uint32_t);
+  }
+  db->bpm_->UnpinPage(meta_page_id, true);
+}
+
+TEST(CatalogTest, CatalogPreNormalizedIndexTest) {
+  auto db_01 = new DBStorageEngine(db_file_name, true);
+  auto &catalog_01 = db_01->catalog_mgr_;
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 32, 1, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  Transaction txn;
+  TableInfo *table_info = nullptr;
+  ASSERT_EQ(DB_SUCCESS, catalog_01->CreateTable("legacy", schema.get(), &txn, table_info));
+  auto insert_rows = [&](int begin, int end) {
+    for (int i = begin; i < end; i++) {
+      std::string name = "name-" + std::to_string(i);
+      std::vector<Field> fields{Field(TypeId::kTypeInt, i),
+                                Field(TypeId::kTypeChar, const_cast<char *>(name.c_str()), name.size(), true)};
+      Row row(fields);
+      ASSERT_TRUE(table_info->GetTableHeap()->InsertTuple(row, &txn));
+    }
+  };
+  insert_rows(0, 300);
+  IndexInfo *index_info = nullptr;
+  ASSERT_EQ(DB_SUCCESS, catalog_01->CreateIndex("legacy", "id_idx", {"id"}, &txn, index_info, "bptree"));
+  // rows the old tree does not hold, they are only found if the index is rebuilt from the table
+  insert_rows(300, 500);
+  WritePreNormalizedIndexRecord(db_01, index_info, table_info->GetTableId());
+  delete db_01;
+
+  auto find_ids = [&](IndexInfo *index_info, int begin, int end) {
+    for (int i = begin; i < end; i++) {
+      std::vector<Field> key_fields{Field(TypeId::kTypeInt, i)};
+      Row key(key_fields);
+      std::vector<RowId> result;
+      index_info->GetIndex()->ScanKey(key, result, &txn);
+      ASSERT_EQ(1, result.size()) << "id " << i;
+      Row row(result[0]);
+      ASSERT_TRUE(table_info->GetTableHeap()->GetTuple(&row, &txn));
+      ASSERT_EQ(CmpBool::kTrue, row.GetField(0)->CompareEquals(Field(TypeId::kTypeInt, i)));
+    }
+  };
+  // the index is read as unique, and rebuilt from the table
+  auto db_02 = new DBStorageEngine(db_file_name, false);
+  ASSERT_EQ(DB_SUCCESS, db_02->catalog_mgr_->GetTable("legacy", table_info));
+  ASSERT_EQ(DB_SUCCESS, db_02->catalog_mgr_->GetIndex("legacy", "id_idx", index_info));
+  ASSERT_TRUE(index_info->GetIndexMetadata().IsUnique());
+  find_ids(index_info, 0, 500);
+  insert_rows(500, 501);
+  delete db_02;
+
+  // its record was written back in the current layout, so it is not rebuilt again
+  auto db_03 = new DBStorageEngine(db_file_name, false);
+  ASSERT_EQ(DB_SUCCESS, db_03->catalog_mgr_->GetTable("legacy", table_info));
+  ASSERT_EQ(DB_SUCCESS, db_03->catalog_mgr_->GetIndex("legacy", "id_idx", index_info));
+  ASSERT_TRUE(index_info->GetIndexMetadata().IsUnique());
+  find_ids(index_info, 0, 500);
+  std::vector<Field> key_fields{Field(TypeId::kTypeInt, 500)};
+  Row key(key_fields);
+  std::vector<RowId> result;
+  index_info->GetIndex()->ScanKey(key, result, &txn);
+  ASSERT_TRUE(result.empty());
+  delete db_03;
+}
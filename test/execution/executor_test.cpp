@@ -7,6 +7,13 @@
 #include "executor/plans/update_plan.h"
 #include "executor/plans/values_plan.h"
 #include "executor_test_util.h"  // NOLINT
+#include "planner/expressions/logic_expression.h"
+
+extern "C" {
+int yyparse(void);
+#include "parser/minisql_lex.h"
+#include "parser/parser.h"
+}
 
 // SELECT id FROM table-1 WHERE id < 500
 TEST_F(ExecutorTest, SimpleSeqScanTest) {
@@ -155,3 +162,199 @@ TEST_F(ExecutorTest, SimpleUpdateTest) {
     ASSERT_TRUE(row.GetField(1)->CompareEquals(Field(kTypeChar, const_cast<char *>("minisql"), 7, false)));
   }
 }
+
+// SELECT id, name FROM table-1 WHERE id < 6000, scanned in parallel
+TEST_F(ExecutorTest, ParallelSeqScanTest) {
+  TableInfo *table_info;
+  GetExecutorContext()->GetCatalog()->GetTable("table-1", table_info);
+  const Schema *schema = table_info->GetSchema();
+  // grow the table well beyond one morsel
+  char characters[64];
+  memset(characters, 'x', sizeof(characters));
+  for (int i = 1000; i < 20000; i++) {
+    Fields fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, characters, 64, true),
+                  Field(TypeId::kTypeFloat, static_cast<float>(i))};
+    Row row(fields);
+    ASSERT_TRUE(table_info->GetTableHeap()->InsertTuple(row, nullptr));
+  }
+  std::vector<page_id_t> page_ids;
+  table_info->GetTableHeap()->GetPageIds(&page_ids);
+  ASSERT_GT(page_ids.size(), 4 * PARALLEL_SCAN_MORSEL_PAGES);
+
+  auto col_a = MakeColumnValueExpression(*schema, 0, "id");
+  auto col_b = MakeColumnValueExpression(*schema, 0, "name");
+  auto const6000 = MakeConstantValueExpression(Field(kTypeInt, 6000));
+  auto predicate = MakeComparisonExpression(col_a, const6000, "<");
+  auto out_schema = MakeOutputSchema({{"id", col_a}, {"name", col_b}});
+  auto serial_plan = make_shared<SeqScanPlanNode>(out_schema, table_info->GetTableName(), predicate);
+  auto parallel_plan = make_shared<SeqScanPlanNode>(out_schema, table_info->GetTableName(), predicate, true);
+  std::vector<Row> serial_set{};
+  GetExecutionEngine()->ExecutePlan(serial_plan, &serial_set, GetTxn(), GetExecutorContext());
+  std::vector<Row> parallel_set{};
+  GetExecutionEngine()->ExecutePlan(parallel_plan, &parallel_set, GetTxn(), GetExecutorContext());
+
+  // Verify: same rows in the same order
+  ASSERT_EQ(6000, serial_set.size());
+  ASSERT_EQ(serial_set.size(), parallel_set.size());
+  for (size_t i = 0; i < serial_set.size(); i++) {
+    ASSERT_EQ(serial_set[i].GetRowId(), parallel_set[i].GetRowId());
+    ASSERT_TRUE(parallel_set[i].GetField(0)->CompareEquals(*serial_set[i].GetField(0)));
+  }
+}
+
+// A scan that skips pages by their zone maps returns exactly the rows of a scan that reads every page
+TEST_F(ExecutorTest, ZoneMapSeqScanTest) {
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, true, false),
+                                   new Column("name", TypeId::kTypeChar, 16, 1, true, false)};
+  auto *schema = new Schema(columns);
+  TableInfo *table_info = nullptr;
+  ASSERT_EQ(DB_SUCCESS, GetExecutorContext()->GetCatalog()->CreateTable("table-2", schema, GetTxn(), table_info));
+  schema = table_info->GetSchema();
+  // ids and names grow with the insert order, every seventh id and every fifth name is null
+  const int row_nums = 3000;
+  std::unordered_map<page_id_t, std::pair<int, int>> id_ranges;
+  for (int i = 0; i < row_nums; i++) {
+    char name[16];
+    int len = snprintf(name, sizeof(name), "%06d", i);
+    Fields fields{i % 7 == 0 ? Field(kTypeInt) : Field(kTypeInt, i),
+                  i % 5 == 0 ? Field(kTypeChar) : Field(kTypeChar, name, len, true)};
+    Row row(fields);
+    ASSERT_TRUE(table_info->GetTableHeap()->InsertTuple(row, nullptr));
+    if (i % 7 != 0) {
+      auto iter = id_ranges.emplace(row.GetRowId().GetPageId(), std::make_pair(i, i)).first;
+      iter->second.second = i;
+    }
+  }
+  std::vector<page_id_t> page_ids;
+  table_info->GetTableHeap()->GetPageIds(&page_ids);
+  ASSERT_GT(page_ids.size(), 4);
+
+  // a scan without a predicate reads every page
+  std::vector<Row> all_rows{};
+  GetExecutionEngine()->ExecutePlan(make_shared<SeqScanPlanNode>(schema, "table-2"), &all_rows, GetTxn(),
+                                    GetExecutorContext());
+  ASSERT_EQ(row_nums, all_rows.size());
+  auto check = [&](const AbstractExpressionRef &predicate) {
+    std::vector<RowId> expected;
+    for (const auto &row : all_rows) {
+      if (Field(kTypeInt, 1).CompareEquals(predicate->Evaluate(&row)) == CmpBool::kTrue) {
+        expected.push_back(row.GetRowId());
+      }
+    }
+    for (bool parallel : {false, true}) {
+      std::vector<Row> result_set{};
+      auto plan = make_shared<SeqScanPlanNode>(schema, "table-2", predicate, parallel);
+      GetExecutionEngine()->ExecutePlan(plan, &result_set, GetTxn(), GetExecutorContext());
+      ASSERT_EQ(expected.size(), result_set.size());
+      for (size_t i = 0; i < expected.size(); i++) {
+        ASSERT_EQ(expected[i], result_set[i].GetRowId());
+      }
+    }
+  };
+
+  auto col_id = MakeColumnValueExpression(*schema, 0, "id");
+  auto col_name = MakeColumnValueExpression(*schema, 0, "name");
+  auto null_id = MakeConstantValueExpression(Field(kTypeInt));
+  auto null_name = MakeConstantValueExpression(Field(kTypeChar));
+  check(MakeComparisonExpression(col_id, null_id, "is"));
+  check(MakeComparisonExpression(col_id, null_id, "not"));
+  check(MakeComparisonExpression(col_name, null_name, "is"));
+  check(MakeComparisonExpression(col_name, null_name, "not"));
+  // the smallest and largest id of a page, and the values just outside them
+  auto range = id_ranges[page_ids[2]];
+  for (int value : {range.first - 1, range.first, range.second, range.second + 1, -1, row_nums}) {
+    auto constant = MakeConstantValueExpression(Field(kTypeInt, value));
+    for (const char *comp_type : {"=", "<>", "<", "<=", ">", ">="}) {
+      check(MakeComparisonExpression(col_id, constant, comp_type));
+      check(MakeComparisonExpression(constant, col_id, comp_type));
+    }
+    check(MakeComparisonExpression(col_id, null_id, "="));
+  }
+  for (int value : {range.first, range.second, range.second + 1}) {
+    char name[16];
+    int len = snprintf(name, sizeof(name), "%06d", value);
+    auto constant = MakeConstantValueExpression(Field(kTypeChar, name, len, true));
+    for (const char *comp_type : {"=", "<", ">="}) {
+      check(MakeComparisonExpression(col_name, constant, comp_type));
+    }
+  }
+  auto low = MakeComparisonExpression(col_id, MakeConstantValueExpression(Field(kTypeInt, range.first)), ">=");
+  auto high = MakeComparisonExpression(col_id, MakeConstantValueExpression(Field(kTypeInt, range.second)), "<=");
+  auto is_null = MakeComparisonExpression(col_name, null_name, "is");
+  check(std::make_shared<LogicExpression>(low, high, LogicType::And));
+  check(std::make_shared<LogicExpression>(std::make_shared<LogicExpression>(low, high, LogicType::And), is_null,
+                                          LogicType::Or));
+}
+
+// INSERT INTO table-1 VALUES (1001, <65 chars>, 2.33) with an index on name(char(64))
+TEST_F(ExecutorTest, InsertKeyTooLongTest) {
+  TableInfo *table_info;
+  GetExecutorContext()->GetCatalog()->GetTable("table-1", table_info);
+  IndexInfo *index_info = nullptr;
+  ASSERT_EQ(DB_SUCCESS, GetExecutorContext()->GetCatalog()->CreateIndex("table-1", "index-name", {"name"}, GetTxn(),
+                                                                         index_info, "bptree", false));
+  std::string long_name(65, 'x');
+  auto const1 = MakeConstantValueExpression(Field(kTypeInt, 1001));
+  auto const2 = MakeConstantValueExpression(Field(kTypeChar, const_cast<char *>(long_name.c_str()), 65, true));
+  auto const3 = MakeConstantValueExpression(Field(kTypeFloat, static_cast<float>(2.33)));
+  std::vector<std::vector<AbstractExpressionRef>> raw_values{{const1, const2, const3}};
+  auto value_plan = std::make_shared<ValuesPlanNode>(nullptr, raw_values);
+  auto insert_plan = std::make_shared<InsertPlanNode>(nullptr, value_plan, "table-1");
+  std::vector<Row> result_set{};
+  GetExecutionEngine()->ExecutePlan(insert_plan, &result_set, GetTxn(), GetExecutorContext());
+
+  // the row is refused rather than indexed under a cut key
+  const Schema *schema = table_info->GetSchema();
+  auto col_a = MakeColumnValueExpression(*schema, 0, "id");
+  auto const1001 = MakeConstantValueExpression(Field(kTypeInt, 1001));
+  auto predicate = MakeComparisonExpression(col_a, const1001, "=");
+  auto scan_plan = make_shared<SeqScanPlanNode>(schema, table_info->GetTableName(), predicate);
+  result_set.clear();
+  GetExecutionEngine()->ExecutePlan(scan_plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_TRUE(result_set.empty());
+}
+
+// Parse one SQL statement and run it on the engine
+static dberr_t ExecuteSql(ExecuteEngine *engine, const std::string &sql) {
+  YY_BUFFER_STATE bp = yy_scan_string(sql.c_str());
+  MinisqlParserInit();
+  yyparse();
+  EXPECT_FALSE(MinisqlParserGetError()) << sql;
+  double time = 0;
+  int affected = 0;
+  auto result = engine->Execute(MinisqlGetParserRootNode(), &time, &affected);
+  MinisqlParserFinish();
+  yy_delete_buffer(bp);
+  yylex_destroy();
+  return result;
+}
+
+// CREATE TABLE with two UNIQUE columns, each rejects a duplicate of its own
+TEST_F(ExecutorTest, CreateTableUniqueColumnsTest) {
+  {
+    ExecuteEngine engine;
+    ASSERT_EQ(DB_SUCCESS, ExecuteSql(&engine, "create database unique_columns_test;"));
+    ASSERT_EQ(DB_SUCCESS, ExecuteSql(&engine, "use unique_columns_test;"));
+    ASSERT_EQ(DB_SUCCESS, ExecuteSql(&engine, "create table t(a int unique, b int unique, c int);"));
+    ExecuteSql(&engine, "insert into t values(1, 1, 1);");
+    ExecuteSql(&engine, "insert into t values(1, 2, 2);");  // duplicate a only
+    ExecuteSql(&engine, "insert into t values(2, 1, 3);");  // duplicate b only
+    ExecuteSql(&engine, "insert into t values(2, 2, 4);");
+    ExecuteSql(&engine, "quit;");
+  }
+  DBStorageEngine db("unique_columns_test", false);
+  TableInfo *table_info = nullptr;
+  ASSERT_EQ(DB_SUCCESS, db.catalog_mgr_->GetTable("t", table_info));
+  std::vector<IndexInfo *> indexes;
+  ASSERT_EQ(DB_SUCCESS, db.catalog_mgr_->GetTableIndexes("t", indexes));
+  ASSERT_EQ(2, indexes.size());
+  for (auto index_info : indexes) {
+    ASSERT_EQ(1, index_info->GetIndexKeySchema()->GetColumnCount());
+  }
+  std::vector<std::string> c_values;
+  for (auto it = table_info->GetTableHeap()->Begin(nullptr); it != table_info->GetTableHeap()->End(); ++it) {
+    c_values.push_back(it->GetField(2)->toString());
+  }
+  std::sort(c_values.begin(), c_values.end());
+  ASSERT_EQ(std::vector<std::string>({"1", "4"}), c_values);
+}
@@ -5,6 +5,7 @@
 #include "common/instance.h"
 #include "gtest/gtest.h"
 #include "index/generic_key.h"
+#include "utils/utils.h"
 
 static const std::string db_name = "bp_tree_index_test.db";
 
@@ -66,4 +67,160 @@ TEST(BPlusTreeTests, BPlusTreeIndexSimpleTest) {
     i++;
   }
   delete index;
-}
\ No newline at end of file
+}
+TEST(BPlusTreeTests, NormalizedKeyOrderTest) {
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, true, false),
+                                   new Column("account", TypeId::kTypeFloat, 1, true, false),
+                                   new Column("name", TypeId::kTypeChar, 8, 2, true, false)};
+  std::vector<uint32_t> index_key_map{0, 1, 2};
+  const TableSchema table_schema(columns);
+  auto *key_schema = Schema::ShallowCopySchema(&table_schema, index_key_map);
+  KeyManager KP(key_schema, 32);
+  std::vector<Field> ints{Field(kTypeInt), Field(kTypeInt, INT32_MIN), Field(kTypeInt, -100000), Field(kTypeInt, -1),
+                          Field(kTypeInt, 0), Field(kTypeInt, 1), Field(kTypeInt, 256), Field(kTypeInt, INT32_MAX)};
+  std::vector<Field> floats{Field(kTypeFloat), Field(kTypeFloat, -1e9f), Field(kTypeFloat, -3.5f),
+                            Field(kTypeFloat, -0.0f), Field(kTypeFloat, 0.0f), Field(kTypeFloat, 1e-3f),
+                            Field(kTypeFloat, 2.5f), Field(kTypeFloat, 1e9f)};
+  std::vector<std::string> strings{"", "a", "ab", "abc", "b", "zzzzzzzz"};
+  std::vector<Field> chars{Field(kTypeChar)};
+  for (auto &str : strings) {
+    chars.emplace_back(kTypeChar, const_cast<char *>(str.c_str()), str.size(), true);
+  }
+  // the order of the fields, nulls first
+  auto compare_fields = [](const Field &lhs, const Field &rhs) {
+    if (lhs.IsNull() || rhs.IsNull()) {
+      return static_cast<int>(rhs.IsNull()) - static_cast<int>(lhs.IsNull());
+    }
+    if (lhs.CompareEquals(rhs) == CmpBool::kTrue) {
+      return 0;
+    }
+    return lhs.CompareLessThan(rhs) == CmpBool::kTrue ? -1 : 1;
+  };
+  std::vector<std::vector<Field>> keys;
+  for (size_t i = 0; i < 200; i++) {
+    keys.emplace_back();
+    keys.back().emplace_back(ints[RandomUtils::RandomInt(0, ints.size() - 1)]);
+    keys.back().emplace_back(floats[RandomUtils::RandomInt(0, floats.size() - 1)]);
+    keys.back().emplace_back(chars[RandomUtils::RandomInt(0, chars.size() - 1)]);
+  }
+  GenericKey *lhs = KP.InitKey();
+  GenericKey *rhs = KP.InitKey();
+  for (auto &lhs_fields : keys) {
+    KP.SerializeFromKey(lhs, Row(lhs_fields), key_schema);
+    // a key decodes to its values
+    Row decoded;
+    KP.DeserializeToKey(lhs, decoded, key_schema);
+    for (uint32_t i = 0; i < 3; i++) {
+      ASSERT_EQ(0, compare_fields(lhs_fields[i], *decoded.GetField(i)));
+    }
+    for (auto &rhs_fields : keys) {
+      KP.SerializeFromKey(rhs, Row(rhs_fields), key_schema);
+      int expected = 0;
+      for (uint32_t i = 0; i < 3 && expected == 0; i++) {
+        expected = compare_fields(lhs_fields[i], rhs_fields[i]);
+      }
+      ASSERT_EQ(expected, KP.CompareKeys(lhs, rhs));
+    }
+  }
+  free(lhs);
+  free(rhs);
+}
+
+TEST(BPlusTreeTests, BPlusTreeIndexRangeScanTest) {
+  DBStorageEngine engine(db_name);
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false)};
+  std::vector<uint32_t> index_key_map{0};
+  const TableSchema table_schema(columns);
+  auto *index_schema = Schema::ShallowCopySchema(&table_schema, index_key_map);
+  auto *index = new BPlusTreeIndex(0, index_schema, 16, engine.bpm_);
+  for (int i = -50; i < 50; i++) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, i)};
+    ASSERT_EQ(DB_SUCCESS, index->InsertEntry(Row(fields), RowId(1000, i + 50), nullptr));
+  }
+  auto scan = [&](int key, const std::string &op) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, key)};
+    std::vector<RowId> ret;
+    index->ScanKey(Row(fields), ret, nullptr, op);
+    return ret;
+  };
+  // negative keys sort before positive ones, an equal key is returned by the inclusive operators only
+  EXPECT_EQ(46, scan(3, ">").size());
+  EXPECT_EQ(47, scan(3, ">=").size());
+  EXPECT_EQ(40, scan(-10, "<").size());
+  EXPECT_EQ(41, scan(-10, "<=").size());
+  std::vector<RowId> greater = scan(-1, ">");
+  ASSERT_EQ(50, greater.size());
+  EXPECT_EQ(RowId(1000, 50).Get(), greater[0].Get());
+  delete index;
+}
+
+TEST(BPlusTreeTests, BPlusTreeIndexInexactProbeTest) {
+  DBStorageEngine engine(db_name);
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, true, false),
+                                   new Column("name", TypeId::kTypeChar, 4, 1, true, false)};
+  const TableSchema table_schema(columns);
+  std::vector<uint32_t> id_key_map{0};
+  std::vector<uint32_t> name_key_map{1};
+  auto *id_schema = Schema::ShallowCopySchema(&table_schema, id_key_map);
+  auto *name_schema = Schema::ShallowCopySchema(&table_schema, name_key_map);
+  auto *id_index = new BPlusTreeIndex(0, id_schema, 16, engine.bpm_, false);
+  auto *name_index = new BPlusTreeIndex(1, name_schema, 16, engine.bpm_, false);
+  std::vector<int> ids;
+  for (int i = -50; i < 50; i++) {
+    ids.push_back(i);
+  }
+  std::vector<std::string> names{"", "a", "ab", "abcd", "abce", "b"};
+  for (size_t i = 0; i < ids.size(); i++) {
+    std::vector<Field> fields{Field(TypeId::kTypeInt, ids[i])};
+    ASSERT_EQ(DB_SUCCESS, id_index->InsertEntry(Row(fields), RowId(1000, i), nullptr));
+  }
+  for (size_t i = 0; i < names.size(); i++) {
+    std::vector<Field> fields{Field(TypeId::kTypeChar, const_cast<char *>(names[i].c_str()), names[i].size(), true)};
+    ASSERT_EQ(DB_SUCCESS, name_index->InsertEntry(Row(fields), RowId(1001, i), nullptr));
+  }
+  // nulls match no comparison
+  for (uint32_t i = 0; i < 3; i++) {
+    std::vector<Field> null_id{Field(TypeId::kTypeInt)};
+    ASSERT_EQ(DB_SUCCESS, id_index->InsertEntry(Row(null_id), RowId(1002, i), nullptr));
+    std::vector<Field> null_name{Field(TypeId::kTypeChar)};
+    ASSERT_EQ(DB_SUCCESS, name_index->InsertEntry(Row(null_name), RowId(1002, i), nullptr));
+  }
+  auto matches = [](int cmp, const std::string &op) {
+    return (op == "=" && cmp == 0) || (op == "<>" && cmp != 0) || (op == "<" && cmp < 0) ||
+           (op == "<=" && cmp <= 0) || (op == ">" && cmp > 0) || (op == ">=" && cmp >= 0);
+  };
+  const std::vector<std::string> ops{"=", "<>", "<", "<=", ">", ">="};
+  // a float probe on an int column is not rounded onto the wrong side of the operator
+  for (float probe : {3.5f, -3.5f, 3.0f, -50.5f, 49.5f, 1e10f, -1e10f}) {
+    for (const auto &op : ops) {
+      size_t expected = 0;
+      for (int id : ids) {
+        expected += matches(id < probe ? -1 : (id > probe ? 1 : 0), op);
+      }
+      std::vector<Field> fields{Field(TypeId::kTypeFloat, probe)};
+      std::vector<RowId> result;
+      id_index->ScanKey(Row(fields), result, nullptr, op);
+      EXPECT_EQ(expected, result.size()) << "id " << op << " " << probe;
+    }
+  }
+  // a probe longer than the column is not cut to the column length
+  for (std::string probe : {"abcd", "abcda", "abcdz", "b\x01"}) {
+    for (const auto &op : ops) {
+      size_t expected = 0;
+      for (const auto &name : names) {
+        expected += matches(name.compare(probe), op);
+      }
+      std::vector<Field> fields{Field(TypeId::kTypeChar, const_cast<char *>(probe.c_str()), probe.size(), true)};
+      std::vector<RowId> result;
+      name_index->ScanKey(Row(fields), result, nullptr, op);
+      EXPECT_EQ(expected, result.size()) << "name " << op << " " << probe;
+    }
+  }
+  // such a value can not be inserted
+  std::string long_name = "abcde";
+  std::vector<Field> fields{Field(TypeId::kTypeChar, const_cast<char *>(long_name.c_str()), long_name.size(), true)};
+  EXPECT_FALSE(KeyManager::KeyFits(Row(fields), name_schema));
+  EXPECT_EQ(DB_FAILED, name_index->InsertEntry(Row(fields), RowId(1003, 0), nullptr));
+  delete id_index;
+  delete name_index;
+}
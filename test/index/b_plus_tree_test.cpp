@@ -1,4 +1,8 @@
 #include "index/b_plus_tree.h"
+
+#include <atomic>
+#include <thread>
+
 #include "common/instance.h"
 #include "gtest/gtest.h"
 #include "index/comparator.h"
@@ -69,4 +73,294 @@ TEST(BPlusTreeTests, SampleTest) {
     ASSERT_TRUE(tree.GetValue(delete_seq[i], ans));
     ASSERT_EQ(kv_map[delete_seq[i]], ans[ans.size() - 1]);
   }
-}
\ No newline at end of file
+}
+
+TEST(BPlusTreeTests, ConcurrentTest) {
+  DBStorageEngine engine("bp_tree_concurrent_test.db");
+  std::vector<Column *> columns = {
+      new Column("int", TypeId::kTypeInt, 0, false, false),
+  };
+  Schema *table_schema = new Schema(columns);
+  KeyManager KP(table_schema, 16);
+  // small pages, so that the threads keep splitting and merging shared pages
+  BPlusTree tree(0, engine.bpm_, KP, 6, 6);
+  const int n = 4000;
+  const int num_threads = 4;
+  vector<GenericKey *> keys;
+  for (int i = 0; i < n; i++) {
+    GenericKey *key = KP.InitKey();
+    std::vector<Field> fields;
+    fields.emplace_back(TypeId::kTypeInt, i);
+    KP.SerializeFromKey(key, Row(fields), table_schema);
+    keys.push_back(key);
+  }
+  // Insert interleaved keys from every thread while readers look them up
+  std::atomic<bool> wrong_value{false};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&, t] {
+      for (int i = t; i < n; i += num_threads) {
+        tree.Insert(keys[i], RowId(i));
+      }
+    });
+  }
+  for (int t = 0; t < 2; t++) {
+    threads.emplace_back([&, t] {
+      for (int i = t; i < n; i += 2) {
+        vector<RowId> result;
+        if (tree.GetValue(keys[i], result) && result[0].Get() != i) {
+          wrong_value = true;
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  threads.clear();
+  ASSERT_FALSE(wrong_value);
+  ASSERT_TRUE(tree.Check());
+  for (int i = 0; i < n; i++) {
+    vector<RowId> result;
+    ASSERT_TRUE(tree.GetValue(keys[i], result));
+    ASSERT_EQ(i, result[0].Get());
+  }
+  // Remove the even keys while the odd ones are looked up and the tree is scanned
+  std::atomic<bool> odd_missing{false};
+  std::atomic<bool> out_of_order{false};
+  std::atomic<bool> odd_skipped{false};
+  std::atomic<int> removing{num_threads};
+  for (int t = 0; t < num_threads; t++) {
+    threads.emplace_back([&, t] {
+      for (int i = 2 * t; i < n; i += 2 * num_threads) {
+        tree.Remove(keys[i]);
+      }
+      removing--;
+    });
+  }
+  threads.emplace_back([&] {
+    for (int i = 1; i < n; i += 2) {
+      vector<RowId> result;
+      if (!tree.GetValue(keys[i], result) || result[0].Get() != i) {
+        odd_missing = true;
+      }
+    }
+  });
+  // scan again and again while the removals go on, the odd keys stay, so a scan must return each of them
+  threads.emplace_back([&] {
+    do {
+      int64_t last = -1;
+      int64_t next_odd = 1;
+      for (auto iter = tree.Begin(); iter != tree.End(); ++iter) {
+        int64_t value = (*iter).second.Get();
+        if (value <= last) {
+          out_of_order = true;
+        }
+        if (value % 2 == 1) {
+          odd_skipped = odd_skipped || value != next_odd;
+          next_odd = value + 2;
+        }
+        last = value;
+      }
+      if (next_odd != n + 1) {
+        odd_skipped = true;
+      }
+    } while (removing > 0);
+  });
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  ASSERT_FALSE(odd_missing);
+  ASSERT_FALSE(out_of_order);
+  ASSERT_FALSE(odd_skipped);
+  ASSERT_TRUE(tree.Check());
+  int i = 1;
+  for (auto iter = tree.Begin(); iter != tree.End(); ++iter, i += 2) {
+    ASSERT_EQ(0, KP.CompareKeys(keys[i], (*iter).first));
+    ASSERT_EQ(i, (*iter).second.Get());
+  }
+  ASSERT_EQ(n + 1, i);
+  for (auto key : keys) {
+    free(key);
+  }
+  delete table_schema;
+}
+
+TEST(BPlusTreeTests, BulkLoadTest) {
+  DBStorageEngine engine("bp_tree_bulk_load_test.db");
+  std::vector<Column *> columns = {
+      new Column("int", TypeId::kTypeInt, 0, false, false),
+  };
+  Schema *table_schema = new Schema(columns);
+  KeyManager KP(table_schema, 16);
+  BPlusTree tree(0, engine.bpm_, KP, 16, 16);
+  const int n = 20000;
+  vector<GenericKey *> keys;
+  for (int i = 0; i < n; i++) {
+    GenericKey *key = KP.InitKey();
+    std::vector<Field> fields;
+    fields.emplace_back(TypeId::kTypeInt, i);
+    KP.SerializeFromKey(key, Row(fields), table_schema);
+    keys.push_back(key);
+  }
+  vector<int> order(n);
+  for (int i = 0; i < n; i++) {
+    order[i] = i;
+  }
+  ShuffleArray(order);
+  // a buffer of 100 pairs writes out more runs than are merged at once
+  {
+    KeySorter sorter(engine.bpm_, KP.GetKeySize(), 100 * (KP.GetKeySize() + sizeof(int64_t)));
+    for (int i : order) {
+      ASSERT_TRUE(sorter.Add(keys[i], RowId(i)));
+    }
+    ASSERT_TRUE(sorter.Finish());
+    ASSERT_TRUE(tree.BulkLoad(&sorter, 0.75));
+  }
+  ASSERT_TRUE(tree.Check());
+  for (int i = 0; i < n; i++) {
+    vector<RowId> result;
+    ASSERT_TRUE(tree.GetValue(keys[i], result));
+    ASSERT_EQ(i, result[0].Get());
+  }
+  int i = 0;
+  for (auto iter = tree.Begin(); iter != tree.End(); ++iter, i++) {
+    ASSERT_EQ(0, KP.CompareKeys(keys[i], (*iter).first));
+  }
+  ASSERT_EQ(n, i);
+  // the loaded tree takes inserts and removes like a tree built by inserts
+  for (int j = 0; j < n; j += 2) {
+    tree.Remove(keys[order[j]]);
+  }
+  for (int j = 0; j < n; j += 4) {
+    ASSERT_TRUE(tree.Insert(keys[order[j]], RowId(order[j])));
+  }
+  ASSERT_TRUE(tree.Check());
+  for (int j = 0; j < n; j++) {
+    vector<RowId> result;
+    ASSERT_EQ(j % 2 == 1 || j % 4 == 0, tree.GetValue(keys[order[j]], result));
+  }
+  // duplicate keys leave the tree empty
+  BPlusTree duplicate_tree(1, engine.bpm_, KP, 16, 16);
+  {
+    KeySorter sorter(engine.bpm_, KP.GetKeySize());
+    for (int j = 0; j < 1000; j++) {
+      ASSERT_TRUE(sorter.Add(keys[j], RowId(j)));
+    }
+    ASSERT_TRUE(sorter.Add(keys[500], RowId(n)));
+    ASSERT_TRUE(sorter.Finish());
+    ASSERT_FALSE(duplicate_tree.BulkLoad(&sorter));
+  }
+  ASSERT_TRUE(duplicate_tree.IsEmpty());
+  ASSERT_TRUE(duplicate_tree.Check());
+  for (auto key : keys) {
+    free(key);
+  }
+  delete table_schema;
+}
+
+TEST(BPlusTreeTests, NonUniqueTest) {
+  DBStorageEngine engine("bp_tree_non_unique_test.db");
+  std::vector<Column *> columns = {
+      new Column("int", TypeId::kTypeInt, 0, false, false),
+  };
+  Schema *table_schema = new Schema(columns);
+  KeyManager KP(table_schema, 16);
+  BPlusTree tree(0, engine.bpm_, KP, 16, 16, false);
+  ASSERT_FALSE(tree.IsUnique());
+  const int n = 200;
+  // key 0 has enough rows to fill several posting list pages, the others have one to three
+  const int big = 2 * PostingListPage::MAX_SIZE + 100;
+  vector<GenericKey *> keys;
+  vector<vector<RowId>> rids(n);
+  vector<pair<int, RowId>> pairs;
+  for (int i = 0; i < n; i++) {
+    GenericKey *key = KP.InitKey();
+    std::vector<Field> fields;
+    fields.emplace_back(TypeId::kTypeInt, i);
+    KP.SerializeFromKey(key, Row(fields), table_schema);
+    keys.push_back(key);
+    int count = i == 0 ? big : i % 3 + 1;
+    for (int j = 0; j < count; j++) {
+      rids[i].emplace_back(i + 1, j);
+      pairs.emplace_back(i, rids[i].back());
+    }
+  }
+  ShuffleArray(pairs);
+  for (auto &pair : pairs) {
+    ASSERT_TRUE(tree.Insert(keys[pair.first], pair.second));
+  }
+  // the same pair twice is rejected
+  ASSERT_FALSE(tree.Insert(keys[0], rids[0][7]));
+  ASSERT_FALSE(tree.Insert(keys[2], rids[2][1]));
+  ASSERT_TRUE(tree.Check());
+  for (int i = 0; i < n; i++) {
+    vector<RowId> result;
+    ASSERT_TRUE(tree.GetValue(keys[i], result));
+    ASSERT_EQ(rids[i], result);
+  }
+  // the iterator returns every pair, by key then by row
+  int key_index = 0;
+  size_t row_index = 0;
+  size_t total = 0;
+  for (auto iter = tree.Begin(); iter != tree.End(); ++iter, total++) {
+    if (row_index == rids[key_index].size()) {
+      key_index++;
+      row_index = 0;
+    }
+    ASSERT_EQ(0, KP.CompareKeys(keys[key_index], (*iter).first));
+    ASSERT_EQ(rids[key_index][row_index++], (*iter).second);
+  }
+  ASSERT_EQ(pairs.size(), total);
+  // removing rows one by one keeps the others, the last one is kept in the leaf again
+  vector<int> order(big);
+  for (int j = 0; j < big; j++) {
+    order[j] = j;
+  }
+  ShuffleArray(order);
+  for (int j = 0; j < big - 1; j++) {
+    tree.Remove(keys[0], rids[0][order[j]]);
+  }
+  tree.Remove(keys[0], RowId(n + 1, 0));
+  vector<RowId> result;
+  ASSERT_TRUE(tree.GetValue(keys[0], result));
+  ASSERT_EQ(1U, result.size());
+  ASSERT_EQ(rids[0][order[big - 1]], result[0]);
+  tree.Remove(keys[0], rids[0][order[big - 1]]);
+  result.clear();
+  ASSERT_FALSE(tree.GetValue(keys[0], result));
+  // removing a key removes all of its rows
+  for (int i = 1; i < n; i += 2) {
+    tree.Remove(keys[i]);
+  }
+  ASSERT_TRUE(tree.Check());
+  for (int i = 1; i < n; i++) {
+    result.clear();
+    ASSERT_EQ(i % 2 == 0, tree.GetValue(keys[i], result));
+    if (i % 2 == 0) {
+      ASSERT_EQ(rids[i], result);
+    }
+  }
+  // a bulk load groups the rows of a key
+  BPlusTree loaded_tree(1, engine.bpm_, KP, 16, 16, false);
+  {
+    KeySorter sorter(engine.bpm_, KP.GetKeySize());
+    for (int i = 0; i < n; i++) {
+      for (auto &rid : rids[i]) {
+        ASSERT_TRUE(sorter.Add(keys[i], rid));
+      }
+    }
+    ASSERT_TRUE(sorter.Finish());
+    ASSERT_TRUE(loaded_tree.BulkLoad(&sorter));
+  }
+  ASSERT_TRUE(loaded_tree.Check());
+  for (int i = 0; i < n; i++) {
+    result.clear();
+    ASSERT_TRUE(loaded_tree.GetValue(keys[i], result));
+    ASSERT_EQ(rids[i], result);
+  }
+  for (auto key : keys) {
+    free(key);
+  }
+  delete table_schema;
+}
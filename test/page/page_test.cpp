@@ -0,0 +1,26 @@
+#include "page/page.h"
+
+#include "gtest/gtest.h"
+
+TEST(PageTests, VersionTest) {
+  Page page;
+  uint64_t version;
+  ASSERT_TRUE(page.ReadVersion(&version));
+  ASSERT_TRUE(page.ValidateVersion(version));
+  // readers neither fail nor change the version
+  page.RLatch();
+  ASSERT_TRUE(page.ValidateVersion(version));
+  page.RUnlatch();
+  // an optimistic read can not start while the page is write latched
+  page.WLatch();
+  uint64_t latched_version;
+  ASSERT_FALSE(page.ReadVersion(&latched_version));
+  ASSERT_FALSE(page.ValidateVersion(version));
+  page.WUnlatch();
+  // nor validate once a writer came and went
+  uint64_t new_version;
+  ASSERT_TRUE(page.ReadVersion(&new_version));
+  ASSERT_NE(version, new_version);
+  ASSERT_FALSE(page.ValidateVersion(version));
+  ASSERT_TRUE(page.ValidateVersion(new_version));
+}
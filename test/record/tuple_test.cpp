@@ -3,8 +3,12 @@
 #include "common/instance.h"
 #include "gtest/gtest.h"
 #include "page/table_page.h"
+#include "planner/expressions/column_value_expression.h"
+#include "planner/expressions/comparison_expression.h"
+#include "planner/expressions/constant_value_expression.h"
 #include "record/field.h"
 #include "record/row.h"
+#include "record/row_view.h"
 #include "record/schema.h"
 
 char *chars[] = {const_cast<char *>(""), const_cast<char *>("hello"), const_cast<char *>("world!"),
@@ -100,4 +104,168 @@ TEST(TupleTest, RowTest) {
   }
   ASSERT_TRUE(table_page.MarkDelete(row.GetRowId(), nullptr, nullptr, nullptr));
   table_page.ApplyDelete(row.GetRowId(), nullptr, nullptr);
-}
\ No newline at end of file
+}
+
+TEST(TupleTest, RowViewTest) {
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 64, 1, true, false),
+                                   new Column("note", TypeId::kTypeChar, 64, 2, true, false),
+                                   new Column("account", TypeId::kTypeFloat, 3, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  std::vector<Field> fields = {Field(TypeId::kTypeInt, 188),
+                               Field(TypeId::kTypeChar, const_cast<char *>("minisql"), strlen("minisql"), false),
+                               Field(TypeId::kTypeChar), Field(TypeId::kTypeFloat, 19.99f)};
+  Row row(fields);
+  char buffer[PAGE_SIZE];
+  uint32_t size = row.SerializeTo(buffer, schema.get());
+
+  // Scenario: every column is read in place, in any order.
+  RowView view(buffer, schema.get(), RowId(1, 2));
+  ASSERT_EQ(4, view.GetFieldCount());
+  EXPECT_EQ(size, view.GetSerializedSize());
+  EXPECT_EQ(19.99f, view.GetFloat(3));
+  EXPECT_EQ(188, view.GetInt(0));
+  EXPECT_TRUE(view.IsNull(2));
+  EXPECT_FALSE(view.IsNull(1));
+  uint32_t len;
+  const char *chars = view.GetChars(1, &len);
+  EXPECT_EQ(std::string("minisql"), std::string(chars, len));
+  EXPECT_EQ(0, view.GetFieldSize(2));
+  for (uint32_t i = 0; i < fields.size(); i++) {
+    Field field = view.GetField(i);
+    if (fields[i].IsNull()) {
+      EXPECT_TRUE(field.IsNull());
+    } else {
+      EXPECT_EQ(CmpBool::kTrue, field.CompareEquals(fields[i]));
+    }
+  }
+
+  // Scenario: columns of two views compare like their fields.
+  std::vector<Field> other_fields = {Field(TypeId::kTypeInt, 189),
+                                     Field(TypeId::kTypeChar, const_cast<char *>("minisq"), strlen("minisq"), false),
+                                     Field(TypeId::kTypeChar, const_cast<char *>("x"), 1, false),
+                                     Field(TypeId::kTypeFloat, 19.99f)};
+  Row other_row(other_fields);
+  char other_buffer[PAGE_SIZE];
+  other_row.SerializeTo(other_buffer, schema.get());
+  RowView other(other_buffer, schema.get());
+  EXPECT_LT(view.CompareField(0, other, 0), 0);
+  EXPECT_GT(view.CompareField(1, other, 1), 0);
+  EXPECT_EQ(0, view.CompareField(2, other, 2));
+  EXPECT_EQ(0, view.CompareField(3, other, 3));
+
+  // Scenario: a predicate gives the same result on the view as on the deserialized row, nulls survive the round trip.
+  auto predicate = std::make_shared<ComparisonExpression>(
+      std::make_shared<ColumnValueExpression>(0, 1, TypeId::kTypeChar),
+      std::make_shared<ConstantValueExpression>(
+          Field(TypeId::kTypeChar, const_cast<char *>("minisql"), strlen("minisql"), false)),
+      "=");
+  Row row2;
+  view.ToRow(&row2);
+  EXPECT_EQ(RowId(1, 2), row2.GetRowId());
+  EXPECT_TRUE(row2.GetField(2)->IsNull());
+  EXPECT_EQ(CmpBool::kTrue, predicate->Evaluate(view).CompareEquals(predicate->Evaluate(&row2)));
+  EXPECT_EQ(CmpBool::kTrue, predicate->Evaluate(view).CompareEquals(Field(TypeId::kTypeInt, 1)));
+}
+
+TEST(TupleTest, PartialDeserializeTest) {
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 64, 1, true, false),
+                                   new Column("note", TypeId::kTypeChar, 64, 2, true, false),
+                                   new Column("account", TypeId::kTypeFloat, 3, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  std::vector<Field> fields = {Field(TypeId::kTypeInt, 188),
+                               Field(TypeId::kTypeChar, const_cast<char *>("minisql"), strlen("minisql"), false),
+                               Field(TypeId::kTypeChar), Field(TypeId::kTypeFloat, 19.99f)};
+  Row row(fields);
+  char buffer[PAGE_SIZE];
+  uint32_t size = row.SerializeTo(buffer, schema.get());
+
+  // Scenario: skipped columns come back as nulls, the columns after them are still read at the right offset.
+  Row partial;
+  EXPECT_EQ(size, partial.DeserializeFrom(buffer, schema.get(), {false, false, true, true}));
+  ASSERT_EQ(4, partial.GetFieldCount());
+  EXPECT_TRUE(partial.GetField(0)->IsNull());
+  EXPECT_TRUE(partial.GetField(1)->IsNull());
+  EXPECT_TRUE(partial.GetField(2)->IsNull());
+  EXPECT_EQ(CmpBool::kTrue, partial.GetField(3)->CompareEquals(fields[3]));
+
+  // Scenario: a short mask leaves the remaining columns deserialized.
+  Row prefix;
+  EXPECT_EQ(size, prefix.DeserializeFrom(buffer, schema.get(), {false}));
+  EXPECT_TRUE(prefix.GetField(0)->IsNull());
+  EXPECT_EQ(CmpBool::kTrue, prefix.GetField(1)->CompareEquals(fields[1]));
+  EXPECT_EQ(CmpBool::kTrue, prefix.GetField(3)->CompareEquals(fields[3]));
+}
+
+TEST(TupleTest, FixedWidthRowTest) {
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 10, 1, true, false),
+                                   new Column("note", TypeId::kTypeChar, 3, 2, true, false),
+                                   new Column("account", TypeId::kTypeFloat, 3, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  ASSERT_TRUE(schema->CanBeFixedWidth());
+  schema->SetFixedWidth(true);
+  // bitmap padded to 4 bytes, char(10) takes 4 + 10 bytes rounded up to 16, char(3) takes 4 + 3 rounded up to 8
+  EXPECT_EQ(4, schema->GetFixedOffset(0));
+  EXPECT_EQ(8, schema->GetFixedOffset(1));
+  EXPECT_EQ(24, schema->GetFixedOffset(2));
+  EXPECT_EQ(32, schema->GetFixedOffset(3));
+  EXPECT_EQ(36, schema->GetFixedSize());
+
+  std::vector<Field> fields = {Field(TypeId::kTypeInt, 188),
+                               Field(TypeId::kTypeChar, const_cast<char *>("minisql"), strlen("minisql"), false),
+                               Field(TypeId::kTypeChar), Field(TypeId::kTypeFloat, 19.99f)};
+  Row row(fields);
+  char buffer[PAGE_SIZE];
+  // Scenario: every row has the same size whatever its values, nulls included.
+  EXPECT_EQ(schema->GetFixedSize(), row.GetSerializedSize(schema.get()));
+  EXPECT_EQ(schema->GetFixedSize(), row.SerializeTo(buffer, schema.get()));
+  EXPECT_EQ(188, MACH_READ_FROM(int32_t, buffer + schema->GetFixedOffset(0)));
+  EXPECT_EQ(19.99f, MACH_READ_FROM(float, buffer + schema->GetFixedOffset(3)));
+
+  Row copy;
+  EXPECT_EQ(schema->GetFixedSize(), copy.DeserializeFrom(buffer, schema.get()));
+  ASSERT_EQ(4, copy.GetFieldCount());
+  for (uint32_t i = 0; i < fields.size(); i++) {
+    if (fields[i].IsNull()) {
+      EXPECT_TRUE(copy.GetField(i)->IsNull());
+    } else {
+      EXPECT_EQ(CmpBool::kTrue, copy.GetField(i)->CompareEquals(fields[i]));
+    }
+  }
+
+  // Scenario: skipped columns come back as nulls.
+  Row partial;
+  EXPECT_EQ(schema->GetFixedSize(), partial.DeserializeFrom(buffer, schema.get(), {false, true}));
+  EXPECT_TRUE(partial.GetField(0)->IsNull());
+  EXPECT_EQ(CmpBool::kTrue, partial.GetField(1)->CompareEquals(fields[1]));
+  EXPECT_EQ(CmpBool::kTrue, partial.GetField(3)->CompareEquals(fields[3]));
+
+  // Scenario: a view reads the columns at the schema's offsets, in any order.
+  RowView view(buffer, schema.get());
+  EXPECT_EQ(4, view.GetFieldCount());
+  EXPECT_EQ(schema->GetFixedSize(), view.GetSerializedSize());
+  EXPECT_FLOAT_EQ(19.99f, view.GetFloat(3));
+  EXPECT_EQ(188, view.GetInt(0));
+  EXPECT_TRUE(view.IsNull(2));
+  uint32_t len;
+  const char *chars = view.GetChars(1, &len);
+  EXPECT_EQ("minisql", std::string(chars, len));
+  EXPECT_EQ(sizeof(uint32_t) + len, view.GetFieldSize(1));
+
+  // Scenario: a char value longer than its column does not fit the fixed-width format.
+  std::vector<Field> long_fields = {Field(TypeId::kTypeInt, 1), Field(TypeId::kTypeChar),
+                                    Field(TypeId::kTypeChar, const_cast<char *>("abcd"), 4, false),
+                                    Field(TypeId::kTypeFloat, 1.0f)};
+  Row long_row(long_fields);
+  EXPECT_FALSE(long_row.FitsSchema(schema.get()));
+  EXPECT_TRUE(row.FitsSchema(schema.get()));
+
+  // Scenario: the format is kept by a deep copy, not by a key schema.
+  std::unique_ptr<Schema> deep(Schema::DeepCopySchema(schema.get()));
+  EXPECT_TRUE(deep->IsFixedWidth());
+  EXPECT_EQ(schema->GetFixedSize(), deep->GetFixedSize());
+  std::unique_ptr<Schema> key(Schema::ShallowCopySchema(schema.get(), {1, 0}));
+  EXPECT_FALSE(key->IsFixedWidth());
+}
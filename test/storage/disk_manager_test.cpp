@@ -1,6 +1,12 @@
 #include "storage/disk_manager.h"
 
+#include <fcntl.h>
+#include <unistd.h>
+#include <array>
+#include <atomic>
+#include <thread>
 #include <unordered_set>
+#include <vector>
 
 #include "gtest/gtest.h"
 
@@ -56,4 +62,184 @@ TEST(DiskManagerTest, FreePageAllocationTest) {
   EXPECT_EQ(DiskManager::BITMAP_SIZE - 2, meta_page->GetExtentUsedPage(0));
   EXPECT_EQ(DiskManager::BITMAP_SIZE - 3, meta_page->GetExtentUsedPage(1));
   remove(db_name.c_str());
-}
\ No newline at end of file
+}
+
+TEST(DiskManagerTest, ReadWritePageTest) {
+  std::string db_name = "disk_rw_test.db";
+  remove(db_name.c_str());
+  char data[PAGE_SIZE];
+  char buf[PAGE_SIZE];
+  auto *disk_mgr = new DiskManager(db_name);
+  // reading beyond the end of the file yields a zeroed page
+  memset(buf, 1, PAGE_SIZE);
+  disk_mgr->ReadPage(10, buf);
+  for (char c : buf) {
+    ASSERT_EQ(0, c);
+  }
+  for (page_id_t page_id = 0; page_id < 16; page_id++) {
+    snprintf(data, PAGE_SIZE, "page %d", page_id);
+    disk_mgr->WritePage(page_id, data);
+  }
+  disk_mgr->Sync();
+  disk_mgr->ReadPage(3, buf);
+  EXPECT_STREQ("page 3", buf);
+  disk_mgr->Close();
+  delete disk_mgr;
+
+  // pages written before Close are still there after reopening the file
+  disk_mgr = new DiskManager(db_name);
+  for (page_id_t page_id = 0; page_id < 16; page_id++) {
+    snprintf(data, PAGE_SIZE, "page %d", page_id);
+    disk_mgr->ReadPage(page_id, buf);
+    EXPECT_STREQ(data, buf);
+  }
+  delete disk_mgr;
+  remove(db_name.c_str());
+}
+
+TEST(DiskManagerTest, AsyncReadWritePageTest) {
+  std::string db_name = "disk_async_test.db";
+  remove(db_name.c_str());
+  const int num_pages = 64;
+  std::vector<std::array<char, PAGE_SIZE>> data(num_pages);
+  std::vector<std::array<char, PAGE_SIZE>> buf(num_pages);
+  auto *disk_mgr = new DiskManager(db_name);
+  // all writes in flight at once
+  std::vector<IOHandle> handles;
+  for (page_id_t page_id = 0; page_id < num_pages; page_id++) {
+    memset(data[page_id].data(), 0, PAGE_SIZE);
+    snprintf(data[page_id].data(), PAGE_SIZE, "page %d", page_id);
+    handles.push_back(disk_mgr->WritePageAsync(page_id, data[page_id].data()));
+  }
+  for (auto &handle : handles) {
+    ASSERT_TRUE(handle->Wait());
+  }
+  // all reads in flight at once, including one beyond the end of the file
+  handles.clear();
+  for (page_id_t page_id = 0; page_id < num_pages; page_id++) {
+    handles.push_back(disk_mgr->ReadPageAsync(page_id, buf[page_id].data()));
+  }
+  char beyond[PAGE_SIZE];
+  memset(beyond, 1, PAGE_SIZE);
+  ASSERT_TRUE(disk_mgr->ReadPageAsync(num_pages * 2, beyond)->Wait());
+  for (page_id_t page_id = 0; page_id < num_pages; page_id++) {
+    ASSERT_TRUE(handles[page_id]->Wait());
+    ASSERT_EQ(0, memcmp(data[page_id].data(), buf[page_id].data(), PAGE_SIZE));
+  }
+  for (char c : beyond) {
+    ASSERT_EQ(0, c);
+  }
+  // synchronous reads see asynchronous writes
+  disk_mgr->ReadPage(7, buf[0].data());
+  EXPECT_STREQ("page 7", buf[0].data());
+  disk_mgr->Close();
+  delete disk_mgr;
+  // requests submitted while Close runs either finish before the file is closed or are dropped, none is lost
+  remove(db_name.c_str());
+  disk_mgr = new DiskManager(db_name);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; t++) {
+    threads.emplace_back([&, t] {
+      for (page_id_t page_id = t; page_id < 4 * num_pages; page_id += 4) {
+        EXPECT_TRUE(disk_mgr->WritePageAsync(page_id, data[page_id % num_pages].data())->Wait());
+        EXPECT_TRUE(disk_mgr->ReadPageAsync(page_id, buf[t].data())->Wait());
+      }
+    });
+  }
+  disk_mgr->Close();
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  delete disk_mgr;
+  remove(db_name.c_str());
+}
+
+TEST(DiskManagerTest, AsyncIOEngineTest) {
+  std::string file_name = "async_engine_test.db";
+  std::vector<std::unique_ptr<AsyncIOEngine>> engines;
+  engines.push_back(std::make_unique<ThreadPoolIOEngine>(2));
+  // io_uring may be disabled in the kernel, the fallback is always tested
+  auto io_uring = IoUringIOEngine::Create(8);
+  if (io_uring != nullptr) {
+    engines.push_back(std::move(io_uring));
+  }
+  for (auto &engine : engines) {
+    remove(file_name.c_str());
+    int fd = open(file_name.c_str(), O_RDWR | O_CREAT, 0644);
+    ASSERT_GE(fd, 0);
+    // more requests than the queue depth of the io_uring engine
+    const int num_pages = 32;
+    std::vector<std::array<char, PAGE_SIZE>> data(num_pages);
+    std::vector<std::array<char, PAGE_SIZE>> buf(num_pages);
+    std::atomic<int> callbacks{0};
+    std::vector<IOHandle> handles;
+    for (int i = 0; i < num_pages; i++) {
+      memset(data[i].data(), 'a' + i % 26, PAGE_SIZE);
+      handles.push_back(std::make_shared<AsyncIOHandle>(true, fd, data[i].data(), PAGE_SIZE, i * PAGE_SIZE,
+                                                        [&](ssize_t rc) { callbacks += rc == PAGE_SIZE; }));
+      engine->Submit(handles.back());
+    }
+    for (auto &handle : handles) {
+      ASSERT_TRUE(handle->Wait());
+      ASSERT_TRUE(handle->IsDone());
+    }
+    EXPECT_EQ(num_pages, callbacks);
+    handles.clear();
+    for (int i = 0; i < num_pages; i++) {
+      handles.push_back(std::make_shared<AsyncIOHandle>(false, fd, buf[i].data(), PAGE_SIZE, i * PAGE_SIZE));
+      engine->Submit(handles.back());
+    }
+    for (int i = 0; i < num_pages; i++) {
+      ASSERT_TRUE(handles[i]->Wait());
+      ASSERT_EQ(0, memcmp(data[i].data(), buf[i].data(), PAGE_SIZE));
+    }
+    // a read reaching past the end of the file returns the bytes before it
+    ssize_t tail_result = 0;
+    auto tail = std::make_shared<AsyncIOHandle>(false, fd, buf[0].data(), PAGE_SIZE, num_pages * PAGE_SIZE - 100,
+                                                [&](ssize_t rc) { tail_result = rc; });
+    engine->Submit(tail);
+    EXPECT_TRUE(tail->Wait());
+    EXPECT_EQ(100, tail_result);
+    EXPECT_EQ(0, memcmp(data[num_pages - 1].data(), buf[0].data(), 100));
+    // errors are reported through the handle
+    auto bad = std::make_shared<AsyncIOHandle>(false, -1, buf[0].data(), PAGE_SIZE, 0);
+    engine->Submit(bad);
+    EXPECT_FALSE(bad->Wait());
+    close(fd);
+  }
+  remove(file_name.c_str());
+}
+
+TEST(DiskManagerTest, AllocationPersistenceTest) {
+  std::string db_name = "disk_alloc_test.db";
+  remove(db_name.c_str());
+  auto *disk_mgr = new DiskManager(db_name);
+  const uint32_t num_pages = DiskManager::BITMAP_SIZE + 100;
+  for (uint32_t i = 0; i < num_pages; i++) {
+    ASSERT_EQ(i, disk_mgr->AllocatePage());
+  }
+  disk_mgr->DeAllocatePage(10);
+  disk_mgr->DeAllocatePage(5);
+  disk_mgr->DeAllocatePage(DiskManager::BITMAP_SIZE + 3);
+  EXPECT_TRUE(disk_mgr->IsPageFree(5));
+  EXPECT_FALSE(disk_mgr->IsPageFree(6));
+  EXPECT_TRUE(disk_mgr->IsPageFree(num_pages));
+  EXPECT_TRUE(disk_mgr->IsPageFree(10 * DiskManager::BITMAP_SIZE));
+  disk_mgr->Close();
+  delete disk_mgr;
+
+  // Scenario: the meta page and the bitmaps survive a restart, freed pages are reused lowest first.
+  disk_mgr = new DiskManager(db_name);
+  auto *meta_page = reinterpret_cast<DiskFileMetaPage *>(disk_mgr->GetMetaData());
+  EXPECT_EQ(num_pages - 3, meta_page->GetAllocatedPages());
+  EXPECT_EQ(2, meta_page->GetExtentNums());
+  EXPECT_TRUE(disk_mgr->IsPageFree(10));
+  EXPECT_FALSE(disk_mgr->IsPageFree(11));
+  EXPECT_EQ(5, disk_mgr->AllocatePage());
+  EXPECT_EQ(10, disk_mgr->AllocatePage());
+  EXPECT_EQ(DiskManager::BITMAP_SIZE + 3, disk_mgr->AllocatePage());
+  EXPECT_EQ(num_pages, disk_mgr->AllocatePage());
+  disk_mgr->Close();
+  delete disk_mgr;
+  remove(db_name.c_str());
+}
@@ -1,3 +1,4 @@
+#include "buffer/buffer_pool_manager_instance.h"
 #include "storage/table_heap.h"
 #include "storage/table_iterator.h"
 
@@ -17,7 +18,7 @@ using Fields = std::vector<Field>;
 TEST(TableHeapTest, TableHeapIteratorTest) {
   // init testing instance
   auto disk_mgr_ = new DiskManager(db_file_name);
-  auto bpm_ = new BufferPoolManager(DEFAULT_BUFFER_POOL_SIZE, disk_mgr_);
+  auto bpm_ = new BufferPoolManagerInstance(DEFAULT_BUFFER_POOL_SIZE, disk_mgr_);
   const int row_nums = 10000;
   // create schema
   std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
@@ -66,8 +67,8 @@ TEST(TableHeapTest, TableHeapIteratorTest) {
     delete field_in_map;
     row_values.erase(row.GetRowId().Get());
   }
-  delete disk_mgr_;
   delete bpm_;
+  delete disk_mgr_;
   ASSERT_EQ(size, 0);
 }
 
@@ -75,7 +76,7 @@ TEST(TableHeapTest, TableHeapIteratorTest) {
 TEST(TableHeapTest, TableHeapSampleTest) {
   // init testing instance
   auto disk_mgr_ = new DiskManager(db_file_name);
-  auto bpm_ = new BufferPoolManager(DEFAULT_BUFFER_POOL_SIZE, disk_mgr_);
+  auto bpm_ = new BufferPoolManagerInstance(DEFAULT_BUFFER_POOL_SIZE, disk_mgr_);
   const int row_nums = 10000;
   // create schema
   std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
@@ -121,3 +122,667 @@ TEST(TableHeapTest, TableHeapSampleTest) {
   ASSERT_EQ(size, 0);
 }
 
+
+TEST(TableHeapTest, FreeSpaceMapTest) {
+  const std::string db_name = "table_heap_fsm_test.db";
+  remove(db_name.c_str());
+  auto disk_mgr_ = new DiskManager(db_name);
+  auto bpm_ = new BufferPoolManagerInstance(DEFAULT_BUFFER_POOL_SIZE, disk_mgr_);
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 256, 1, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  char characters[256];
+  memset(characters, 'a', sizeof(characters));
+  auto make_row = [&](int i) {
+    Fields fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, characters, 256, true)};
+    return Row(fields);
+  };
+
+  // Scenario: appending fills every page before a new one is attached.
+  const int row_nums = 2000;
+  TableHeap *table_heap = TableHeap::Create(bpm_, schema.get(), nullptr, nullptr, nullptr);
+  std::vector<RowId> rids;
+  std::unordered_map<page_id_t, int> rows_per_page;
+  for (int i = 0; i < row_nums; i++) {
+    Row row = make_row(i);
+    ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+    rids.push_back(row.GetRowId());
+    rows_per_page[row.GetRowId().GetPageId()]++;
+  }
+  int rows_per_full_page = rows_per_page[table_heap->GetFirstPageId()];
+  EXPECT_GT(rows_per_full_page, 1);
+  EXPECT_EQ((row_nums + rows_per_full_page - 1) / rows_per_full_page, rows_per_page.size());
+
+  // Scenario: space freed in the middle of the heap is reused, also after the heap is reopened from the map.
+  RowId freed = rids[row_nums / 2];
+  ASSERT_TRUE(table_heap->MarkDelete(freed, nullptr));
+  table_heap->ApplyDelete(freed, nullptr);
+  page_id_t first_page_id = table_heap->GetFirstPageId();
+  page_id_t fsm_page_id = table_heap->GetFreeSpaceMapPageId();
+  ASSERT_NE(INVALID_PAGE_ID, fsm_page_id);
+  delete table_heap;
+  table_heap = TableHeap::Create(bpm_, first_page_id, fsm_page_id, schema.get(), nullptr, nullptr);
+  Row row = make_row(row_nums);
+  ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+  EXPECT_EQ(freed.GetPageId(), row.GetRowId().GetPageId());
+
+  // Scenario: a heap opened without a map rebuilds one from the page chain.
+  delete table_heap;
+  table_heap = TableHeap::Create(bpm_, first_page_id, INVALID_PAGE_ID, schema.get(), nullptr, nullptr);
+  EXPECT_NE(INVALID_PAGE_ID, table_heap->GetFreeSpaceMapPageId());
+  int rows = 0;
+  for (auto itr = table_heap->Begin(nullptr); itr != table_heap->End(); ++itr) {
+    rows++;
+  }
+  EXPECT_EQ(row_nums, rows);
+
+  delete table_heap;
+  delete bpm_;
+  delete disk_mgr_;
+  remove(db_name.c_str());
+}
+
+
+TEST(TableHeapTest, BulkInsertTest) {
+  const std::string db_name = "table_heap_bulk_test.db";
+  remove(db_name.c_str());
+  auto disk_mgr_ = new DiskManager(db_name);
+  auto bpm_ = new BufferPoolManagerInstance(DEFAULT_BUFFER_POOL_SIZE, disk_mgr_);
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 64, 1, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  char characters[64];
+  memset(characters, 'b', sizeof(characters));
+  const int row_nums = 5000;
+  std::vector<Row> rows;
+  for (int i = 0; i < row_nums; i++) {
+    Fields fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, characters, i % 64, true)};
+    rows.emplace_back(fields);
+  }
+
+  // Scenario: every row lands where its rid says, and all pages but the tail are packed.
+  TableHeap *table_heap = TableHeap::Create(bpm_, schema.get(), nullptr, nullptr, nullptr);
+  std::vector<RowId> rids;
+  ASSERT_TRUE(table_heap->BulkInsert(rows, nullptr, &rids));
+  ASSERT_EQ(row_nums, rids.size());
+  std::unordered_map<page_id_t, int> rows_per_page;
+  for (int i = 0; i < row_nums; i++) {
+    ASSERT_EQ(rids[i], rows[i].GetRowId());
+    rows_per_page[rids[i].GetPageId()]++;
+    Row row(rids[i]);
+    ASSERT_TRUE(table_heap->GetTuple(&row, nullptr));
+    ASSERT_EQ(CmpBool::kTrue, row.GetField(0)->CompareEquals(Field(TypeId::kTypeInt, i)));
+  }
+  page_id_t tail_page_id = rids.back().GetPageId();
+  for (auto &page_rows : rows_per_page) {
+    if (page_rows.first == tail_page_id) {
+      continue;
+    }
+    auto page = reinterpret_cast<TablePage *>(bpm_->FetchPage(page_rows.first));
+    EXPECT_LT(page->GetFreeSpaceRemaining(), rows[0].GetSerializedSize(schema.get()) + 64 + sizeof(uint32_t) * 2);
+    bpm_->UnpinPage(page_rows.first, false);
+  }
+
+  // Scenario: single-row inserts keep working after a bulk append.
+  Fields fields{Field(TypeId::kTypeInt, row_nums), Field(TypeId::kTypeChar, characters, 8, true)};
+  Row row(fields);
+  ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+  int count = 0;
+  for (auto itr = table_heap->Begin(nullptr); itr != table_heap->End(); ++itr) {
+    count++;
+  }
+  EXPECT_EQ(row_nums + 1, count);
+
+  delete table_heap;
+  delete bpm_;
+  delete disk_mgr_;
+  remove(db_name.c_str());
+}
+
+
+TEST(TableHeapTest, IteratorPinTest) {
+  const std::string db_name = "table_heap_iterator_test.db";
+  remove(db_name.c_str());
+  auto disk_mgr_ = new DiskManager(db_name);
+  auto bpm_ = new BufferPoolManagerInstance(DEFAULT_BUFFER_POOL_SIZE, disk_mgr_);
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 128, 1, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  char characters[128];
+  memset(characters, 'c', sizeof(characters));
+  const int row_nums = 1000;
+  TableHeap *table_heap = TableHeap::Create(bpm_, schema.get(), nullptr, nullptr, nullptr);
+  std::vector<RowId> rids;
+  for (int i = 0; i < row_nums; i++) {
+    Fields fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, characters, 128, true)};
+    Row row(fields);
+    ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+    rids.push_back(row.GetRowId());
+  }
+
+  // Scenario: a scan visits every row in order and leaves no page pinned behind it.
+  {
+    int i = 0;
+    for (auto itr = table_heap->Begin(nullptr); itr != table_heap->End(); ++itr, ++i) {
+      ASSERT_EQ(rids[i], itr->GetRowId());
+      ASSERT_EQ(CmpBool::kTrue, (*itr).GetField(0)->CompareEquals(Field(TypeId::kTypeInt, i)));
+    }
+    EXPECT_EQ(row_nums, i);
+  }
+  EXPECT_TRUE(bpm_->CheckAllUnpinned());
+
+  // Scenario: empty pages at the head of the chain and deleted slots are skipped, copies hold their own pin.
+  int deleted = 0;
+  for (auto &rid : rids) {
+    if (rid.GetPageId() == table_heap->GetFirstPageId() || rid.GetSlotNum() % 2 == 1) {
+      ASSERT_TRUE(table_heap->MarkDelete(rid, nullptr));
+      table_heap->ApplyDelete(rid, nullptr);
+      deleted++;
+    }
+  }
+  {
+    auto begin = table_heap->Begin(nullptr);
+    ASSERT_NE(table_heap->GetFirstPageId(), begin->GetRowId().GetPageId());
+    TableIterator copy(begin);
+    int count = 0;
+    for (; begin != table_heap->End(); begin++) {
+      ASSERT_EQ(0, begin->GetRowId().GetSlotNum() % 2);
+      count++;
+    }
+    EXPECT_EQ(row_nums - deleted, count);
+    EXPECT_NE(table_heap->End(), copy);
+  }
+  EXPECT_TRUE(bpm_->CheckAllUnpinned());
+
+  delete table_heap;
+  delete bpm_;
+  delete disk_mgr_;
+  remove(db_name.c_str());
+}
+
+
+TEST(TableHeapTest, ScanPageTest) {
+  const std::string db_name = "table_heap_scan_page_test.db";
+  remove(db_name.c_str());
+  auto disk_mgr_ = new DiskManager(db_name);
+  auto bpm_ = new BufferPoolManagerInstance(DEFAULT_BUFFER_POOL_SIZE, disk_mgr_);
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 64, 1, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  char characters[64];
+  memset(characters, 'd', sizeof(characters));
+  const int row_nums = 3000;
+  TableHeap *table_heap = TableHeap::Create(bpm_, schema.get(), nullptr, nullptr, nullptr);
+  std::vector<RowId> rids;
+  std::unordered_map<int64_t, int> ids;
+  for (int i = 0; i < row_nums; i++) {
+    Fields fields{Field(TypeId::kTypeInt, i), Field(TypeId::kTypeChar, characters, i % 64, true)};
+    Row row(fields);
+    ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+    rids.push_back(row.GetRowId());
+    ids[row.GetRowId().Get()] = i;
+  }
+  for (int i = 0; i < row_nums; i += 3) {
+    ASSERT_TRUE(table_heap->MarkDelete(rids[i], nullptr));
+    table_heap->ApplyDelete(rids[i], nullptr);
+  }
+
+  // Scenario: walking the heap a page at a time returns exactly the live rows, in slot order within a page.
+  RowBatch batch;
+  int count = 0;
+  page_id_t page_id = table_heap->GetFirstPageId();
+  while (page_id != INVALID_PAGE_ID) {
+    ASSERT_TRUE(table_heap->ScanPage(page_id, batch, nullptr));
+    ASSERT_EQ(page_id, batch.GetPageId());
+    for (size_t i = 0; i < batch.Size(); i++, count++) {
+      ASSERT_EQ(page_id, batch.GetRowId(i).GetPageId());
+      if (i > 0) {
+        ASSERT_LT(batch.GetRowId(i - 1).GetSlotNum(), batch.GetRowId(i).GetSlotNum());
+      }
+      Row row;
+      batch.GetRow(i, &row, schema.get());
+      ASSERT_EQ(1, ids.count(row.GetRowId().Get()));
+      int id = ids[row.GetRowId().Get()];
+      ASSERT_NE(0, id % 3);
+      ASSERT_EQ(CmpBool::kTrue, row.GetField(0)->CompareEquals(Field(TypeId::kTypeInt, id)));
+      ASSERT_EQ(row.GetSerializedSize(schema.get()), batch.GetSpan(i).size);
+    }
+    page_id = batch.GetNextPageId();
+  }
+  EXPECT_EQ(row_nums - (row_nums + 2) / 3, count);
+  batch.Release();
+  EXPECT_TRUE(bpm_->CheckAllUnpinned());
+
+  delete table_heap;
+  delete bpm_;
+  delete disk_mgr_;
+  remove(db_name.c_str());
+}
+
+TEST(TableHeapTest, ColumnarHeapTest) {
+  const std::string db_name = "table_heap_columnar_test.db";
+  remove(db_name.c_str());
+  auto disk_mgr_ = new DiskManager(db_name);
+  auto bpm_ = new BufferPoolManagerInstance(DEFAULT_BUFFER_POOL_SIZE, disk_mgr_);
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 12, 1, true, false),
+                                   new Column("account", TypeId::kTypeFloat, 2, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  ASSERT_TRUE(PaxPage::CanStore(schema.get()));
+  schema->SetColumnar(true);
+  ASSERT_TRUE(schema->IsFixedWidth());
+  const int row_nums = 5000;
+  TableHeap *table_heap = TableHeap::Create(bpm_, schema.get(), nullptr, nullptr, nullptr);
+  std::vector<RowId> rids;
+  std::unordered_map<int64_t, int> ids;
+  auto make_fields = [](int i, std::string *name) {
+    *name = "name-" + std::to_string(i);
+    return Fields{Field(TypeId::kTypeInt, i),
+                  Field(TypeId::kTypeChar, const_cast<char *>(name->c_str()), name->size(), true),
+                  i % 7 == 0 ? Field(TypeId::kTypeFloat) : Field(TypeId::kTypeFloat, static_cast<float>(i) / 2)};
+  };
+  // the first half goes through InsertTuple, the second half through BulkInsert
+  std::string name;
+  for (int i = 0; i < row_nums / 2; i++) {
+    Fields fields = make_fields(i, &name);
+    Row row(fields);
+    ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+    rids.push_back(row.GetRowId());
+  }
+  std::vector<Row> bulk_rows;
+  for (int i = row_nums / 2; i < row_nums; i++) {
+    Fields fields = make_fields(i, &name);
+    bulk_rows.emplace_back(fields);
+  }
+  ASSERT_TRUE(table_heap->BulkInsert(bulk_rows, nullptr, &rids));
+  ASSERT_EQ(row_nums, rids.size());
+  for (int i = 0; i < row_nums; i++) {
+    ASSERT_EQ(0, ids.count(rids[i].Get()));
+    ids[rids[i].Get()] = i;
+  }
+  // a value longer than its column is refused
+  std::string long_name(13, 'x');
+  Fields long_fields{Field(TypeId::kTypeInt, -1),
+                     Field(TypeId::kTypeChar, const_cast<char *>(long_name.c_str()), 13, true),
+                     Field(TypeId::kTypeFloat, 0.f)};
+  Row long_row(long_fields);
+  ASSERT_FALSE(table_heap->InsertTuple(long_row, nullptr));
+
+  // Scenario: point reads, in-place updates and deletes work on PAX pages.
+  for (int i = 0; i < row_nums; i += 5) {
+    Fields fields = make_fields(i + 100000, &name);
+    Row row(fields);
+    ASSERT_TRUE(table_heap->UpdateTuple(row, rids[i], nullptr));
+  }
+  for (int i = 1; i < row_nums; i += 5) {
+    ASSERT_TRUE(table_heap->MarkDelete(rids[i], nullptr));
+    table_heap->ApplyDelete(rids[i], nullptr);
+  }
+  ASSERT_TRUE(table_heap->MarkDelete(rids[2], nullptr));
+  table_heap->RollbackDelete(rids[2], nullptr);
+  for (int i = 0; i < row_nums; i++) {
+    Row row(rids[i]);
+    if (i % 5 == 1) {
+      ASSERT_FALSE(table_heap->GetTuple(&row, nullptr));
+      continue;
+    }
+    ASSERT_TRUE(table_heap->GetTuple(&row, nullptr));
+    int id = i % 5 == 0 ? i + 100000 : i;
+    Fields fields = make_fields(id, &name);
+    for (size_t j = 0; j < fields.size(); j++) {
+      if (fields[j].IsNull()) {
+        ASSERT_TRUE(row.GetField(j)->IsNull());
+      } else {
+        ASSERT_EQ(CmpBool::kTrue, row.GetField(j)->CompareEquals(fields[j]));
+      }
+    }
+  }
+  int live_rows = row_nums - row_nums / 5;
+
+  // Scenario: the iterator and a page at a time scan see the same live rows, read through views and masks.
+  int count = 0;
+  for (auto iter = table_heap->Begin(nullptr); iter != table_heap->End(); ++iter) {
+    ASSERT_NE(1, ids[iter->GetRowId().Get()] % 5);
+    count++;
+  }
+  EXPECT_EQ(live_rows, count);
+  RowBatch batch;
+  RowView view;
+  count = 0;
+  size_t pages = 0;
+  for (page_id_t page_id = table_heap->GetFirstPageId(); page_id != INVALID_PAGE_ID; page_id = batch.GetNextPageId()) {
+    ASSERT_TRUE(table_heap->ScanPage(page_id, batch, nullptr));
+    pages++;
+    for (size_t i = 0; i < batch.Size(); i++, count++) {
+      int i_row = ids[batch.GetRowId(i).Get()];
+      int id = i_row % 5 == 0 ? i_row + 100000 : i_row;
+      batch.GetView(i, schema.get(), &view);
+      ASSERT_EQ(id, view.GetInt(0));
+      ASSERT_EQ(id % 7 == 0, view.IsNull(2));
+      uint32_t len;
+      const char *chars = view.GetChars(1, &len);
+      ASSERT_EQ("name-" + std::to_string(id), std::string(chars, len));
+      Row row;
+      batch.GetRow(i, &row, schema.get());
+      ASSERT_EQ(CmpBool::kTrue, row.GetField(0)->CompareEquals(Field(TypeId::kTypeInt, id)));
+      Row masked;
+      std::vector<bool> mask{false, true, false};
+      batch.GetRow(i, &masked, schema.get(), &mask);
+      ASSERT_TRUE(masked.GetField(0)->IsNull());
+      ASSERT_TRUE(masked.GetField(2)->IsNull());
+      ASSERT_EQ(CmpBool::kTrue, masked.GetField(1)->CompareEquals(view.GetField(1)));
+    }
+  }
+  EXPECT_EQ(live_rows, count);
+  // a PAX page is filled completely, the table takes no more pages than its rows need
+  uint32_t tuple_space = PaxPage::GetTupleSpace(schema.get());
+  EXPECT_LE(pages, static_cast<size_t>(row_nums) * tuple_space / (PAGE_SIZE - 64) + 2);
+  batch.Release();
+  EXPECT_TRUE(bpm_->CheckAllUnpinned());
+
+  delete table_heap;
+  delete bpm_;
+  delete disk_mgr_;
+  remove(db_name.c_str());
+}
+
+TEST(TableHeapTest, ZoneMapTest) {
+  const std::string db_name = "table_heap_zone_map_test.db";
+  remove(db_name.c_str());
+  auto disk_mgr_ = new DiskManager(db_name);
+  auto bpm_ = new BufferPoolManagerInstance(DEFAULT_BUFFER_POOL_SIZE, disk_mgr_);
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 64, 1, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  char characters[64];
+  memset(characters, 'a', sizeof(characters));
+  // ids grow with the insert order, every tenth name is null
+  auto make_row = [&](int i) {
+    Fields fields{Field(TypeId::kTypeInt, i), i % 10 == 0 ? Field(TypeId::kTypeChar)
+                                                          : Field(TypeId::kTypeChar, characters, 64, true)};
+    return Row(fields);
+  };
+  const int row_nums = 2000;
+  TableHeap *table_heap = TableHeap::Create(bpm_, schema.get(), nullptr, nullptr, nullptr);
+  std::unordered_map<page_id_t, std::pair<int, int>> id_ranges;
+  for (int i = 0; i < row_nums; i++) {
+    Row row = make_row(i);
+    ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+    auto iter = id_ranges.emplace(row.GetRowId().GetPageId(), std::make_pair(i, i)).first;
+    iter->second.second = i;
+  }
+  std::vector<page_id_t> page_ids;
+  table_heap->GetPageIds(&page_ids);
+  ASSERT_GT(page_ids.size(), 2);
+  auto check_zones = [&]() {
+    for (page_id_t page_id : page_ids) {
+      auto range = id_ranges[page_id];
+      EXPECT_TRUE(table_heap->PageMayMatch(page_id, 0, "=", Field(kTypeInt, range.first)));
+      EXPECT_TRUE(table_heap->PageMayMatch(page_id, 0, "<=", Field(kTypeInt, range.first)));
+      EXPECT_FALSE(table_heap->PageMayMatch(page_id, 0, "<", Field(kTypeInt, range.first)));
+      EXPECT_FALSE(table_heap->PageMayMatch(page_id, 0, ">", Field(kTypeInt, range.second)));
+      EXPECT_FALSE(table_heap->PageMayMatch(page_id, 0, "=", Field(kTypeInt, range.second + 1)));
+      EXPECT_TRUE(table_heap->PageMayMatch(page_id, 0, "<>", Field(kTypeInt, range.second + 1)));
+      EXPECT_FALSE(table_heap->PageMayMatch(page_id, 0, "is", Field(kTypeInt)));
+      EXPECT_TRUE(table_heap->PageMayMatch(page_id, 1, "is", Field(kTypeChar)));
+      EXPECT_FALSE(table_heap->PageMayMatch(page_id, 1, "=", Field(kTypeChar, const_cast<char *>("b"), 1, true)));
+    }
+  };
+  check_zones();
+
+  // Scenario: an update widens the zone of its page.
+  page_id_t first_page_id = table_heap->GetFirstPageId();
+  Row updated = make_row(row_nums * 2);
+  ASSERT_TRUE(table_heap->UpdateTuple(updated, RowId(first_page_id, 1), nullptr));
+  EXPECT_TRUE(table_heap->PageMayMatch(first_page_id, 0, "=", Field(kTypeInt, row_nums * 2)));
+  id_ranges[first_page_id].second = row_nums * 2;
+
+  // Scenario: a reopened heap knows no zone until a scan reads the page.
+  page_id_t fsm_page_id = table_heap->GetFreeSpaceMapPageId();
+  delete table_heap;
+  table_heap = TableHeap::Create(bpm_, first_page_id, fsm_page_id, schema.get(), nullptr, nullptr);
+  EXPECT_TRUE(table_heap->PageMayMatch(page_ids[1], 0, "<", Field(kTypeInt, 0)));
+  RowBatch batch;
+  for (page_id_t page_id : page_ids) {
+    ASSERT_TRUE(table_heap->ScanPage(page_id, batch, nullptr));
+  }
+  batch.Release();
+  check_zones();
+
+  delete table_heap;
+  delete bpm_;
+  delete disk_mgr_;
+  remove(db_name.c_str());
+}
+
+TEST(TableHeapTest, OverflowValueTest) {
+  const std::string db_name = "table_heap_overflow_test.db";
+  remove(db_name.c_str());
+  auto disk_mgr_ = new DiskManager(db_name);
+  auto bpm_ = new BufferPoolManagerInstance(DEFAULT_BUFFER_POOL_SIZE, disk_mgr_);
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("payload", TypeId::kTypeChar, 3 * PAGE_SIZE, 1, true, false),
+                                   new Column("note", TypeId::kTypeChar, 64, 2, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  // payloads from a few bytes up to three pages, only the long ones go out of line
+  auto payload_of = [](int i) { return std::string((i * 397) % (3 * PAGE_SIZE), static_cast<char>('a' + i % 26)); };
+  auto make_row = [&](int i, const std::string &payload) {
+    std::string note = "note-" + std::to_string(i);
+    Fields fields{Field(TypeId::kTypeInt, i),
+                  Field(TypeId::kTypeChar, const_cast<char *>(payload.c_str()), payload.size(), true),
+                  Field(TypeId::kTypeChar, const_cast<char *>(note.c_str()), note.size(), true)};
+    return Row(fields);
+  };
+  const int row_nums = 300;
+  TableHeap *table_heap = TableHeap::Create(bpm_, schema.get(), nullptr, nullptr, nullptr);
+  std::vector<RowId> rids;
+  for (int i = 0; i < row_nums; i++) {
+    std::string payload = payload_of(i);
+    Row row = make_row(i, payload);
+    ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+    // the caller's row keeps its values
+    ASSERT_TRUE(row.GetExternalValues().empty());
+    ASSERT_EQ(payload.size(), row.GetField(1)->GetLength());
+    rids.push_back(row.GetRowId());
+  }
+  // the heap pages hold pointers only, so they stay dense
+  std::vector<page_id_t> page_ids;
+  table_heap->GetPageIds(&page_ids);
+  EXPECT_LT(page_ids.size(), row_nums / 8);
+
+  auto check_row = [&](int i, const std::string &payload) {
+    Row row(rids[i]);
+    ASSERT_TRUE(table_heap->GetTuple(&row, nullptr));
+    ASSERT_TRUE(row.GetExternalValues().empty());
+    ASSERT_EQ(payload.size(), row.GetField(1)->GetLength());
+    EXPECT_EQ(0, memcmp(payload.c_str(), row.GetField(1)->GetData(), payload.size()));
+  };
+  for (int i = 0; i < row_nums; i++) {
+    check_row(i, payload_of(i));
+  }
+
+  // Scenario: a scan that does not read the payload leaves it in the overflow pages.
+  RowBatch batch;
+  std::vector<bool> needed_columns{true, false, true};
+  int external = 0;
+  int rows = 0;
+  for (page_id_t page_id = table_heap->GetFirstPageId(); page_id != INVALID_PAGE_ID; page_id = batch.GetNextPageId()) {
+    ASSERT_TRUE(table_heap->ScanPage(page_id, batch, nullptr));
+    RowView view;
+    for (size_t i = 0; i < batch.Size(); i++, rows++) {
+      batch.GetView(i, schema.get(), &view);
+      int id = view.GetInt(0);
+      std::string payload = payload_of(id);
+      // the payload is the only long value, it goes out of line whenever the tuple is too large
+      EXPECT_EQ(make_row(id, payload).GetSerializedSize(schema.get()) > TOAST_TUPLE_THRESHOLD, view.IsExternal(1));
+      external += view.IsExternal(1);
+      // reading the value through the view follows the pointer
+      Field field = view.GetField(1);
+      ASSERT_EQ(payload.size(), field.GetLength());
+      EXPECT_EQ(0, memcmp(payload.c_str(), field.GetData(), payload.size()));
+      Row row;
+      batch.GetRow(i, &row, schema.get(), &needed_columns);
+      EXPECT_TRUE(row.GetField(1)->IsNull());
+      EXPECT_TRUE(row.GetExternalValues().empty());
+      EXPECT_EQ(CmpBool::kTrue, row.GetField(0)->CompareEquals(Field(kTypeInt, id)));
+    }
+  }
+  batch.Release();
+  EXPECT_EQ(row_nums, rows);
+  EXPECT_GT(external, row_nums / 2);
+
+  // Scenario: updates move values in and out of line, deletes free the overflow pages.
+  std::string longer(2 * PAGE_SIZE + 17, 'x');
+  std::string shorter = "short";
+  Row update_long = make_row(1, longer);
+  ASSERT_TRUE(table_heap->UpdateTuple(update_long, rids[1], nullptr));
+  check_row(1, longer);
+  Row update_short = make_row(2, shorter);
+  ASSERT_TRUE(table_heap->UpdateTuple(update_short, rids[2], nullptr));
+  check_row(2, shorter);
+  for (int i = 3; i < row_nums; i += 2) {
+    ASSERT_TRUE(table_heap->MarkDelete(rids[i], nullptr));
+    table_heap->ApplyDelete(rids[i], nullptr);
+  }
+  std::unordered_map<int64_t, int> ids;
+  for (int i = 0; i < row_nums; i++) {
+    ids[rids[i].Get()] = i;
+  }
+  rows = 0;
+  for (auto itr = table_heap->Begin(nullptr); itr != table_heap->End(); ++itr) {
+    int id = ids[itr->GetRowId().Get()];
+    ASSERT_EQ(CmpBool::kTrue, itr->GetField(0)->CompareEquals(Field(kTypeInt, id)));
+    EXPECT_TRUE(id < 3 || id % 2 == 0);
+    if (id > 2) {
+      std::string payload = payload_of(id);
+      ASSERT_EQ(payload.size(), itr->GetField(1)->GetLength());
+      EXPECT_EQ(0, memcmp(payload.c_str(), itr->GetField(1)->GetData(), payload.size()));
+    }
+    rows++;
+  }
+  EXPECT_EQ(row_nums / 2 + 1, rows);
+
+  table_heap->DeleteTable();
+  EXPECT_TRUE(bpm_->CheckAllUnpinned());
+  delete table_heap;
+  delete bpm_;
+  delete disk_mgr_;
+  remove(db_name.c_str());
+}
+
+TEST(TableHeapTest, ForwardingUpdateTest) {
+  const std::string db_name = "table_heap_forwarding_test.db";
+  remove(db_name.c_str());
+  auto disk_mgr_ = new DiskManager(db_name);
+  auto bpm_ = new BufferPoolManagerInstance(DEFAULT_BUFFER_POOL_SIZE, disk_mgr_);
+  std::vector<Column *> columns = {new Column("id", TypeId::kTypeInt, 0, false, false),
+                                   new Column("name", TypeId::kTypeChar, 900, 1, true, false)};
+  auto schema = std::make_shared<Schema>(columns);
+  auto make_row = [](int i, const std::string &name) {
+    Fields fields{Field(TypeId::kTypeInt, i),
+                  Field(TypeId::kTypeChar, const_cast<char *>(name.c_str()), name.size(), true)};
+    return Row(fields);
+  };
+  // names stay below the toast threshold, a grown row has to move
+  auto name_of = [](int i, size_t len) { return std::string(len, static_cast<char>('a' + i % 26)); };
+  const int row_nums = 300;
+  TableHeap *table_heap = TableHeap::Create(bpm_, schema.get(), nullptr, nullptr, nullptr);
+  std::vector<RowId> rids;
+  std::vector<std::string> names;
+  for (int i = 0; i < row_nums; i++) {
+    names.push_back(name_of(i, 8));
+    Row row = make_row(i, names[i]);
+    ASSERT_TRUE(table_heap->InsertTuple(row, nullptr));
+    rids.push_back(row.GetRowId());
+  }
+  std::unordered_map<int64_t, int> ids;
+  for (int i = 0; i < row_nums; i++) {
+    ids[rids[i].Get()] = i;
+  }
+  auto check_row = [&](int i) {
+    Row row(rids[i]);
+    ASSERT_TRUE(table_heap->GetTuple(&row, nullptr));
+    EXPECT_EQ(rids[i].Get(), row.GetRowId().Get());
+    ASSERT_EQ(CmpBool::kTrue, row.GetField(0)->CompareEquals(Field(kTypeInt, i)));
+    ASSERT_EQ(names[i].size(), row.GetField(1)->GetLength());
+    EXPECT_EQ(0, memcmp(names[i].c_str(), row.GetField(1)->GetData(), names[i].size()));
+  };
+  // every live row is seen once by both kinds of scan, under its original rid and with its latest values
+  auto check_scans = [&](const std::vector<bool> &live) {
+    std::vector<int> seen(row_nums, 0);
+    RowBatch batch;
+    for (page_id_t page_id = table_heap->GetFirstPageId(); page_id != INVALID_PAGE_ID;
+         page_id = batch.GetNextPageId()) {
+      ASSERT_TRUE(table_heap->ScanPage(page_id, batch, nullptr));
+      RowView view;
+      for (size_t i = 0; i < batch.Size(); i++) {
+        batch.GetView(i, schema.get(), &view);
+        int id = view.GetInt(0);
+        ASSERT_EQ(rids[id].Get(), batch.GetRowId(i).Get());
+        ASSERT_EQ(names[id].size(), view.GetField(1).GetLength());
+        seen[id]++;
+      }
+    }
+    batch.Release();
+    for (auto itr = table_heap->Begin(nullptr); itr != table_heap->End(); ++itr) {
+      int id = ids[itr->GetRowId().Get()];
+      ASSERT_EQ(CmpBool::kTrue, itr->GetField(0)->CompareEquals(Field(kTypeInt, id)));
+      ASSERT_EQ(names[id].size(), itr->GetField(1)->GetLength());
+      seen[id] += 2;
+    }
+    for (int i = 0; i < row_nums; i++) {
+      ASSERT_EQ(live[i] ? 3 : 0, seen[i]) << "row " << i;
+    }
+  };
+  std::vector<bool> live(row_nums, true);
+  check_scans(live);
+
+  // Scenario: rows grow past the room left in their page and move, their rids stay.
+  for (int i = 0; i < row_nums; i++) {
+    names[i] = name_of(i, 600);
+    ASSERT_TRUE(table_heap->UpdateTuple(make_row(i, names[i]), rids[i], nullptr));
+  }
+  std::vector<page_id_t> page_ids;
+  table_heap->GetPageIds(&page_ids);
+  EXPECT_GT(page_ids.size(), row_nums * 600 / PAGE_SIZE);
+  for (int i = 0; i < row_nums; i++) {
+    check_row(i);
+  }
+  check_scans(live);
+
+  // Scenario: moved rows move again, or shrink where they are.
+  for (int i = 0; i < row_nums; i++) {
+    names[i] = name_of(i, i % 3 == 0 ? 4 : 900);
+    ASSERT_TRUE(table_heap->UpdateTuple(make_row(i, names[i]), rids[i], nullptr));
+  }
+  for (int i = 0; i < row_nums; i++) {
+    check_row(i);
+  }
+  check_scans(live);
+
+  // Scenario: deleting through the home slot hides and removes the moved tuple.
+  ASSERT_TRUE(table_heap->MarkDelete(rids[1], nullptr));
+  live[1] = false;
+  check_scans(live);
+  table_heap->RollbackDelete(rids[1], nullptr);
+  live[1] = true;
+  check_scans(live);
+  for (int i = 0; i < row_nums; i += 2) {
+    ASSERT_TRUE(table_heap->MarkDelete(rids[i], nullptr));
+    table_heap->ApplyDelete(rids[i], nullptr);
+    live[i] = false;
+    Row row(rids[i]);
+    EXPECT_FALSE(table_heap->GetTuple(&row, nullptr));
+  }
+  check_scans(live);
+  // an update of a deleted row fails instead of moving it back to life
+  EXPECT_FALSE(table_heap->UpdateTuple(make_row(0, names[0]), rids[0], nullptr));
+  check_scans(live);
+
+  table_heap->DeleteTable();
+  EXPECT_TRUE(bpm_->CheckAllUnpinned());
+  delete table_heap;
+  delete bpm_;
+  delete disk_mgr_;
+  remove(db_name.c_str());
+}